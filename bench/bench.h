@@ -0,0 +1,299 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+/**
+ * @file bench.h
+ * @brief the helpers for the benchmarks
+ * @details Each benchmark prints one JSON object per line, so that the result of `make bench`
+ *          (bench.jsonl) can be compared across commits. The first argument of a benchmark
+ *          is the scale factor of the workload (1 by default, or the environment variable BENCH_SCALE).
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+#include <adam.h>
+/**
+ * @brief get current time
+ * @return the time in nanoseconds
+ **/
+static inline uint64_t bench_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+/**
+ * @brief get the scale factor of the workload
+ * @param argc the argc of main
+ * @param argv the argv of main
+ * @return the scale factor
+ **/
+static inline int bench_scale(int argc, char** argv)
+{
+	const char* str = (argc > 1) ? argv[1] : getenv("BENCH_SCALE");
+	int scale = (NULL == str) ? 1 : atoi(str);
+	return (scale > 0) ? scale : 1;
+}
+/**
+ * @brief initialize libadam for benchmarking
+ * @details the debug logs are filtered out at run time, so that they do not dominate the result
+ * @return nothing
+ **/
+static inline void bench_init()
+{
+	assert(0 == adam_init());
+	log_set_filter(NULL, WARNING);
+}
+/**
+ * @brief report the result of a benchmark
+ * @param name the name of the benchmark
+ * @param size the size of the workload
+ * @param ops the number of operations
+ * @param ns the time spent in nanoseconds
+ * @return nothing
+ **/
+static inline void bench_report(const char* name, uint64_t size, uint64_t ops, uint64_t ns)
+{
+	printf("{\"benchmark\": \"%s\", \"size\": %llu, \"ops\": %llu, \"total_ns\": %llu, \"ns_per_op\": %.2f, \"log_level\": %d}\n",
+		   name,
+		   (unsigned long long)size,
+		   (unsigned long long)ops,
+		   (unsigned long long)ns,
+		   (ops > 0) ? (double)ns / ops : 0.0,
+		   LOG_LEVEL);
+	fflush(stdout);
+}
+/** @brief measure a piece of code, and report the result */
+#define BENCH(name, size, ops, code...) do{\
+	uint64_t __bench_begin = bench_now();\
+	code;\
+	bench_report(name, size, ops, bench_now() - __bench_begin);\
+}while(0)
+
+/** @brief a growing text buffer used to generate programs */
+typedef struct {
+	char*  data;  /*!< the text */
+	size_t size;  /*!< the length of the text */
+	size_t cap;   /*!< the capacity of the buffer */
+} bench_text_t;
+/**
+ * @brief append formatted text to the buffer
+ * @param text the buffer
+ * @param fmt the format string
+ * @return nothing
+ **/
+static inline void bench_text_printf(bench_text_t* text, const char* fmt, ...)
+	__attribute__((format (printf, 2, 3)));
+static inline void bench_text_printf(bench_text_t* text, const char* fmt, ...)
+{
+	va_list ap;
+	for(;;)
+	{
+		size_t avail = text->cap - text->size;
+		va_start(ap, fmt);
+		int rc = vsnprintf(text->data + text->size, avail, fmt, ap);
+		va_end(ap);
+		assert(rc >= 0);
+		if((size_t)rc < avail)
+		{
+			text->size += rc;
+			return;
+		}
+		text->cap = (text->cap == 0) ? 4096 : text->cap * 2;
+		if(text->cap < text->size + rc + 1) text->cap = text->size + rc + 1;
+		char* data = (char*)realloc(text->data, text->cap);
+		assert(NULL != data);
+		text->data = data;
+	}
+}
+/**
+ * @brief generate a call chain BenchChain/f0 -> f1 -> ... -> f(depth-1)
+ * @param text the output buffer
+ * @param depth the length of the chain
+ * @return nothing
+ **/
+static inline void bench_program_chain(bench_text_t* text, int depth)
+{
+	int i;
+	bench_text_printf(text, "(class (attrs public) BenchChain\n\t(super java/lang/Object)\n");
+	for(i = 0; i < depth; i ++)
+	{
+		bench_text_printf(text, "\t(method (attrs public static) f%d(int) int\n\t\t(limit-registers 3)\n", i);
+		if(i + 1 < depth)
+			bench_text_printf(text,
+				"\t\t(const v0 1)\n"
+				"\t\t(add-int v1 v2 v0)\n"
+				"\t\t(invoke-static {v1} BenchChain/f%d (int) int)\n"
+				"\t\t(move-result v1)\n"
+				"\t\t(return v1)\n", i + 1);
+		else
+			bench_text_printf(text, "\t\t(return v2)\n");
+		bench_text_printf(text, "\t)\n");
+	}
+	bench_text_printf(text, ")\n");
+}
+/**
+ * @brief generate a method BenchSwitch/run(int) with a packed switch
+ * @param text the output buffer
+ * @param width the number of cases
+ * @return nothing
+ **/
+static inline void bench_program_switch(bench_text_t* text, int width)
+{
+	int i;
+	bench_text_printf(text,
+		"(class (attrs public) BenchSwitch\n"
+		"\t(super java/lang/Object)\n"
+		"\t(method (attrs public static) run(int) int\n"
+		"\t\t(limit-registers 2)\n"
+		"\t\t(packed-switch v1 0");
+	for(i = 0; i < width; i ++)
+		bench_text_printf(text, " BenchSwitch_L%d", i);
+	bench_text_printf(text, " BenchSwitch_Ldefault)\n");
+	for(i = 0; i < width; i ++)
+		bench_text_printf(text, "\t\t(label BenchSwitch_L%d)\n\t\t(const v0 %d)\n\t\t(goto BenchSwitch_Lend)\n", i, i);
+	bench_text_printf(text,
+		"\t\t(label BenchSwitch_Ldefault)\n"
+		"\t\t(const v0 -1)\n"
+		"\t\t(label BenchSwitch_Lend)\n"
+		"\t\t(return v0)\n"
+		"\t)\n"
+		")\n");
+}
+/**
+ * @brief generate a method BenchLoop/run() with nested counting loops
+ * @param text the output buffer
+ * @param nesting the depth of the loop nest
+ * @return nothing
+ **/
+static inline void bench_program_loop(bench_text_t* text, int nesting)
+{
+	int i;
+	/* v0: the accumulator, v1: the constant 1, v2: the bound, v(3+i): the counter of loop i */
+	bench_text_printf(text,
+		"(class (attrs public) BenchLoop\n"
+		"\t(super java/lang/Object)\n"
+		"\t(method (attrs public static) run() int\n"
+		"\t\t(limit-registers %d)\n"
+		"\t\t(const v0 0)\n"
+		"\t\t(const v1 1)\n"
+		"\t\t(const v2 100)\n", nesting + 3);
+	for(i = 0; i < nesting; i ++)
+		bench_text_printf(text,
+			"\t\t(const v%d 0)\n"
+			"\t\t(label BenchLoop_Begin%d)\n"
+			"\t\t(if-ge v%d v2 BenchLoop_End%d)\n", i + 3, i, i + 3, i);
+	bench_text_printf(text, "\t\t(add-int v0 v0 v1)\n");
+	for(i = nesting - 1; i >= 0; i --)
+		bench_text_printf(text,
+			"\t\t(add-int v%d v%d v1)\n"
+			"\t\t(goto BenchLoop_Begin%d)\n"
+			"\t\t(label BenchLoop_End%d)\n", i + 3, i + 3, i, i);
+	bench_text_printf(text, "\t\t(return v0)\n\t)\n)\n");
+}
+/**
+ * @brief generate many classes BenchClass0 .. BenchClass(n-1) and a method BenchMany/run() which
+ *        instantiates each of them and invokes a virtual method on it
+ * @param text the output buffer
+ * @param n the number of classes
+ * @return nothing
+ **/
+static inline void bench_program_classes(bench_text_t* text, int n)
+{
+	int i;
+	for(i = 0; i < n; i ++)
+		bench_text_printf(text,
+			"(class (attrs public) BenchClass%d\n"
+			"\t(super %s)\n"
+			"\t(field (attrs public) value int)\n"
+			"\t(method (attrs public) get() int\n"
+			"\t\t(limit-registers 2)\n"
+			"\t\t(iget v0 v1 BenchClass%d.value int)\n"
+			"\t\t(return v0)\n"
+			"\t)\n"
+			")\n", i, (i % 8 == 0) ? "java/lang/Object" : "BenchClassBase", i);
+	bench_text_printf(text,
+		"(class (attrs public) BenchClassBase\n"
+		"\t(super java/lang/Object)\n"
+		"\t(field (attrs public) base int)\n"
+		")\n"
+		"(class (attrs public) BenchMany\n"
+		"\t(super java/lang/Object)\n"
+		"\t(method (attrs public static) run() int\n"
+		"\t\t(limit-registers 3)\n");
+	for(i = 0; i < n; i ++)
+		bench_text_printf(text,
+			"\t\t(new-instance v0 BenchClass%d)\n"
+			"\t\t(const v1 %d)\n"
+			"\t\t(iput v1 v0 BenchClass%d.value int)\n"
+			"\t\t(invoke-virtual {v0} BenchClass%d/get () int)\n"
+			"\t\t(move-result v2)\n", i, i, i, i);
+	bench_text_printf(text, "\t\t(return v2)\n\t)\n)\n");
+}
+/**
+ * @brief generate a method BenchFanin/run() which invokes BenchFanin/f0 from n call sites with
+ *        different arguments, and f0 calls a chain of depth methods
+ * @param text the output buffer
+ * @param n the number of call sites
+ * @param depth the length of the chain
+ * @return nothing
+ **/
+static inline void bench_program_fanin(bench_text_t* text, int n, int depth)
+{
+	int i;
+	bench_text_printf(text,
+		"(class (attrs public) BenchFanin\n"
+		"\t(super java/lang/Object)\n"
+		"\t(method (attrs public static) run() int\n"
+		"\t\t(limit-registers 2)\n");
+	for(i = 0; i < n; i ++)
+		bench_text_printf(text,
+			"\t\t(const v0 %d)\n"
+			"\t\t(invoke-static {v0} BenchFanin/f0 (int) int)\n"
+			"\t\t(move-result v1)\n", (i % 3) - 1);
+	bench_text_printf(text, "\t\t(return v1)\n\t)\n");
+	for(i = 0; i < depth; i ++)
+	{
+		bench_text_printf(text, "\t(method (attrs public static) f%d(int) int\n\t\t(limit-registers 3)\n", i);
+		if(i + 1 < depth)
+			bench_text_printf(text,
+				"\t\t(const v0 1)\n"
+				"\t\t(add-int v1 v2 v0)\n"
+				"\t\t(invoke-static {v1} BenchFanin/f%d (int) int)\n"
+				"\t\t(move-result v1)\n"
+				"\t\t(return v1)\n", i + 1);
+		else
+			bench_text_printf(text, "\t\t(move v0 v2)\n\t\t(return v0)\n");
+		bench_text_printf(text, "\t)\n");
+	}
+	bench_text_printf(text, ")\n");
+}
+/**
+ * @brief load the classes in the program text
+ * @param text the program text
+ * @return the number of classes loaded
+ **/
+static inline int bench_program_load(const char* text)
+{
+	int count = 0;
+	const char* ptr;
+	for(ptr = text; NULL != ptr && ptr[0] != 0;)
+	{
+		sexpression_t* sexp;
+		if(NULL == (ptr = sexp_parse(ptr, &sexp)))
+		{
+			assert(SEXP_EOF == sexp);
+			break;
+		}
+		if(SEXP_NIL == sexp) continue;
+		assert(NULL != dalvik_class_from_sexp(sexp));
+		sexp_free(sexp);
+		count ++;
+	}
+	return count;
+}
+#endif
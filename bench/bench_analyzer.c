@@ -0,0 +1,89 @@
+#include "bench.h"
+/**
+ * @brief analyze a static method of the generated program
+ * @param name the name of the benchmark
+ * @param size the size of the program
+ * @param classpath the class path
+ * @param methodname the method name
+ * @param args the argument type list
+ * @param rtype the return type
+ * @return nothing
+ **/
+static void analyze(const char* name, int size, const char* classpath, const char* methodname, const dalvik_type_t * const * args, const dalvik_type_t* rtype)
+{
+	char buf[128];
+	const dalvik_block_t* graph = NULL;
+	snprintf(buf, sizeof(buf), "analyzer.%s.block_graph", name);
+	BENCH(buf, size, 1, graph = dalvik_block_from_method(stringpool_query(classpath), stringpool_query(methodname), args, rtype));
+	assert(NULL != graph);
+
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	/* the integer argument is always the last register */
+	if(NULL != args[0])
+		cesk_set_push(frame->regs[CESK_FRAME_GENERAL_REG(graph->nregs - 1)], CESK_STORE_ADDR_POS);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = NULL;
+	snprintf(buf, sizeof(buf), "analyzer.%s.analyze", name);
+	BENCH(buf, size, 1, ret = cesk_method_analyze(graph, frame, NULL, &rtab));
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+}
+/**
+ * @brief parse and load a generated program
+ * @param name the name of the benchmark
+ * @param size the size of the program
+ * @param text the program text
+ * @return nothing
+ **/
+static void load(const char* name, int size, bench_text_t* text)
+{
+	char buf[128];
+	snprintf(buf, sizeof(buf), "analyzer.%s.load", name);
+	int nclasses = 0;
+	BENCH(buf, size, 1, nclasses = bench_program_load(text->data));
+	assert(nclasses > 0);
+	free(text->data);
+	text->data = NULL;
+	text->size = text->cap = 0;
+}
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	assert(NULL != tint);
+	const dalvik_type_t* noarg[1] = {NULL};
+	const dalvik_type_t* intarg[2] = {tint, NULL};
+
+	bench_text_t text = {};
+	int depth = 32 * scale;
+	int width = 64 * scale;
+	int nesting = 2 + scale;
+	int nclasses = 64 * scale;
+
+	bench_program_chain(&text, depth);
+	load("chain", depth, &text);
+	analyze("chain", depth, "BenchChain", "f0", intarg, tint);
+
+	bench_program_switch(&text, width);
+	load("switch", width, &text);
+	analyze("switch", width, "BenchSwitch", "run", intarg, tint);
+
+	bench_program_loop(&text, nesting);
+	load("loop", nesting, &text);
+	analyze("loop", nesting, "BenchLoop", "run", noarg, tint);
+
+	bench_program_classes(&text, nclasses);
+	load("classes", nclasses, &text);
+	analyze("classes", nclasses, "BenchMany", "run", noarg, tint);
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include "bench.h"
+/**
+ * @brief make a diff that modifies the registers
+ * @param nregs the number of registers
+ * @param seed the seed of the register values
+ * @param reverse if this diff is a inverse diff
+ * @return the diff
+ **/
+static cesk_diff_t* make_diff(int nregs, int seed, int reverse)
+{
+	cesk_diff_buffer_t* buf = cesk_diff_buffer_new(reverse, 0);
+	assert(NULL != buf);
+	int i;
+	for(i = 0; i < nregs; i ++)
+	{
+		cesk_set_t* set = cesk_set_empty_set();
+		cesk_set_push(set, (seed + i) % 3 ? CESK_STORE_ADDR_POS : CESK_STORE_ADDR_NEG);
+		assert(0 == cesk_diff_buffer_append(buf, CESK_DIFF_REG, CESK_FRAME_GENERAL_REG(i), set));
+		cesk_set_free(set);
+	}
+	cesk_diff_t* ret = cesk_diff_from_buffer(buf);
+	cesk_diff_buffer_free(buf);
+	assert(NULL != ret);
+	return ret;
+}
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+	int nregs = 64;
+	int n = 1000 * scale;
+	int i;
+	cesk_diff_t* diffs[4];
+	cesk_diff_t* invs[4];
+	cesk_frame_t* frames[4];
+	for(i = 0; i < 4; i ++)
+	{
+		diffs[i] = make_diff(nregs, i, 0);
+		invs[i] = make_diff(nregs, i + 1, 1);
+		frames[i] = cesk_frame_new(nregs);
+		assert(NULL != frames[i]);
+	}
+
+	BENCH("cesk_diff.from_buffer", nregs, n, 
+		for(i = 0; i < n; i ++)
+			cesk_diff_free(make_diff(nregs, i, 0));
+	);
+
+	BENCH("cesk_diff.apply", nregs, n, 
+		for(i = 0; i < n; i ++)
+		{
+			cesk_diff_t* ret = cesk_diff_apply(4, diffs);
+			assert(NULL != ret);
+			cesk_diff_free(ret);
+		}
+	);
+
+	BENCH("cesk_diff.factorize", nregs, n, 
+		for(i = 0; i < n; i ++)
+		{
+			cesk_diff_t* args[4] = {diffs[0], diffs[1], diffs[2], diffs[3]};
+			cesk_diff_t* ret = cesk_diff_factorize(4, args, (const cesk_frame_t**)frames);
+			assert(NULL != ret);
+			cesk_diff_free(ret);
+		}
+	);
+
+	for(i = 0; i < 4; i ++)
+	{
+		cesk_diff_free(diffs[i]);
+		cesk_diff_free(invs[i]);
+		cesk_frame_free(frames[i]);
+	}
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,58 @@
+#include "bench.h"
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+	int n = 1000 * scale;
+	int nsets = 100 * scale;
+	int i, j;
+	cesk_set_t** sets = (cesk_set_t**)malloc(sizeof(cesk_set_t*) * nsets);
+	assert(NULL != sets);
+
+	BENCH("cesk_set.push", n, (uint64_t)n * 16, 
+		for(i = 0; i < 16; i ++)
+		{
+			cesk_set_t* set = cesk_set_empty_set();
+			for(j = 0; j < n; j ++)
+				cesk_set_push(set, j * 16 + i);
+			cesk_set_free(set);
+		}
+	);
+
+	cesk_set_t* base = cesk_set_empty_set();
+	for(j = 0; j < n; j ++)
+		cesk_set_push(base, j);
+
+	BENCH("cesk_set.contain", n, (uint64_t)n * 16, 
+		for(i = 0; i < 16; i ++)
+			for(j = 0; j < n; j ++)
+				assert(cesk_set_contain(base, j * 2) == (j * 2 < n));
+	);
+
+	BENCH("cesk_set.fork", nsets, nsets, 
+		for(i = 0; i < nsets; i ++)
+			sets[i] = cesk_set_fork(base);
+	);
+
+	BENCH("cesk_set.fork_write", nsets, nsets, 
+		for(i = 0; i < nsets; i ++)
+			cesk_set_push(sets[i], n + i);
+	);
+
+	BENCH("cesk_set.merge", nsets, nsets, 
+		for(i = 1; i < nsets; i ++)
+			cesk_set_merge(sets[0], sets[i]);
+	);
+
+	BENCH("cesk_set.compute_hashcode", nsets, nsets, 
+		for(i = 0; i < nsets; i ++)
+			cesk_set_compute_hashcode(sets[i]);
+	);
+
+	for(i = 0; i < nsets; i ++)
+		cesk_set_free(sets[i]);
+	cesk_set_free(base);
+	free(sets);
+	adam_finalize();
+	return 0;
+}
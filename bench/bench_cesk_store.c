@@ -0,0 +1,60 @@
+#include "bench.h"
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+	int n = 1000 * scale;
+	int nforks = 100 * scale;
+	int i;
+	uint32_t* addrs = (uint32_t*)malloc(sizeof(uint32_t) * n);
+	cesk_store_t** stores = (cesk_store_t**)malloc(sizeof(cesk_store_t*) * nforks);
+	assert(NULL != addrs && NULL != stores);
+
+	cesk_store_t* store = cesk_store_empty_store();
+	assert(NULL != store);
+
+	BENCH("cesk_store.allocate", n, n, 
+		for(i = 0; i < n; i ++)
+		{
+			cesk_alloc_param_t param = CESK_ALLOC_PARAM(i, CESK_ALLOC_NA);
+			addrs[i] = cesk_store_allocate(store, &param);
+			assert(CESK_STORE_ADDR_NULL != addrs[i]);
+			cesk_store_attach(store, addrs[i], cesk_value_empty_set());
+			cesk_store_release_rw(store, addrs[i]);
+		}
+	);
+
+	BENCH("cesk_store.get_ro", n, n, 
+		for(i = 0; i < n; i ++)
+			assert(NULL != cesk_store_get_ro(store, addrs[i]));
+	);
+
+	BENCH("cesk_store.fork", nforks, nforks, 
+		for(i = 0; i < nforks; i ++)
+			stores[i] = cesk_store_fork(store);
+	);
+
+	BENCH("cesk_store.fork_write", nforks, nforks, 
+		for(i = 0; i < nforks; i ++)
+		{
+			uint32_t addr = addrs[(i * 7) % n];
+			cesk_value_t* value = cesk_store_get_rw(stores[i], addr, 0);
+			assert(NULL != value);
+			cesk_set_push(value->pointer.set, CESK_STORE_ADDR_POS);
+			cesk_store_release_rw(stores[i], addr);
+		}
+	);
+
+	BENCH("cesk_store.compute_hashcode", nforks, nforks, 
+		for(i = 0; i < nforks; i ++)
+			cesk_store_compute_hashcode(stores[i]);
+	);
+
+	for(i = 0; i < nforks; i ++)
+		cesk_store_free(stores[i]);
+	cesk_store_free(store);
+	free(stores);
+	free(addrs);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "bench.h"
+/**
+ * The classes are generated by the sxgen tool (make bench does this),
+ * the directory can be changed with the environment variable BENCH_SXDDX_DIR.
+ * If BENCH_PRECOMPUTE is set, the block graphs are built in parallel before the analysis.
+ * If BENCH_LAZY is set, the classes are only indexed, and they are parsed when the analysis refers to them
+ **/
+int main(int argc, char** argv)
+{
+	const char* path = getenv("BENCH_SXDDX_DIR");
+	if(NULL == path) path = "bench/generated";
+	if(access(path, R_OK) != 0)
+	{
+		fprintf(stderr, "%s does not exist, run sxgen first\n", path);
+		return 1;
+	}
+	bench_init();
+	/* the size is evaluated after the code is executed, which is the number of loaded classes */
+	int lazy = (NULL != getenv("BENCH_LAZY"));
+	if(lazy)
+		BENCH("loader.index_directory", dalvik_loader_num_classes(), 1, assert(0 == dalvik_loader_index_directory(path)));
+	else
+		BENCH("loader.from_directory", dalvik_loader_num_classes(), 1, assert(0 == dalvik_loader_from_directory(path)));
+	assert(dalvik_loader_num_classes() > 0);
+	if(NULL != getenv("BENCH_PRECOMPUTE"))
+	{
+		int nthreads = atoi(getenv("BENCH_PRECOMPUTE"));
+		int ngraphs = 0;
+		BENCH("loader.precompute_blocks", nthreads, 1, ngraphs = dalvik_block_precompute(nthreads));
+		assert(ngraphs > 0);
+	}
+
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	assert(NULL != tint);
+	const dalvik_type_t* args[2] = {tint, NULL};
+
+	const dalvik_block_t* graph = dalvik_block_from_method(stringpool_query("synthetic/C0"), stringpool_query("m0"), args, tint);
+	assert(NULL != graph);
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = NULL;
+	BENCH("loader.analyze_entry", 0, 1, ret = cesk_method_analyze(graph, frame, NULL, &rtab));
+	assert(NULL != ret);
+	if(lazy) bench_report("loader.lazy_loaded", dalvik_loader_num_classes() - dalvik_loader_num_pending(), 0, 0);
+
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
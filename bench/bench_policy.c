@@ -0,0 +1,49 @@
+#include "bench.h"
+/** @brief the policies to compare */
+static const char* _policies[] = {"full", "callsite:1", "callsite:2", "object:1", "type:1", NULL};
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	assert(NULL != tint);
+	const dalvik_type_t* noarg[1] = {NULL};
+
+	int nsites = 16 * scale;
+	int depth = 8 * scale;
+	bench_text_t text = {};
+	bench_program_fanin(&text, nsites, depth);
+	assert(bench_program_load(text.data) > 0);
+	free(text.data);
+
+	const dalvik_block_t* graph = dalvik_block_from_method(stringpool_query("BenchFanin"), stringpool_query("run"), noarg, tint);
+	assert(NULL != graph);
+
+	/* the same program is analyzed from scratch under each policy */
+	int i;
+	char buf[128];
+	for(i = 0; NULL != _policies[i]; i ++)
+	{
+		assert(1 == cesk_policy_parse(_policies[i]));
+		cesk_method_clean_cache();
+		cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+		assert(NULL != frame);
+		cesk_reloc_table_t* rtab;
+		cesk_diff_t* ret = NULL;
+		snprintf(buf, sizeof(buf), "policy.%s.analyze", _policies[i]);
+		BENCH(buf, nsites, 1, ret = cesk_method_analyze(graph, frame, NULL, &rtab));
+		assert(NULL != ret);
+		cesk_diff_free(ret);
+		cesk_frame_free(frame);
+	}
+	cesk_method_clean_cache();
+	cesk_policy_reset();
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
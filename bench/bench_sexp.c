@@ -0,0 +1,28 @@
+#include "bench.h"
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+	bench_text_t text = {};
+	int n = 256 * scale;
+	bench_program_chain(&text, n);
+	bench_program_switch(&text, n);
+	bench_program_classes(&text, n);
+	int count = 0;
+
+	BENCH("sexp.parse", text.size, text.size, 
+		const char* ptr;
+		for(ptr = text.data; NULL != ptr && ptr[0] != 0;)
+		{
+			sexpression_t* sexp;
+			if(NULL == (ptr = sexp_parse(ptr, &sexp))) break;
+			sexp_free(sexp);
+			count ++;
+		}
+	);
+	assert(count > 0);
+
+	free(text.data);
+	adam_finalize();
+	return 0;
+}
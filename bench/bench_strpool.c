@@ -0,0 +1,26 @@
+#include "bench.h"
+int main(int argc, char** argv)
+{
+	int scale = bench_scale(argc, argv);
+	bench_init();
+	int n = 100000 * scale;
+	int i;
+	char (*strings)[48] = malloc(sizeof(*strings) * n);
+	assert(NULL != strings);
+	for(i = 0; i < n; i ++)
+		snprintf(strings[i], sizeof(strings[i]), "bench/Class%d/method%d", i, i * 7);
+
+	BENCH("stringpool.insert", n, n, 
+		for(i = 0; i < n; i ++)
+			stringpool_query(strings[i])
+	);
+
+	BENCH("stringpool.lookup", n, n, 
+		for(i = 0; i < n; i ++)
+			stringpool_query(strings[i])
+	);
+
+	free(strings);
+	adam_finalize();
+	return 0;
+}
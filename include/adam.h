@@ -15,6 +15,9 @@
  *  To change the log level and the optimization level
  *  @code L=<log-level> O=<opt-level> cmake . && make @endcode
  *
+ *  To compile the instrumentation counters in (dumped to perf.json or $ADAMPERF at exit)
+ *  @code cmake -DPERF=yes . && make @endcode
+ *
  *  To show the compile flags 
  *  @code make show-flags @endcode
  *
@@ -38,6 +41,10 @@
  *
  *	Then run test cases use @code make test @endcode<br>
  *
+ *	To run the benchmarks (the results are written to bench.jsonl, one JSON object per line) use
+ *	@code make bench @endcode
+ *	the workload can be scaled with the environment variable BENCH_SCALE.<br>
+ *
  *	<h1>Dalvik Disassemble Tool</h1>
  *  ADAM takes the output of <a href="https://github.com/38/dex2sex">dex2sex</a> which produces S-Expression represention of dalvik disassmebly code.
  *
@@ -51,6 +58,7 @@
 #include <stringpool.h>
 #include <log.h>
 #include <vector.h>
+#include <perf.h>
 
 #include <dalvik/dalvik.h>
 #include <cesk/cesk.h>
@@ -25,8 +25,15 @@ typedef struct _bci_class_wrap_t bci_class_wrap_t;
 #define BCI_BOOLEAN_TRUE  1
 #define BCI_BOOLEAN_UNKNOWN 2
 
+/** @brief the method has no store effects, and the result only depends on the argument sets, so the result can be memoized */
 #define BCI_CLASS_METHOD_CONST 0x40000000ul
+/** @brief the method has no store effects, but the result might depend on the store */
+#define BCI_CLASS_METHOD_PURE  0x20000000ul
+/** @brief all the flag bits of a method id */
+#define BCI_CLASS_METHOD_FLAGS (BCI_CLASS_METHOD_CONST | BCI_CLASS_METHOD_PURE)
 #define BCI_CLASS_METHOD_IS_CONST(id) (BCI_CLASS_METHOD_CONST & (id))
+/** @brief a const method is also a pure method */
+#define BCI_CLASS_METHOD_IS_PURE(id) (BCI_CLASS_METHOD_FLAGS & (id))
 
 /**
  * @brief the wrapper type for a built-in class
@@ -77,10 +84,12 @@ struct _bci_class_t {
 					  const char* classpath,
 	                  const char* method,
 	                  const dalvik_type_t * const * typelist,
-					  const dalvik_type_t*  rtype);    /*!< return the method id if the highest bit is 1 indicates that this method won't modify 
-														*  the object. if this class can not handle this function call, return value should be < 0 */
+					  const dalvik_type_t*  rtype);    /*!< return the method id, the id can carry BCI_CLASS_METHOD_CONST or BCI_CLASS_METHOD_PURE, 
+														*  which indicates the method do not modify the store and the analyzer only writes the result 
+														*  register. if this class can not handle this function call, return value should be < 0 */
 
-	int (*invoke)(int method_id, bci_method_env_t* env); /*< invoke a method sepecified by method_id using env as envrionment */
+	int (*invoke)(int method_id, bci_method_env_t* env); /*< invoke a method sepecified by method_id (without the flag bits) using env as envrionment, 
+	                                                       *  for a pure method, env->D is NULL and the result should be returned by bci_interface_return_* */
 
 	const char* super;                           /*!< the super class of this built-in class, NULL means no super class */
 	
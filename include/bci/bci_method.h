@@ -23,6 +23,7 @@ struct _bci_method_env_t {
 	cesk_reloc_table_t*       rtable;   /*!< relocation table */
 	cesk_frame_t*             frame;    /*!< envrion store */
 	const dalvik_instruction_t* instruction; /*!< the instruction that calls this  function */
-	cesk_diff_buffer_t*       D;        /*!< the diff buffer */
+	cesk_diff_buffer_t*       D;        /*!< the diff buffer, NULL if this is a pure method */
+	cesk_set_t*               result;   /*!< the result of a pure method */
 } __attribute__((__packed__));
 #endif
@@ -17,6 +17,7 @@
 #include <cesk/cesk_arithmetic.h>
 #include <cesk/cesk_block.h>
 #include <cesk/cesk_method.h>
+#include <cesk/cesk_policy.h>
 #include <cesk/cesk_static.h>
 
 
@@ -11,14 +11,152 @@
  *  Those address do not actually exist in the store,
  *  So we need a group of operation to operate those
  *  address directly
+ *
+ *  By default the numeric values are abstracted to the sign
+ *  lattice {neg, zero, pos}. In the interval domain, a value in a single
+ *  sign class is refined with a small magnitude, which is either an exact
+ *  value or a bounded interval (See cesk_store.h for the encoding). The
+ *  domain is selected by the environment variable ADAMNUMERIC ("sign" or
+ *  "interval"), and the analyzer prunes the infeasible branches in the
+ *  interval domain.
  */
 #include <cesk/cesk_store.h>
+/** @brief the numeric domains */
+enum {
+	CESK_ARITHMETIC_DOMAIN_SIGN,      /*!< the sign lattice */
+	CESK_ARITHMETIC_DOMAIN_INTERVAL,  /*!< the sign lattice refined with small constants and bounded intervals */
+	CESK_ARITHMETIC_NUM_OF_DOMAINS
+};
+/** @brief the bound used as the infinity in the interval computation, which is far beyond the encodable magnitudes */
+#define CESK_ARITHMETIC_INF (1ll << 30)
+/** @brief the numeric domain in use, do not modify it directly, use cesk_arithmetic_set_domain instead */
+extern int cesk_arithmetic_domain;
+/**
+ * @brief initialize the numeric domain from the environment variable ADAMNUMERIC
+ * @return < 0 indicates an error
+ **/
+int cesk_arithmetic_init(void);
+/**
+ * @brief finalize the numeric domain
+ * @return nothing
+ **/
+void cesk_arithmetic_finalize(void);
+/**
+ * @brief select the numeric domain
+ * @param domain the domain
+ * @return < 0 indicates an error
+ **/
+int cesk_arithmetic_set_domain(int domain);
+/**
+ * @brief parse the name of a numeric domain
+ * @param name the name of the domain
+ * @return the domain, < 0 if the name is invalid
+ **/
+int cesk_arithmetic_parse_domain(const char* name);
+/** @brief drop the magnitude of a numeric constant
+ *  @param a the constant address
+ *  @return the sign class of the constant
+ */
+static inline uint32_t cesk_arithmetic_sign(uint32_t a)
+{
+	return a & ~(CESK_STORE_ADDR_CONST_MAG_MASK | CESK_STORE_ADDR_CONST_RANGE);
+}
+/** @brief get the interval that a numeric constant stands for
+ *  @param a the constant address
+ *  @param lo the buffer for the lower bound
+ *  @param hi the buffer for the upper bound
+ *  @return 1 if the constant is an interval, 0 if it's not (the empty set and {neg, pos})
+ */
+static inline int cesk_arithmetic_range(uint32_t a, int64_t* lo, int64_t* hi)
+{
+	uint32_t sign = CESK_STORE_ADDR_CONST_SUFFIX(a) & CESK_STORE_ADDR_CONST_SIGN_MASK;
+	int neg = CESK_STORE_ADDR_CONST_CONTAIN(a, NEG);
+	int zero = CESK_STORE_ADDR_CONST_CONTAIN(a, ZERO);
+	int pos = CESK_STORE_ADDR_CONST_CONTAIN(a, POS);
+	if(0 == sign || (neg && pos && !zero)) return 0;
+	/* the magnitude only makes sense in a single sign class */
+	int64_t low = 1, high = CESK_ARITHMETIC_INF;
+	if(CESK_STORE_ADDR_CONST_IS_REFINED(a) && 0 == (sign & (sign - 1)))
+	{
+		high = (a & CESK_STORE_ADDR_CONST_MAG_MASK) >> CESK_STORE_ADDR_CONST_MAG_SHIFT;
+		low = (a & CESK_STORE_ADDR_CONST_RANGE) ? 1 : high;
+	}
+	*lo = neg ? -high : (zero ? 0 : low);
+	*hi = pos ? high : (zero ? 0 : -low);
+	return 1;
+}
+/** @brief returns the address for the interval [lo, hi]
+ *  @details the interval is encoded as a refined constant in the interval domain if it's in a
+ *           single sign class and the bound fits the magnitude field, otherwise the sign class
+ *           containing the interval is returned
+ *  @param lo the lower bound
+ *  @param hi the upper bound
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_from_range(int64_t lo, int64_t hi)
+{
+	uint32_t ret = CESK_STORE_ADDR_CONST_PREFIX;
+	if(lo < 0) ret = CESK_STORE_ADDR_CONST_SET(ret, NEG);
+	if(lo <= 0 && hi >= 0) ret = CESK_STORE_ADDR_CONST_SET(ret, ZERO);
+	if(hi > 0) ret = CESK_STORE_ADDR_CONST_SET(ret, POS);
+	if(CESK_ARITHMETIC_DOMAIN_INTERVAL != cesk_arithmetic_domain) return ret;
+	/* the magnitudes of the bounds */
+	int64_t low, high;
+	if(lo > 0) low = lo, high = hi;
+	else if(hi < 0) low = -hi, high = -lo;
+	else return ret;
+	if(high > CESK_ARITHMETIC_MAX_MAGNITUDE) return ret;
+	ret |= (uint32_t)high << CESK_STORE_ADDR_CONST_MAG_SHIFT;
+	if(low != high) ret |= CESK_STORE_ADDR_CONST_RANGE;
+	return ret;
+}
+/** @brief returns the address for a numeric constant
+ *  @param value the value
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_const(int64_t value)
+{
+	return cesk_arithmetic_from_range(value, value);
+}
+/** @brief returns the address for the union of a and b
+ *  @details unlike the bitwise or, the magnitudes of the refined constants are merged
+ *  @param a first operand
+ *  @param b second operand
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_join(uint32_t a, uint32_t b)
+{
+	if(a == b) return a;
+	if(!CESK_STORE_ADDR_CONST_IS_REFINED(a) && !CESK_STORE_ADDR_CONST_IS_REFINED(b)) return a | b;
+	uint32_t sa = cesk_arithmetic_sign(a);
+	uint32_t sb = cesk_arithmetic_sign(b);
+	if(CESK_STORE_ADDR_EMPTY == sa) return b;
+	if(CESK_STORE_ADDR_EMPTY == sb) return a;
+	/* the hull of two sign classes loses the information about zero, so we use the sign lattice */
+	if(sa != sb) return sa | sb;
+	int64_t alo, ahi, blo, bhi;
+	if(!cesk_arithmetic_range(a, &alo, &ahi) || !cesk_arithmetic_range(b, &blo, &bhi)) return sa;
+	return cesk_arithmetic_from_range(alo < blo ? alo : blo, ahi > bhi ? ahi : bhi);
+}
+/** @brief returns the sign of a comparison result, which is -1, 0 or 1
+ *  @param a the difference of the operands
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_signum(uint32_t a)
+{
+	int64_t lo, hi;
+	if(!CESK_STORE_ADDR_CONST_IS_REFINED(a) || !cesk_arithmetic_range(a, &lo, &hi)) return cesk_arithmetic_sign(a);
+	return cesk_arithmetic_from_range((lo > 0) - (lo < 0), (hi > 0) - (hi < 0));
+}
 /** @brief returns address for -a 
  *  @param a first operand
  *  @return result address
  */
 static inline uint32_t cesk_arithmetic_neg(uint32_t a)
 {
+	int64_t lo, hi;
+	if(CESK_STORE_ADDR_CONST_IS_REFINED(a) && cesk_arithmetic_range(a, &lo, &hi))
+		return cesk_arithmetic_from_range(-hi, -lo);
 	uint32_t ret = CESK_STORE_ADDR_CONST_PREFIX;
 	/* - neg = pos */
 	if(CESK_STORE_ADDR_CONST_CONTAIN(a, NEG))
@@ -42,6 +180,10 @@ static inline uint32_t cesk_arithmetic_neg(uint32_t a)
  */
 static inline uint32_t cesk_arithmetic_add(uint32_t a, uint32_t b)
 {
+	int64_t alo, ahi, blo, bhi;
+	if((CESK_STORE_ADDR_CONST_IS_REFINED(a) || CESK_STORE_ADDR_CONST_IS_REFINED(b)) &&
+	   cesk_arithmetic_range(a, &alo, &ahi) && cesk_arithmetic_range(b, &blo, &bhi))
+		return cesk_arithmetic_from_range(alo + blo, ahi + bhi);
 	uint32_t ret = CESK_STORE_ADDR_CONST_PREFIX;
 	/* neg + neg = neg */
 	if(CESK_STORE_ADDR_CONST_CONTAIN(a, NEG) &&
@@ -111,6 +253,21 @@ static inline uint32_t cesk_arithmetic_sub(uint32_t a, uint32_t b)
  */
 static inline uint32_t cesk_arithmetic_mul(uint32_t a, uint32_t b)
 {
+	int64_t alo, ahi, blo, bhi;
+	if((CESK_STORE_ADDR_CONST_IS_REFINED(a) || CESK_STORE_ADDR_CONST_IS_REFINED(b)) &&
+	   cesk_arithmetic_range(a, &alo, &ahi) && cesk_arithmetic_range(b, &blo, &bhi))
+	{
+		/* the bounds are at most CESK_ARITHMETIC_INF, so the products do not overflow */
+		int64_t p[] = {alo * blo, alo * bhi, ahi * blo, ahi * bhi};
+		int64_t lo = p[0], hi = p[0];
+		int i;
+		for(i = 1; i < 4; i ++)
+		{
+			if(p[i] < lo) lo = p[i];
+			if(p[i] > hi) hi = p[i];
+		}
+		return cesk_arithmetic_from_range(lo, hi);
+	}
 	uint32_t ret = CESK_STORE_ADDR_CONST_PREFIX;
 	/* neg x neg = pos */
 	if(CESK_STORE_ADDR_CONST_CONTAIN(a, NEG) &&
@@ -156,6 +313,7 @@ static inline uint32_t cesk_arithmetic_mul(uint32_t a, uint32_t b)
 	return ret;
 }
 /** @brief returns address for a/b 
+ *  @details the quotient is truncated, so it's zero when |a| < |b|. The result is in the sign lattice
  *  @param a first operand
  *  @param b second operand
  *  @return result address
@@ -169,8 +327,74 @@ static inline uint32_t cesk_arithmetic_div(uint32_t a, uint32_t b)
 	if(CESK_STORE_ADDR_CONST_PREFIX == b)
 	{
 		LOG_WARNING("divided by zero");
+		return b;
+	}
+	uint32_t ret = cesk_arithmetic_mul(cesk_arithmetic_sign(a), b);
+	if(CESK_STORE_ADDR_CONST_PREFIX != ret) ret = CESK_STORE_ADDR_CONST_SET(ret, ZERO);
+	return ret;
+}
+/** @brief returns address for a%b 
+ *  @details the remainder has the sign of the dividend or it's zero. The result is in the sign lattice
+ *  @param a first operand
+ *  @param b second operand
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_rem(uint32_t a, uint32_t b)
+{
+	if(!CESK_STORE_ADDR_CONST_CONTAIN(b, NEG) && !CESK_STORE_ADDR_CONST_CONTAIN(b, POS))
+	{
+		LOG_WARNING("divided by zero");
+		return CESK_STORE_ADDR_CONST_PREFIX;
+	}
+	uint32_t ret = cesk_arithmetic_sign(a);
+	if(CESK_STORE_ADDR_CONST_PREFIX != ret) ret = CESK_STORE_ADDR_CONST_SET(ret, ZERO);
+	return ret;
+}
+/** @brief returns address for the bitwise complement ~a, which is -a-1
+ *  @param a the operand
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_complement(uint32_t a)
+{
+	int64_t lo, hi;
+	if(CESK_STORE_ADDR_CONST_IS_REFINED(a) && cesk_arithmetic_range(a, &lo, &hi))
+		return cesk_arithmetic_from_range(-hi - 1, -lo - 1);
+	uint32_t ret = CESK_STORE_ADDR_CONST_PREFIX;
+	/* ~neg = {zero, pos} */
+	if(CESK_STORE_ADDR_CONST_CONTAIN(a, NEG))
+	{
+		ret = CESK_STORE_ADDR_CONST_SET(ret, ZERO);
+		ret = CESK_STORE_ADDR_CONST_SET(ret, POS);
 	}
-	return cesk_arithmetic_mul(a,b);
+	/* ~zero = ~pos = neg */
+	if(CESK_STORE_ADDR_CONST_CONTAIN(a, ZERO) || CESK_STORE_ADDR_CONST_CONTAIN(a, POS))
+		ret = CESK_STORE_ADDR_CONST_SET(ret, NEG);
+	return ret;
+}
+/** @brief returns address for a value converted to another primitive type
+ *  @details a narrowing conversion wraps around (e.g. int-to-char maps -3 to 65533), so only the 
+ *           values that every primitive type holds exactly keep the magnitude, the others are 
+ *           abstracted to the sign class, which is not used to prune branches
+ *  @param a the operand
+ *  @return result address
+ */
+static inline uint32_t cesk_arithmetic_convert(uint32_t a)
+{
+	int64_t lo, hi;
+	if(CESK_STORE_ADDR_CONST_IS_REFINED(a) && cesk_arithmetic_range(a, &lo, &hi) && lo >= 0 && hi <= 127)
+		return a;
+	return cesk_arithmetic_sign(a);
+}
+/** @brief check if a value is bounded, i.e. it's computed by the transfer functions that are exact 
+ *         in the interval domain (the constants, neg, add, sub, mul and the join of them)
+ *  @details the sign lattice is not sound for the conversions and the bitwise operations, so a value 
+ *           that is only known by its sign class should not be used to prune branches
+ *  @param a the value
+ *  @return 1 if the value is bounded, 0 if it's not
+ */
+static inline int cesk_arithmetic_is_bounded(uint32_t a)
+{
+	return CESK_STORE_ADDR_CONST_IS_REFINED(a) != 0;
 }
 /** @brief returns address for !a 
  *  @param a first operand
@@ -29,6 +29,11 @@ int cesk_block_init();
  * @return nothing
  **/
 void cesk_block_finalize();
+/**
+ * @brief print the hit rate of the virtual dispatch caches to the log
+ * @return nothing
+ **/
+void cesk_block_dispatch_summary();
 
 /**
  * @brief Analyze a code block, return the result in buf
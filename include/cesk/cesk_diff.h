@@ -202,4 +202,15 @@ cesk_diff_t* cesk_diff_prepare_to_write(cesk_diff_t* diff);
  * @return the number of object has been modified
  **/
 int cesk_diff_correct_modified_object_number(const cesk_diff_t* diff, const cesk_diff_t* inv, const cesk_frame_t* frame, int num_modified);
+/**
+ * @brief rename the object addresses in the diff
+ * @details this is used to apply the diff computed from a frame to an isomorphic frame (See cesk_frame_isomorphic),
+ *          the relocated addresses, the constants and the register numbers are not changed
+ * @param diff the input diff
+ * @param from the object addresses to rename
+ * @param to the new names, from[i] is renamed to to[i]
+ * @param count the number of addresses
+ * @return the renamed diff, NULL if there's an error or the diff contains an object address which is not in the list
+ **/
+cesk_diff_t* cesk_diff_rename(const cesk_diff_t* diff, const uint32_t* from, const uint32_t* to, uint32_t count);
 #endif
@@ -61,6 +61,10 @@ typedef struct _cesk_frame_t cesk_frame_t;
  **/
 #define CESK_FRAME_REG_STATIC_IDX(id) ((uint32_t)((id)&~CESK_FRAME_REG_STATIC_PREFIX))
 
+/**
+ * @brief the canonical address order of a frame (See cesk_frame_canonical_order)
+ **/
+typedef struct _cesk_frame_canon_t cesk_frame_canon_t;
 /** 
  * @brief A Stack Frame of ADAM
  **/
@@ -68,6 +72,7 @@ struct _cesk_frame_t{
 	uint32_t       size;     /*!<the number of registers in this frame */
 	cesk_store_t*  store;    /*!<the store for this frame */ 
 	cesk_static_table_t* statics; /*!< the static fields */ 
+	cesk_frame_canon_t* canon;    /*!< the cached canonical order, which is recomputed once the frame is changed */
 	cesk_set_t*    regs[0];  /*!<array of all registers, include result and exception */
 	cesk_set_t*    reg_result; /*!<result register*/
 	cesk_set_t*    reg_exception;  /*!<exception register*/
@@ -131,6 +136,59 @@ hashval_t cesk_frame_hashcode(const cesk_frame_t* frame);
  *  @param frame
  *  @return the hash code of the frame */
 hashval_t cesk_frame_compute_hashcode(const cesk_frame_t* frame);
+
+/** @brief the hash code of the projection of the frame, which consists of the registers, the given static fields
+ *         and the part of the store reachable from them
+ *  @param frame
+ *  @param statics the addresses of the static fields in the projection, NULL means all the static fields
+ *  @param nstatics the number of the static fields
+ *  @return the hash code of the projection
+ */
+hashval_t cesk_frame_projection_hashcode(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics);
+
+/** @brief compare if the projections of two frames are equal, the store cells that can not be reached
+ *         from the registers and the given static fields are ignored
+ *  @param first the first frame
+ *  @param second the second frame
+ *  @param statics the addresses of the static fields in the projection, NULL means all the static fields
+ *  @param nstatics the number of the static fields
+ *  @return 1 if the projections are equal, 0 otherwise
+ */
+int cesk_frame_projection_equal(const cesk_frame_t* first, const cesk_frame_t* second, const uint32_t* statics, uint32_t nstatics);
+
+/** @brief the hash code of the projection of the frame with the object addresses renamed in the canonical order,
+ *         so that the frames which only differ in the naming of the objects have the same hash code
+ *  @param frame
+ *  @param statics the addresses of the static fields in the projection, NULL means all the static fields
+ *  @param nstatics the number of the static fields
+ *  @return the canonical hash code
+ */
+hashval_t cesk_frame_canonical_hashcode(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics);
+
+/** @brief the canonical order of the object addresses in the projection of the frame
+ *  @details the addresses are listed in the breadth first order from the registers and the static fields,
+ *           the members of an object are visited in the order of the fields, and the addresses in the same set 
+ *           are visited in the order of their allocation parameters. The order is cached on the frame.
+ *           If two frames are isomorphic (See cesk_frame_isomorphic), the k-th address of the first frame 
+ *           corresponds to the k-th address of the second frame
+ *  @param frame
+ *  @param statics the addresses of the static fields in the projection, NULL means all the static fields
+ *  @param nstatics the number of the static fields
+ *  @param p_count the buffer used to return the number of addresses
+ *  @return the address list, NULL if the addresses can not be renamed, because a relocated address or a
+ *          built-in instance holding an object is reachable
+ */
+const uint32_t* cesk_frame_canonical_order(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics, uint32_t* p_count);
+
+/** @brief check if the projections of two frames are equal up to the naming of the objects
+ *  @details the frames that can not be renamed are compared with cesk_frame_projection_equal
+ *  @param first the first frame
+ *  @param second the second frame
+ *  @param statics the addresses of the static fields in the projection, NULL means all the static fields
+ *  @param nstatics the number of the static fields
+ *  @return 1 if the projections are isomorphic, 0 otherwise
+ */
+int cesk_frame_isomorphic(const cesk_frame_t* first, const cesk_frame_t* second, const uint32_t* statics, uint32_t nstatics);
 /**
  * @brief set the allocation table for this store
  * @param frame
@@ -205,6 +263,21 @@ int cesk_frame_register_move(
 		uint32_t src_reg, 
 		cesk_diff_buffer_t* diff_buf, 
 		cesk_diff_buffer_t* inv_buf);
+/**
+ * @brief assign a value set to the register
+ * @param frame the target frame
+ * @param dst_reg destination register reference
+ * @param set the value set
+ * @param diff_buf the diff buffer
+ * @param inv_buf the inverse diff buffer
+ * @return < 0 indicates errors
+ **/
+int cesk_frame_register_assign(
+		cesk_frame_t* frame,
+		uint32_t dst_reg,
+		const cesk_set_t* set,
+		cesk_diff_buffer_t* diff_buf,
+		cesk_diff_buffer_t* inv_buf);
 /**
  * @brief clear the register, make the value set of the register is empty 
  * @param frame the target frame
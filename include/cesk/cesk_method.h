@@ -11,6 +11,7 @@
 #include <cesk/cesk_frame.h>
 #include <cesk/cesk_diff.h>
 #include <cesk/cesk_block.h>
+#include <cesk/cesk_policy.h>
 /**
  * @brief initialize the method analyzer
  * @return result of intialization, < 0 indicates errors
@@ -68,4 +69,10 @@ void cesk_method_clean_cache();
  * @return the closure id
  **/
 uint32_t cesk_method_context_get_closure_id(const void* context);
+/**
+ * @brief get the abstract calling context of the input context
+ * @param context the input context
+ * @return the abstract calling context, NULL if there's none
+ **/
+const cesk_policy_key_t* cesk_method_context_get_policy_key(const void* context);
 #endif
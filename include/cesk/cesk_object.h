@@ -80,8 +80,22 @@ CONST_ASSERTION_SIZE(cesk_object_t, members, 0);
 		cur = (typeof(cur))((cur)->bcidata + (cur)->num_members);\
 } while(0)
 
+/**
+ * @brief initialize the object module (the per-class layout cache)
+ * @return < 0 indicates error
+ **/
+int cesk_object_init();
+/**
+ * @brief finalize the object module
+ * @return nothing
+ **/
+void cesk_object_finalize();
 /**
  * @brief Create a new instance object of class in classpath 
+ * @details the memory layout of a class is computed only once and kept as a template
+ *          in the layout cache, so that creating an instance is just a copy of the template.
+ *          The built-in class data is left uninitialized as before, the caller is responsible
+ *          for calling the initializer of each built-in section
  * @param classpath the class path of the object
  * @return the object created from the object, NULL indicates error
  */
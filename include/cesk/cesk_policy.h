@@ -0,0 +1,142 @@
+/**
+ * @file cesk_policy.h
+ * @brief the context-sensitivity policy of the method analyzer
+ * @details The method analyzer caches the analysis result for each calling context. By default the
+ *          calling context is the full input frame, which is the most precise but might be expensive
+ *          on a deep call graph. A policy abstracts the calling context into a key. When a method is invoked
+ *          with the same key and the same store as a previous invocation, the input frame is joined with the
+ *          previous input frame before the cache lookup, so these invocations share one (less precise) analysis
+ *          result instead of being analyzed one by one:
+ *
+ *          full        the context is the input frame (the default)
+ *
+ *          callsite:k  the context is the last k call sites (the code block of the caller in the call stack)
+ *
+ *          object:k    the context is the receiver object (the store address, which is determined by the
+ *                      allocation site) and the receivers of k-1 enclosing contexts
+ *
+ *          type:k      same as object:k, but use the class of the receiver instead of the address
+ *
+ *          The policy can be selected for a run, or for all the classes with a class path prefix, the policy
+ *          with the longest matching prefix is used. A policy specification is a comma separated list of
+ *          [prefix=]policy[:k], for example "callsite:1,android/=type,com/example/=object:2". The environment
+ *          variable ADAMPOLICY is parsed when the module is initialized.
+ **/
+#ifndef __CESK_POLICY_H__
+#define __CESK_POLICY_H__
+#include <stdio.h>
+#include <stdint.h>
+#include <constants.h>
+#include <const_assertion.h>
+
+/** @brief the kinds of the context-sensitivity policy */
+enum {
+	CESK_POLICY_FULL,      /*!< the calling context is the full input frame */
+	CESK_POLICY_CALLSITE,  /*!< k call site sensitivity */
+	CESK_POLICY_OBJECT,    /*!< k object sensitivity */
+	CESK_POLICY_TYPE,      /*!< k type sensitivity */
+	CESK_POLICY_NUM_OF_TYPES
+};
+
+/** @brief a context-sensitivity policy */
+typedef struct {
+	uint32_t type;   /*!< the kind of the policy */
+	uint32_t k;      /*!< the context depth */
+} cesk_policy_t;
+
+/** @brief the separator between the levels of an object or type context */
+#define CESK_POLICY_KEY_SEPARATOR (~(uintptr_t)0)
+
+/** @brief an abstract calling context */
+typedef struct {
+	cesk_policy_t policy;                  /*!< the policy that produces this key */
+	uint32_t      size;                    /*!< the number of elements */
+	uintptr_t     elem[CESK_POLICY_KEY_SIZE];  /*!< the elements */
+} cesk_policy_key_t;
+
+#include <dalvik/dalvik_block.h>
+#include <cesk/cesk_frame.h>
+
+/**
+ * @brief initialize the policy module, and parse the environment variable ADAMPOLICY
+ * @return < 0 indicates an error
+ **/
+int cesk_policy_init();
+
+/**
+ * @brief finalize the policy module
+ * @return nothing
+ **/
+void cesk_policy_finalize();
+
+/**
+ * @brief set the policy for the classes with a prefix
+ * @note the method analyzer cache should be cleaned after the policy is changed
+ * @param prefix the class path prefix, NULL for the default policy
+ * @param type the kind of the policy
+ * @param k the context depth, ignored by the full policy
+ * @return < 0 indicates an error
+ **/
+int cesk_policy_set(const char* prefix, uint32_t type, uint32_t k);
+
+/**
+ * @brief parse a policy specification, and set the policies
+ * @param spec the policy specification
+ * @return the number of policies set, < 0 indicates an error
+ **/
+int cesk_policy_parse(const char* spec);
+
+/**
+ * @brief remove all the rules and use the full policy by default
+ * @return nothing
+ **/
+void cesk_policy_reset();
+
+/**
+ * @brief get the policy for a class
+ * @param classpath the class path
+ * @return the policy
+ **/
+const cesk_policy_t* cesk_policy_get(const char* classpath);
+
+/**
+ * @brief compute the abstract calling context of an invocation
+ * @param code the block graph of the callee
+ * @param frame the input frame of the callee
+ * @param caller the caller context
+ * @param key the buffer for the result
+ * @return < 0 indicates an error
+ **/
+int cesk_policy_key(const dalvik_block_t* code, const cesk_frame_t* frame, const void* caller, cesk_policy_key_t* key);
+
+/**
+ * @brief the hash code of an abstract calling context
+ * @param key the abstract calling context
+ * @return the hash code
+ **/
+hashval_t cesk_policy_key_hashcode(const cesk_policy_key_t* key);
+
+/**
+ * @brief compare two abstract calling contexts
+ * @param first the first context
+ * @param second the second context
+ * @return 1 if they are the same, otherwise 0
+ **/
+int cesk_policy_key_equal(const cesk_policy_key_t* first, const cesk_policy_key_t* second);
+
+/**
+ * @brief convert a policy to string
+ * @param policy the policy
+ * @param buf the output buffer, NULL to use the default buffer
+ * @param sz the size of the buffer
+ * @return the string
+ **/
+const char* cesk_policy_to_string(const cesk_policy_t* policy, char* buf, size_t sz);
+
+/**
+ * @brief print the default policy and all the rules
+ * @param fp the output file
+ * @return nothing
+ **/
+void cesk_policy_dump(FILE* fp);
+#endif
@@ -90,6 +90,21 @@ CONST_ASSERTION_EQ(CESK_STORE_ADDR_NULL, 0xffffffff);
 /** @brief return a new address that contains a value */
 #define CESK_STORE_ADDR_CONST_SET(addr, elem) ((addr) | CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_##elem))
 
+/* A numeric constant in a single sign class can be refined with a magnitude m (1 <= m <= 15),
+ * which is either the exact value sign * m, or the interval sign * [1, m] if the range bit is set.
+ * The magnitude 0 stands for the whole sign class. Because the sign bits are kept, the code that
+ * only tests the sign bits treats the refined constant as its sign class (See cesk_arithmetic.h) */
+/** @brief the mask of the sign bits in a constant address */
+#define CESK_STORE_ADDR_CONST_SIGN_MASK 0x07ul
+/** @brief the shift of the magnitude field in a refined numeric constant */
+#define CESK_STORE_ADDR_CONST_MAG_SHIFT 3
+/** @brief the mask of the magnitude field in a refined numeric constant */
+#define CESK_STORE_ADDR_CONST_MAG_MASK (0x0ful << CESK_STORE_ADDR_CONST_MAG_SHIFT)
+/** @brief the range bit of a refined numeric constant, if it's set the constant is an interval rather than an exact value */
+#define CESK_STORE_ADDR_CONST_RANGE 0x80ul
+/** @brief check if the address is a refined numeric constant */
+#define CESK_STORE_ADDR_CONST_IS_REFINED(addr) (CESK_STORE_ADDR_NULL != (addr) && CESK_STORE_ADDR_IS_CONST(addr) && ((addr) & CESK_STORE_ADDR_CONST_MAG_MASK))
+
 /* special addresses used for relocation */
 /** @brief check if or not an address is a relocated address */
 #define CESK_STORE_ADDR_IS_RELOC(addr) ((((addr)&CESK_STORE_ADDR_RELOC_PREFIX) == CESK_STORE_ADDR_RELOC_PREFIX) && !CESK_STORE_ADDR_IS_CONST(addr))
@@ -187,6 +202,12 @@ cesk_value_const_t* cesk_store_get_ro(const cesk_store_t* store, uint32_t addr);
  *  @return result
  */
 int cesk_store_get_reuse(const cesk_store_t* store, uint32_t addr);
+/** @brief get the allocation parameter of the address
+ *  @param store the virtual store
+ *  @param addr the virtual address
+ *  @return the allocation parameter, NULL indicates an error
+ */
+const cesk_alloc_param_t* cesk_store_get_alloc_param(const cesk_store_t* store, uint32_t addr);
 /** @brief set the reuse flag 
  *  @param store virtual store
  *  @param addr vitual address
@@ -10,6 +10,36 @@
 #	define LOG_DEFAULT_CONFIG_FILE "log.cfg"
 #endif
 
+#ifndef PERF_DEFAULT_OUTPUT
+/** @brief the default file the instrumentation counters are dumped to */
+#	define PERF_DEFAULT_OUTPUT "perf.json"
+#endif
+
+#ifndef PERF_METHOD_TABLE_SIZE
+/** @brief the size of the hash table for per-method counters */
+#	define PERF_METHOD_TABLE_SIZE 10007
+#endif
+
+#ifndef LOG_MAX_RECORD_SIZE
+/** @brief the max size of a single log record, a longer message will be truncated */
+#	define LOG_MAX_RECORD_SIZE 4096
+#endif
+
+#ifndef LOG_MAX_FILTERS
+/** @brief the max number of module filters in the log config file */
+#	define LOG_MAX_FILTERS 64
+#endif
+
+#ifndef LOG_RING_SIZE
+/** @brief the size of the per-thread ring buffer used by asynchronous logging (must be a power of 2) */
+#	define LOG_RING_SIZE 0x100000
+#endif
+
+#ifndef LOG_WRITER_INTERVAL
+/** @brief how long (in microseconds) the background log writer sleeps when there's nothing to write */
+#	define LOG_WRITER_INTERVAL 1000
+#endif
+
 #ifndef VECTOR_INIT_CAP
 /** @brief initial capacity of a vector */
 #   define VECTOR_INIT_CAP 32
@@ -20,9 +50,14 @@
 #	define DALVIK_CLASS_MAX_NUM_IMPLEMENTS 128
 #endif
 
-#ifndef DAVLIK_LABEL_POOL_SIZE
-/** @brief the number of slot of label pool **/
-#   define DAVLIK_LABEL_POOL_SIZE 655217
+#ifndef DALVIK_LABEL_SCOPE_INIT_SIZE
+/** @brief the initial number of slots of a label scope, must be a power of 2 **/
+#   define DALVIK_LABEL_SCOPE_INIT_SIZE 64
+#endif
+
+#ifndef DALVIK_LABEL_JUMP_TABLE_INIT_SIZE
+/** @brief the initial size of the label jump table **/
+#   define DALVIK_LABEL_JUMP_TABLE_INIT_SIZE 4096
 #endif
 
 #ifndef STRING_POOL_SIZE
@@ -31,8 +66,19 @@
 #endif
 
 #ifndef DALVIK_POOL_INIT_SIZE
-/** @brief the initial size of the instruction pool */
-#   define DALVIK_POOL_INIT_SIZE 1024
+/** @brief the initial size of the page table of the instruction pool */
+#   define DALVIK_POOL_INIT_SIZE 64
+#endif
+
+#ifndef DALVIK_POOL_PAGE_BITS
+/** @brief a page of the instruction pool holds 2^DALVIK_POOL_PAGE_BITS instructions */
+#   define DALVIK_POOL_PAGE_BITS 10
+#endif
+
+#ifndef DALVIK_INSTRUCTION_MAX_OPERANDS
+/** @brief the maximum number of operands of an instruction, a non-range invoke takes 4 operands and at most 5 arguments,
+ *         the rest of the operand array is used by the annotation */
+#   define DALVIK_INSTRUCTION_MAX_OPERANDS 10
 #endif
 
 #ifndef DALVIK_MAX_CATCH_BLOCK
@@ -40,6 +86,21 @@
 #   define DALVIK_MAX_CATCH_BLOCK 1024
 #endif
 
+#ifndef DALVIK_HIERARCHY_SIZE
+/** @brief the number of hash slots in the class hierarchy index */
+#   define DALVIK_HIERARCHY_SIZE 100007
+#endif
+
+#ifndef DALVIK_HIERARCHY_MAX_DEPTH
+/** @brief the maximum depth of the class hierarchy walked by the subtype check of the hierarchy index */
+#   define DALVIK_HIERARCHY_MAX_DEPTH 64
+#endif
+
+#ifndef DALVIK_LOADER_INDEX_SIZE
+/** @brief the number of hash slots in the lazy loader's class index */
+#   define DALVIK_LOADER_INDEX_SIZE 100007
+#endif
+
 #ifndef DALVIK_MEMBERDICT_SIZE
 /** @brief the number of hash slots in the member dictionary */
 #   define DALVIK_MEMBERDICT_SIZE 100007
@@ -50,11 +111,44 @@
 #   define DALVIK_BLOCK_CACHE_SIZE 100007
 #endif
 
+#ifndef DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS
+/** @brief the maximum number of threads used to precompute the block graphs */
+#   define DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS 64
+#endif
+
 #ifndef DALVIK_BLOCK_MAX_KEYS
-/** @brief the maximum size of a key instruction list */
+/** @brief the size of the key instruction buffer on the stack, the buffer is moved to the heap for larger methods */
 #   define DALVIK_BLOCK_MAX_KEYS 1024
-/** @brief the maximum number of blocks in a method */
-#	define CESK_METHOD_MAX_NBLOCKS DALVIK_BLOCK_MAX_KEYS  
+#endif
+
+#ifndef DALVIK_BLOCK_MAX_HIERARCHY_DEPTH
+/** @brief the maximum depth of the class hierarchy the exception dispatch walks through */
+#   define DALVIK_BLOCK_MAX_HIERARCHY_DEPTH 64
+#endif
+
+#ifndef DALVIK_PREPASS_MAX_CELLS
+/** @brief the pre-pass is skipped for the methods whose number of blocks times number of registers exceeds this */
+#   define DALVIK_PREPASS_MAX_CELLS 4194304
+#endif
+
+#ifndef DALVIK_PREPASS_MAX_HIERARCHY_DEPTH
+/** @brief the maximum depth of the class hierarchy the pre-pass walks through for an instance-of check */
+#   define DALVIK_PREPASS_MAX_HIERARCHY_DEPTH 64
+#endif
+
+#ifndef CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS
+/** @brief the analyzer contexts for the methods with at most this number of blocks are recycled by the context pool */
+#	define CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS 64
+#endif
+
+#ifndef CESK_METHOD_CONTEXT_POOL_DEPTH
+/** @brief the maximum number of free contexts of the same size kept in the context pool */
+#	define CESK_METHOD_CONTEXT_POOL_DEPTH 16
+#endif
+
+#ifndef CESK_METHOD_MAX_STACK_INPUTS
+/** @brief the size of the input term buffer on the stack, the buffer is moved to the heap for the blocks with more inputs */
+#	define CESK_METHOD_MAX_STACK_INPUTS 64
 #endif
 
 #ifndef CESK_STORE_BLOCK_SIZE
@@ -82,6 +176,11 @@
 #	define CESK_OBJECT_MAX_BUILTIN_CLASSES 1024u
 #endif
 
+#ifndef CESK_OBJECT_LAYOUT_CACHE_SIZE
+/** @brief the number of slots in the per-class object layout cache */
+#	define CESK_OBJECT_LAYOUT_CACHE_SIZE 10007
+#endif
+
 #ifndef CESK_SET_HASH_SIZE
 /** @brief the number of slots that used for implementation of set */
 #   define CESK_SET_HASH_SIZE 100007
@@ -140,6 +239,31 @@
 #	define CESK_METHOD_CAHCE_SIZE 100007
 #endif
 
+#ifndef CESK_METHOD_FOOTPRINT_TABLE_SIZE
+/** @brief the size of the hash table for the static fields each method can touch */
+#	define CESK_METHOD_FOOTPRINT_TABLE_SIZE 4099
+#endif
+
+#ifndef CESK_METHOD_FOOTPRINT_MAX_METHODS
+/** @brief the maximum number of methods in the call closure of a method footprint, beyond this the footprint is unknown */
+#	define CESK_METHOD_FOOTPRINT_MAX_METHODS 256
+#endif
+
+#ifndef CESK_ARITHMETIC_MAX_MAGNITUDE
+/** @brief the largest magnitude of a refined numeric constant, the larger values are abstracted to their sign (at most 15) */
+#	define CESK_ARITHMETIC_MAX_MAGNITUDE 15
+#endif
+
+#ifndef CESK_POLICY_KEY_SIZE
+/** @brief the maximum number of elements in an abstract calling context, the elements beyond this are ignored */
+#	define CESK_POLICY_KEY_SIZE 16
+#endif
+
+#ifndef CESK_POLICY_MAX_K
+/** @brief the maximum context depth of a context-sensitivity policy */
+#	define CESK_POLICY_MAX_K 8
+#endif
+
 #ifndef CESK_RELOC_HASH_SIZE
 /** @brief the number of slots for the relocated hash **/
 #	define CESK_RELOC_HASH_SIZE 655217
@@ -156,6 +280,26 @@
 #	define CESK_BLOCK_METHOD_PARTITION_HEAP_SIZE 2048
 #endif
 
+#ifndef CESK_BLOCK_DISPATCH_CACHE_SIZE
+/** @brief the number of slots in the virtual dispatch cache */
+#	define CESK_BLOCK_DISPATCH_CACHE_SIZE 100007
+#endif
+
+#ifndef CESK_BLOCK_INLINE_CACHE_SIZE
+/** @brief the number of instructions that can have an inline dispatch cache at the same time */
+#	define CESK_BLOCK_INLINE_CACHE_SIZE 65536
+#endif
+
+#ifndef CESK_BLOCK_INLINE_CACHE_WAYS
+/** @brief how many receiver classes an inline cache can remember, an instruction with more receiver classes is megamorphic */
+#	define CESK_BLOCK_INLINE_CACHE_WAYS 4
+#endif
+
+#ifndef CESK_BLOCK_SUMMARY_CACHE_SIZE
+/** @brief the number of slots in the memoization table for the const built-in methods */
+#	define CESK_BLOCK_SUMMARY_CACHE_SIZE 10007
+#endif
+
 #ifndef BCI_NAMETAB_SIZE
 /** @brief the size of BCI Name Table */
 #	define BCI_NAMETAB_SIZE 100007
@@ -167,13 +311,33 @@
 #endif
 
 #ifndef TAG_SET_MAX_TAGS
-/** @brief the number of tags supported */
-#	define TAG_SET_MAX_TAGS 1024
+/** @brief the number of tags supported, this is also the width of the tag set bitset, so keep it small */
+#	define TAG_SET_MAX_TAGS 128
+#endif
+
+#ifndef TAG_SET_HASH_SIZE
+/** @brief the size of the hash table used to hash-cons the tag set contents */
+#	define TAG_SET_HASH_SIZE 10007
+#endif
+
+#ifndef TAG_TRACKER_INIT_SIZE
+/** @brief the initial capacity of the arrays in the tag tracker provenance graph **/
+#	define TAG_TRACKER_INIT_SIZE 4096
+#endif
+
+#ifndef TAG_TRACKER_ARENA_CHUNK_SIZE
+/** @brief the size of a chunk of the tag tracker node arena **/
+#	define TAG_TRACKER_ARENA_CHUNK_SIZE 1048576
+#endif
+
+#ifndef TAG_TRACKER_MEMORY_LIMIT
+/** @brief the max size of the tag tracker node arena in bytes, 0 means unlimited. The tag sets created after the limit is hit are not tracked **/
+#	define TAG_TRACKER_MEMORY_LIMIT 0
 #endif
 
-#ifndef TAG_TRACKER_HASH_SIZE
-/** @brief the size of tag tacker hash **/
-#	define TAG_TRACKER_HASH_SIZE 999991
+#ifndef TAG_TRACKER_STACK_HASH_SIZE
+/** @brief the size of the hash table for the hash-consed call stacks in tag tracker **/
+#	define TAG_TRACKER_STACK_HASH_SIZE 65537
 #endif
 
 #ifndef TAG_TRACKER_STACK_SIZE
@@ -22,6 +22,7 @@
 #include <dalvik/dalvik_label.h>
 #include <dalvik/dalvik_type.h>
 #include <dalvik/dalvik_memberdict.h>
+#include <dalvik/dalvik_hierarchy.h>
 #include <dalvik/dalvik_class.h>
 #include <dalvik/dalvik_field.h>
 #include <dalvik/dalvik_method.h>
@@ -29,6 +30,8 @@
 #include <dalvik/dalvik_attrs.h>
 #include <dalvik/dalvik_loader.h>
 #include <dalvik/dalvik_block.h>
+#include <dalvik/dalvik_prepass.h>
+#include <dalvik/dalvik_liveness.h>
 /** @brief initialization */
 int dalvik_init(void);
 /** @brief finalization */
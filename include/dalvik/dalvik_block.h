@@ -23,6 +23,7 @@
 #include <dalvik/dalvik_method.h>
 #include <dalvik/dalvik_memberdict.h>
 #include <dalvik/dalvik_field.h>
+#include <dalvik/dalvik_compact.h>
 
 /** @brief invalid block index */
 #define DALVIK_BLOCK_INDEX_INVALID 0xfffffffful
@@ -102,6 +103,26 @@ CONST_ASSERTION_SIZE(dalvik_block_branch_t, flags, 0);
 CONST_ASSERTION_SIZE(dalvik_block_branch_t, handler, 0);
 CONST_ASSERTION_SIZE(dalvik_block_branch_t, exception, 0);
 
+/** @brief an entry of the exception dispatch table */
+typedef struct {
+	const char* exception;   /*!< the class path of the exception this handler catches */
+	uint32_t    order;       /*!< the position of the handler in the handler list, the earlier handler wins */
+	uint32_t    branch;      /*!< the index of the exception branch in the block */
+} dalvik_block_exception_entry_t;
+/** 
+ * @brief the exception dispatch table of a block, the entries are sorted by the class path, so that the 
+ *        handler for a class is found by a binary search. All the blocks without exception handler share 
+ *        one empty table 
+ **/
+typedef struct {
+	uint32_t    nentries;        /*!< the number of entries */
+	uint32_t    catch_all;       /*!< the branch index of the first catch-all handler, DALVIK_BLOCK_INDEX_INVALID if there's none */
+	uint32_t    catch_all_order; /*!< the position of the catch-all handler in the handler list */
+	dalvik_block_exception_entry_t entries[0]; /*!< the entries */
+} dalvik_block_exception_table_t;
+CONST_ASSERTION_LAST(dalvik_block_exception_table_t, entries);
+CONST_ASSERTION_SIZE(dalvik_block_exception_table_t, entries, 0);
+
 /** @brief the block structure */
 struct _dalvik_block_t{ 
 	uint32_t   index;    /*!<the index of the block with the method, we do assume that a function is not large*/
@@ -109,17 +130,35 @@ struct _dalvik_block_t{
 	uint32_t   end;      /*!<the last instruction of this block  + 1. The range of the block is [begin,end) */
 	size_t     nbranches; /*!<how many possible executing path after this block is done */
 	uint16_t   nregs;     /*!<number of registers the block can use */
+	uint16_t   loop_depth; /*!<the number of natural loops that contain this block */
+	uint32_t   rpo;       /*!<the position of this block in the reverse post-order of the graph */
+	uint32_t   idom;      /*!<the index of the immediate dominator, the entry block is dominated by itself. DALVIK_BLOCK_INDEX_INVALID if the loop info is not computed */
+	uint8_t    loop_header:1; /*!<if this block is the header of a natural loop */
 	struct {
 		const char* method;   /*!<the method name */
 		const char* class;    /*!<the class path */
 		const dalvik_type_t * const * signature; /*!< the function signature */
 		const dalvik_type_t* return_type; /*!< the function return type */
+		size_t      nblocks;  /*!< the number of block indices in this graph, all block index is less than this */
 	} *info;                  /*!<info*/
+	const dalvik_block_exception_table_t* handlers; /*!< the exception dispatch table */
+	const uint32_t* live_in;  /*!< the bitmap of the registers live at the entry of the block, NULL if unknown */
+	const dalvik_compact_t* compact; /*!< the compact encoding of the instructions in the block */
 	dalvik_block_branch_t branches[0]; /*!<all possible executing path */
 };
 CONST_ASSERTION_LAST(dalvik_block_t, branches);
 CONST_ASSERTION_SIZE(dalvik_block_t, branches, 0);
 
+/** @brief check if a register is live at the entry of the block, the register is live if the liveness is unknown */
+#define DALVIK_BLOCK_REG_IS_LIVE(b, reg) (NULL == (b)->live_in || (reg) >= (b)->nregs || (((b)->live_in[(reg) / 32] >> ((reg) % 32)) & 1))
+
+/**
+ * @brief if the dominator tree and the loop nesting (idom, loop_depth, loop_header) are computed when a graph is built.
+ *        The analyzer does not use them, so it's off by default and only set by the tools which display them.
+ *        The graphs that are already built are not affected when this changes
+ **/
+extern int dalvik_block_loop_info_enabled;
+
 /** @brief initialize block cache (function path -> block graph) */
 int dalvik_block_init();
 /** @brief finalize block cache (function path -> block graph) */
@@ -139,4 +178,32 @@ dalvik_block_t* dalvik_block_from_method(
 		const dalvik_type_t * const * args, 
 		const dalvik_type_t* rtype);
 
+/**
+ * @brief build the block graphs for all the methods that are loaded (the indexed classes are loaded first)
+ * @details the graphs are built by a group of threads, and then inserted into the block cache, so that 
+ *          the analyzer does not build the graph on the critical path. The dominator tree and the loop 
+ *          nesting of each graph are computed as well
+ * @param nthreads the number of threads, <= 0 means the number of processors
+ * @return the number of graphs built, < 0 indicates an error
+ **/
+int dalvik_block_precompute(int nthreads);
+
+/** @brief the exception is not caught by any handler of the block */
+#define DALVIK_BLOCK_EXCEPTION_UNCAUGHT -2
+/** @brief the class hierarchy of the exception is incomplete, it might be caught by any handler */
+#define DALVIK_BLOCK_EXCEPTION_ANY -3
+
+/**
+ * @brief find the exception handler that catches an exception thrown by the block
+ * @details the dispatch table is searched for the exception class and all its super classes, and the
+ *          handler that comes first in the handler list wins. If some super class is not loaded, the
+ *          handler can not be decided, and the exception should be routed to all the exception branches
+ * @param block the block
+ * @param exception the class path of the exception
+ * @return the index of the exception branch, DALVIK_BLOCK_EXCEPTION_UNCAUGHT if the exception is not caught
+ *         in this method, DALVIK_BLOCK_EXCEPTION_ANY if it might be caught by any handler, -1
+ *         indicates an error
+ **/
+int dalvik_block_exception_dispatch(const dalvik_block_t* block, const char* exception);
+
 #endif
@@ -0,0 +1,114 @@
+#ifndef __DALVIK_COMPACT_H__
+#define __DALVIK_COMPACT_H__
+/** @file dalvik_compact.h
+ *  @brief the compact encoding of the instructions in a block graph
+ *
+ *  @details
+ *  The instructions in the pool have a generic operand array with a payload union for each
+ *  operand, which takes a few hundreds of bytes for one instruction. The abstract interpreter
+ *  executes the same blocks many times before it reaches the fix point, and most of the
+ *  instructions it executes only need the register numbers and the instruction flags.
+ *
+ *  So when a block graph is built, the instructions of the graph are encoded in a struct-of-arrays
+ *  form: a dispatch index, the flags and the register operands of every instruction are packed
+ *  into dense arrays, and the constant operands are copied to a side table of the graph.
+ *  The dispatch index tells the analyzer which handler should be used, and the handlers of the
+ *  rare instructions (object and method related) still read the instruction from the pool.
+ *
+ *  The encoding of a graph is allocated in one piece of memory owned by the block cache.
+ */
+#include <constants.h>
+#include <dalvik/dalvik_instruction.h>
+
+#include <log.h>
+
+struct _dalvik_block_t;
+
+/** @brief the dispatch index of an instruction in the compact encoding */
+enum {
+	DALVIK_COMPACT_OP_NOP,          /*!< nop */
+	DALVIK_COMPACT_OP_MOVE,         /*!< regs[0] = regs[1] */
+	DALVIK_COMPACT_OP_MOVE_WIDE,    /*!< move a register pair, regs[0] = regs[1] */
+	DALVIK_COMPACT_OP_CONST,        /*!< regs[0] = consts[aux] */
+	DALVIK_COMPACT_OP_CMP,          /*!< regs[0] = compare(regs[1], regs[2]) */
+	DALVIK_COMPACT_OP_CMP_WIDE,     /*!< regs[0] = compare(regs[1]:regs[1]+1, regs[2]:regs[2]+1) */
+	DALVIK_COMPACT_OP_UNOP,         /*!< regs[0] = flags(regs[1]) */
+	DALVIK_COMPACT_OP_BINOP,        /*!< regs[0] = flags(regs[1], regs[2]), the constant operands are in the side table */
+	DALVIK_COMPACT_OP_CONST_STRING, /*!< a string constant, the handler reads the instruction from the pool */
+	DALVIK_COMPACT_OP_INSTANCE,     /*!< an instance operation, the handler reads the instruction from the pool */
+	DALVIK_COMPACT_OP_INVOKE,       /*!< a method invocation, the handler reads the instruction from the pool */
+	DALVIK_COMPACT_OP_MONITOR,      /*!< monitor-enter and monitor-exit */
+	DALVIK_COMPACT_OP_OTHER,        /*!< the instructions which are not executed by the analyzer */
+	DALVIK_COMPACT_NUM_OF_OPS
+};
+
+/** @brief the number of register operands of an instruction in the compact encoding */
+#define DALVIK_COMPACT_NREGS 3
+/** @brief the operand is not a register */
+#define DALVIK_COMPACT_REG_NONE 0xffffu
+/** @brief the operand is the result register */
+#define DALVIK_COMPACT_REG_RESULT 0xfffeu
+/** @brief the operand is the exception register */
+#define DALVIK_COMPACT_REG_EXCEPTION 0xfffdu
+/** @brief the operand is a constant in the side table */
+#define DALVIK_COMPACT_REG_CONST 0xfffcu
+/** @brief the instruction has no constant operand */
+#define DALVIK_COMPACT_AUX_NONE 0xffffffffu
+
+/**
+ * @brief the compact encoding of the instructions in one block, the k-th instruction of the block
+ *        is the instruction begin + k in the pool
+ * @details the constant operands of an instruction are stored in the side table from consts[aux[k]],
+ *          in the order of the operands
+ **/
+typedef struct {
+	const uint8_t*  op;             /*!< the dispatch index of each instruction */
+	const uint8_t*  flags;          /*!< the flags of each instruction */
+	const uint16_t* regs;           /*!< DALVIK_COMPACT_NREGS register operands of each instruction */
+	const uint32_t* aux;            /*!< the index of the first constant operand in the side table */
+	const dalvik_operand_t* consts; /*!< the constant side table, which is shared by all the blocks in the graph */
+} dalvik_compact_t;
+
+/** @brief the dispatch index of the k-th instruction */
+#define DALVIK_COMPACT_OP(c, k) ((c)->op[(k)])
+/** @brief the i-th register operand of the k-th instruction */
+#define DALVIK_COMPACT_REG(c, k, i) ((c)->regs[(k) * DALVIK_COMPACT_NREGS + (i)])
+/** @brief the i-th constant operand of the k-th instruction */
+#define DALVIK_COMPACT_CONST(c, k, i) ((c)->consts + (c)->aux[(k)] + (i))
+
+/**
+ * @brief the opcode of a dispatch index, which is used for the profiling
+ * @param op the dispatch index
+ * @return the opcode
+ **/
+static inline int dalvik_compact_opcode(uint8_t op)
+{
+	static const uint8_t _opcode[DALVIK_COMPACT_NUM_OF_OPS] = {
+		[DALVIK_COMPACT_OP_NOP]          = DVM_NOP,
+		[DALVIK_COMPACT_OP_MOVE]         = DVM_MOVE,
+		[DALVIK_COMPACT_OP_MOVE_WIDE]    = DVM_MOVE,
+		[DALVIK_COMPACT_OP_CONST]        = DVM_CONST,
+		[DALVIK_COMPACT_OP_CMP]          = DVM_CMP,
+		[DALVIK_COMPACT_OP_CMP_WIDE]     = DVM_CMP,
+		[DALVIK_COMPACT_OP_UNOP]         = DVM_UNOP,
+		[DALVIK_COMPACT_OP_BINOP]        = DVM_BINOP,
+		[DALVIK_COMPACT_OP_CONST_STRING] = DVM_CONST,
+		[DALVIK_COMPACT_OP_INSTANCE]     = DVM_INSTANCE,
+		[DALVIK_COMPACT_OP_INVOKE]       = DVM_INVOKE,
+		[DALVIK_COMPACT_OP_MONITOR]      = DVM_MONITOR,
+		[DALVIK_COMPACT_OP_OTHER]        = DVM_NOP
+	};
+	return op < DALVIK_COMPACT_NUM_OF_OPS ? _opcode[op] : DVM_NOP;
+}
+
+/**
+ * @brief encode the instructions of a block graph, and set the compact field of the blocks
+ * @details the encoding of all the blocks is allocated in one piece of memory, which is returned
+ *          to the caller, and should be freed after the graph is freed
+ * @param blocks the block list, the deleted blocks are NULL
+ * @param kcnt the number of blocks
+ * @param p_result the buffer used to return the memory of the encoding
+ * @return < 0 indicates error
+ **/
+int dalvik_compact_encode(struct _dalvik_block_t** blocks, uint32_t kcnt, void** p_result);
+#endif /* __DALVIK_COMPACT_H__ */
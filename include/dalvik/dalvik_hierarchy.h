@@ -0,0 +1,105 @@
+#ifndef __DALVIK_HIERARCHY_H__
+#define __DALVIK_HIERARCHY_H__
+/** @file dalvik_hierarchy.h
+ *  @brief the class hierarchy index
+ *
+ *  @details
+ *  The index is maintained when a class is registered in the member dictionary,
+ *  so that it's always in sync with the loaded classes. For each class path, 
+ *  it knows the direct subclasses and the classes which directly implement it
+ *  (if it's an interface). This information is used for class hierarchy analysis,
+ *  for example find all possible targets of a virtual method call before the
+ *  abstract interpreter runs.
+ *
+ *  All class path used in this module should be pooled strings.
+ */
+#include <constants.h>
+#include <dalvik/dalvik_class.h>
+#include <dalvik/dalvik_type.h>
+
+#include <log.h>
+
+/**
+ * @brief initialization
+ * @return < 0 indicates error
+ */
+int dalvik_hierarchy_init();
+/**
+ * @brief finalization
+ * @return nothing
+ */
+void dalvik_hierarchy_finalize();
+/**
+ * @brief add a newly registered class to the hierarchy index
+ * @param class the class definition
+ * @return < 0 indicates error
+ **/
+int dalvik_hierarchy_add_class(const dalvik_class_t* class);
+/**
+ * @brief get the subclasses of a class
+ * @param classpath the class path
+ * @param transitive if this is 0, only the direct subclasses are returned
+ * @param p_class_path the buffer to return the class paths
+ * @param bufsize the size of the buffer
+ * @return the number of classes returned, < 0 indicates error
+ **/
+int dalvik_hierarchy_get_subclasses(const char* classpath, int transitive, const char** p_class_path, size_t bufsize);
+/**
+ * @brief get all the classes that implement the interface, this includes the classes that 
+ *        implement a sub-interface and the subclasses of an implementor
+ * @param classpath the class path of the interface
+ * @param p_class_path the buffer to return the class paths
+ * @param bufsize the size of the buffer
+ * @return the number of classes returned, < 0 indicates error
+ **/
+int dalvik_hierarchy_get_implementors(const char* classpath, const char** p_class_path, size_t bufsize);
+/**
+ * @brief get all the classes that define the method and might be the receiver of a call with 
+ *        the static type classpath, i.e. the class itself, its subclasses and implementors
+ * @param classpath the static type of the receiver
+ * @param methodname the method name
+ * @param typelist the argument type list
+ * @param rtype the return type
+ * @param p_class_path the buffer to return the class paths
+ * @param bufsize the size of the buffer
+ * @return the number of classes returned, < 0 indicates error
+ **/
+int dalvik_hierarchy_get_overriders(
+		const char* classpath, 
+		const char* methodname, 
+		const dalvik_type_t * const * typelist, 
+		const dalvik_type_t* rtype,
+		const char** p_class_path,
+		size_t bufsize);
+/**
+ * @brief get the number of classes which are not loaded but have loaded subclasses or implementors
+ * @details if it's 0, every loaded class reaches its super types through loaded classes, so the subtree
+ *          walked by dalvik_hierarchy_resolve_monomorphic covers all the user-defined receivers
+ * @return the number of unresolved classes
+ **/
+uint32_t dalvik_hierarchy_num_unresolved();
+/**
+ * @brief check if a class is in the subtree of the hierarchy index under the target type, i.e. the 
+ *        target is reachable from the class through the super classes and interfaces which are loaded
+ * @details a class that reaches the target through a class which is not loaded is not in the subtree,
+ *          so it's not covered by dalvik_hierarchy_resolve_monomorphic
+ * @param classpath the class path
+ * @param target the target type
+ * @return 1 if the class is in the subtree, 0 if it's not
+ **/
+int dalvik_hierarchy_is_subtype(const char* classpath, const char* target);
+/**
+ * @brief try to resolve a virtual call statically
+ * @param classpath the static type of the receiver
+ * @param methodname the method name
+ * @param typelist the argument type list
+ * @param rtype the return type
+ * @return the class path of the class which defines the only possible target, NULL if the call site
+ *         is polymorphic or the target can not be found in the loaded classes
+ **/
+const char* dalvik_hierarchy_resolve_monomorphic(
+		const char* classpath, 
+		const char* methodname, 
+		const dalvik_type_t * const * typelist, 
+		const dalvik_type_t* rtype);
+#endif /* __DALVIK_HIERARCHY_H__ */
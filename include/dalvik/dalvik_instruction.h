@@ -165,6 +165,7 @@ struct _dalvik_instruction_t{
 	uint8_t            opcode:4;        /*!<Opcode of the instruction */
 	uint8_t            num_operands:4;  /*!<How many operand ? */
 	uint16_t           flags:8;         /*!<Additional flags for instruction, DVM_FLAG_OPTYPE_NAME */
+	uint32_t           index;           /*!<The index of this instruction in the pool */
 	const dalvik_method_t* method;      /*!<A backward pointer to the method that owns this instruction */
 	int                line;            /*!<Line number of this instruction */
 	uint32_t next;                      /*!<The next instruction offset in the pool */
@@ -172,7 +173,7 @@ struct _dalvik_instruction_t{
 	dalvik_operand_t   annotation_begin[0];        /*!<we reuse operand space for additional infomation,
 													the first address we can safely use is 
 													(void*)(annotation_begin + num_operands) */
-	dalvik_operand_t   operands[16];        /*!<Operand array */
+	dalvik_operand_t   operands[DALVIK_INSTRUCTION_MAX_OPERANDS];  /*!<Operand array */
 	char               annotation_end[0];   /*!<the limit address of this insturction */
 };
 CONST_ASSERTION_FOLLOWS(dalvik_instruction_t, annotation_begin, operands);
@@ -259,8 +260,10 @@ enum {
 	DVM_FLAG_BINOP_RSUB
 };
 
-/** @brief the instruction allocation pool */
-extern dalvik_instruction_t* dalvik_instruction_pool;
+/** @brief the number of instructions in a page of the instruction pool */
+#define DALVIK_POOL_PAGE_SIZE (1u << DALVIK_POOL_PAGE_BITS)
+/** @brief the pages of the instruction allocation pool */
+extern dalvik_instruction_t** dalvik_instruction_pages;
 /** @brief Return a new empty dalvik instruction */
 dalvik_instruction_t* dalvik_instruction_new( void );
 /** @brief initialization */
@@ -282,6 +285,14 @@ int dalvik_instruction_from_sexp(const sexpression_t* sexp, dalvik_instruction_t
  */
 void dalvik_instruction_free(dalvik_instruction_t* buf);
 
+/** 
+ * @brief the annotation of an invoke instruction, the target register is written by _invoke, and the label id
+ *        of the array data is written for the calls to &lt;fill_array_data&gt;
+ **/
+typedef struct {
+	uint32_t target;   /*!< the target register of _invoke */
+	int32_t  labelid;  /*!< the label id of the array data, which is resolved in the label scope of the method */
+} dalvik_instruction_invoke_annotation_t;
 /** @brief read the annotation from the instruction 
  * @param ins the instruction
  * @param buf buf of the annotation
@@ -295,20 +306,18 @@ static inline void dalvik_instruction_read_annotation(const dalvik_instruction_t
 /**@brief get a instruction by instruction index */
 static inline uint32_t dalvik_instruction_get_index(const dalvik_instruction_t* inst)
 {
-	extern dalvik_instruction_t* dalvik_instruction_pool;
-	return inst - dalvik_instruction_pool;
+	return inst->index;
 }
 /**@brief get instruction of instruction */
 static inline const dalvik_instruction_t* dalvik_instruction_get(uint32_t offset)
 {
-	extern dalvik_instruction_t* dalvik_instruction_pool;
-	return dalvik_instruction_pool + offset;
+	extern dalvik_instruction_t** dalvik_instruction_pages;
+	return dalvik_instruction_pages[offset >> DALVIK_POOL_PAGE_BITS] + (offset & (DALVIK_POOL_PAGE_SIZE - 1));
 }
 /** @brief set the next instruction of currently last instruction */
 static inline void dalvik_instruction_set_next(uint32_t last, const dalvik_instruction_t* inst)
 {
-	extern dalvik_instruction_t* dalvik_instruction_pool;
-	dalvik_instruction_pool[last].next = dalvik_instruction_get_index(inst);
+	((dalvik_instruction_t*)dalvik_instruction_get(last))->next = dalvik_instruction_get_index(inst);
 }
 /** @brief print the instruction to a string */
 const char* dalvik_instruction_to_string(const dalvik_instruction_t* inst, char* buf, size_t sz);
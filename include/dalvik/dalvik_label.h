@@ -6,8 +6,8 @@
 #include <constants.h>
 #include <stdint.h>
 #include <dalvik/dalvik_instruction.h>
-/** @brief this is the jump table for the labels, labelid -> instruction index */
-extern uint32_t dalvik_label_jump_table[DAVLIK_LABEL_POOL_SIZE];
+/** @brief this is the jump table for the labels, labelid -> instruction index, the table grows when a new label is created */
+extern uint32_t* dalvik_label_jump_table;
 
 /**@brief initialization*/
 int dalvik_label_init(void);   /* initialize the label pool */
@@ -15,6 +15,18 @@ int dalvik_label_init(void);   /* initialize the label pool */
 void dalvik_label_finalize(void);   /* finalize the global variables */
 /**@brief free a label */
 void dalvik_label_free(void);   
+/**
+ * @brief open the label scope of a method, the label names are resolved in this scope until 
+ *        dalvik_label_scope_end is called, so that the same label name can be used in different methods
+ * @return < 0 indicates an error
+ **/
+int dalvik_label_scope_begin(void);
+/**
+ * @brief close the label scope of the method, the label names in this scope are released, but the label ids
+ *        are still valid
+ * @return nothing
+ **/
+void dalvik_label_scope_end(void);
 /**
  * @brief look for the label table to figure out wether or not the label is existed in the label table
  *        this is useful to find the redefined label which is not allowed
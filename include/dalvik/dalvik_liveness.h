@@ -0,0 +1,53 @@
+#ifndef __DALVIK_LIVENESS_H__
+#define __DALVIK_LIVENESS_H__
+/** @file dalvik_liveness.h
+ *  @brief the register liveness analysis on the block graph
+ *
+ *  @details
+ *  A register is live at the entry of a block if there's a path from the entry that reads
+ *  the register before it's overwritten. The registers that are dead at the entry of a block
+ *  can be cleared by the abstract interpreter without changing the result, so that the frames
+ *  which only differ in the dead registers are equal, which makes the method cache and the
+ *  fix point iteration converge faster.
+ *
+ *  The liveness is computed once for each block graph and stored as a bitmap for each block
+ *  (see DALVIK_BLOCK_REG_IS_LIVE). The analysis is conservative, an instruction that is not
+ *  fully understood reads all its register operands and writes none of them.
+ *
+ *  The analysis is enabled by default, set the environment variable ADAMLIVENESS to 0 to
+ *  consider all the registers live.
+ */
+#include <constants.h>
+#include <dalvik/dalvik_block.h>
+
+#include <log.h>
+
+/** @brief the number of 32 bit words in the liveness bitmap of one block */
+#define DALVIK_LIVENESS_NWORDS(nregs) (((nregs) + 31) / 32)
+
+/**
+ * @brief if the liveness analysis is enabled, the graphs that are already built are not affected when this changes
+ **/
+extern int dalvik_liveness_enabled;
+/**
+ * @brief initialization
+ * @return < 0 indicates error
+ **/
+int dalvik_liveness_init();
+/**
+ * @brief finalization
+ * @return nothing
+ **/
+void dalvik_liveness_finalize();
+/**
+ * @brief compute the registers live at the entry of each block, and set the live_in field of the blocks
+ * @details the bitmaps of all the blocks are allocated in one piece of memory, which is returned
+ *          to the caller, and should be freed after the graph is freed
+ * @param blocks the block list, the first block is the entry of the method, the deleted blocks are NULL
+ * @param kcnt the number of blocks
+ * @param nregs the number of registers of the method
+ * @param p_result the buffer used to return the memory of the bitmaps, NULL if the analysis is disabled
+ * @return < 0 indicates error
+ **/
+int dalvik_liveness_compute(dalvik_block_t** blocks, uint32_t kcnt, uint32_t nregs, uint32_t** p_result);
+#endif /* __DALVIK_LIVENESS_H__ */
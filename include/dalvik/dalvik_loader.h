@@ -2,10 +2,51 @@
 #define __DALVIK_LOADER_H__
 /** @file dalvik_loader.h
  *  @brief dalvik package loader
+ *  @details The loader works in two modes. dalvik_loader_from_directory parses and registers every
+ *           class under the directory. dalvik_loader_index_directory only scans the files and
+ *           builds an index from the class path to the location of the class definition, the class
+ *           is parsed when the member dictionary is asked for it the first time. In this way, the
+ *           classes that are never referenced during the analysis are never parsed.
  */
 #include <log.h>
+#include <stdint.h>
+/**@brief initialize the loader 
+ * @return < 0 indicates an error
+ */
+int dalvik_loader_init();
+/**@brief finalize the loader 
+ * @return nothing
+ */
+void dalvik_loader_finalize();
 /**@brief load from path */
 int dalvik_loader_from_directory(const char* path);
+/**@brief scan the path and build the class index, the classes are loaded on demand 
+ * @details this function reserves the static fields for the indexed classes,
+ *          so it should be called before the analysis begins
+ * @param path the directory
+ * @return < 0 indicates an error
+ */
+int dalvik_loader_index_directory(const char* path);
+/**@brief load an indexed class if it is not loaded yet
+ * @param class_path the class path
+ * @return 1 if the class has been loaded by this call, 0 if the class is not indexed or has been loaded before,
+ *         < 0 indicates an error
+ */
+int dalvik_loader_load_class(const char* class_path);
+/**@brief load all indexed classes that are not loaded yet
+ * @details this is required by the queries that need to see the whole program, for example
+ *          the class hierarchy queries
+ * @return < 0 indicates an error
+ */
+int dalvik_loader_load_all();
+/**@brief the number of indexed classes that are not loaded yet 
+ * @return the number of classes
+ */
+uint32_t dalvik_loader_num_pending();
+/**@brief the number of classes that have been loaded or indexed by the loader
+ * @return the number of classes
+ */
+uint32_t dalvik_loader_num_classes();
 /**@brief print a summary */
 void dalvik_loader_summary();
 
@@ -13,6 +13,7 @@
 #include <dalvik/dalvik_class.h>
 
 #include <log.h>
+#include <vector.h>
 
 /**
  * @brief initialization
@@ -95,5 +96,12 @@ int dalvik_memberdict_find_member_by_prefix(
 		const dalvik_type_t * const ** p_signature,
 		const dalvik_type_t ** p_rettype,
 		size_t bufsize);
+/**
+ * @brief get all the methods in the dictionary, all the indexed classes are loaded first
+ * @param result the vector of const dalvik_method_t* used to return the methods
+ * @return the number of methods, < 0 indicates error
+ **/
+int dalvik_memberdict_get_methods(vector_t* result);
+
 
 #endif /* __DALVIK_MEMBERDICT_H__ */
@@ -0,0 +1,51 @@
+#ifndef __DALVIK_PREPASS_H__
+#define __DALVIK_PREPASS_H__
+/** @file dalvik_prepass.h
+ *  @brief the register-only pre-pass on the block graph
+ *
+ *  @details
+ *  Before the block graph is handed to the abstract interpreter, a fast intraprocedural
+ *  data flow analysis runs on the registers only. For each register it tracks whether
+ *  the value is null (zero), a non-null object, its sign, the exact value of an integer
+ *  constant and the exact class of a newly created object. With this information, the
+ *  branches that can never be taken, for example the null check of an object which is
+ *  just created, or the instance-of check on an object whose class is known, are disabled.
+ *  Because the values of all the registers are unknown at the entry of the method, the
+ *  result does not depend on the calling context, so the graph in the cache can be pruned.
+ *
+ *  The pass only reads the member dictionary, so it's safe to run it in the precompute
+ *  threads once all the classes are loaded.
+ *
+ *  The pre-pass is enabled by default, set the environment variable ADAMPREPASS to 0
+ *  to build the graphs without it.
+ */
+#include <constants.h>
+#include <dalvik/dalvik_block.h>
+
+#include <log.h>
+
+/**
+ * @brief if the pre-pass is enabled, the graphs that are already built are not affected when this changes
+ **/
+extern int dalvik_prepass_enabled;
+/**
+ * @brief initialization
+ * @return < 0 indicates error
+ **/
+int dalvik_prepass_init();
+/**
+ * @brief finalization
+ * @return nothing
+ **/
+void dalvik_prepass_finalize();
+/**
+ * @brief run the pre-pass on a linked block graph and disable the infeasible branches
+ * @details the disabled branches are unlinked, so that the blocks which become unreachable
+ *          can be deleted by the reachability check
+ * @param blocks the block list, the first block is the entry of the method
+ * @param kcnt the number of blocks
+ * @param nregs the number of registers of the method
+ * @return the number of branches disabled, 0 if the pre-pass is disabled, < 0 indicates error
+ **/
+int dalvik_prepass_prune(dalvik_block_t** blocks, uint32_t kcnt, uint32_t nregs);
+#endif /* __DALVIK_PREPASS_H__ */
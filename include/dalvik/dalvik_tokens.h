@@ -131,6 +131,7 @@ extern const char* dalvik_keywords[DALVIK_MAX_NUM_KEYWORDS];
 #define DALVIK_TOKEN_UINVOKE    DALVIK_TOKEN_TABLE_ENTITY(116) /* this is the _invoke (used to emliminate instructions like array-new */
 #define DALVIK_TOKEN_VOLATILE   DALVIK_TOKEN_TABLE_ENTITY(117)
 #define DALVIK_TOKEN_NATIVE     DALVIK_TOKEN_TABLE_ENTITY(118)
+#define DALVIK_TOKEN_FILL_ARRAY_DATA DALVIK_TOKEN_TABLE_ENTITY(119) /* the builtin method that emulates fill-array-data */
 /** @brief initialize the token table. no need to finalize, because stringpool can dealing with this */
 int dalvik_tokens_init(void);
 
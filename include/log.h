@@ -16,7 +16,17 @@
  * 			 Config file log.conf is used for redirect log to a file. For each log level, we 
  * 			 can define an output file, so that we can seperately record log in different  level in 
  * 			 different files.
+ *
+ * 			 The config file can also set up runtime filters, the global level threshold with
+ * 			 `level <LEVEL>` and a threshold for the modules whose source file name begins with a 
+ * 			 given prefix with `filter <prefix> <LEVEL>`. The filter is checked before the arguments
+ * 			 are evaluated, so a filtered log costs nothing but a comparison.
+ *
+ * 			 `async on` makes the logs go to a per-thread ring buffer which is drained by a 
+ * 			 background writer thread, and `format binary` writes the log records in binary
+ * 			 format (see log_binary_record_t) which can be decoded by the logdecode tool.
  */
+#include <stdint.h>
 /* log levels */
 enum{
 	/** Use this level when something would stop the program */
@@ -44,6 +54,46 @@ int log_init();
  */
 void log_finalize();
 
+/** @brief the magic number of a binary log record */
+#define LOG_BINARY_MAGIC 0x474c4441ul
+/**
+ * @brief the header of a binary log record
+ * @details the header is followed by the file name, the function name and the message, 
+ *          none of them is NUL-terminated
+ **/
+typedef struct {
+	uint32_t magic;         /*!< the magic number, must be LOG_BINARY_MAGIC */
+	uint8_t  level;         /*!< the log level */
+	uint8_t  reserved;      /*!< reserved, must be 0 */
+	uint16_t file_len;      /*!< the length of file name */
+	uint32_t line;          /*!< the line number */
+	uint16_t function_len;  /*!< the length of function name */
+	uint16_t message_len;   /*!< the length of the message */
+	uint64_t timestamp;     /*!< when this log is written, in nanoseconds since epoch */
+} log_binary_record_t;
+
+/** @brief the generation of log filters, it changes each time the filters are modified */
+extern int log_filter_generation;
+
+/** @brief check if a log should be written with current filters
+ *  @param level the log level
+ *  @param file the file name of the source code
+ *  @return 1 if the log should be written, 0 otherwise
+ */
+int log_filter_check(int level, const char* file);
+
+/** @brief set the level threshold for a module at run time
+ *  @param module the prefix of the source file name, NULL for the global threshold
+ *  @param level the level threshold, the logs whose level is higher than this would be dropped
+ *  @return < 0 indicates an error
+ */
+int log_set_filter(const char* module, int level);
+
+/** @brief wait until all logs in the ring buffers are written 
+ *  @return nothing
+ */
+void log_flush();
+
 /** @brief	the implementation of write a log
  *  @param	level	the log level
  *  @param	file	the file name of the source code
@@ -55,9 +105,18 @@ void log_finalize();
 void log_write(int level, const char* file, const char* function, int line, const char* fmt, ...) 
 	__attribute__((format (printf, 5, 6)));
 
-/** @brief helper macros for write a log, do not use it directly */
+/** @brief helper macros for write a log, do not use it directly. 
+ *         The result of filter is cached in each call site until the filters change */
 #define __LOG__(level,fmt,arg...) do{\
-	    log_write(level,__FILE__,__FUNCTION__,__LINE__,fmt, ##arg);\
+		static int __log_generation = -1;\
+		static int __log_enabled = 0;\
+		if(__log_generation != log_filter_generation)\
+		{\
+			__log_enabled = log_filter_check(level, __FILE__);\
+			__log_generation = log_filter_generation;\
+		}\
+		if(__log_enabled)\
+			log_write(level,__FILE__,__FUNCTION__,__LINE__,fmt, ##arg);\
 }while(0)
 
 #ifndef LOG_LEVEL
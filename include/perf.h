@@ -0,0 +1,115 @@
+#ifndef __PERF_H__
+#define __PERF_H__
+/**
+ * @file perf.h
+ * @brief the instrumentation counters for the abstract interpreter
+ * @details The counters are compiled in only if PERF_COUNT is defined (cmake -DPERF=yes),
+ *          otherwise all the PERF_* macros expand to nothing, so that there's no overhead.
+ *          The counters are dumped in JSON format at adam_finalize, the output file is specified
+ *          by the environment variable ADAMPERF (PERF_DEFAULT_OUTPUT by default).
+ **/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <constants.h>
+#include <dalvik/dalvik_instruction.h>
+/** @brief the modules we track the allocation for */
+enum {
+	PERF_ALLOC_STORE,     /*!< the store module */
+	PERF_ALLOC_SET,       /*!< the set module */
+	PERF_ALLOC_DIFF,      /*!< the diff module */
+	PERF_ALLOC_VALUE,     /*!< the value module */
+	PERF_ALLOC_NUM_OF_MODULE
+};
+/** @brief the global counters */
+typedef struct {
+	uint64_t opcode_count[DVM_NUM_OF_OPCODE];        /*!< how many times the instructions are executed */
+	uint64_t opcode_cycles[DVM_NUM_OF_OPCODE];       /*!< how many cycles spent on the instructions */
+	uint64_t method_cache_hit;                       /*!< the method analyzer cache hit */
+	uint64_t method_cache_miss;                      /*!< the method analyzer cache miss */
+	uint64_t method_cache_merged;                    /*!< the input frames joined with a previous frame in the same abstract calling context */
+	uint64_t method_cache_renamed;                   /*!< the method cache hits whose result is renamed for an isomorphic input frame */
+	uint64_t bci_fast_path;                          /*!< the built-in invocations that only write the result register */
+	uint64_t bci_summary_hit;                        /*!< the const built-in invocations answered by the memoization table */
+	uint64_t bci_summary_miss;                       /*!< the const built-in invocations actually executed */
+	uint64_t block_cache_hit;                        /*!< the block graph cache hit */
+	uint64_t block_cache_miss;                       /*!< the block graph cache miss */
+	uint64_t context_pool_hit;                       /*!< the analyzer contexts reused from the context pool */
+	uint64_t context_pool_miss;                      /*!< the analyzer contexts allocated from the heap */
+	uint64_t context_bytes;                          /*!< the bytes of the active analyzer contexts */
+	uint64_t context_peak_bytes;                     /*!< the peak bytes of the active analyzer contexts */
+	uint64_t branch_pruned;                          /*!< the branches pruned because their conditions can not hold */
+	uint64_t dead_register_cleared;                  /*!< the registers cleared because they are dead at the block entry */
+	uint64_t alloc_count[PERF_ALLOC_NUM_OF_MODULE];  /*!< the number of allocations */
+	uint64_t alloc_bytes[PERF_ALLOC_NUM_OF_MODULE];  /*!< the bytes allocated */
+} perf_counters_t;
+
+/** @brief the global counters */
+extern perf_counters_t perf_counters;
+
+/**
+ * @brief read the cycle counter
+ * @return the current cycles (or nanoseconds if there's no cycle counter)
+ **/
+static inline uint64_t perf_clock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief initialize the instrumentation counters
+ * @return < 0 indicates an error
+ **/
+int perf_init();
+
+/**
+ * @brief dump the counters, and finalize
+ * @return nothing
+ **/
+void perf_finalize();
+
+/**
+ * @brief record a method analysis
+ * @param class the class path
+ * @param method the method name
+ * @param key the key that identifies the method (the info pointer of the block graph)
+ * @param iterations the number of fix-point iterations
+ * @return nothing
+ **/
+void perf_method_analyzed(const char* class, const char* method, const void* key, uint32_t iterations);
+
+/**
+ * @brief dump the counters in JSON format
+ * @param fp the output file
+ * @return nothing
+ **/
+void perf_dump(FILE* fp);
+
+#ifdef PERF_COUNT
+/** @brief the code only compiled when the instrumentation is enabled */
+#	define PERF_CODE(code...) code
+/** @brief increase a counter */
+#	define PERF_INC(counter) (perf_counters.counter ++)
+/** @brief record an allocation */
+#	define PERF_ALLOC(module, size) do{\
+		perf_counters.alloc_count[module] ++;\
+		perf_counters.alloc_bytes[module] += (size);\
+	}while(0)
+/** @brief record an instruction is executed, begin is the cycle counter before the instruction is executed */
+#	define PERF_OPCODE(opcode, begin) do{\
+		perf_counters.opcode_count[opcode] ++;\
+		perf_counters.opcode_cycles[opcode] += perf_clock() - (begin);\
+	}while(0)
+#else
+#	define PERF_CODE(code...)
+#	define PERF_INC(counter)
+#	define PERF_ALLOC(module, size)
+#	define PERF_OPCODE(opcode, begin)
+#endif
+#endif
@@ -81,7 +81,7 @@ void tag_set_free(tag_set_t* set);
 hashval_t tag_set_hashcode(const tag_set_t* set);
 
 /**
- * @brief check wether or not two tag set are equal
+ * @brief check wether or not two tag set are equal, the contents are hash-consed so this is a pointer comparison
  * @param first the first tag set
  * @param second the second tag set
  * @return 1 if they are equal, 0 if not equal, < 0 if error happens
@@ -1,10 +1,34 @@
 /**
  * @brief tracker the value tags
+ * @details The tracker records the provenance graph of the tag sets: each tag set created in a transaction is a
+ *          node, and the tag sets it's created from are its inputs. The graph is stored in compact arrays and
+ *          the queries are iterative, the reachability of a (tag, tag set) pair is memoized. The graph is
+ *          protected by a mutex, so the queries can be made while the analyzer is running in another thread.
+ *          A data-flow path of a tag is a chain of tag sets which all contain the tag, from the tag set we are
+ *          interested in back to a source, which is a tag set without input (or with an input that is not tracked)
+ *
+ *          The nodes are varint-encoded records in an append-only chunked arena, and the call stacks are
+ *          hash-consed. The mode of the tracker is selected by tag_tracker_set_mode or the environment variable
+ *          ADAMTRACKER, which is a comma separated list of:
+ *
+ *          full     record the complete abstract machine state (the default)
+ *
+ *          compact  only record the instruction and the call stack, which are what the queries need
+ *
+ *          tainted  only track the tag sets containing a watched tag (all tags if no tag is watched) and
+ *                   reachable from a source, the edges from other tag sets are dropped
  * @file tag_tracker.h
  **/
 #ifndef __TAG_TRACKER_H__
 #define __TAG_TRACKER_H__
 #include <tag/tag_set.h>
+
+/** @brief the modes of the tag tracker */
+enum {
+	TAG_TRACKER_MODE_FULL    = 0x0,  /*!< record the complete abstract machine state */
+	TAG_TRACKER_MODE_COMPACT = 0x1,  /*!< only record the instruction and the call stack */
+	TAG_TRACKER_MODE_TAINTED = 0x2   /*!< only track the tag sets reachable from the tainted sources */
+};
 /**
  * @brief initialize
  * @param < 0 for failure
@@ -15,6 +39,23 @@ int tag_tracker_init();
  * @return nothing
  **/
 void tag_tracker_finalize();
+/**
+ * @brief set the mode of the tracker, which affects the tag sets registered after the call
+ * @param mode the mode
+ * @return < 0 on error
+ **/
+int tag_tracker_set_mode(uint32_t mode);
+/**
+ * @brief watch a tag in tainted mode
+ * @param tag_id the tag id
+ * @return < 0 on error
+ **/
+int tag_tracker_watch(uint32_t tag_id);
+/**
+ * @brief get the memory used by the provenance graph
+ * @return the size in bytes
+ **/
+size_t tag_tracker_memory_usage();
 /**
  * @brief open a instruction executing transaction
  * @param closure current closure
@@ -53,15 +94,42 @@ int tag_tracker_transaction_close();
 int tag_tracker_register_tagset(uint32_t tsid, const tag_set_t* tagset, const uint32_t* inputs, uint32_t ninputs);
 
 /**
- * @brief get data-flow path
+ * @brief get at most N data-flow paths, each path is a newly allocated instruction array terminated by
+ *        DALVIK_INSTRUCTION_INVALID, and the caller should free it
  * @param tag_id the tag id to focus on
  * @param tagset_id the id of tagset that we are instrested in 
- * @param buf the path buffer
+ * @param instruction the path buffer
  * @param N the size of buffer
- * @param stack_info the pointer to return stack_info
+ * @param stack_info the buffer to return stack_info for each path, NULL if not needed
  * @return the number of pathes found < 0 on error
  **/
 int tag_tracker_get_path(uint32_t tag_id, uint32_t tagset_id, uint32_t** instruction, size_t N, void** stack_info);
+/**
+ * @brief check if the tag flows to the tag set from a source
+ * @param tag_id the tag id
+ * @param tagset_id the id of the tag set
+ * @return 1 if there's a data-flow path, 0 if not, < 0 on error
+ **/
+int tag_tracker_reachable(uint32_t tag_id, uint32_t tagset_id);
+/**
+ * @brief get the shortest data-flow path
+ * @param tag_id the tag id to focus on
+ * @param tagset_id the id of tagset that we are instrested in 
+ * @param buf the buffer for the instructions on the path, terminated by DALVIK_INSTRUCTION_INVALID
+ * @param N the size of buffer
+ * @param stack_info the pointer to return stack_info, NULL if not needed
+ * @return the length of the path, < 0 if there's no path or the buffer is too small
+ **/
+int tag_tracker_shortest_path(uint32_t tag_id, uint32_t tagset_id, uint32_t* buf, size_t N, void** stack_info);
+/**
+ * @brief get all the sinks of a tag, which are the tag sets that the tag flows to but never flow to
+ *        another tag set containing the tag
+ * @param tag_id the tag id
+ * @param buf the buffer for the tag set ids
+ * @param N the size of buffer
+ * @return the number of sinks (which might be larger than N, only the first N are returned), < 0 on error
+ **/
+int tag_tracker_get_sinks(uint32_t tag_id, uint32_t* buf, size_t N);
 /**
  * @brief move upward in the call stack
  * @param stack_info the pointer to the stack info
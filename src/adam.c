@@ -5,6 +5,11 @@ int adam_init(void)
 	{
 		return -1;
 	}
+	if(perf_init() < 0)
+	{
+		LOG_FATAL("failed to initialize the instrumentation counters");
+		return -1;
+	}
 	if(stringpool_init(STRING_POOL_SIZE) < 0)
 	{
 		LOG_FATAL("failed to initialize string pool");
@@ -34,9 +39,11 @@ int adam_init(void)
 }
 void adam_finalize(void)
 {
-	tag_finalize();
+	perf_finalize();
+	/* the values freed by the analyzer and the built-in classes still hold tag sets */
 	cesk_finalize();
 	bci_finalize();
+	tag_finalize();
 	dalvik_finalize();
 	stringpool_fianlize();
 	log_finalize();
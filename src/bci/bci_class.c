@@ -96,5 +96,5 @@ int bci_class_get_method(const void* this, const char* classpath, const char* me
 int bci_class_invoke(int method_id, bci_method_env_t* env, const bci_class_t* class)
 {
 	if(method_id < 0 || NULL == class) return -1;
-	return (NULL == class->invoke)?-1:class->invoke(method_id, env);
+	return (NULL == class->invoke)?-1:class->invoke(method_id & ~BCI_CLASS_METHOD_FLAGS, env);
 }
@@ -1,6 +1,14 @@
 #include <dalvik/dalvik.h>
 #include <cesk/cesk.h>
 #include <bci/bci.h>
+/** @brief the store is read-only for a pure method, which is invoked without a diff buffer */
+#define _BCI_INTERFACE_CHECK_WRITABLE(env, errval) do{\
+	if(NULL == (env)->D)\
+	{\
+		LOG_ERROR("a pure method can not modify the store");\
+		return errval;\
+	}\
+}while(0)
 const cesk_set_t* bci_interface_read_arg(const bci_method_env_t* env, uint32_t k, uint32_t N)
 {
 	if(NULL == env || N + 2 > env->frame->size || k >= N)
@@ -17,6 +25,7 @@ uint32_t bci_interface_new_object(bci_method_env_t* env, const char* path, const
 		LOG_ERROR("invalid argument");
 		return CESK_STORE_ADDR_NULL;
 	}
+	_BCI_INTERFACE_CHECK_WRITABLE(env, CESK_STORE_ADDR_NULL);
 	cesk_alloc_param_t param = CESK_ALLOC_PARAM(CESK_ALLOC_NA, CESK_ALLOC_NA);
 	return cesk_frame_store_new_object(env->frame, env->rtable, env->instruction, &param, path, init_param, env->D, NULL);
 }
@@ -27,6 +36,7 @@ int bci_interface_return_set(bci_method_env_t* env, const cesk_set_t* set)
 		LOG_ERROR("invalid argument");
 		return -1;
 	}
+	if(NULL == env->D) return cesk_set_merge(env->result, set);
 	return cesk_diff_buffer_append(env->D, CESK_DIFF_REG, CESK_FRAME_RESULT_REG, set); 
 }
 int bci_interface_return_single_address(bci_method_env_t* env, uint32_t addr)
@@ -36,6 +46,7 @@ int bci_interface_return_single_address(bci_method_env_t* env, uint32_t addr)
 		LOG_ERROR("invalid argument");
 		return -1;
 	}
+	if(NULL == env->D) return cesk_set_push(env->result, addr);
 	return cesk_frame_register_load(env->frame, CESK_FRAME_RESULT_REG, addr, NULL, env->D, NULL);
 }
 const cesk_set_t* bci_interface_read_register(const bci_method_env_t* env, uint32_t regid)
@@ -54,6 +65,7 @@ void* bci_interface_get_rw_by_classdef(bci_method_env_t* env, uint32_t addr, con
 		LOG_ERROR("invalid argument");
 		return NULL;
 	}
+	_BCI_INTERFACE_CHECK_WRITABLE(env, NULL);
 	cesk_value_t* value = cesk_store_get_rw(env->frame->store, addr, 0);
 	if(NULL == value)
 	{
@@ -83,6 +95,7 @@ void* bci_interface_get_rw(bci_method_env_t* env, uint32_t addr, const char* cla
 		LOG_ERROR("invalid argument");
 		return NULL;
 	}
+	_BCI_INTERFACE_CHECK_WRITABLE(env, NULL);
 	cesk_value_t* value = cesk_store_get_rw(env->frame->store, addr, 0);
 	if(NULL == value)
 	{
@@ -130,6 +143,7 @@ int bci_interface_append_tag_set(bci_method_env_t* env, uint32_t addr, const tag
 		LOG_ERROR("invalid argument");
 		return -1;
 	}
+	_BCI_INTERFACE_CHECK_WRITABLE(env, -1);
 	cesk_value_t* value = cesk_store_get_rw(env->frame->store, addr, 0);
 	if(NULL == value)
 	{
@@ -221,6 +235,7 @@ int bci_interface_return_object(bci_method_env_t* env, uint32_t addr)
 		LOG_ERROR("invalid argument");
 		return -1;
 	}
+	_BCI_INTERFACE_CHECK_WRITABLE(env, -1);
 	cesk_value_const_t* value = cesk_store_get_ro(env->frame->store, addr);
 	if(NULL == value)
 	{
@@ -1,8 +1,6 @@
 #include <bci/bci_interface.h>
 #include <stringpool.h>
-//static const char* _hashcode = NULL;
-//static dalvik_type_t* _hashcode_rtype = NULL;
-//static dalvik_type_t* _hashcdoe_args[1] = {NULL};
+static const char* _hashcode = NULL;
 hashval_t java_lang_Object_hash(const void* data)
 {
 	return 0x38745c6;
@@ -38,19 +36,37 @@ int java_lang_Object_instance_of(const void* this, const dalvik_type_t* type)
 }
 int java_lang_Object_onload()
 {
-	//_hashcode = stringpool_query("hashCode");
-	//_hashcode_rtype = DALVIK_TYPE_INT;
+	_hashcode = stringpool_query("hashCode");
 	return 0;
 }
 int java_lang_Object_get_method(const void* this, const char* classpath, const char* methodname, const dalvik_type_t* const* args, const dalvik_type_t* rtype)
 {
-	/*if(methodname == _hashcode && dalvik_type_list_equal(args, (const dalvik_type_t* const*) _hashcdoe_args) && dalvik_type_equal(rtype, _hashcode_rtype))
-		return 0;
-	return -1;*/
+	/* the hash code can be any integer, which does not depend on anything */
+	if(methodname == _hashcode) return 1 | BCI_CLASS_METHOD_CONST;
 	return 0;
 }
 int java_lang_Object_invoke(int method_id, bci_method_env_t* env)
 {
+	if(method_id == 1)
+	{
+		cesk_set_t* ret = cesk_set_empty_set();
+		if(NULL == ret)
+		{
+			LOG_ERROR("can not create the result set");
+			return -1;
+		}
+		int rc = 0;
+		if(cesk_set_push(ret, CESK_STORE_ADDR_NEG) < 0 ||
+		   cesk_set_push(ret, CESK_STORE_ADDR_ZERO) < 0 ||
+		   cesk_set_push(ret, CESK_STORE_ADDR_POS) < 0 ||
+		   bci_interface_return_set(env, ret) < 0)
+		{
+			LOG_ERROR("can not return the hash code");
+			rc = -1;
+		}
+		cesk_set_free(ret);
+		return rc;
+	}
 	return 0;
 }
 bci_class_t java_lang_Object_metadata = {
@@ -123,8 +123,40 @@ int java_lang_String_get_method(const void* this_ptr, const char* classpath, con
 {
 	if(method == kw_init) return 0;
 	if(method == kw_concat) return 1;
+	if(method == java_lang_String_length) return 2 | BCI_CLASS_METHOD_PURE;
 	return -1;
 }
+static inline int _java_lang_String_length(bci_method_env_t* env)
+{
+	const cesk_set_t* this = bci_interface_read_arg(env, 0, 1);
+	if(NULL == this)
+	{
+		LOG_ERROR("can not read argument");
+		return -1;
+	}
+	uint32_t addr;
+	cesk_set_iter_t iter;
+	if(NULL == cesk_set_iter(this, &iter))
+	{
+		LOG_ERROR("can not read `this' set");
+		return -1;
+	}
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		const string_data_t* self = (const string_data_t*)bci_interface_get_ro_by_classdef(env, addr, &java_lang_String_metadata);
+		if(NULL == self) continue;
+		cesk_set_t* length = java_lang_String_get_field(self, java_lang_String_length);
+		if(NULL == length)
+		{
+			LOG_ERROR("can not get the length of the string");
+			return -1;
+		}
+		int rc = bci_interface_return_set(env, length);
+		cesk_set_free(length);
+		if(rc < 0) return -1;
+	}
+	return 0;
+}
 static inline int _java_lang_String_concat(bci_method_env_t* env)
 {
 	extern bci_class_t java_lang_String_metadata;
@@ -190,6 +222,7 @@ int java_lang_String_invoke(int method_id, bci_method_env_t* env)
 {
 	if(method_id == 0) return 0;
 	else if(method_id == 1) return _java_lang_String_concat(env);
+	else if(method_id == 2) return _java_lang_String_length(env);
 	return -1;
 }
 bci_class_t java_lang_String_metadata = {
@@ -496,15 +496,20 @@ static inline int _array_get_handler(bci_method_env_t* env)
  * @brief handler for &lt;fill_array_data&gt;
  * @brief env the envrion
  * @param env the invoke environ
- * @param label_type the type that carries a label
  * @return the result of invocation
  **/
-static inline int _array_fill_handler(bci_method_env_t* env, const dalvik_type_t* label_type)
+static inline int _array_fill_handler(bci_method_env_t* env)
 {
 	const cesk_set_t* self = bci_interface_read_arg(env, 0, 1);
-	const char* label_name = stringpool_query(label_type->data.object.path + 13);
-	uint32_t lid = dalvik_label_get_label_id(label_name);
-	uint32_t idx = dalvik_label_jump_table[lid];
+	/* the label has been resolved in the method scope when the instruction is parsed */
+	dalvik_instruction_invoke_annotation_t annotation;
+	dalvik_instruction_read_annotation(env->instruction, &annotation, sizeof(annotation));
+	if(annotation.labelid < 0)
+	{
+		LOG_ERROR("the label of the array data is not resolved");
+		return -1;
+	}
+	uint32_t idx = dalvik_label_jump_table[annotation.labelid];
 	const dalvik_instruction_t* data = dalvik_instruction_get(idx);
 	if(NULL == data)
 	{
@@ -581,7 +586,7 @@ int java_lang_reflect_Array_invoke(int method_id, bci_method_env_t* env)
 		case ARRAY_GET:
 			return _array_get_handler(env);
 		case FILL_ARRAY:
-			return _array_fill_handler(env, method->signature[0]);
+			return _array_fill_handler(env);
 		//TODO: newInstance, because it depends on java.lang.Class and refelction
 		default:
 			LOG_ERROR("unsupported method");
@@ -1,11 +1,21 @@
 #include <cesk/cesk.h>
 int cesk_init(void)
 {
+	if(cesk_arithmetic_init() < 0)
+	{
+		LOG_FATAL("can not initialize the numeric domain");
+		return -1;
+	}
 	if(cesk_value_init() < 0)
 	{
 		LOG_FATAL("can not initialize module cesk_value");
 		return -1;
 	}
+	if(cesk_object_init() < 0)
+	{
+		LOG_FATAL("can not initialize module cesk_object");
+		return -1;
+	}
 	if(cesk_set_init() < 0)
 	{
 		LOG_FATAL("can not initialize module cesk_set");
@@ -21,6 +31,11 @@ int cesk_init(void)
 		LOG_FATAL("can not invialize the block analyzer module");
 		return -1;
 	}
+	if(cesk_policy_init() < 0)
+	{
+		LOG_FATAL("can not initialize the context-sensitivity policy");
+		return -1;
+	}
 	if(cesk_method_init() < 0)
 	{
 		LOG_FATAL("can not initialize method analyzer");
@@ -43,8 +58,11 @@ void cesk_finalize(void)
 	cesk_frame_finalize();
 	cesk_static_finalize();
 	cesk_method_finalize();
+	cesk_policy_finalize();
 	cesk_block_finalize();
 	cesk_reloc_finalize();
 	cesk_value_finalize();
+	cesk_object_finalize();
 	cesk_set_finalize();
+	cesk_arithmetic_finalize();
 }
@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include <string.h>
+#include <cesk/cesk_arithmetic.h>
+/**
+ * @brief the names of the numeric domains
+ **/
+static const char* const _cesk_arithmetic_domain_name[CESK_ARITHMETIC_NUM_OF_DOMAINS] = {
+	[CESK_ARITHMETIC_DOMAIN_SIGN]     = "sign",
+	[CESK_ARITHMETIC_DOMAIN_INTERVAL] = "interval"
+};
+
+int cesk_arithmetic_domain = CESK_ARITHMETIC_DOMAIN_SIGN;
+
+int cesk_arithmetic_init()
+{
+	cesk_arithmetic_domain = CESK_ARITHMETIC_DOMAIN_SIGN;
+	const char* spec = getenv("ADAMNUMERIC");
+	if(NULL == spec || 0 == strlen(spec)) return 0;
+	int domain = cesk_arithmetic_parse_domain(spec);
+	if(domain < 0)
+	{
+		LOG_ERROR("invalid numeric domain %s", spec);
+		return -1;
+	}
+	return cesk_arithmetic_set_domain(domain);
+}
+void cesk_arithmetic_finalize()
+{
+	cesk_arithmetic_domain = CESK_ARITHMETIC_DOMAIN_SIGN;
+}
+int cesk_arithmetic_set_domain(int domain)
+{
+	if(domain < 0 || domain >= CESK_ARITHMETIC_NUM_OF_DOMAINS)
+	{
+		LOG_ERROR("invalid numeric domain %d", domain);
+		return -1;
+	}
+	cesk_arithmetic_domain = domain;
+	LOG_DEBUG("numeric domain: %s", _cesk_arithmetic_domain_name[domain]);
+	return 0;
+}
+int cesk_arithmetic_parse_domain(const char* name)
+{
+	if(NULL == name) return -1;
+	int i;
+	for(i = 0; i < CESK_ARITHMETIC_NUM_OF_DOMAINS; i ++)
+		if(0 == strcmp(name, _cesk_arithmetic_domain_name[i]))
+			return i;
+	return -1;
+}
@@ -8,6 +8,9 @@
 #include <cesk/cesk_block.h>
 #include <cesk/cesk_method.h>
 #include <bci/bci_nametab.h>
+#include <dalvik/dalvik_hierarchy.h>
+#include <dalvik/dalvik_loader.h>
+#include <perf.h>
 
 /** 
  * @brief convert an register referencing operand to index of register 
@@ -37,6 +40,29 @@ static inline uint32_t _cesk_block_operand_to_regidx(const dalvik_operand_t* ope
 		return CESK_FRAME_GENERAL_REG(operand->payload.uint16);
 	}
 }
+/**
+ * @brief convert a register code in the compact encoding to index of register
+ * @param reg the register code
+ * @return the register index, CESK_STORE_ADDR_NULL indicates errors
+ **/
+static inline uint32_t _cesk_block_compact_to_regidx(uint16_t reg)
+{
+	switch(reg)
+	{
+		case DALVIK_COMPACT_REG_EXCEPTION:
+			return CESK_FRAME_EXCEPTION_REG;
+		case DALVIK_COMPACT_REG_RESULT:
+			return CESK_FRAME_RESULT_REG;
+		case DALVIK_COMPACT_REG_CONST:
+			LOG_ERROR("can not convert a constant operand to register index");
+			return CESK_STORE_ADDR_NULL;
+		case DALVIK_COMPACT_REG_NONE:
+			LOG_ERROR("the operand is not a register");
+			return CESK_STORE_ADDR_NULL;
+		default:
+			return CESK_FRAME_GENERAL_REG(reg);
+	}
+}
 /**
  * @brief merge constant addresses in a register to a single constant address
  * @param frame
@@ -61,7 +87,7 @@ static inline uint32_t _cesk_block_register_const_merge(const cesk_frame_t* fram
 			LOG_WARNING("ignoring non-constant address "PRSAddr"", current);
 			continue;
 		}
-		input |= current;
+		input = cesk_arithmetic_join(input, current);
 	}
 	return input;
 }
@@ -88,17 +114,18 @@ static inline int _cesk_block_register_assign_tags(cesk_frame_t* frame, uint32_t
 }
 /**
  * @brief the instruction handler for move instructions 
- * @param ins current instruction
+ * @param code the compact encoding of current block
+ * @param k the offset of current instruction in the block
  * @param frame current stack frame
  * @param D the diff buffer to track the modification
  * @param I the diff buffer to tacck the how to revert the modification
  * @return the result of execution, < 0 indicates failure
  **/
-static inline int _cesk_block_handler_move(const dalvik_instruction_t* ins, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
+static inline int _cesk_block_handler_move(const dalvik_compact_t* code, uint32_t k, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
 {
-	uint16_t to     = _cesk_block_operand_to_regidx(ins->operands + 0);
-	uint16_t from   = _cesk_block_operand_to_regidx(ins->operands + 1);
-	if(ins->operands[0].header.info.size)
+	uint16_t to     = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 0));
+	uint16_t from   = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 1));
+	if(DALVIK_COMPACT_OP_MOVE_WIDE == DALVIK_COMPACT_OP(code, k))
 	{
 		/* if this instruction is to move a register pair */
 		if(cesk_frame_register_move(frame, to, from, D, I) < 0)
@@ -124,7 +151,7 @@ static inline int _cesk_block_handler_move(const dalvik_instruction_t* ins, cesk
 	return 0;
 }
 /**
- * @brief the instruction handler for constant loading instructions 
+ * @brief the instruction handler for string constant loading instructions 
  * @param ins current instruction
  * @param frame current stack frame
  * @param rtab the relocation table used by current context
@@ -132,59 +159,64 @@ static inline int _cesk_block_handler_move(const dalvik_instruction_t* ins, cesk
  * @param I the diff buffer to tacck the how to revert the modification
  * @return the result of execution, < 0 indicates failure
  **/
-static inline int _cesk_block_handler_const(
+static inline int _cesk_block_handler_const_string(
 		const dalvik_instruction_t* ins, 
 		cesk_frame_t* frame, 
 		cesk_reloc_table_t* rtab,
 		cesk_diff_buffer_t* D, 
 		cesk_diff_buffer_t* I)
 {
-	if(DVM_OPERAND_TYPE_STRING == ins->operands[1].header.info.type)
+	const char* value = ins->operands[1].payload.string;
+	uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
+	static const char* clspath = NULL;
+	if(NULL == clspath)
 	{
-		const char* value = ins->operands[1].payload.string;
-		uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
-		static const char* clspath = NULL;
-		if(NULL == clspath)
-		{
-			clspath = stringpool_query("java/lang/String");
-			if(NULL == clspath) return -1;
-		}
+		clspath = stringpool_query("java/lang/String");
+		if(NULL == clspath) return -1;
+	}
 
-		/* the instruction index is determined by current instruction
-		 * and the offset is unknown at this time, so we just use CESK_ALLOC_NA */
-		cesk_alloc_param_t param = CESK_ALLOC_PARAM(CESK_ALLOC_NA, CESK_ALLOC_NA);
+	/* the instruction index is determined by current instruction
+	 * and the offset is unknown at this time, so we just use CESK_ALLOC_NA */
+	cesk_alloc_param_t param = CESK_ALLOC_PARAM(CESK_ALLOC_NA, CESK_ALLOC_NA);
 
-		uint32_t ret = cesk_frame_store_new_object(frame, rtab, ins, &param, clspath, value, D, I);
-		if(CESK_STORE_ADDR_NULL == ret)
-		{
-			LOG_ERROR("can not allocate new instance of class %s in frame %p", clspath, frame);
-			return -1;
-		}
-		LOG_DEBUG("allocated new instance of class %s at store address "PRSAddr"", clspath, ret);
+	uint32_t ret = cesk_frame_store_new_object(frame, rtab, ins, &param, clspath, value, D, I);
+	if(CESK_STORE_ADDR_NULL == ret)
+	{
+		LOG_ERROR("can not allocate new instance of class %s in frame %p", clspath, frame);
+		return -1;
+	}
+	LOG_DEBUG("allocated new instance of class %s at store address "PRSAddr"", clspath, ret);
 
-		cesk_value_const_t* store_value = cesk_store_get_ro(frame->store, ret);
+	cesk_value_const_t* store_value = cesk_store_get_ro(frame->store, ret);
 
-		if(NULL == store_value || 
-		   CESK_TYPE_OBJECT != store_value->type || 
-		   clspath != cesk_object_classpath(store_value->pointer.object) ||
-		   NULL == store_value->pointer.object->builtin)
-		{
-			LOG_ERROR("unexcepted object value");
-			return -1;
-		}
-		
-		return cesk_frame_register_load(frame, dest, ret, NULL, D, I);
-		
+	if(NULL == store_value || 
+	   CESK_TYPE_OBJECT != store_value->type || 
+	   clspath != cesk_object_classpath(store_value->pointer.object) ||
+	   NULL == store_value->pointer.object->builtin)
+	{
+		LOG_ERROR("unexcepted object value");
+		return -1;
 	}
-	else
+	
+	return cesk_frame_register_load(frame, dest, ret, NULL, D, I);
+}
+/**
+ * @brief the instruction handler for numeric constant loading instructions 
+ * @param code the compact encoding of current block
+ * @param k the offset of current instruction in the block
+ * @param frame current stack frame
+ * @param D the diff buffer to track the modification
+ * @param I the diff buffer to tacck the how to revert the modification
+ * @return the result of execution, < 0 indicates failure
+ **/
+static inline int _cesk_block_handler_const(const dalvik_compact_t* code, uint32_t k, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
+{
+	uint32_t dest = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 0));
+	uint32_t sour = cesk_store_const_addr_from_operand(DALVIK_COMPACT_CONST(code, k, 0));
+	if(cesk_frame_register_load(frame, dest, sour, NULL,D, I) < 0)
 	{
-		uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
-		uint32_t sour = cesk_store_const_addr_from_operand(&ins->operands[1]);
-		if(cesk_frame_register_load(frame, dest, sour, NULL,D, I) < 0)
-		{
-			LOG_ERROR("can not load the value "PRSAddr" to register %u", sour, dest);
-			return -1;
-		}
+		LOG_ERROR("can not load the value "PRSAddr" to register %u", sour, dest);
+		return -1;
 	}
 	return 0;
 }
@@ -210,23 +242,24 @@ static inline uint32_t _cesk_block_regcmp(const cesk_frame_t* frame, uint32_t le
 }
 /**
  * @brief the instruction handler for comparasion instructions 
- * @param ins current instruction
+ * @param code the compact encoding of current block
+ * @param k the offset of current instruction in the block
  * @param frame current stack frame
  * @param D the diff buffer to track the modification
  * @param I the diff buffer to tacck the how to revert the modification
  * @return the result of execution, < 0 indicates failure
  **/
-static inline int _cesk_block_handler_cmp(const dalvik_instruction_t* ins, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
+static inline int _cesk_block_handler_cmp(const dalvik_compact_t* code, uint32_t k, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
-	uint32_t left = _cesk_block_operand_to_regidx(ins->operands + 1);
-	uint32_t right = _cesk_block_operand_to_regidx(ins->operands + 2);
+	uint32_t dest = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 0));
+	uint32_t left = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 1));
+	uint32_t right = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 2));
 	if(CESK_STORE_ADDR_NULL == left || CESK_STORE_ADDR_NULL == right)
 	{
 		LOG_ERROR("invalid operand");
 		return -1;
 	}
-	int wide = ins->operands[1].header.info.size;
+	int wide = (DALVIK_COMPACT_OP_CMP_WIDE == DALVIK_COMPACT_OP(code, k));
 
 	/* compare the first part */
 	uint32_t result = _cesk_block_regcmp(frame, left, right);
@@ -241,8 +274,10 @@ static inline int _cesk_block_handler_cmp(const dalvik_instruction_t* ins, cesk_
 	{
 		/* clear the equal bit */
 		result ^= (CESK_STORE_ADDR_ZERO ^ CESK_STORE_ADDR_CONST_PREFIX);
-		result |= _cesk_block_regcmp(frame, left + 1, right + 1);
+		result = cesk_arithmetic_join(result, _cesk_block_regcmp(frame, left + 1, right + 1));
 	}
+	/* the result of the comparison is -1, 0 or 1 */
+	result = cesk_arithmetic_signum(result);
 
 	const tag_set_t* left_tags = _cesk_block_register_get_tags(frame, left);
 	if(NULL == left_tags)
@@ -449,16 +484,17 @@ static inline int _cesk_block_handler_instance(
 }
 /**
  * @brief the instruction handler for unary operation  
- * @param ins current instruction
+ * @param code the compact encoding of current block
+ * @param k the offset of current instruction in the block
  * @param frame current stack frame
  * @param D the diff buffer to track the modification
  * @param I the diff buffer to tacck the how to revert the modification
  * @return the result of execution, < 0 indicates failure
  **/
-static inline int _cesk_block_handler_unop(const dalvik_instruction_t* ins, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
+static inline int _cesk_block_handler_unop(const dalvik_compact_t* code, uint32_t k, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
-	uint32_t sour = _cesk_block_operand_to_regidx(ins->operands + 1);
+	uint32_t dest = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 0));
+	uint32_t sour = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 1));
 	if(CESK_STORE_ADDR_NULL == dest || CESK_STORE_ADDR_NULL == sour)
 	{
 		LOG_ERROR("bad register reference");
@@ -473,19 +509,19 @@ static inline int _cesk_block_handler_unop(const dalvik_instruction_t* ins, cesk
 	}
 	/* acctual computation */
 	uint32_t output;
-	switch(ins->flags)
+	switch(code->flags[k])
 	{
 		case DVM_FLAG_UOP_NEG:
 			output = cesk_arithmetic_neg(input);
 			break;
 		case DVM_FLAG_UOP_NOT:
-			output = cesk_arithmetic_neg(input);
+			output = cesk_arithmetic_complement(input);
 			break;
 		case DVM_FLAG_UOP_TO:
-			output = input;
+			output = cesk_arithmetic_convert(input);
 			break;
 		default:
-			LOG_ERROR("unknown instruction flag %x", ins->flags);
+			LOG_ERROR("unknown instruction flag %x", code->flags[k]);
 			return -1;
 	}
 	
@@ -506,32 +542,35 @@ static inline int _cesk_block_handler_unop(const dalvik_instruction_t* ins, cesk
 }
 /**
  * @brief the instruction handler for binary operation  
- * @param ins current instruction
+ * @param code the compact encoding of current block
+ * @param k the offset of current instruction in the block
  * @param frame current stack frame
  * @param D the diff buffer to track the modification
  * @param I the diff buffer to tacck the how to revert the modification
  * @return the result of execution, < 0 indicates failure
  **/
-static inline int _cesk_block_handler_binop(const dalvik_instruction_t* ins, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
+static inline int _cesk_block_handler_binop(const dalvik_compact_t* code, uint32_t k, cesk_frame_t* frame, cesk_diff_buffer_t* D, cesk_diff_buffer_t* I)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(ins->operands + 0);
+	uint32_t dest = _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 0));
 	uint32_t left = CESK_STORE_ADDR_NULL;
 	uint32_t right = CESK_STORE_ADDR_NULL;
 	const tag_set_t* left_tags = NULL;
 	const tag_set_t* right_tags = NULL;
-	if(ins->operands[1].header.info.is_const)
-		left = cesk_store_const_addr_from_operand(ins->operands + 1);
+	/* the constant operands are stored in the side table in the order of operands */
+	int nconsts = 0;
+	if(DALVIK_COMPACT_REG_CONST == DALVIK_COMPACT_REG(code, k, 1))
+		left = cesk_store_const_addr_from_operand(DALVIK_COMPACT_CONST(code, k, nconsts ++));
 	else
 	{
-		left = _cesk_block_register_const_merge(frame, _cesk_block_operand_to_regidx(ins->operands + 1));
-		left_tags = _cesk_block_register_get_tags(frame, _cesk_block_operand_to_regidx(ins->operands + 1));
+		left = _cesk_block_register_const_merge(frame, _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 1)));
+		left_tags = _cesk_block_register_get_tags(frame, _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 1)));
 	}
-	if(ins->operands[2].header.info.is_const)
-		right = cesk_store_const_addr_from_operand(ins->operands + 2);
+	if(DALVIK_COMPACT_REG_CONST == DALVIK_COMPACT_REG(code, k, 2))
+		right = cesk_store_const_addr_from_operand(DALVIK_COMPACT_CONST(code, k, nconsts ++));
 	else
 	{
-		right = _cesk_block_register_const_merge(frame, _cesk_block_operand_to_regidx(ins->operands + 2));
-		right_tags = _cesk_block_register_get_tags(frame, _cesk_block_operand_to_regidx(ins->operands + 2));
+		right = _cesk_block_register_const_merge(frame, _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 2)));
+		right_tags = _cesk_block_register_get_tags(frame, _cesk_block_compact_to_regidx(DALVIK_COMPACT_REG(code, k, 2)));
 	}
 	//uint32_t aleft = _cesk_block_register_const_merge(frame, left);
 	//uint32_t aright = _cesk_block_register_const_merge(frame, right);
@@ -544,7 +583,7 @@ static inline int _cesk_block_handler_binop(const dalvik_instruction_t* ins, ces
 
 	uint32_t result = 0;
 	/* actual operation */
-	switch(ins->flags)
+	switch(code->flags[k])
 	{
 		case DVM_FLAG_BINOP_ADD:
 			result = cesk_arithmetic_add(left, right);
@@ -568,11 +607,11 @@ static inline int _cesk_block_handler_binop(const dalvik_instruction_t* ins, ces
 			result = cesk_arithmetic_xor(left, right);
 			break;
 		case DVM_FLAG_BINOP_REM:
-			result = cesk_arithmetic_div(left, cesk_arithmetic_mul(cesk_arithmetic_div(left, right), right));
+			result = cesk_arithmetic_rem(left, right);
 			break;
 		/* TODO other operations */
 		default:
-			LOG_ERROR("unknown instruction flag %x", ins->flags);
+			LOG_ERROR("unknown instruction flag %x", code->flags[k]);
 			return -1;
 	}
 
@@ -583,34 +622,15 @@ static inline int _cesk_block_handler_binop(const dalvik_instruction_t* ins, ces
 	return cesk_frame_register_load(frame, dest, result, new_tags, D, I);
 }
 /**
- * @brief binary search for the relocated address
- * @param diff the result diff
- * @param addr the address in result diff
- * @return the index in data array < 0 means not found
+ * @brief the translation map of a result diff, which is a dense array indexed by the relocated index
+ *        of the allocations in the result diff. Because the allocation section is sorted, the map
+ *        covers the relocated indices from the first allocation to the last allocation
  **/
-static inline int _cesk_block_invoke_result_allocate_bsearch(const cesk_diff_t* diff, uint32_t addr)
-{
-	/* the starting address of the allocation section */
-	const cesk_diff_rec_t* data = diff->data + diff->offset[CESK_DIFF_ALLOC];
-	/* how many allocation record do we have */
-	size_t nrec = diff->offset[CESK_DIFF_ALLOC + 1] - diff->offset[CESK_DIFF_ALLOC];
-	/* of course we need to check the boundary cases */
-	if(0 == nrec) return -1;
-	if(addr < data[0].addr || data[nrec-1].addr < addr) return -1;
-	/* okay, let's do binary search */
-	int l = 0, r = nrec;
-	while(r - l > 1)
-	{
-		int m = (l + r) / 2;
-		if(data[m].addr <= addr)
-			l = m;
-		else
-			r = m;
-	}
-	/* verify if the only one left in range is the one wanted */
-	if(r - l > 0 && data[l].addr == addr) return l;
-	else return -1;
-}
+typedef struct {
+	uint32_t base;     /*!< the relocated index of the first allocation in the result */
+	uint32_t span;     /*!< the number of slots in the map */
+	uint32_t* addr;    /*!< addr[k] is the internal address of the relocated address with index base + k */
+} _cesk_block_addr_map_t;
 /**
  * @brief do a result address --> interal address translation
  * @details this function actually do two things. First, it adjust the
@@ -621,15 +641,13 @@ static inline int _cesk_block_invoke_result_allocate_bsearch(const cesk_diff_t*
  *          callee frame).
  * @param addr the address to be translated
  * @param frame current stack frame
- * @param diff the result diff
- * @param addrmap the address map from result address to interal address
+ * @param map the translation map of the result diff
  * @return the interal address traslated from the result address
  **/
 static inline uint32_t _cesk_block_invoke_result_addr_translate(
 		uint32_t addr,
 		const cesk_frame_t* frame,
-		const cesk_diff_t* diff,
-		const uint32_t* addrmap)
+		const _cesk_block_addr_map_t* map)
 {
 	uint32_t r_addr;
 	/*if this address is a relocated address, that means we need translate it from result 
@@ -637,62 +655,85 @@ static inline uint32_t _cesk_block_invoke_result_addr_translate(
 	if(CESK_STORE_ADDR_IS_RELOC(addr))
 	{
 		/* convert current address to internal address */
-		int idx = _cesk_block_invoke_result_allocate_bsearch(diff, addr);
-		if(idx < 0)
+		uint32_t idx = CESK_STORE_ADDR_RELOC_IDX(addr) - map->base;
+		if(idx >= map->span || CESK_STORE_ADDR_NULL == (r_addr = map->addr[idx]))
 		{
-			LOG_ERROR("can not find the address in the allocation section");
+			LOG_ERROR("there's no map from result address "PRSAddr" to interal address, stopping", addr);
 			return CESK_STORE_ADDR_NULL;
 		}
-		uint32_t i_addr = addrmap[idx];
-		if(CESK_STORE_ADDR_NULL == i_addr)
-		{
-			LOG_ERROR("there's no map from result address "PRSAddr" to interal address, stopping", i_addr);
-			return CESK_STORE_ADDR_NULL;
-		}
-		r_addr = i_addr;
 	}
 	/* if this address is not a relocated address in this store, then the translated address is the address itself 
 	 * In addition, if this address is relocated in the caller frame, we should substitude the object address to
 	 * the internal relocated address. */ 
-	else if(CESK_STORE_ADDR_NULL == (r_addr = cesk_alloctab_query(frame->store->alloc_tab, frame->store, addr)))
+	else if(CESK_STORE_ADDR_IS_CONST(addr) || 
+	        CESK_STORE_ADDR_NULL == (r_addr = cesk_alloctab_query(frame->store->alloc_tab, frame->store, addr)))
 		r_addr = addr;
 	LOG_DEBUG("invocation address translation: "PRSAddr" --> "PRSAddr"", addr, r_addr);
 	return r_addr;
 }
+/**
+ * @brief the buffer for the address pairs to be modified in a set
+ **/
+static uint32_t* _cesk_block_set_translate_buf = NULL;
+/**
+ * @brief the capacity of the address pair buffer
+ **/
+static size_t    _cesk_block_set_translate_bufsize = 0;
 /**
  * @brief peform the translation process on a address set
+ * @details the addresses are translated first, and then the modifications are applied to the
+ *          set in bulk, so that the set is not touched if nothing changes
  * @param set the address set to be translated
  * @param frame current stack frame
- * @param diff the result diff
- * @param addrmap the address map 
+ * @param map the translation map
  * @note  the function will modify the input set, and return the same set instance
  * @return the translated set
  **/
 static inline cesk_set_t* _cesk_block_invoke_result_set_translate(
 		cesk_set_t* set,
 		const cesk_frame_t* frame,
-		const cesk_diff_t* diff,
-		const uint32_t* addrmap)
+		const _cesk_block_addr_map_t* map)
 {
 	cesk_set_iter_t iter;
+	size_t size = cesk_set_size(set);
+	if(0 == size) return set;
+	if(2 * size > _cesk_block_set_translate_bufsize)
+	{
+		uint32_t* buf = (uint32_t*)realloc(_cesk_block_set_translate_buf, sizeof(uint32_t) * 2 * size);
+		if(NULL == buf)
+		{
+			LOG_ERROR("can not allocate memory for the address translation buffer");
+			return NULL;
+		}
+		_cesk_block_set_translate_buf = buf;
+		_cesk_block_set_translate_bufsize = 2 * size;
+	}
 	if(NULL == cesk_set_iter(set, &iter))
 	{
 		LOG_ERROR("can not acquire the set iterator");
 		return NULL;
 	}
 	uint32_t addr;
+	size_t nmod = 0;
 	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
 	{
 		/* translate the result address to internal address */
-		uint32_t i_addr = _cesk_block_invoke_result_addr_translate(addr, frame, diff, addrmap);
+		uint32_t i_addr = _cesk_block_invoke_result_addr_translate(addr, frame, map);
 		if(CESK_STORE_ADDR_NULL == i_addr)
 		{
 			LOG_ERROR("can not translate result address "PRSAddr"", addr);
 			return NULL;
 		}
-		if(cesk_set_modify(set, addr, i_addr) < 0)
+		if(addr == i_addr) continue;
+		_cesk_block_set_translate_buf[nmod ++] = addr;
+		_cesk_block_set_translate_buf[nmod ++] = i_addr;
+	}
+	size_t i;
+	for(i = 0; i < nmod; i += 2)
+	{
+		if(cesk_set_modify(set, _cesk_block_set_translate_buf[i], _cesk_block_set_translate_buf[i + 1]) < 0)
 		{
-			LOG_ERROR("can not modify address "PRSAddr" to address "PRSAddr"", addr, i_addr);
+			LOG_ERROR("can not modify address "PRSAddr" to address "PRSAddr"", _cesk_block_set_translate_buf[i], _cesk_block_set_translate_buf[i + 1]);
 			return NULL;
 		}
 	}
@@ -703,21 +744,19 @@ static inline cesk_set_t* _cesk_block_invoke_result_set_translate(
  *        needs to be patched
  * @param value the value to translate
  * @param frame current stack frame
- * @param diff the result idf
- * @param addrmap the address map
+ * @param map the translation map
  * @return the translated value
  * @note the return value actually is the input address.
  **/
 static inline cesk_value_t* _cesk_block_invoke_result_value_translate(
 		cesk_value_t* value,
 		const cesk_frame_t* frame,
-		const cesk_diff_t* diff,
-		const uint32_t* addrmap)
+		const _cesk_block_addr_map_t* map)
 {
 	/* if the value to be translated is a set, invoke the set translation function directly */
 	if(CESK_TYPE_SET == value->type)
 	{
-		if(NULL == _cesk_block_invoke_result_set_translate(value->pointer.set, frame, diff, addrmap))
+		if(NULL == _cesk_block_invoke_result_set_translate(value->pointer.set, frame, map))
 		{
 			LOG_ERROR("can not translate value of set");
 			return NULL;
@@ -757,7 +796,7 @@ static inline cesk_value_t* _cesk_block_invoke_result_value_translate(
 				int j;
 				/* translate the address one by one */
 				for(j = 0; j < rc; j ++)
-					buf[j] = _cesk_block_invoke_result_addr_translate(buf[j], frame, diff, addrmap);
+					buf[j] = _cesk_block_invoke_result_addr_translate(buf[j], frame, map);
 				/* ok, write the addresses back */
 				if(bci_class_write(this->bcidata, offset, buf, rc, this->class.bci->class) < 0)
 				{
@@ -777,8 +816,8 @@ static inline cesk_value_t* _cesk_block_invoke_result_value_translate(
 			for(j = 0; j < this->num_members; j ++)
 			{
 				uint32_t addr = this->addrtab[j];
-				uint32_t r_addr = _cesk_block_invoke_result_addr_translate(addr, frame, diff, addrmap);
-				if(CESK_STORE_ADDR_NULL == addr)
+				uint32_t r_addr = _cesk_block_invoke_result_addr_translate(addr, frame, map);
+				if(CESK_STORE_ADDR_NULL == r_addr)
 				{
 					LOG_ERROR("can not translate result address "PRSAddr" to interal address", addr);
 					return NULL;
@@ -800,24 +839,35 @@ static uint32_t* _cesk_block_internal_addr_buf = NULL;
  **/
 static size_t    _cesk_block_internal_addr_bufsize = 0;
 /**
- * @brief check the size of the interal address buffer, if it's not a proper size, reallocate it
+ * @brief check the size of the interal address buffer, if it's not a proper size, reallocate it.
+ *        And then set up the translation map for each result
  * @param nfunc how many function do this instruction actually invokes
  * @param results the invoke results
- * @param nallocation the buffer for an array of number of allocation of each result
- * @param internal_addr the buffer for internal_addr array
+ * @param maps the buffer for the translation maps
  * @return if there's no way to make the buffer in proper size, return a value < 0
  */
 static inline int _cesk_block_internal_addr_buf_check(
 		uint32_t nfunc, 
 		cesk_diff_t** results, 
-		size_t* nallocation, 
-		uint32_t** internal_addr)
+		_cesk_block_addr_map_t* maps)
 {
 	uint32_t i;
 
 	size_t needed = 0;
 	for(i = 0; i < nfunc; i ++) 
-		needed += (nallocation[i] = results[i]->offset[CESK_DIFF_ALLOC + 1] - results[i]->offset[CESK_DIFF_ALLOC]);
+	{
+		const cesk_diff_t* result = results[i];
+		uint32_t first = result->offset[CESK_DIFF_ALLOC];
+		uint32_t last  = result->offset[CESK_DIFF_ALLOC + 1];
+		if(first == last)
+		{
+			maps[i].base = maps[i].span = 0;
+			continue;
+		}
+		maps[i].base = CESK_STORE_ADDR_RELOC_IDX(result->data[first].addr);
+		maps[i].span = CESK_STORE_ADDR_RELOC_IDX(result->data[last - 1].addr) - maps[i].base + 1;
+		needed += maps[i].span;
+	}
 
 	if(needed > _cesk_block_internal_addr_bufsize)
 	{
@@ -832,18 +882,33 @@ static inline int _cesk_block_internal_addr_buf_check(
 			return -1;
 		}
 	}
-	internal_addr[0] = _cesk_block_internal_addr_buf;
-	for(i = 1; i < nfunc; i ++) 
-		internal_addr[i] = internal_addr[i - 1] + results[i - 1]->offset[CESK_DIFF_ALLOC + 1] - results[i - 1]->offset[CESK_DIFF_ALLOC];
+	/* the slots which is not an allocation in the result do not have a map */
+	memset(_cesk_block_internal_addr_buf, 0xff, sizeof(uint32_t) * needed);
+	uint32_t* ptr = _cesk_block_internal_addr_buf;
+	for(i = 0; i < nfunc; i ++) 
+	{
+		maps[i].addr = ptr;
+		ptr += maps[i].span;
+	}
 	return 0;
 }
+/**
+ * @brief get the slot in the translation map for an allocation in the result diff
+ * @param map the translation map
+ * @param addr the allocated address in the result diff
+ * @return the slot
+ **/
+static inline uint32_t* _cesk_block_addr_map_slot(const _cesk_block_addr_map_t* map, uint32_t addr)
+{
+	return map->addr + (CESK_STORE_ADDR_RELOC_IDX(addr) - map->base);
+}
 /**
  * @brief assign each allocations of a result diff internal addresses
  * @param result the input result diff
  * @param callee_rtab the relocation table used by the target function
  * @param frame the caller frame
  * @param rtab  the caller relocation table
- * @param internal_addr the buffer for the result address array
+ * @param map the translation map to fill
  * @return the result of operation < 0 indicates error 
  **/
 static inline int _cesk_block_allocation_address_assignment(
@@ -851,7 +916,7 @@ static inline int _cesk_block_allocation_address_assignment(
 		const cesk_reloc_table_t* callee_rtab,
 		const cesk_frame_t* frame,
 		cesk_reloc_table_t* rtab,
-		uint32_t* internal_addr)
+		const _cesk_block_addr_map_t* map)
 {
 	uint32_t i;
 	for(i = result->offset[CESK_DIFF_ALLOC]; i < result->offset[CESK_DIFF_ALLOC + 1]; i ++)
@@ -876,7 +941,7 @@ static inline int _cesk_block_allocation_address_assignment(
 			return -1;
 		}
 		/* update the address map */
-		internal_addr[i - result->offset[CESK_DIFF_ALLOC]] = iaddr;
+		*_cesk_block_addr_map_slot(map, result->data[i].addr) = iaddr;
 		LOG_DEBUG("new address map "PRSAddr" --> "PRSAddr"", result->data[i].addr, iaddr);
 	}
 	return 0;
@@ -884,14 +949,14 @@ static inline int _cesk_block_allocation_address_assignment(
 /**
  * @brief tanslate the reuse record: only target address needs to be translated
  * @param result the result diff
- * @param internal_addr the internal address list
+ * @param map the translation map
  * @param frame the caller frame
  * @param buf the diff buffer
  * @return result of the operation < 0 indicates error
  **/
 static inline int _cesk_block_invoke_result_reuse_section_translate(
 		const cesk_diff_t* result, 
-		const uint32_t* internal_addr, 
+		const _cesk_block_addr_map_t* map, 
 		const cesk_frame_t* frame, 
 		cesk_diff_buffer_t* buf)
 {
@@ -899,7 +964,7 @@ static inline int _cesk_block_invoke_result_reuse_section_translate(
 	for(i = result->offset[CESK_DIFF_REUSE]; i < result->offset[CESK_DIFF_REUSE + 1]; i ++)
 	{
 		uint32_t ret_addr = result->data[i].addr;
-		uint32_t i_addr = _cesk_block_invoke_result_addr_translate(ret_addr, frame, result, internal_addr); 
+		uint32_t i_addr = _cesk_block_invoke_result_addr_translate(ret_addr, frame, map); 
 		if(cesk_diff_buffer_append(buf, CESK_DIFF_REUSE, i_addr, result->data[i].arg.generic) < 0)
 		{
 			LOG_ERROR("can not append reuse record to the diff buffer");
@@ -911,7 +976,7 @@ static inline int _cesk_block_invoke_result_reuse_section_translate(
 /**
  * @brief translate the allocation section, do a value translation
  * @param result the result diff
- * @param internal_addr the internal address list
+ * @param map the translation map
  * @param frame the caller frame
  * @param raddr_limit the relocated address limit
  * @param buf the diff buffer
@@ -919,7 +984,7 @@ static inline int _cesk_block_invoke_result_reuse_section_translate(
  **/
 static inline int _cesk_block_invoke_result_allocation_section_translate(
 		cesk_diff_t* result, 
-		const uint32_t* internal_addr, 
+		const _cesk_block_addr_map_t* map, 
 		const cesk_frame_t* frame, 
 		uint32_t raddr_limit, 
 		cesk_diff_buffer_t* buf)
@@ -928,7 +993,7 @@ static inline int _cesk_block_invoke_result_allocation_section_translate(
 	/* then allocation section, do a address translation and then object translation */
 	for(i = result->offset[CESK_DIFF_ALLOC]; i < result->offset[CESK_DIFF_ALLOC + 1]; i ++)
 	{
-		uint32_t iaddr = internal_addr[i - result->offset[CESK_DIFF_ALLOC]];
+		uint32_t iaddr = *_cesk_block_addr_map_slot(map, result->data[i].addr);
 		cesk_value_const_t* store_value;
 		/* if the the interal addrness is smaller than raddr_limit, this object 
 		 * has been allocated in the target store already, so that what we should do is
@@ -948,7 +1013,7 @@ static inline int _cesk_block_invoke_result_allocation_section_translate(
 			 * set will have the same address, what we need to do this take care about the values in the set */
 			if(CESK_TYPE_SET == result->data[i].arg.value->type)
 			{
-				cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, result, internal_addr);
+				cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, map);
 				if(NULL == value) 
 				{
 					LOG_ERROR("can not translate the value "PRSAddr, result->data[i].addr);
@@ -974,7 +1039,7 @@ static inline int _cesk_block_invoke_result_allocation_section_translate(
 		/* otherwise, this object is new to the target store, so we need emit an allocation record to the buffer */
 		else
 		{
-			cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, result, internal_addr);
+			cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, map);
 			if(NULL == value)
 			{
 				LOG_ERROR("can not translate the value");
@@ -992,7 +1057,7 @@ static inline int _cesk_block_invoke_result_allocation_section_translate(
 /**
  * @brief translate the register section, just address set translation
  * @param result the result buffer
- * @param internal_addr the internal address lit
+ * @param map the translation map
  * @param frame the caller frame
  * @param buf the diff buffer
  * @param result_reg the register that is to carry the invocation result
@@ -1000,7 +1065,7 @@ static inline int _cesk_block_invoke_result_allocation_section_translate(
  **/
 static inline int _cesk_block_invoke_result_register_section_translation(
 		cesk_diff_t* result, 
-		const uint32_t* internal_addr,
+		const _cesk_block_addr_map_t* map,
 		uint32_t result_reg,
 		const cesk_frame_t* frame, 
 		cesk_diff_buffer_t* buf)
@@ -1012,7 +1077,7 @@ static inline int _cesk_block_invoke_result_register_section_translation(
 		uint32_t regid = result->data[i].addr; 
 		if(CESK_FRAME_RESULT_REG == regid) regid = result_reg;
 		/* translate the register value set */
-		cesk_set_t* set = _cesk_block_invoke_result_set_translate(result->data[i].arg.set, frame, result, internal_addr);
+		cesk_set_t* set = _cesk_block_invoke_result_set_translate(result->data[i].arg.set, frame, map);
 		if(NULL == set)
 		{
 			LOG_ERROR("can not translate register v%d = %s", regid, cesk_set_to_string(result->data[i].arg.set, 0, 0));
@@ -1029,7 +1094,7 @@ static inline int _cesk_block_invoke_result_register_section_translation(
 /**
  * @brief trnslate the store section
  * @param result the result buffer
- * @param internal_addr the internal address list
+ * @param map the translation map
  * @param frame the caller frame
  * @param raddr_limit the relocated address boundary
  * @param buf the diff buffer
@@ -1037,7 +1102,7 @@ static inline int _cesk_block_invoke_result_register_section_translation(
  **/
 static inline int _cesk_block_invoke_result_store_section_translation(
 		cesk_diff_t* result, 
-		const uint32_t* internal_addr, 
+		const _cesk_block_addr_map_t* map, 
 		const cesk_frame_t* frame, 
 		uint32_t raddr_limit, 
 		cesk_diff_buffer_t* buf)
@@ -1046,14 +1111,14 @@ static inline int _cesk_block_invoke_result_store_section_translation(
 	/* then, store section */
 	for(i = result->offset[CESK_DIFF_STORE]; i < result->offset[CESK_DIFF_STORE + 1]; i ++)
 	{
-		uint32_t addr = _cesk_block_invoke_result_addr_translate(result->data[i].addr, frame, result, internal_addr);
+		uint32_t addr = _cesk_block_invoke_result_addr_translate(result->data[i].addr, frame, map);
 		if(CESK_STORE_ADDR_NULL == addr)
 		{
 			LOG_ERROR("can not translate address");
 			return -1;
 		}
 		
-		cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, result, internal_addr);
+		cesk_value_t* value = _cesk_block_invoke_result_value_translate(result->data[i].arg.value, frame, map);
 		
 		if(NULL == value)
 		{
@@ -1185,11 +1250,10 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 		}
 	}
 
-	/* the address map, allocation record index --> internal addr */
-	static size_t   nallocation[CESK_BLOCK_MAX_NUM_OF_FUNC];
-	static uint32_t* internal_addr[CESK_BLOCK_MAX_NUM_OF_FUNC];
+	/* the address map, relocated index in the result --> internal addr */
+	static _cesk_block_addr_map_t maps[CESK_BLOCK_MAX_NUM_OF_FUNC];
 	
-	if(_cesk_block_internal_addr_buf_check(nfunc, results, nallocation ,internal_addr) < 0)
+	if(_cesk_block_internal_addr_buf_check(nfunc, results, maps) < 0)
 	{
 		LOG_ERROR("can not make the interal address buffer in proper size, aborting");
 		goto ERR;
@@ -1205,7 +1269,7 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 	/* now we can get the address maps */
 	for(i = 0; i < nfunc; i ++)
 	{
-		if(_cesk_block_allocation_address_assignment(results[i], callee_rtabs[i], frame, rtab, internal_addr[i]) < 0)
+		if(_cesk_block_allocation_address_assignment(results[i], callee_rtabs[i], frame, rtab, maps + i) < 0)
 		{
 			LOG_ERROR("can not assign internal addresses for allocations in result #%u", i);
 			goto ERR;
@@ -1215,7 +1279,7 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 	/* translate the reuse section */
 	for(i = 0; i < nfunc; i ++)
 	{
-		if(_cesk_block_invoke_result_reuse_section_translate(results[i], internal_addr[i], frame, buf) < 0)
+		if(_cesk_block_invoke_result_reuse_section_translate(results[i], maps + i, frame, buf) < 0)
 		{
 			LOG_ERROR("can not translate the reuse section of result diff #%u", i);
 			goto ERR;
@@ -1225,7 +1289,7 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 	/* translate the allocation section */
 	for(i = 0; i < nfunc; i ++)
 	{
-		if(_cesk_block_invoke_result_allocation_section_translate(results[i], internal_addr[i], frame, raddr_limit, buf) < 0)
+		if(_cesk_block_invoke_result_allocation_section_translate(results[i], maps + i, frame, raddr_limit, buf) < 0)
 		{
 			LOG_ERROR("can not translate the allocation section of result diff #%u", i);
 			goto ERR;
@@ -1235,7 +1299,7 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 	/* translate register section */
 	for(i = 0; i < nfunc; i ++)
 	{
-		if(_cesk_block_invoke_result_register_section_translation(results[i], internal_addr[i], result_reg, frame, buf) < 0)
+		if(_cesk_block_invoke_result_register_section_translation(results[i], maps + i, result_reg, frame, buf) < 0)
 		{
 			LOG_ERROR("can not translate the regiseter of result diff #%u", i);
 			goto ERR;
@@ -1245,7 +1309,7 @@ static inline cesk_diff_t* _cesk_block_invoke_result_translate(
 	/* translate the store section */
 	for(i = 0; i < nfunc; i ++)
 	{
-		if(_cesk_block_invoke_result_store_section_translation(results[i], internal_addr[i], frame, raddr_limit, buf) < 0)
+		if(_cesk_block_invoke_result_store_section_translation(results[i], maps + i, frame, raddr_limit, buf) < 0)
 		{
 			LOG_ERROR("can not translate the store section of result diff #%u", i);
 			goto ERR;
@@ -1379,6 +1443,262 @@ static inline cesk_set_t* _cesk_block_method_heap_get_partition(const dalvik_blo
 	}
 	return ret;
 }
+/**
+ * @brief the node of the virtual dispatch cache
+ * @details the method adopted by an object only depends on the class of the object, so that
+ *          the result of the method lookup is cached with key &lt;receiver class, method name, 
+ *          typelist, return type, is super call&gt;. Because the object layout only depends 
+ *          on the class, we record the offset of the object struct that provides the method.
+ *          For a built-in class, the built-in class interface should be asked for the method id,
+ *          because the get_method callback may be not pure.
+ **/
+typedef struct _cesk_block_dispatch_node_t {
+	const char* receiver;                      /*!< the class path of the receiver object */
+	const char* methodname;                    /*!< the method name */
+	const dalvik_type_t* const * typelist;     /*!< the type list */
+	const dalvik_type_t* rtype;                /*!< the return type */
+	uint8_t super:1;                           /*!< if this is an invoke-super */
+	uint8_t found:1;                           /*!< if there's a method has been adopted */
+	uint32_t offset;                           /*!< the offset of the object struct provides the method */
+	const dalvik_block_t* code;                /*!< the code of the method, NULL if it's a built-in method */
+	struct _cesk_block_dispatch_node_t* next;  /*!< the next pointer in the hash table */
+} _cesk_block_dispatch_node_t;
+/**
+ * @brief the inline cache of an invoke instruction
+ **/
+typedef struct {
+	uint32_t inst;                         /*!< the instruction index owns this cache, CESK_STORE_ADDR_NULL means unused */
+	uint32_t size;                         /*!< the number of receiver classes in this cache */
+	const _cesk_block_dispatch_node_t* entry[CESK_BLOCK_INLINE_CACHE_WAYS];  /*!< the dispatch results */
+	uint8_t mono_resolved;                 /*!< if the class hierarchy analysis has been done for this call site */
+	uint8_t mono_size;                     /*!< the number of receiver classes known to be in the subtree of the static type */
+	const dalvik_block_t* mono;            /*!< the only possible target for the receivers in the subtree of the static type, NULL if it's polymorphic */
+	const char* mono_receiver[CESK_BLOCK_INLINE_CACHE_WAYS];  /*!< the receiver classes known to be in the subtree */
+} _cesk_block_inline_cache_t;
+/**
+ * @brief the global dispatch table
+ **/
+static _cesk_block_dispatch_node_t* _cesk_block_dispatch_cache[CESK_BLOCK_DISPATCH_CACHE_SIZE];
+/**
+ * @brief the result returned when no method is adopted, which is not in the cache
+ **/
+static const _cesk_block_dispatch_node_t _cesk_block_dispatch_not_found = {
+	.found = 0
+};
+/**
+ * @brief the inline caches, indexed by the instruction index
+ **/
+static _cesk_block_inline_cache_t _cesk_block_inline_cache[CESK_BLOCK_INLINE_CACHE_SIZE];
+/** @brief how many lookups are answered by the inline cache */
+static uint32_t _cesk_block_dispatch_inline_hit;
+/** @brief how many lookups are answered by the global dispatch table */
+static uint32_t _cesk_block_dispatch_global_hit;
+/** @brief how many lookups need to walk the inheritance path */
+static uint32_t _cesk_block_dispatch_miss;
+/** @brief how many receivers are dispatched to the target resolved by the class hierarchy analysis */
+static uint32_t _cesk_block_dispatch_monomorphic;
+/**
+ * @brief the hash function for the dispatch table
+ * @param receiver the class of the receiver
+ * @param methodname the method name
+ * @param typelist the type list
+ * @param rtype the return type
+ * @param super if this is an invoke-super
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_block_dispatch_hash(
+		const char* receiver, 
+		const char* methodname, 
+		const dalvik_type_t* const * typelist, 
+		const dalvik_type_t* rtype, 
+		int super)
+{
+	return (((uintptr_t)receiver) * MH_MULTIPLY) ^ 
+		   (((uintptr_t)methodname) * MH_MULTIPLY * MH_MULTIPLY) ^ 
+		   dalvik_type_list_hashcode(typelist) ^ 
+		   (dalvik_type_hashcode(rtype) * MH_MULTIPLY) ^ 
+		   super;
+}
+/**
+ * @brief walk the inheritance path of the object and find which object struct provides the method
+ * @param object the receiver object
+ * @param methodname the method name
+ * @param typelist the type list
+ * @param rtype the return type
+ * @param super if this is an invoke-super
+ * @param node the dispatch node to fill
+ * @return nothing
+ **/
+static inline void _cesk_block_dispatch_resolve(
+		const cesk_object_t* object, 
+		const char* methodname, 
+		const dalvik_type_t* const * typelist, 
+		const dalvik_type_t* rtype, 
+		int super,
+		_cesk_block_dispatch_node_t* node)
+{
+	const cesk_object_struct_t* current = object->members;
+	int i;
+	node->found = 0;
+	node->code = NULL;
+	node->offset = 0;
+	for(i = 0; i < object->depth; i ++)
+	{
+		/* for super call, just skip the class methods */
+		if(0 == i && super) 
+			continue; 
+		/* this is an instance of an user defined class */
+		if(!current->built_in)
+		{
+			const char* clspath = current->class.path->value;
+			node->code = dalvik_block_from_method(clspath, methodname, typelist, rtype);
+			if(NULL != node->code) 
+			{
+				node->found = 1;
+				node->offset = CESK_OBJECT_FIELD_OFS(object, current);
+				return;
+			}
+		}
+		else if(bci_class_get_method(current->bcidata, current->class.path->value, methodname, typelist, rtype, current->class.bci->class) >= 0)
+		{
+			node->found = 1;
+			node->offset = CESK_OBJECT_FIELD_OFS(object, current);
+			return;
+		}
+		CESK_OBJECT_STRUCT_ADVANCE(current);
+	}
+}
+/**
+ * @brief get the inline cache of an invoke instruction, the slot is reset if it's owned by another instruction
+ * @param ins the invoke instruction
+ * @return the inline cache
+ **/
+static inline _cesk_block_inline_cache_t* _cesk_block_inline_cache_get(const dalvik_instruction_t* ins)
+{
+	uint32_t inst = dalvik_instruction_get_index(ins);
+	_cesk_block_inline_cache_t* ic = _cesk_block_inline_cache + (inst % CESK_BLOCK_INLINE_CACHE_SIZE);
+	if(ic->inst != inst)
+	{
+		ic->inst = inst;
+		ic->size = 0;
+		ic->mono_resolved = 0;
+		ic->mono_size = 0;
+		ic->mono = NULL;
+	}
+	return ic;
+}
+/**
+ * @brief resolve a virtual call site with the class hierarchy analysis
+ * @details the result is only used for the receivers which are instances of user-defined classes,
+ *          because the hierarchy index only knows the loaded classes. The analysis needs the whole 
+ *          program, so it's skipped while there are classes waiting for the lazy loader
+ * @param ins the invoke instruction
+ * @return the code of the only possible target, NULL if the call site is polymorphic or unknown
+ **/
+static inline const dalvik_block_t* _cesk_block_dispatch_monomorphic_target(const dalvik_instruction_t* ins)
+{
+	_cesk_block_inline_cache_t* ic = _cesk_block_inline_cache_get(ins);
+	if(ic->mono_resolved) return ic->mono;
+	if(dalvik_loader_num_pending() > 0) return NULL;
+	const char* classpath = ins->operands[0].payload.methpath;
+	const char* methodname = ins->operands[1].payload.methpath;
+	const dalvik_type_t* const * typelist = ins->operands[2].payload.typelist;
+	const dalvik_type_t* rtype = ins->operands[3].payload.type;
+	const char* target = dalvik_hierarchy_resolve_monomorphic(classpath, methodname, typelist, rtype);
+	ic->mono = (NULL == target) ? NULL : dalvik_block_from_method(target, methodname, typelist, rtype);
+	ic->mono_resolved = 1;
+	if(NULL != ic->mono)
+		LOG_DEBUG("the call site of %s.%s is monomorphic, the target is defined in class %s", classpath, methodname, target);
+	return ic->mono;
+}
+/**
+ * @brief check if the target resolved by the class hierarchy analysis applies to the receiver
+ * @details the hierarchy index only walks the loaded classes under the static type, so a receiver
+ *          which reaches the static type through a class that is not loaded (e.g. a library class)
+ *          is not covered, and it should take the dynamic lookup
+ * @param ins the invoke instruction
+ * @param receiver the class path of the receiver
+ * @return 1 if the receiver is in the subtree of the static type, 0 otherwise
+ **/
+static inline int _cesk_block_dispatch_monomorphic_covers(const dalvik_instruction_t* ins, const char* receiver)
+{
+	_cesk_block_inline_cache_t* ic = _cesk_block_inline_cache_get(ins);
+	uint32_t i;
+	for(i = 0; i < ic->mono_size; i ++)
+		if(ic->mono_receiver[i] == receiver) return 1;
+	if(!dalvik_hierarchy_is_subtype(receiver, ins->operands[0].payload.methpath)) return 0;
+	if(ic->mono_size < CESK_BLOCK_INLINE_CACHE_WAYS)
+		ic->mono_receiver[ic->mono_size ++] = receiver;
+	return 1;
+}
+/**
+ * @brief find the dispatch result for a receiver object
+ * @param ins the invoke instruction
+ * @param object the receiver object
+ * @param super if this is an invoke-super
+ * @return the dispatch result, NULL indicates error
+ **/
+static inline const _cesk_block_dispatch_node_t* _cesk_block_dispatch_lookup(
+		const dalvik_instruction_t* ins, 
+		const cesk_object_t* object, 
+		int super)
+{
+	const char* receiver = cesk_object_classpath(object);
+	const char* methodname = ins->operands[1].payload.methpath;
+	const dalvik_type_t* const * typelist = ins->operands[2].payload.typelist;
+	const dalvik_type_t* rtype = ins->operands[3].payload.type;
+	
+	/* try the inline cache first, the flags and the method is decided by the instruction */
+	_cesk_block_inline_cache_t* ic = _cesk_block_inline_cache_get(ins);
+	int i;
+	for(i = 0; i < ic->size; i ++)
+		if(ic->entry[i]->receiver == receiver)
+		{
+			_cesk_block_dispatch_inline_hit ++;
+			return ic->entry[i];
+		}
+
+	/* then the global dispatch table */
+	hashval_t h = _cesk_block_dispatch_hash(receiver, methodname, typelist, rtype, super) % CESK_BLOCK_DISPATCH_CACHE_SIZE;
+	_cesk_block_dispatch_node_t* node;
+	for(node = _cesk_block_dispatch_cache[h]; NULL != node; node = node->next)
+		if(node->receiver == receiver &&
+		   node->methodname == methodname &&
+		   node->super == super && 
+		   dalvik_type_list_equal(node->typelist, typelist) &&
+		   dalvik_type_equal(node->rtype, rtype))
+			break;
+	if(NULL != node)
+		_cesk_block_dispatch_global_hit ++;
+	else
+	{
+		_cesk_block_dispatch_miss ++;
+		_cesk_block_dispatch_node_t result = {
+			.receiver   = receiver,
+			.methodname = methodname,
+			.typelist   = typelist,
+			.rtype      = rtype,
+			.super      = (super != 0)
+		};
+		_cesk_block_dispatch_resolve(object, methodname, typelist, rtype, super, &result);
+		/* the method might be found later, e.g. the class is loaded lazily or the block graph 
+		 * can not be built this time, so that a miss is never cached */
+		if(!result.found) return &_cesk_block_dispatch_not_found;
+		node = (_cesk_block_dispatch_node_t*)malloc(sizeof(_cesk_block_dispatch_node_t));
+		if(NULL == node)
+		{
+			LOG_ERROR("can not allocate memory for the dispatch cache");
+			return NULL;
+		}
+		*node = result;
+		node->next = _cesk_block_dispatch_cache[h];
+		_cesk_block_dispatch_cache[h] = node;
+	}
+	/* a megamorphic instruction only uses the global table */
+	if(ic->size < CESK_BLOCK_INLINE_CACHE_WAYS)
+		ic->entry[ic->size ++] = node;
+	return node;
+}
 /**
  * @brief find proper methods for the function call
  * @param ins the invoke instruction
@@ -1432,7 +1752,10 @@ static inline int _cesk_block_find_invoke_method(const dalvik_instruction_t* ins
 				self[0] = cesk_set_fork(this);
 				goto DIRECT_INVOKE;
 			}
-			/* only invoke-virtual and invoke-interface can be here */
+			/* only invoke-virtual, invoke-interface and invoke-super can be here */
+			const dalvik_block_t* mono = NULL;
+			if(DVM_FLAG_INVOKE_SUPER != (ins->flags & DVM_FLAG_INVOKE_TYPE_MSK))
+				mono = _cesk_block_dispatch_monomorphic_target(ins);
 			cesk_set_iter_t iter;
 			if(NULL == cesk_set_iter(this, &iter))
 			{
@@ -1449,45 +1772,45 @@ static inline int _cesk_block_find_invoke_method(const dalvik_instruction_t* ins
 					continue;
 				}
 				const cesk_object_t* object = value->pointer.object;
-				const cesk_object_struct_t* current = object->members;
-				int i;
+				/* all the user-defined classes in the subtree of the static type adopt the same method */
+				if(NULL != mono && !object->members[0].built_in && _cesk_block_dispatch_monomorphic_covers(ins, cesk_object_classpath(object)))
+				{
+					_cesk_block_dispatch_monomorphic ++;
+					_cesk_block_method_heap_addr[_cesk_block_method_heap_size] = addr;
+					_cesk_block_method_heap_code[_cesk_block_method_heap_size] = mono;
+					_cesk_block_method_heap_size ++;
+					continue;
+				}
+				const _cesk_block_dispatch_node_t* node = _cesk_block_dispatch_lookup(ins, object, DVM_FLAG_INVOKE_SUPER == (ins->flags & DVM_FLAG_INVOKE_TYPE_MSK));
+				if(NULL == node)
+				{
+					LOG_ERROR("can not resolve method %s.%s for address "PRSAddr, classpath, methodname, addr);
+					return -1;
+				}
+				if(!node->found)
+				{
+					LOG_WARNING("can not found target method %s.%s for object, ignore this address"PRSAddr, classpath, methodname, addr);
+					continue;
+				}
 				_cesk_block_method_heap_addr[_cesk_block_method_heap_size] = addr;
-				for(i = 0; i < object->depth; i ++)
+				_cesk_block_method_heap_code[_cesk_block_method_heap_size] = node->code;
+				if(NULL != node->code)
+					LOG_DEBUG("method %s.%s is actually adopted for address " PRSAddr, cesk_object_classpath(object), methodname, addr);
+				else
 				{
-					/* for super call, just skip the class methods */
-					if(0 == i && DVM_FLAG_INVOKE_SUPER == (ins->flags & DVM_FLAG_INVOKE_TYPE_MSK)) 
-						continue; 
-					/* this is an instance of an user defined class */
-					if(!current->built_in)
-					{
-						const char* clspath = current->class.path->value;
-						_cesk_block_method_heap_code[_cesk_block_method_heap_size] = dalvik_block_from_method(clspath, methodname, typelist, rtype);
-						if(NULL != _cesk_block_method_heap_code[_cesk_block_method_heap_size]) 
-						{
-							LOG_DEBUG("method %s.%s is actually adopted for address " PRSAddr, clspath, methodname, addr);
-							break;
-						}
-					}
-					else
+					/* the built-in class still needs to know which method we are calling */
+					const cesk_object_struct_t* current = (const cesk_object_struct_t*)(((const char*)object) + node->offset);
+					int method_id = bci_class_get_method(current->bcidata, current->class.path->value, methodname, typelist, rtype, current->class.bci->class);
+					if(method_id < 0)
 					{
-						/* TODO: test this branch */
-						int method_id = bci_class_get_method(current->bcidata, current->class.path->value, methodname, typelist, rtype, current->class.bci->class);
-						_cesk_block_method_heap_code[_cesk_block_method_heap_size] = NULL;
-						/* if this method is supported by this method */ 
-						if(method_id >= 0)
-						{
-							LOG_DEBUG("built-in method %s.%s has been adopted as a candidate function", current->class.path->value, methodname);
-							_cesk_block_method_heap_midx[_cesk_block_method_heap_size] = method_id;
-							_cesk_block_method_heap_bcls[_cesk_block_method_heap_size] = current->class.bci->class;
-							break;
-						}
+						LOG_WARNING("built-in class %s refused method %s, ignore this address"PRSAddr, current->class.path->value, methodname, addr);
+						continue;
 					}
-					CESK_OBJECT_STRUCT_ADVANCE(current);
+					LOG_DEBUG("built-in method %s.%s has been adopted as a candidate function", current->class.path->value, methodname);
+					_cesk_block_method_heap_midx[_cesk_block_method_heap_size] = method_id;
+					_cesk_block_method_heap_bcls[_cesk_block_method_heap_size] = current->class.bci->class;
 				}
-				if(i == object->depth)
-					LOG_WARNING("can not found target method %s.%s for object, ignore this address"PRSAddr, classpath, methodname, addr);
-				else 
-					_cesk_block_method_heap_size ++;
+				_cesk_block_method_heap_size ++;
 			}
 			_cesk_block_method_heap_init();
 			for(;NULL != (self[ret] = _cesk_block_method_heap_get_partition(code + ret, class + ret, method_id + ret)); ret ++);
@@ -1524,6 +1847,154 @@ DIRECT_INVOKE:
 
 	return ret;
 }
+/**
+ * @brief the memoized result of a const built-in method
+ **/
+typedef struct _cesk_block_summary_node_t {
+	const bci_class_t* class;                  /*!< the built-in class */
+	int method_id;                             /*!< the method id */
+	uint32_t nargs;                            /*!< the number of arguments */
+	cesk_set_t* result;                        /*!< the result set */
+	struct _cesk_block_summary_node_t* next;   /*!< the next pointer in the hash table */
+	cesk_set_t* args[0];                       /*!< the argument sets */
+} _cesk_block_summary_node_t;
+/**
+ * @brief the memoization table for the const built-in methods
+ **/
+static _cesk_block_summary_node_t* _cesk_block_summary_cache[CESK_BLOCK_SUMMARY_CACHE_SIZE];
+/**
+ * @brief the frame used to pass the arguments to a pure built-in method, it shares the store with the caller
+ **/
+static cesk_frame_t* _cesk_block_summary_frame = NULL;
+/**
+ * @brief the number of registers the summary frame can hold
+ **/
+static uint32_t _cesk_block_summary_frame_cap = 0;
+/**
+ * @brief the hash function for the memoization table
+ * @param class the built-in class
+ * @param method_id the method id
+ * @param nargs the number of arguments
+ * @param args the argument sets
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_block_summary_hash(const bci_class_t* class, int method_id, uint32_t nargs, cesk_set_t* const* args)
+{
+	hashval_t ret = (((uintptr_t)class) * MH_MULTIPLY) ^ (method_id * MH_MULTIPLY * MH_MULTIPLY) ^ nargs;
+	uint32_t i;
+	for(i = 0; i < nargs; i ++)
+		ret = (ret * MH_MULTIPLY) ^ cesk_set_hashcode(args[i]);
+	return ret;
+}
+/**
+ * @brief invoke a pure built-in method, the method can only read the store and return a value set, 
+ *        so we do not need the callee store, the relocation table and the result translation
+ * @param ins the invoke instruction
+ * @param frame the caller frame
+ * @param class the built-in class
+ * @param method_id the method id
+ * @param nargs the number of arguments
+ * @param args the argument sets
+ * @param result the set to merge the result into
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_block_invoke_pure(
+		const dalvik_instruction_t* ins, 
+		const cesk_frame_t* frame, 
+		const bci_class_t* class, 
+		int method_id, 
+		uint32_t nargs, 
+		cesk_set_t* const* args,
+		cesk_set_t* result)
+{
+	uint32_t i;
+	int memoize = BCI_CLASS_METHOD_IS_CONST(method_id) ? 1 : 0;
+	hashval_t h = 0;
+	PERF_INC(bci_fast_path);
+	if(memoize)
+	{
+		h = _cesk_block_summary_hash(class, method_id, nargs, args) % CESK_BLOCK_SUMMARY_CACHE_SIZE;
+		const _cesk_block_summary_node_t* node;
+		for(node = _cesk_block_summary_cache[h]; NULL != node; node = node->next)
+		{
+			if(node->class != class || node->method_id != method_id || node->nargs != nargs) continue;
+			for(i = 0; i < nargs && cesk_set_equal(node->args[i], args[i]) == 1; i ++);
+			if(i == nargs)
+			{
+				PERF_INC(bci_summary_hit);
+				return cesk_set_merge(result, node->result);
+			}
+		}
+		PERF_INC(bci_summary_miss);
+	}
+	/* the arguments are passed in the last nargs registers of the frame */
+	if(_cesk_block_summary_frame_cap < nargs + 2)
+	{
+		cesk_frame_t* new_frame = (cesk_frame_t*)realloc(_cesk_block_summary_frame, sizeof(cesk_frame_t) + (nargs + 2) * sizeof(cesk_set_t*));
+		if(NULL == new_frame)
+		{
+			LOG_ERROR("can not allocate memory for the argument frame");
+			return -1;
+		}
+		_cesk_block_summary_frame = new_frame;
+		_cesk_block_summary_frame_cap = nargs + 2;
+	}
+	cesk_frame_t* callee_frame = _cesk_block_summary_frame;
+	callee_frame->size = nargs + 2;
+	callee_frame->store = frame->store;
+	callee_frame->statics = frame->statics;
+	callee_frame->canon = NULL;
+	callee_frame->reg_result = NULL;
+	callee_frame->reg_exception = NULL;
+	memcpy(callee_frame->general_regs, args, nargs * sizeof(cesk_set_t*));
+
+	bci_method_env_t env = {
+		.frame = callee_frame,
+		.rtable = NULL,
+		.instruction = ins,
+		.D = NULL,
+		.result = cesk_set_empty_set()
+	};
+	if(NULL == env.result)
+	{
+		LOG_ERROR("can not create the result set");
+		return -1;
+	}
+	if(bci_class_invoke(method_id, &env, class) < 0)
+	{
+		LOG_ERROR("function invocation returns an error");
+		goto ERR;
+	}
+	if(cesk_set_merge(result, env.result) < 0)
+	{
+		LOG_ERROR("can not merge the result set");
+		goto ERR;
+	}
+	if(memoize)
+	{
+		_cesk_block_summary_node_t* node = (_cesk_block_summary_node_t*)malloc(sizeof(_cesk_block_summary_node_t) + nargs * sizeof(cesk_set_t*));
+		if(NULL == node)
+		{
+			LOG_WARNING("can not allocate memory for the memoization table, the result is not memoized");
+			cesk_set_free(env.result);
+			return 0;
+		}
+		node->class = class;
+		node->method_id = method_id;
+		node->nargs = nargs;
+		node->result = env.result;
+		for(i = 0; i < nargs; i ++)
+			node->args[i] = cesk_set_fork(args[i]);
+		node->next = _cesk_block_summary_cache[h];
+		_cesk_block_summary_cache[h] = node;
+		return 0;
+	}
+	cesk_set_free(env.result);
+	return 0;
+ERR:
+	cesk_set_free(env.result);
+	return -1;
+}
 /**
  * @brief the instruction handler for function calls
  * @param ins current instruction
@@ -1567,6 +2038,17 @@ static inline int _cesk_block_handler_invoke(
 	cesk_diff_buffer_t* bci_I = NULL;
 
 	int k;
+	/* if all the candidates are pure built-in methods, the invocation only writes the result register */
+	int pure = (nfunc > 0);
+	for(k = 0; pure && k < nfunc; k ++)
+		pure = (NULL == code[k] && BCI_CLASS_METHOD_IS_PURE(method_id[k]));
+	cesk_set_t* pure_result = NULL;
+	if(pure && NULL == (pure_result = cesk_set_empty_set()))
+	{
+		LOG_ERROR("can not create the result set");
+		return -1;
+	}
+
 	for(k = 0; k < nfunc; k ++)
 	{
 		
@@ -1601,6 +2083,23 @@ static inline int _cesk_block_handler_invoke(
 		if(NULL != code[k]) nregs = code[k]->nregs;
 		else nregs = nargs;
 
+		if(pure)
+		{
+			if(_cesk_block_invoke_pure(ins, frame, class[k], method_id[k], nargs, args, pure_result) < 0)
+			{
+				LOG_ERROR("can not invoke the pure built-in method");
+				goto ERR;
+			}
+			for(i = 0; i < nargs; i ++)
+			{
+				cesk_set_free(args[i]);
+				args[i] = NULL;
+			}
+			/* the this pointer is passed as the first argument, so it has been released */
+			this[k] = NULL;
+			callee_rtable[k] = NULL;
+			continue;
+		}
 
 		/* for a user defined call, call analyzer recursively */
 		if(NULL != code[k])
@@ -1704,6 +2203,17 @@ BCI_INVOKE_ERR:
 		result_reg = CESK_FRAME_GENERAL_REG(regid);
 	}
 
+	if(pure)
+	{
+		if(cesk_frame_register_assign(frame, result_reg, pure_result, D, I) < 0)
+		{
+			LOG_ERROR("can not assign the result to the result register");
+			goto ERR;
+		}
+		cesk_set_free(pure_result);
+		return 0;
+	}
+
 	cesk_diff_t* result = _cesk_block_invoke_result_translate(ins, frame, rtab, callee_rtable, invoke_result, nfunc, result_reg);
 	if(NULL == result)
 	{
@@ -1731,6 +2241,7 @@ PARAMERR_RANGE:
 ERR:
 	if(bci_D) cesk_diff_buffer_free(bci_D);
 	if(bci_I) cesk_diff_buffer_free(bci_I);
+	if(pure_result) cesk_set_free(pure_result);
 	if(flag_args_ref)
 	{
 		for(i = 0; i < nargs; i ++)
@@ -1780,9 +2291,17 @@ int cesk_block_analyze(
 	uint32_t ctx_id;
 	if(NULL != caller_ctx) ctx_id = *(uint32_t*)caller_ctx;
 	else ctx_id = 0;
+	const dalvik_compact_t* compact = code->compact;
+	if(NULL == compact)
+	{
+		LOG_ERROR("the block is not encoded");
+		goto ERR;
+	}
 	for(i = code->begin; i < code->end; i ++)
 	{
+		/* only the handlers of the generic instructions read the instruction body */
 		const dalvik_instruction_t* ins = dalvik_instruction_get(i);
+		uint32_t k = i - code->begin;
 		LOG_DEBUG("currently executing instruction %s", dalvik_instruction_to_string(ins, NULL, 0));
 #if DEBUGGER
 		if(debugger_callback(ins, frame, caller_ctx) < 0) goto ERR;
@@ -1793,38 +2312,45 @@ int cesk_block_analyze(
 			LOG_ERROR("can not open transaction");
 			return -1;
 		}
-		switch(ins->opcode)
+		PERF_CODE(uint64_t perf_begin = perf_clock());
+		switch(DALVIK_COMPACT_OP(compact, k))
 		{
-			case DVM_NOP:
+			case DALVIK_COMPACT_OP_NOP:
+				break;
+			case DALVIK_COMPACT_OP_MOVE:
+			case DALVIK_COMPACT_OP_MOVE_WIDE:
+				if(_cesk_block_handler_move(compact, k, frame, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_MOVE:
-				if(_cesk_block_handler_move(ins, frame, dbuf, ibuf) < 0) goto EXE_ERR;
+			case DALVIK_COMPACT_OP_CONST:
+				if(_cesk_block_handler_const(compact, k, frame, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_CONST:
-				if(_cesk_block_handler_const(ins, frame, rtab, dbuf, ibuf) < 0) goto EXE_ERR;
+			case DALVIK_COMPACT_OP_CONST_STRING:
+				if(_cesk_block_handler_const_string(ins, frame, rtab, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_CMP:
-				if(_cesk_block_handler_cmp(ins, frame, dbuf, ibuf) < 0) goto EXE_ERR;
+			case DALVIK_COMPACT_OP_CMP:
+			case DALVIK_COMPACT_OP_CMP_WIDE:
+				if(_cesk_block_handler_cmp(compact, k, frame, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_INSTANCE:
+			case DALVIK_COMPACT_OP_INSTANCE:
 				if(_cesk_block_handler_instance(ins, frame, ctx_id, rtab, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_INVOKE:
+			case DALVIK_COMPACT_OP_INVOKE:
 				if(_cesk_block_handler_invoke(ins, frame, rtab, dbuf, ibuf, caller_ctx) < 0) goto EXE_ERR;
 				break;
-			case DVM_UNOP:
-				if(_cesk_block_handler_unop(ins, frame, dbuf, ibuf) < 0) goto EXE_ERR;
+			case DALVIK_COMPACT_OP_UNOP:
+				if(_cesk_block_handler_unop(compact, k, frame, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_BINOP:
-				if(_cesk_block_handler_binop(ins, frame, dbuf, ibuf) < 0) goto EXE_ERR;
+			case DALVIK_COMPACT_OP_BINOP:
+				if(_cesk_block_handler_binop(compact, k, frame, dbuf, ibuf) < 0) goto EXE_ERR;
 				break;
-			case DVM_MONITOR:
+			case DALVIK_COMPACT_OP_MONITOR:
 				LOG_TRACE("fixme: multi-threading support");
 				break;
 			/* TODO implement other instructions */
 			default:
 				LOG_WARNING("ignore unknown opcode");
 		}
+		PERF_OPCODE(dalvik_compact_opcode(DALVIK_COMPACT_OP(compact, k)), perf_begin);
 		tag_tracker_transaction_close();
 		LOG_DEBUG("TAG_TRACKER: EndInstruction(Closure=%u, Instruction=%u)", ctx_id, i);
 		/* TODO: based on the dbuf and ibuf, invoke the fianlize functions */
@@ -1859,10 +2385,64 @@ ERR:
 }
 int cesk_block_init()
 {
-	// do nothing, just follow the protocol
+	memset(_cesk_block_dispatch_cache, 0, sizeof(_cesk_block_dispatch_cache));
+	memset(_cesk_block_inline_cache, 0xff, sizeof(_cesk_block_inline_cache));
+	memset(_cesk_block_summary_cache, 0, sizeof(_cesk_block_summary_cache));
+	_cesk_block_dispatch_inline_hit = 0;
+	_cesk_block_dispatch_global_hit = 0;
+	_cesk_block_dispatch_miss = 0;
+	_cesk_block_dispatch_monomorphic = 0;
 	return 0;
 }
 void cesk_block_finalize()
 {
 	if(_cesk_block_internal_addr_buf) free(_cesk_block_internal_addr_buf);
+	_cesk_block_internal_addr_buf = NULL;
+	_cesk_block_internal_addr_bufsize = 0;
+	if(_cesk_block_set_translate_buf) free(_cesk_block_set_translate_buf);
+	_cesk_block_set_translate_buf = NULL;
+	_cesk_block_set_translate_bufsize = 0;
+	cesk_block_dispatch_summary();
+	int i;
+	for(i = 0; i < CESK_BLOCK_DISPATCH_CACHE_SIZE; i ++)
+	{
+		_cesk_block_dispatch_node_t* node;
+		for(node = _cesk_block_dispatch_cache[i]; NULL != node;)
+		{
+			_cesk_block_dispatch_node_t* cur = node;
+			node = node->next;
+			free(cur);
+		}
+		_cesk_block_dispatch_cache[i] = NULL;
+	}
+	for(i = 0; i < CESK_BLOCK_SUMMARY_CACHE_SIZE; i ++)
+	{
+		_cesk_block_summary_node_t* node;
+		for(node = _cesk_block_summary_cache[i]; NULL != node;)
+		{
+			_cesk_block_summary_node_t* cur = node;
+			node = node->next;
+			uint32_t j;
+			for(j = 0; j < cur->nargs; j ++)
+				cesk_set_free(cur->args[j]);
+			cesk_set_free(cur->result);
+			free(cur);
+		}
+		_cesk_block_summary_cache[i] = NULL;
+	}
+	if(NULL != _cesk_block_summary_frame) free(_cesk_block_summary_frame);
+	_cesk_block_summary_frame = NULL;
+	_cesk_block_summary_frame_cap = 0;
+}
+void cesk_block_dispatch_summary()
+{
+	uint32_t total = _cesk_block_dispatch_inline_hit + _cesk_block_dispatch_global_hit + _cesk_block_dispatch_miss;
+	if(0 == total && 0 == _cesk_block_dispatch_monomorphic) return;
+	LOG_INFO("virtual dispatch: %u receivers resolved by class hierarchy analysis", _cesk_block_dispatch_monomorphic);
+	if(0 == total) return;
+	LOG_INFO("virtual dispatch: %u lookups, inline cache hit %u (%.2f%%), dispatch table hit %u (%.2f%%), miss %u (%.2f%%)",
+			 total,
+			 _cesk_block_dispatch_inline_hit, 100.0 * _cesk_block_dispatch_inline_hit / total,
+			 _cesk_block_dispatch_global_hit, 100.0 * _cesk_block_dispatch_global_hit / total,
+			 _cesk_block_dispatch_miss, 100.0 * _cesk_block_dispatch_miss / total);
 }
@@ -12,6 +12,7 @@
 
 #include <const_assertion.h>
 #include <vector.h>
+#include <perf.h>
 
 #include <cesk/cesk_diff.h>
 #include <cesk/cesk_value.h>
@@ -30,6 +31,7 @@ struct _cesk_diff_node_t{
 cesk_diff_buffer_t* cesk_diff_buffer_new(uint8_t reverse, uint32_t merge)
 {
 	cesk_diff_buffer_t* ret = (cesk_diff_buffer_t*)malloc(sizeof(cesk_diff_buffer_t));
+	PERF_ALLOC(PERF_ALLOC_DIFF, sizeof(cesk_diff_buffer_t));
 	if(NULL == ret)
 	{
 		LOG_ERROR("can not allocate memory for this buffer");
@@ -651,6 +653,7 @@ cesk_diff_t* cesk_diff_from_buffer(cesk_diff_buffer_t* buffer)
 	/* allocate memory for the result */
 	cesk_diff_t* ret;
 	ret = (cesk_diff_t*)malloc(sizeof(cesk_diff_t) + sizeof(_cesk_diff_node_t) * size);
+	PERF_ALLOC(PERF_ALLOC_DIFF, sizeof(cesk_diff_t) + sizeof(_cesk_diff_node_t) * size);
 	if(NULL == ret)
 	{
 		LOG_ERROR("can not allocate memory for the diff");
@@ -896,6 +899,7 @@ static inline cesk_diff_t* _cesk_diff_allocate_result(int N, cesk_diff_t* args[]
 	}
 	size += nreuse;
 	cesk_diff_t* ret = (cesk_diff_t*) malloc(sizeof(cesk_diff_t) + size * sizeof(_cesk_diff_node_t));
+	PERF_ALLOC(PERF_ALLOC_DIFF, sizeof(cesk_diff_t) + size * sizeof(_cesk_diff_node_t));
 	LOG_DEBUG("created a new diff struct with %zu slots", size);
 	if(NULL == ret)
 	{
@@ -1258,6 +1262,7 @@ cesk_diff_t* cesk_diff_empty()
 	if(NULL == ret)
 	{
 		ret = (cesk_diff_t*)malloc(sizeof(cesk_diff_t));
+		PERF_ALLOC(PERF_ALLOC_DIFF, sizeof(cesk_diff_t));
 		if(NULL == ret)
 		{
 			LOG_ERROR("can not allocate memory for an empty diff");
@@ -1286,6 +1291,7 @@ cesk_diff_t* cesk_diff_prepare_to_write(cesk_diff_t* diff)
 	/* otherwise make a copy */
 	size_t size = diff->offset[CESK_DIFF_NTYPES] - diff->offset[0];
 	cesk_diff_t* ret = (cesk_diff_t*)malloc(sizeof(cesk_diff_t) + sizeof(cesk_diff_rec_t) * size);
+	PERF_ALLOC(PERF_ALLOC_DIFF, sizeof(cesk_diff_t) + sizeof(cesk_diff_rec_t) * size);
 	if(NULL == ret)
 	{
 		LOG_ERROR("failed to allocate new value for the copy of input diff");
@@ -1563,3 +1569,196 @@ int cesk_diff_correct_modified_object_number(const cesk_diff_t* diff, const cesk
 	}
 	return num_modified;
 }
+/**
+ * @brief an entry of the address map used by diff renaming
+ **/
+typedef struct {
+	uint32_t from;   /*!< the old name */
+	uint32_t to;     /*!< the new name */
+} _cesk_diff_rename_t;
+/**
+ * @brief compare the address map entries by the old name
+ **/
+static int _cesk_diff_rename_cmp(const void* left, const void* right)
+{
+	uint32_t laddr = ((const _cesk_diff_rename_t*)left)->from;
+	uint32_t raddr = ((const _cesk_diff_rename_t*)right)->from;
+	return (laddr > raddr) - (laddr < raddr);
+}
+/**
+ * @brief rename an address
+ * @param map the sorted address map
+ * @param count the size of the address map
+ * @param addr the address
+ * @return the new name, CESK_STORE_ADDR_NULL if the address is an object address which is not in the map
+ **/
+static inline uint32_t _cesk_diff_rename_addr(const _cesk_diff_rename_t* map, uint32_t count, uint32_t addr)
+{
+	if(CESK_STORE_ADDR_NULL == addr || !CESK_STORE_ADDR_IS_OBJ(addr)) return addr;
+	_cesk_diff_rename_t key = {.from = addr};
+	const _cesk_diff_rename_t* entry = (const _cesk_diff_rename_t*)bsearch(&key, map, count, sizeof(_cesk_diff_rename_t), _cesk_diff_rename_cmp);
+	if(NULL == entry)
+	{
+		LOG_DEBUG("the object address "PRSAddr" can not be renamed", addr);
+		return CESK_STORE_ADDR_NULL;
+	}
+	return entry->to;
+}
+/**
+ * @brief make a renamed copy of a set
+ * @param map the sorted address map
+ * @param count the size of the address map
+ * @param set the set
+ * @return the renamed set, NULL indicates an error
+ **/
+static inline cesk_set_t* _cesk_diff_rename_set(const _cesk_diff_rename_t* map, uint32_t count, const cesk_set_t* set)
+{
+	cesk_set_iter_t iter;
+	uint32_t addr;
+	if(NULL == cesk_set_iter(set, &iter)) return NULL;
+	cesk_set_t* ret = cesk_set_empty_set();
+	if(NULL == ret) return NULL;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		uint32_t name = _cesk_diff_rename_addr(map, count, addr);
+		if(CESK_STORE_ADDR_NULL == name || cesk_set_push(ret, name) < 0)
+		{
+			cesk_set_free(ret);
+			return NULL;
+		}
+	}
+	if(cesk_set_merge_tags(ret, set) < 0)
+	{
+		cesk_set_free(ret);
+		return NULL;
+	}
+	return ret;
+}
+/**
+ * @brief make a renamed copy of a value
+ * @param map the sorted address map
+ * @param count the size of the address map
+ * @param value the value
+ * @return the renamed value which is referenced by the caller, NULL indicates an error
+ **/
+static inline cesk_value_t* _cesk_diff_rename_value(const _cesk_diff_rename_t* map, uint32_t count, const cesk_value_t* value)
+{
+	cesk_value_t* ret = NULL;
+	if(CESK_TYPE_SET == value->type)
+	{
+		cesk_set_t* set = _cesk_diff_rename_set(map, count, value->pointer.set);
+		if(NULL == set) return NULL;
+		if(NULL == (ret = cesk_value_from_set(set)))
+		{
+			cesk_set_free(set);
+			return NULL;
+		}
+		cesk_value_incref(ret);
+		return ret;
+	}
+	if(NULL == (ret = cesk_value_fork(value))) return NULL;
+	cesk_value_incref(ret);
+	cesk_object_struct_t* this = ret->pointer.object->members;
+	int i, j;
+	for(i = 0; i < ret->pointer.object->depth; i ++)
+	{
+		if(this->built_in)
+		{
+			/* the built-in instance is kept as it is if it holds no object */
+			uint32_t buf[128];
+			uint32_t offset = 0;
+			int rc;
+			while((rc = bci_class_read(this->bcidata, offset, buf, sizeof(buf)/sizeof(buf[0]), this->class.bci->class)) > 0)
+			{
+				offset += rc;
+				for(j = 0; j < rc; j ++)
+					if(CESK_STORE_ADDR_IS_OBJ(buf[j])) rc = -1;
+				if(rc < 0) break;
+			}
+			if(rc < 0)
+			{
+				LOG_DEBUG("the addresses in a built-in object can not be renamed");
+				cesk_value_decref(ret);
+				return NULL;
+			}
+			CESK_OBJECT_STRUCT_ADVANCE(this);
+			continue;
+		}
+		for(j = 0; j < this->num_members; j ++)
+			if(CESK_STORE_ADDR_NULL != this->addrtab[j] && 
+			   CESK_STORE_ADDR_NULL == (this->addrtab[j] = _cesk_diff_rename_addr(map, count, this->addrtab[j])))
+			{
+				cesk_value_decref(ret);
+				return NULL;
+			}
+		CESK_OBJECT_STRUCT_ADVANCE(this);
+	}
+	return ret;
+}
+cesk_diff_t* cesk_diff_rename(const cesk_diff_t* diff, const uint32_t* from, const uint32_t* to, uint32_t count)
+{
+	if(NULL == diff || (count > 0 && (NULL == from || NULL == to)))
+	{
+		LOG_ERROR("invalid argument");
+		return NULL;
+	}
+	cesk_diff_t* ret = NULL;
+	cesk_diff_buffer_t* buffer = NULL;
+	_cesk_diff_rename_t* map = (_cesk_diff_rename_t*)malloc(sizeof(_cesk_diff_rename_t) * (count + 1));
+	if(NULL == map)
+	{
+		LOG_ERROR("can not allocate memory for the address map");
+		goto CLEANUP;
+	}
+	uint32_t i;
+	for(i = 0; i < count; i ++)
+	{
+		map[i].from = from[i];
+		map[i].to = to[i];
+	}
+	qsort(map, count, sizeof(_cesk_diff_rename_t), _cesk_diff_rename_cmp);
+	if(NULL == (buffer = cesk_diff_buffer_new(0, 0)))
+	{
+		LOG_ERROR("can not create the diff buffer");
+		goto CLEANUP;
+	}
+	int type;
+	for(type = 0; type < CESK_DIFF_NTYPES; type ++)
+	{
+		int j;
+		for(j = diff->offset[type]; j < diff->offset[type + 1]; j ++)
+		{
+			const cesk_diff_rec_t* rec = diff->data + j;
+			/* the address of a register record is the register number */
+			uint32_t addr = (CESK_DIFF_REG == type) ? rec->addr : _cesk_diff_rename_addr(map, count, rec->addr);
+			if(CESK_STORE_ADDR_NULL == addr) goto CLEANUP;
+			int rc;
+			if(CESK_DIFF_REG == type)
+			{
+				cesk_set_t* set = _cesk_diff_rename_set(map, count, rec->arg.set);
+				if(NULL == set) goto CLEANUP;
+				rc = cesk_diff_buffer_append(buffer, type, addr, set);
+				cesk_set_free(set);
+			}
+			else if(CESK_DIFF_STORE == type || CESK_DIFF_ALLOC == type)
+			{
+				cesk_value_t* value = _cesk_diff_rename_value(map, count, rec->arg.value);
+				if(NULL == value) goto CLEANUP;
+				rc = cesk_diff_buffer_append(buffer, type, addr, value);
+				cesk_value_decref(value);
+			}
+			else 
+				rc = cesk_diff_buffer_append(buffer, type, addr, rec->arg.generic);
+			if(rc < 0)
+			{
+				LOG_ERROR("can not append the renamed record to the diff buffer");
+				goto CLEANUP;
+			}
+		}
+	}
+	ret = cesk_diff_from_buffer(buffer);
+CLEANUP:
+	if(NULL != map) free(map);
+	if(NULL != buffer) cesk_diff_buffer_free(buffer);
+	return ret;
+}
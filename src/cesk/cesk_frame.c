@@ -31,6 +31,24 @@
 #include <cesk/cesk_store.h>
 static uint32_t *_cesk_frame_gc_fb = NULL;
 static uint32_t _cesk_frame_gc_fb_size = 0;
+/** @brief the visit flags used by the projection traversal, a cell is visited iff its flag equals to the current tick */
+static uint32_t *_cesk_frame_proj_flags = NULL;
+/** @brief the addresses reached by the projection traversal, in the order they are found */
+static uint32_t *_cesk_frame_proj_list = NULL;
+/** @brief the capacity of the projection buffers */
+static uint32_t _cesk_frame_proj_size = 0;
+/** @brief the tick of the current projection traversal */
+static uint32_t _cesk_frame_proj_tick = 0;
+/**
+ * @brief the marks of the canonical index, the index of an address is valid iff the mark equals to the current tick
+ **/
+static uint32_t* _cesk_frame_canon_mark = NULL;
+/** @brief the canonical index of each address */
+static uint32_t* _cesk_frame_canon_index = NULL;
+/** @brief the capacity of the canonical index buffers */
+static uint32_t _cesk_frame_canon_size = 0;
+/** @brief the tick of the current canonical index */
+static uint32_t _cesk_frame_canon_tick = 0;
 int cesk_frame_init()
 {
 	return 0;
@@ -38,6 +56,14 @@ int cesk_frame_init()
 void cesk_frame_finalize()
 {
 	if(NULL != _cesk_frame_gc_fb) free(_cesk_frame_gc_fb);
+	if(NULL != _cesk_frame_proj_flags) free(_cesk_frame_proj_flags);
+	if(NULL != _cesk_frame_proj_list) free(_cesk_frame_proj_list);
+	_cesk_frame_proj_flags = _cesk_frame_proj_list = NULL;
+	_cesk_frame_proj_size = _cesk_frame_proj_tick = 0;
+	if(NULL != _cesk_frame_canon_mark) free(_cesk_frame_canon_mark);
+	if(NULL != _cesk_frame_canon_index) free(_cesk_frame_canon_index);
+	_cesk_frame_canon_mark = _cesk_frame_canon_index = NULL;
+	_cesk_frame_canon_size = _cesk_frame_canon_tick = 0;
 }
 cesk_frame_t* cesk_frame_new(uint16_t size)
 {
@@ -177,6 +203,7 @@ cesk_frame_t* cesk_frame_make_invocation_frame(const cesk_frame_t* frame, uint32
 	}
 	/* we have result and exception resiter */
 	ret->size = nregs + 2;
+	ret->canon = NULL;
 	/* register init */
 	stage = 1;
 	/* first part is the register that does not carry a parameter */
@@ -335,6 +362,7 @@ void cesk_frame_free(cesk_frame_t* frame)
 	}
 	cesk_store_free(frame->store);
 	cesk_static_table_free(frame->statics);
+	if(NULL != frame->canon) free(frame->canon);
 	free(frame);
 }
 
@@ -549,6 +577,619 @@ hashval_t cesk_frame_compute_hashcode(const cesk_frame_t* frame)
 	hashval_t static_hash = cesk_static_table_compute_hashcode(frame->statics);
 	return ret ^ (static_hash * static_hash);
 }
+/**
+ * @brief the static field addresses in a projection
+ **/
+typedef struct {
+	const cesk_static_table_t* table;  /*!< the static table */
+	const uint32_t* statics;           /*!< the addresses, NULL means all the static fields */
+	uint32_t nstatics;                 /*!< the number of addresses */
+	uint32_t index;                    /*!< the iteration position */
+	cesk_static_table_iter_t iter;     /*!< the iterator used when all the fields are included */
+} _cesk_frame_proj_statics_t;
+/**
+ * @brief start iterating the static fields in the projection
+ * @param it the iterator
+ * @param table the static table
+ * @param statics the addresses, NULL means all the static fields
+ * @param nstatics the number of addresses
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_frame_proj_statics_begin(_cesk_frame_proj_statics_t* it, const cesk_static_table_t* table, const uint32_t* statics, uint32_t nstatics)
+{
+	it->table = table;
+	it->statics = statics;
+	it->nstatics = nstatics;
+	it->index = 0;
+	if(NULL == statics && NULL == cesk_static_table_iter(table, &it->iter))
+	{
+		LOG_ERROR("can not acquire iterator for the static field table");
+		return -1;
+	}
+	return 0;
+}
+/**
+ * @brief get the next static field in the projection
+ * @param it the iterator
+ * @param paddr the buffer for the address of the field
+ * @param pvalue the buffer for the value, NULL if the field is not initialized
+ * @return 0 if there's no more field, 1 otherwise
+ **/
+static inline int _cesk_frame_proj_statics_next(_cesk_frame_proj_statics_t* it, uint32_t* paddr, const cesk_set_t** pvalue)
+{
+	if(NULL == it->statics)
+		return NULL != (*pvalue = cesk_static_table_iter_next(&it->iter, paddr));
+	if(it->index >= it->nstatics) return 0;
+	*paddr = it->statics[it->index ++];
+	*pvalue = cesk_static_table_get_ro(it->table, *paddr, 0);
+	return 1;
+}
+/**
+ * @brief mark an address as reached in the projection traversal
+ * @param store the store
+ * @param addr the address
+ * @param count the number of addresses reached so far
+ * @return 1 if the address is a relocated address, which can not be traversed, 0 otherwise
+ **/
+static inline int _cesk_frame_proj_visit(const cesk_store_t* store, uint32_t addr, uint32_t* count)
+{
+	if(CESK_STORE_ADDR_NULL == addr || CESK_STORE_ADDR_IS_CONST(addr)) return 0;
+	if(CESK_STORE_ADDR_IS_RELOC(addr)) return 1;
+	if(addr >= store->nblocks * CESK_STORE_BLOCK_NSLOTS || _cesk_frame_proj_flags[addr] == _cesk_frame_proj_tick) return 0;
+	_cesk_frame_proj_flags[addr] = _cesk_frame_proj_tick;
+	_cesk_frame_proj_list[(*count) ++] = addr;
+	return 0;
+}
+/**
+ * @brief the store used by the compare function of the addresses reached from a set
+ **/
+static const cesk_store_t* _cesk_frame_proj_store = NULL;
+/**
+ * @brief compare the addresses reached from the same set by their allocation parameters, so that the
+ *        order doesn't depend on the addresses if the allocation parameters are different
+ **/
+static int _cesk_frame_proj_addr_cmp(const void* left, const void* right)
+{
+	uint32_t laddr = *(const uint32_t*)left;
+	uint32_t raddr = *(const uint32_t*)right;
+	const cesk_alloc_param_t* lparam = cesk_store_get_alloc_param(_cesk_frame_proj_store, laddr);
+	const cesk_alloc_param_t* rparam = cesk_store_get_alloc_param(_cesk_frame_proj_store, raddr);
+	if(NULL != lparam && NULL != rparam)
+	{
+		if(lparam->inst != rparam->inst) return lparam->inst < rparam->inst ? -1 : 1;
+		if(lparam->offset != rparam->offset) return lparam->offset < rparam->offset ? -1 : 1;
+	}
+	return (laddr > raddr) - (laddr < raddr);
+}
+/**
+ * @brief mark all the addresses in a set as reached, the newly reached addresses are sorted by the allocation parameters
+ * @param store the store
+ * @param set the set
+ * @param count the number of addresses reached so far
+ * @return 1 if there's a relocated address, 0 otherwise, < 0 indicates an error
+ **/
+static inline int _cesk_frame_proj_visit_set(const cesk_store_t* store, const cesk_set_t* set, uint32_t* count)
+{
+	cesk_set_iter_t iter;
+	uint32_t addr, begin = *count;
+	if(NULL == cesk_set_iter(set, &iter))
+	{
+		LOG_ERROR("can not acquire iterator for the value set");
+		return -1;
+	}
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+		if(_cesk_frame_proj_visit(store, addr, count)) return 1;
+	if(*count - begin > 1)
+	{
+		_cesk_frame_proj_store = store;
+		qsort(_cesk_frame_proj_list + begin, *count - begin, sizeof(uint32_t), _cesk_frame_proj_addr_cmp);
+	}
+	return 0;
+}
+/**
+ * @brief find all the store cells reachable from the registers and the given static fields, the addresses
+ *        are returned in _cesk_frame_proj_list in the breadth first order
+ * @details the roots are visited in the order of the registers and then the static fields, the members of
+ *          an object are visited in the order of the fields, and the addresses reached from the same set are
+ *          sorted by the allocation parameters. So the order is determined by the shape of the frame rather
+ *          than the addresses, which makes it the canonical order of the frame
+ * @param frame the frame
+ * @param statics the addresses of the static fields, NULL means all the static fields
+ * @param nstatics the number of the static fields
+ * @param p_builtin the buffer used to return if there's an object held by a built-in instance, NULL if not needed
+ * @return the number of addresses reached, CESK_STORE_ADDR_NULL if a relocated address is reached, < 0 indicates an error
+ **/
+static inline int64_t _cesk_frame_proj_traverse(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics, int* p_builtin)
+{
+	if(NULL != p_builtin) *p_builtin = 0;
+	const cesk_store_t* store = frame->store;
+	uint32_t nslot = store->nblocks * CESK_STORE_BLOCK_NSLOTS;
+	if(_cesk_frame_proj_size < nslot || NULL == _cesk_frame_proj_flags)
+	{
+		uint32_t size = _cesk_frame_proj_size < 1024 ? 1024 : _cesk_frame_proj_size;
+		while(size < nslot) size *= 2;
+		if(NULL != _cesk_frame_proj_flags) free(_cesk_frame_proj_flags);
+		if(NULL != _cesk_frame_proj_list) free(_cesk_frame_proj_list);
+		_cesk_frame_proj_flags = (uint32_t*)calloc(size, sizeof(uint32_t));
+		_cesk_frame_proj_list = (uint32_t*)malloc(size * sizeof(uint32_t));
+		_cesk_frame_proj_tick = 0;
+		if(NULL == _cesk_frame_proj_flags || NULL == _cesk_frame_proj_list)
+		{
+			LOG_ERROR("can not allocate the buffers for the projection");
+			if(NULL != _cesk_frame_proj_flags) free(_cesk_frame_proj_flags);
+			if(NULL != _cesk_frame_proj_list) free(_cesk_frame_proj_list);
+			_cesk_frame_proj_flags = _cesk_frame_proj_list = NULL;
+			_cesk_frame_proj_size = 0;
+			return -1;
+		}
+		_cesk_frame_proj_size = size;
+	}
+	if(0 == ++ _cesk_frame_proj_tick)
+	{
+		memset(_cesk_frame_proj_flags, 0, sizeof(uint32_t) * _cesk_frame_proj_size);
+		_cesk_frame_proj_tick = 1;
+	}
+	uint32_t count = 0, head, i;
+	int rc;
+	/* the roots */
+	for(i = 0; i < frame->size; i ++)
+		if((rc = _cesk_frame_proj_visit_set(store, frame->regs[i], &count)) != 0)
+			return rc < 0 ? -1 : CESK_STORE_ADDR_NULL;
+	_cesk_frame_proj_statics_t it;
+	uint32_t addr;
+	const cesk_set_t* value;
+	if(_cesk_frame_proj_statics_begin(&it, frame->statics, statics, nstatics) < 0) return -1;
+	while(_cesk_frame_proj_statics_next(&it, &addr, &value))
+		if(NULL != value && (rc = _cesk_frame_proj_visit_set(store, value, &count)) != 0)
+			return rc < 0 ? -1 : CESK_STORE_ADDR_NULL;
+	/* then the cells reachable from the roots */
+	for(head = 0; head < count; head ++)
+	{
+		cesk_value_const_t* val = cesk_store_get_ro(store, _cesk_frame_proj_list[head]);
+		if(NULL == val) continue;
+		if(CESK_TYPE_SET == val->type)
+		{
+			if((rc = _cesk_frame_proj_visit_set(store, val->pointer.set, &count)) != 0)
+				return rc < 0 ? -1 : CESK_STORE_ADDR_NULL;
+			continue;
+		}
+		const cesk_object_t* obj = val->pointer.object;
+		const cesk_object_struct_t* this = obj->members;
+		int j;
+		for(i = 0; i < obj->depth; i ++)
+		{
+			if(this->built_in)
+			{
+				uint32_t buf[128];
+				uint32_t offset = 0;
+				for(;;)
+				{
+					rc = bci_class_read(this->bcidata, offset, buf, sizeof(buf)/sizeof(buf[0]), this->class.bci->class);
+					if(rc < 0)
+					{
+						LOG_ERROR("can not get the address list of the built-in instance");
+						return -1;
+					}
+					if(0 == rc) break;
+					offset += rc;
+					for(j = 0; j < rc; j ++)
+					{
+						/* the built-in instances which hold no object, e.g. java/lang/Object, can be compared as they are */
+						if(NULL != p_builtin && CESK_STORE_ADDR_IS_OBJ(buf[j])) *p_builtin = 1;
+						if(_cesk_frame_proj_visit(store, buf[j], &count)) return CESK_STORE_ADDR_NULL;
+					}
+				}
+			}
+			else
+			{
+				for(j = 0; j < this->num_members; j ++)
+					if(_cesk_frame_proj_visit(store, this->addrtab[j], &count)) return CESK_STORE_ADDR_NULL;
+			}
+			CESK_OBJECT_STRUCT_ADVANCE(this);
+		}
+	}
+	return count;
+}
+hashval_t cesk_frame_projection_hashcode(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics)
+{
+	/* the frame passed to the callee has been collected, so all of the store is reachable */
+	if(NULL == statics) return cesk_frame_hashcode(frame);
+	hashval_t ret = CESK_FRAME_INIT_HASH;
+	hashval_t mul = MH_MULTIPLY;
+	uint32_t i;
+	for(i = 0; i < frame->size; i ++)
+	{
+		ret ^= mul * cesk_set_hashcode(frame->regs[i]);
+		mul *= MH_MULTIPLY;
+	}
+	for(i = 0; i < nstatics; i ++)
+	{
+		const cesk_set_t* value = cesk_static_table_get_ro(frame->statics, statics[i], 0);
+		ret ^= (statics[i] * MH_MULTIPLY) + (NULL == value ? 0 : cesk_set_hashcode(value));
+	}
+	int64_t count = _cesk_frame_proj_traverse(frame, statics, nstatics, NULL);
+	/* the relocated address can not be followed, fall back to the whole store */
+	if(count < 0 || CESK_STORE_ADDR_NULL == count) return ret ^ cesk_store_hashcode(frame->store);
+	for(i = 0; i < count; i ++)
+	{
+		uint32_t addr = _cesk_frame_proj_list[i];
+		const cesk_value_t* value = (const cesk_value_t*)cesk_store_get_ro(frame->store, addr);
+		if(NULL == value) continue;
+		ret ^= (addr * MH_MULTIPLY + cesk_value_hashcode(value)) ^ (cesk_store_get_reuse(frame->store, addr) * ~MH_MULTIPLY);
+	}
+	return ret;
+}
+int cesk_frame_projection_equal(const cesk_frame_t* first, const cesk_frame_t* second, const uint32_t* statics, uint32_t nstatics)
+{
+	if(NULL == statics) return cesk_frame_equal(first, second);
+	if(NULL == first || NULL == second) return first == second;
+	if(first->size != second->size) return 0;
+	uint32_t i;
+	for(i = 0; i < first->size; i ++)
+		if(0 == cesk_set_equal(first->regs[i], second->regs[i]))
+			return 0;
+	for(i = 0; i < nstatics; i ++)
+	{
+		const cesk_set_t* left = cesk_static_table_get_ro(first->statics, statics[i], 0);
+		const cesk_set_t* right = cesk_static_table_get_ro(second->statics, statics[i], 0);
+		if(NULL == left || NULL == right)
+		{
+			if(left != right) return 0;
+		}
+		else if(0 == cesk_set_equal(left, right)) return 0;
+	}
+	int64_t count = _cesk_frame_proj_traverse(first, statics, nstatics, NULL);
+	if(count < 0 || CESK_STORE_ADDR_NULL == count)
+		return cesk_store_equal(first->store, second->store);
+	/* the roots are equal, so if the cells reachable in the first frame are equal, the same cells are reachable 
+	 * in the second frame */
+	for(i = 0; i < count; i ++)
+	{
+		uint32_t addr = _cesk_frame_proj_list[i];
+		if(addr >= second->store->nblocks * CESK_STORE_BLOCK_NSLOTS) return 0;
+		if(0 == cesk_value_equal((const cesk_value_t*)cesk_store_get_ro(first->store, addr), (const cesk_value_t*)cesk_store_get_ro(second->store, addr)))
+			return 0;
+		if(cesk_store_get_reuse(first->store, addr) != cesk_store_get_reuse(second->store, addr))
+			return 0;
+	}
+	return 1;
+}
+/**
+ * @brief the canonical address order of a frame, which is cached on the frame
+ **/
+struct _cesk_frame_canon_t {
+	hashval_t frame_hash;     /*!< the hash code of the frame when the order is computed */
+	const uint32_t* statics;  /*!< the static fields used as the roots */
+	uint32_t nstatics;        /*!< the number of the static fields */
+	uint8_t supported;        /*!< if the addresses can be renamed, the frames reaching a relocated address or an object held by a built-in instance can not */
+	hashval_t hashcode;       /*!< the canonical hash code */
+	uint32_t count;           /*!< the number of addresses */
+	uint32_t order[0];        /*!< the addresses in the canonical order */
+};
+CONST_ASSERTION_LAST(cesk_frame_canon_t, order);
+CONST_ASSERTION_SIZE(cesk_frame_canon_t, order, 0);
+/**
+ * @brief build the canonical index of the addresses from a canonical order
+ * @param store the store
+ * @param canon the canonical order
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_frame_canon_index_build(const cesk_store_t* store, const cesk_frame_canon_t* canon)
+{
+	uint32_t nslot = store->nblocks * CESK_STORE_BLOCK_NSLOTS;
+	if(_cesk_frame_canon_size < nslot || NULL == _cesk_frame_canon_mark)
+	{
+		uint32_t size = _cesk_frame_canon_size < 1024 ? 1024 : _cesk_frame_canon_size;
+		while(size < nslot) size *= 2;
+		if(NULL != _cesk_frame_canon_mark) free(_cesk_frame_canon_mark);
+		if(NULL != _cesk_frame_canon_index) free(_cesk_frame_canon_index);
+		_cesk_frame_canon_mark = (uint32_t*)calloc(size, sizeof(uint32_t));
+		_cesk_frame_canon_index = (uint32_t*)malloc(size * sizeof(uint32_t));
+		_cesk_frame_canon_tick = 0;
+		if(NULL == _cesk_frame_canon_mark || NULL == _cesk_frame_canon_index)
+		{
+			LOG_ERROR("can not allocate the buffers for the canonical index");
+			if(NULL != _cesk_frame_canon_mark) free(_cesk_frame_canon_mark);
+			if(NULL != _cesk_frame_canon_index) free(_cesk_frame_canon_index);
+			_cesk_frame_canon_mark = _cesk_frame_canon_index = NULL;
+			_cesk_frame_canon_size = 0;
+			return -1;
+		}
+		_cesk_frame_canon_size = size;
+	}
+	if(0 == ++ _cesk_frame_canon_tick)
+	{
+		memset(_cesk_frame_canon_mark, 0, sizeof(uint32_t) * _cesk_frame_canon_size);
+		_cesk_frame_canon_tick = 1;
+	}
+	uint32_t i;
+	for(i = 0; i < canon->count; i ++)
+	{
+		_cesk_frame_canon_mark[canon->order[i]] = _cesk_frame_canon_tick;
+		_cesk_frame_canon_index[canon->order[i]] = i;
+	}
+	return 0;
+}
+/**
+ * @brief get the canonical index of an address
+ * @param addr the object address
+ * @return the index, CESK_STORE_ADDR_NULL if the address is not in the canonical order
+ **/
+static inline uint32_t _cesk_frame_canon_lookup(uint32_t addr)
+{
+	if(addr >= _cesk_frame_canon_size || _cesk_frame_canon_mark[addr] != _cesk_frame_canon_tick) return CESK_STORE_ADDR_NULL;
+	return _cesk_frame_canon_index[addr];
+}
+/**
+ * @brief the canonical name of an address, the object address is replaced with its canonical index
+ * @param addr the address
+ * @return the canonical name
+ **/
+static inline uint32_t _cesk_frame_canon_name(uint32_t addr)
+{
+	return CESK_STORE_ADDR_IS_OBJ(addr) ? _cesk_frame_canon_lookup(addr) : addr;
+}
+/**
+ * @brief the hash code of a set with the canonical names
+ * @param set the set
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_frame_canon_set_hashcode(const cesk_set_t* set)
+{
+	cesk_set_iter_t iter;
+	uint32_t addr;
+	hashval_t ret = CESK_STORE_EMPTY_HASH;
+	if(NULL == cesk_set_iter(set, &iter)) return ret;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		uint32_t name = _cesk_frame_canon_name(addr);
+		ret += (name ^ (name >> 16)) * MH_MULTIPLY;
+	}
+	hashval_t ts_hash = tag_set_hashcode(cesk_set_get_tags(set));
+	return ret ^ (ts_hash * MH_MULTIPLY);
+}
+/**
+ * @brief the hash code of a store value with the canonical names
+ * @param value the value
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_frame_canon_value_hashcode(const cesk_value_const_t* value)
+{
+	if(NULL == value) return (hashval_t)0x3c4fab47;
+	if(CESK_TYPE_SET == value->type) return _cesk_frame_canon_set_hashcode(value->pointer.set);
+	const cesk_object_t* object = value->pointer.object;
+	const cesk_object_struct_t* this = object->members;
+	hashval_t ret = ((uintptr_t)this->class.path) & ~(hashval_t)0;
+	int i, j;
+	for(i = 0; i < object->depth; i ++)
+	{
+		/* a built-in instance in a canonical order holds no object, so it's hashed as it is */
+		if(this->built_in)
+			ret = ret * MH_MULTIPLY + bci_class_hashcode(this->bcidata, this->class.bci->class);
+		else
+			for(j = 0; j < this->num_members; j ++)
+				ret = ret * MH_MULTIPLY + _cesk_frame_canon_name(this->addrtab[j]);
+		CESK_OBJECT_STRUCT_ADVANCE(this);
+	}
+	hashval_t ts_hash = tag_set_hashcode(object->tags);
+	return ret ^ (ts_hash * ts_hash + MH_MULTIPLY * ts_hash);
+}
+/**
+ * @brief compute the canonical hash code of the frame, the canonical index should be built before calling this function
+ * @param frame the frame
+ * @param canon the canonical order
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_frame_canon_hashcode(const cesk_frame_t* frame, const cesk_frame_canon_t* canon)
+{
+	hashval_t ret = CESK_FRAME_INIT_HASH;
+	hashval_t mul = MH_MULTIPLY;
+	uint32_t i;
+	for(i = 0; i < frame->size; i ++)
+	{
+		ret ^= mul * _cesk_frame_canon_set_hashcode(frame->regs[i]);
+		mul *= MH_MULTIPLY;
+	}
+	_cesk_frame_proj_statics_t it;
+	uint32_t addr;
+	const cesk_set_t* value;
+	if(_cesk_frame_proj_statics_begin(&it, frame->statics, canon->statics, canon->nstatics) >= 0)
+		while(_cesk_frame_proj_statics_next(&it, &addr, &value))
+			ret = ret * MH_MULTIPLY + addr + (NULL == value ? 0 : _cesk_frame_canon_set_hashcode(value));
+	/* the cells are hashed in the canonical order, so the position is a part of the hash code */
+	for(i = 0; i < canon->count; i ++)
+	{
+		const cesk_alloc_param_t* param = cesk_store_get_alloc_param(frame->store, canon->order[i]);
+		hashval_t h = _cesk_frame_canon_value_hashcode(cesk_store_get_ro(frame->store, canon->order[i]));
+		if(NULL != param) h ^= cesk_alloc_param_hash(param);
+		ret = ret * MH_MULTIPLY + h + cesk_store_get_reuse(frame->store, canon->order[i]);
+	}
+	return ret;
+}
+/**
+ * @brief get the canonical order of a frame, the cached one is used if the frame is not changed
+ * @param frame the frame
+ * @param statics the addresses of the static fields, NULL means all the static fields
+ * @param nstatics the number of the static fields
+ * @return the canonical order, NULL indicates an error
+ **/
+static inline const cesk_frame_canon_t* _cesk_frame_canon_get(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics)
+{
+	hashval_t frame_hash = cesk_frame_hashcode(frame);
+	cesk_frame_canon_t* canon = frame->canon;
+	if(NULL != canon && canon->frame_hash == frame_hash && canon->statics == statics && canon->nstatics == nstatics)
+		return canon;
+	int builtin;
+	int64_t count = _cesk_frame_proj_traverse(frame, statics, nstatics, &builtin);
+	if(count < 0) return NULL;
+	int supported = (CESK_STORE_ADDR_NULL != count && !builtin);
+	if(!supported) count = 0;
+	canon = (cesk_frame_canon_t*)malloc(sizeof(cesk_frame_canon_t) + sizeof(uint32_t) * count);
+	if(NULL == canon)
+	{
+		LOG_ERROR("can not allocate memory for the canonical order");
+		return NULL;
+	}
+	canon->frame_hash = frame_hash;
+	canon->statics = statics;
+	canon->nstatics = nstatics;
+	canon->supported = supported;
+	canon->count = count;
+	if(count > 0) memcpy(canon->order, _cesk_frame_proj_list, sizeof(uint32_t) * count);
+	if(supported)
+	{
+		if(_cesk_frame_canon_index_build(frame->store, canon) < 0)
+		{
+			free(canon);
+			return NULL;
+		}
+		canon->hashcode = _cesk_frame_canon_hashcode(frame, canon);
+	}
+	else
+		canon->hashcode = cesk_frame_projection_hashcode(frame, statics, nstatics);
+	/* the cache doesn't change the content of the frame */
+	if(NULL != frame->canon) free(frame->canon);
+	((cesk_frame_t*)frame)->canon = canon;
+	return canon;
+}
+hashval_t cesk_frame_canonical_hashcode(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics)
+{
+	const cesk_frame_canon_t* canon = _cesk_frame_canon_get(frame, statics, nstatics);
+	if(NULL == canon) return cesk_frame_projection_hashcode(frame, statics, nstatics);
+	return canon->hashcode;
+}
+const uint32_t* cesk_frame_canonical_order(const cesk_frame_t* frame, const uint32_t* statics, uint32_t nstatics, uint32_t* p_count)
+{
+	const cesk_frame_canon_t* canon = _cesk_frame_canon_get(frame, statics, nstatics);
+	if(NULL == canon || !canon->supported) return NULL;
+	*p_count = canon->count;
+	return canon->order;
+}
+/**
+ * @brief check if an address in the first frame is mapped to the address in the second frame,
+ *        the canonical index of the first frame should be built before calling this function
+ * @param first the address in the first frame
+ * @param second the address in the second frame
+ * @param order the canonical order of the second frame
+ * @return 1 if it's mapped, 0 otherwise
+ **/
+static inline int _cesk_frame_canon_addr_mapped(uint32_t first, uint32_t second, const uint32_t* order)
+{
+	if(!CESK_STORE_ADDR_IS_OBJ(first)) return first == second;
+	uint32_t idx = _cesk_frame_canon_lookup(first);
+	return CESK_STORE_ADDR_NULL != idx && order[idx] == second;
+}
+/**
+ * @brief check if the set in the first frame is mapped to the set in the second frame
+ * @param first the set in the first frame
+ * @param second the set in the second frame
+ * @param order the canonical order of the second frame
+ * @return 1 if it's mapped, 0 otherwise
+ **/
+static inline int _cesk_frame_canon_set_mapped(const cesk_set_t* first, const cesk_set_t* second, const uint32_t* order)
+{
+	if(NULL == first || NULL == second) return first == second;
+	if(cesk_set_size(first) != cesk_set_size(second)) return 0;
+	if(0 == tag_set_equal(cesk_set_get_tags(first), cesk_set_get_tags(second))) return 0;
+	cesk_set_iter_t iter;
+	uint32_t addr;
+	if(NULL == cesk_set_iter(first, &iter)) return 0;
+	/* the mapping is injective, so the sets are mapped if all the images are in the second set */
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		if(!CESK_STORE_ADDR_IS_OBJ(addr))
+		{
+			if(!cesk_set_contain(second, addr)) return 0;
+			continue;
+		}
+		uint32_t idx = _cesk_frame_canon_lookup(addr);
+		if(CESK_STORE_ADDR_NULL == idx || !cesk_set_contain(second, order[idx])) return 0;
+	}
+	return 1;
+}
+/**
+ * @brief check if the value in the first frame is mapped to the value in the second frame
+ * @param first the value in the first frame
+ * @param second the value in the second frame
+ * @param order the canonical order of the second frame
+ * @return 1 if it's mapped, 0 otherwise
+ **/
+static inline int _cesk_frame_canon_value_mapped(const cesk_value_const_t* first, const cesk_value_const_t* second, const uint32_t* order)
+{
+	if(NULL == first || NULL == second) return first == second;
+	if(first->type != second->type) return 0;
+	if(CESK_TYPE_SET == first->type) return _cesk_frame_canon_set_mapped(first->pointer.set, second->pointer.set, order);
+	const cesk_object_t* fobj = first->pointer.object;
+	const cesk_object_t* sobj = second->pointer.object;
+	if(fobj->members[0].class.path != sobj->members[0].class.path || fobj->depth != sobj->depth) return 0;
+	if(0 == tag_set_equal(fobj->tags, sobj->tags)) return 0;
+	const cesk_object_struct_t* this = fobj->members;
+	const cesk_object_struct_t* that = sobj->members;
+	int i, j;
+	for(i = 0; i < fobj->depth; i ++)
+	{
+		if(this->built_in != that->built_in) return 0;
+		if(this->built_in)
+		{
+			if(bci_class_equal(this->bcidata, that->bcidata, this->class.bci->class) <= 0) return 0;
+		}
+		else
+		{
+			if(this->num_members != that->num_members) return 0;
+			for(j = 0; j < this->num_members; j ++)
+				if(!_cesk_frame_canon_addr_mapped(this->addrtab[j], that->addrtab[j], order))
+					return 0;
+		}
+		CESK_OBJECT_STRUCT_ADVANCE(this);
+		CESK_OBJECT_STRUCT_ADVANCE(that);
+	}
+	return 1;
+}
+int cesk_frame_isomorphic(const cesk_frame_t* first, const cesk_frame_t* second, const uint32_t* statics, uint32_t nstatics)
+{
+	if(NULL == first || NULL == second) return first == second;
+	if(first->size != second->size) return 0;
+	const cesk_frame_canon_t* fcanon = _cesk_frame_canon_get(first, statics, nstatics);
+	const cesk_frame_canon_t* scanon = _cesk_frame_canon_get(second, statics, nstatics);
+	if(NULL == fcanon || NULL == scanon || !fcanon->supported || !scanon->supported)
+		return cesk_frame_projection_equal(first, second, statics, nstatics);
+	if(fcanon->hashcode != scanon->hashcode || fcanon->count != scanon->count) return 0;
+	if(_cesk_frame_canon_index_build(first->store, fcanon) < 0) return 0;
+	/* the k-th address of the first frame is mapped to the k-th address of the second frame, the mapping is a
+	 * bijection between the canonical orders, and it's an isomorphism if it preserves all the roots and cells.
+	 * Because every address reached from a root or a cell of the first frame must be in the canonical order,
+	 * the check is sound even though the cached order is out of date */
+	uint32_t i;
+	for(i = 0; i < first->size; i ++)
+		if(!_cesk_frame_canon_set_mapped(first->regs[i], second->regs[i], scanon->order))
+			return 0;
+	_cesk_frame_proj_statics_t fit, sit;
+	uint32_t faddr, saddr;
+	const cesk_set_t *fvalue, *svalue;
+	if(_cesk_frame_proj_statics_begin(&fit, first->statics, statics, nstatics) < 0 ||
+	   _cesk_frame_proj_statics_begin(&sit, second->statics, statics, nstatics) < 0)
+		return 0;
+	for(;;)
+	{
+		int frc = _cesk_frame_proj_statics_next(&fit, &faddr, &fvalue);
+		int src = _cesk_frame_proj_statics_next(&sit, &saddr, &svalue);
+		if(frc != src) return 0;
+		if(0 == frc) break;
+		if(faddr != saddr || !_cesk_frame_canon_set_mapped(fvalue, svalue, scanon->order)) return 0;
+	}
+	for(i = 0; i < fcanon->count; i ++)
+	{
+		uint32_t fcell = fcanon->order[i], scell = scanon->order[i];
+		const cesk_alloc_param_t* fparam = cesk_store_get_alloc_param(first->store, fcell);
+		const cesk_alloc_param_t* sparam = cesk_store_get_alloc_param(second->store, scell);
+		/* the allocation parameter decides where the callee allocates the new objects, so it should be kept */
+		if(NULL == fparam || NULL == sparam || !cesk_alloc_param_equal(fparam, sparam)) return 0;
+		if(cesk_store_get_reuse(first->store, fcell) != cesk_store_get_reuse(second->store, scell)) return 0;
+		if(!_cesk_frame_canon_value_mapped(cesk_store_get_ro(first->store, fcell), cesk_store_get_ro(second->store, scell), scanon->order))
+			return 0;
+	}
+	return 1;
+}
 /**
  * @brief free a value set, this function should be called before modifying the value of register to a new set
  * @param frame 
@@ -1357,6 +1998,44 @@ int cesk_frame_register_move(
 
 	return 0;
 }
+int cesk_frame_register_assign(
+		cesk_frame_t* frame,
+		uint32_t dst_reg,
+		const cesk_set_t* set,
+		cesk_diff_buffer_t* diff_buf,
+		cesk_diff_buffer_t* inv_buf)
+{
+	if(NULL == frame || dst_reg >= frame->size || NULL == set)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+
+	_SNAPSHOT(inv_buf, CESK_DIFF_REG, dst_reg, frame->regs[dst_reg]);
+
+	if(_cesk_frame_set_ref(frame, set) < 0)
+	{
+		LOG_ERROR("can not incref for the new register value");
+		return -1;
+	}
+
+	if(_cesk_frame_free_set(frame, frame->regs[dst_reg]) < 0)
+	{
+		LOG_ERROR("can not free the old value of register %d", dst_reg);
+		return -1;
+	}
+
+	frame->regs[dst_reg] = cesk_set_fork(set);
+	if(NULL == frame->regs[dst_reg])
+	{
+		LOG_ERROR("can not copy the value set");
+		return -1;
+	}
+
+	_SNAPSHOT(diff_buf, CESK_DIFF_REG, dst_reg, frame->regs[dst_reg]);
+
+	return 0;
+}
 int cesk_frame_register_clear(
 		cesk_frame_t* frame,
 		uint32_t dst_reg,
@@ -1,17 +1,36 @@
 #include <cesk/cesk_method.h>
+#include <bci/bci_nametab.h>
+#include <dalvik/dalvik_hierarchy.h>
+#include <dalvik/dalvik_loader.h>
+#include <perf.h>
 /* types */
 
 /**
- * @brief node in cache , use [block, frame] as key
+ * @brief node in cache , use [block, frame] as key, or [block, abstract context] if the 
+ *        context-sensitivity policy of the method is not the full policy
  **/
 typedef struct _cesk_method_cache_node_t{
 	const dalvik_block_t* code;  /*!< the code block */
 	cesk_frame_t* frame;          /*!< the stack frame */
+	cesk_policy_key_t key;        /*!< the abstract calling context */
 	cesk_diff_t* result;          /*!< the analyze result */
 	cesk_reloc_table_t* rtable;   /*!< the relocation table */
 	struct _cesk_method_cache_node_t* next;  /*!< next pointer for the hash table */
 } _cesk_method_cache_node_t;
 
+/**
+ * @brief the static fields a method can touch, the cache key of the method only includes these static fields
+ *        and the part of the store reachable from them and the registers
+ **/
+typedef struct _cesk_method_footprint_t{
+	const dalvik_block_t* code;   /*!< the entry block of the method */
+	uint8_t  unknown;             /*!< if the method might touch any static field, because it invokes a method that can not be resolved */
+	uint32_t nstatics;            /*!< the number of static fields */
+	struct _cesk_method_footprint_t* next;  /*!< next pointer for the hash table */
+	uint32_t statics[0];          /*!< the sorted addresses of the static fields */
+} _cesk_method_footprint_t;
+CONST_ASSERTION_LAST(_cesk_method_footprint_t, statics);
+
 typedef struct _cesk_method_block_context_t _cesk_method_block_context_t;
 /**
  * @brief the branch information, because we consider the value that might
@@ -22,11 +41,13 @@ typedef struct _cesk_method_block_context_t _cesk_method_block_context_t;
 typedef struct {
 	uint32_t index:31;                  /*!< the index of the branch in the code block */
 	uint8_t  visited:1;                 /*!< Visited before? */
+	uint8_t  pruned:1;                  /*!< if the branch is pruned in the youngest result, which means its diff is in the pending diff */
 	_cesk_method_block_context_t* block;  /*!< the code block struct that produces this input, if NULL this is a return branch */
 	cesk_frame_t* frame;             /*!< the result stack frame of this block in this branch*/
 	cesk_diff_t* prv_inversion;      /*!< the previous (second youngest result) inversive diff (from branch output to block input) */
 	cesk_diff_t* cur_diff;           /*!< the current (the youngest result) execution diff (from block input to branch output) */
 	cesk_diff_t* cur_inversion;      /*!< the current (the youngest result) inversive diff (from branch output to block input) */
+	cesk_diff_t* pending;            /*!< the output diffs of the pruned branch that the target block has not seen yet, NULL if there's none */
 } _cesk_method_block_input_t;
 /**
  * @brief the data structure we used for block context data storage
@@ -49,7 +70,7 @@ typedef struct _cesk_method_context_t{
 	uint32_t closure_id;   /*!< a unique number for each closure */
 	uint32_t tick;
 	const cesk_frame_t* input_frame;     /*!< the input frame for this context */
-	uint32_t Q[CESK_METHOD_MAX_NBLOCKS]; /*!< the analyzer queue */ 
+	uint32_t* Q;                         /*!< the analyzer queue, a ring buffer with nslots elements after the block contexts */
 	uint32_t front;                      /*!< the earlist timestamp in the queue */
 	uint32_t rear;                       /*!< next fresh timestamp */
 	cesk_reloc_table_t* rtable;          /*!< relocation table*/
@@ -57,6 +78,8 @@ typedef struct _cesk_method_context_t{
 	uint32_t nslots;                     /*!< the number of slots */
 	cesk_diff_buffer_t* result_buffer;   /*!< the result diff buffer */
 	const struct _cesk_method_context_t* caller;      /*!< the caller context */
+	const cesk_policy_key_t* key;        /*!< the abstract calling context */
+	struct _cesk_method_context_t* next;  /*!< the next free context in the context pool */
 	_cesk_method_block_context_t blocks[0];  /*!< the block contexts */
 } _cesk_method_context_t;
 CONST_ASSERTION_LAST(_cesk_method_context_t, blocks);
@@ -68,25 +91,17 @@ CONST_ASSERTION_LAST(_cesk_method_context_t, blocks);
  **/
 static _cesk_method_cache_node_t* _cesk_method_cache[CESK_METHOD_CAHCE_SIZE];
 /**
- * @brief the max block index in current method
- **/
-static uint32_t _cesk_method_block_max_idx;
-/**
- * @brief the max number of inputs 
+ * @brief the static fields each method can touch
  **/
-static uint32_t _cesk_method_block_max_ninputs;
+static _cesk_method_footprint_t* _cesk_method_footprint[CESK_METHOD_FOOTPRINT_TABLE_SIZE];
 /**
- * @brief all blocks in this method 
+ * @brief the context pool, the free contexts for the methods with n blocks are in _cesk_method_context_pool[n] 
  **/
-static const dalvik_block_t* _cesk_method_block_list[CESK_METHOD_MAX_NBLOCKS];
+static _cesk_method_context_t* _cesk_method_context_pool[CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS + 1];
 /**
- * @brief how many inputs does this block have 
+ * @brief how many free contexts are there in each list of the context pool
  **/
-static int _cesk_method_block_ninputs[CESK_METHOD_MAX_NBLOCKS];
-/**
- * @brief how many input slots are used 
- **/
-static int _cesk_method_block_inputs_used[CESK_METHOD_MAX_NBLOCKS];
+static uint32_t _cesk_method_context_pool_count[CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS + 1];
 
 /**
  * @brief a pointer to hold the empty diff, at least one refcount
@@ -96,6 +111,9 @@ static cesk_diff_t *_cesk_method_empty_diff = NULL;
 int cesk_method_init()
 {
 	memset(_cesk_method_cache, 0, sizeof(_cesk_method_cache));
+	memset(_cesk_method_footprint, 0, sizeof(_cesk_method_footprint));
+	memset(_cesk_method_context_pool, 0, sizeof(_cesk_method_context_pool));
+	memset(_cesk_method_context_pool_count, 0, sizeof(_cesk_method_context_pool_count));
 	_cesk_method_empty_diff = cesk_diff_empty();
 	return 0;
 }
@@ -121,26 +139,353 @@ void cesk_method_finalize()
 {
 	cesk_method_clean_cache();
 	if(NULL != _cesk_method_empty_diff) cesk_diff_free(_cesk_method_empty_diff);
+	int i;
+	for(i = 0; i < CESK_METHOD_FOOTPRINT_TABLE_SIZE; i ++)
+	{
+		_cesk_method_footprint_t* node;
+		for(node = _cesk_method_footprint[i]; NULL != node;)
+		{
+			_cesk_method_footprint_t* current = node;
+			node = node->next;
+			free(current);
+		}
+		_cesk_method_footprint[i] = NULL;
+	}
+	for(i = 0; i <= CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS; i ++)
+	{
+		_cesk_method_context_t* context;
+		for(context = _cesk_method_context_pool[i]; NULL != context;)
+		{
+			_cesk_method_context_t* current = context;
+			context = context->next;
+			free(current);
+		}
+		_cesk_method_context_pool[i] = NULL;
+		_cesk_method_context_pool_count[i] = 0;
+	}
+}
+/**
+ * @brief the compare function used to sort the static field addresses
+ **/
+static int _cesk_method_footprint_comp(const void* this, const void* that)
+{
+	uint32_t left = *(const uint32_t*)this, right = *(const uint32_t*)that;
+	return (left > right) - (left < right);
+}
+/**
+ * @brief find the memoized footprint of a method
+ * @param code the entry block of the method
+ * @return the footprint node, NULL if it's not computed yet
+ **/
+static inline _cesk_method_footprint_t* _cesk_method_footprint_find(const dalvik_block_t* code)
+{
+	uint32_t h = (uint32_t)(((uintptr_t)code) / sizeof(void*)) % CESK_METHOD_FOOTPRINT_TABLE_SIZE;
+	_cesk_method_footprint_t* node;
+	for(node = _cesk_method_footprint[h]; NULL != node; node = node->next)
+		if(node->code == code)
+			return node;
+	return NULL;
+}
+/**
+ * @brief append a static field address to the footprint buffer
+ * @param p_statics the buffer
+ * @param p_size the number of addresses in the buffer
+ * @param p_capacity the capacity of the buffer
+ * @param addr the address
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_method_footprint_append(uint32_t** p_statics, uint32_t* p_size, uint32_t* p_capacity, uint32_t addr)
+{
+	if(*p_size == *p_capacity)
+	{
+		uint32_t capacity = (0 == *p_capacity) ? 8 : *p_capacity * 2;
+		uint32_t* new_statics = (uint32_t*)realloc(*p_statics, sizeof(uint32_t) * capacity);
+		if(NULL == new_statics)
+		{
+			LOG_ERROR("can not allocate memory for the footprint of the method");
+			return -1;
+		}
+		*p_statics = new_statics;
+		*p_capacity = capacity;
+	}
+	(*p_statics)[(*p_size) ++] = addr;
+	return 0;
 }
 /**
- * @brief the hash code used by the method analyzer cache, the key is the code block and current stack frame
+ * @brief resolve the callee of an invoke instruction statically
+ * @details the static and direct calls have only one target. For a virtual call, the class hierarchy
+ *          analysis is used, and only the monomorphic call sites are resolved. The built-in methods never
+ *          touch the static fields of the user-defined classes, so a built-in callee is ignored
+ * @param ins the invoke instruction
+ * @param p_code the buffer used to return the entry block of the callee, NULL if it's a built-in method
+ * @return 1 if the callee is resolved, 0 if it can not be decided
+ **/
+static inline int _cesk_method_footprint_callee(const dalvik_instruction_t* ins, const dalvik_block_t** p_code)
+{
+	const char* classpath = ins->operands[0].payload.methpath;
+	const char* methodname = ins->operands[1].payload.methpath;
+	const dalvik_type_t* const * typelist = ins->operands[2].payload.typelist;
+	const dalvik_type_t* rtype = ins->operands[3].payload.type;
+	*p_code = NULL;
+	switch(ins->flags & DVM_FLAG_INVOKE_TYPE_MSK)
+	{
+		case DVM_FLAG_INVOKE_STATIC:
+		case DVM_FLAG_INVOKE_DIRECT:
+			break;
+		case DVM_FLAG_INVOKE_VIRTUAL:
+		case DVM_FLAG_INVOKE_INTERFACE:
+			/* the built-in receivers take the built-in methods, so only the user-defined target matters, 
+			 * but a user-defined receiver is only covered by the hierarchy index when all its super types
+			 * are loaded */
+			if(dalvik_loader_num_pending() > 0 || dalvik_hierarchy_num_unresolved() > 0) return 0;
+			classpath = dalvik_hierarchy_resolve_monomorphic(classpath, methodname, typelist, rtype);
+			if(NULL == classpath) return 0;
+			break;
+		default:
+			return 0;
+	}
+	if(NULL != (*p_code = dalvik_block_from_method(classpath, methodname, typelist, rtype))) return 1;
+	return NULL != bci_nametab_get_class(classpath);
+}
+/**
+ * @brief collect the static fields accessed by the blocks of one method, and the methods it calls
+ * @param code the entry block of the method
+ * @param methods the methods in the call closure, the callees that are not in the list are appended
+ * @param p_nmethods the number of methods in the list
+ * @param p_statics the buffer of the static field addresses
+ * @param p_size the number of addresses in the buffer
+ * @param p_capacity the capacity of the buffer
+ * @return 1 if the footprint is known, 0 if it's unknown, < 0 indicates an error
+ **/
+static inline int _cesk_method_footprint_scan_method(
+		const dalvik_block_t* code, 
+		const dalvik_block_t** methods, 
+		uint32_t* p_nmethods,
+		uint32_t** p_statics,
+		uint32_t* p_size,
+		uint32_t* p_capacity)
+{
+	if(NULL == code->info) return 0;
+	size_t nblocks = code->info->nblocks;
+	int ret = -1;
+	const dalvik_block_t** stack = (const dalvik_block_t**)malloc(sizeof(const dalvik_block_t*) * nblocks);
+	uint8_t* visited = (uint8_t*)calloc(nblocks, 1);
+	if(NULL == stack || NULL == visited)
+	{
+		LOG_ERROR("can not allocate memory for the footprint of the method");
+		goto CLEANUP;
+	}
+	uint32_t sp = 0, i, j;
+	stack[sp ++] = code;
+	visited[code->index] = 1;
+	while(sp > 0)
+	{
+		const dalvik_block_t* block = stack[-- sp];
+		for(i = block->begin; i < block->end; i ++)
+		{
+			const dalvik_instruction_t* ins = dalvik_instruction_get(i);
+			if(DVM_INVOKE == ins->opcode)
+			{
+				const dalvik_block_t* callee;
+				if(!_cesk_method_footprint_callee(ins, &callee))
+				{
+					LOG_DEBUG("the callee of %s can not be resolved, the footprint is unknown", ins->operands[1].payload.methpath);
+					ret = 0;
+					goto CLEANUP;
+				}
+				if(NULL == callee) continue;
+				for(j = 0; j < *p_nmethods && methods[j] != callee; j ++);
+				if(j < *p_nmethods) continue;
+				if(*p_nmethods >= CESK_METHOD_FOOTPRINT_MAX_METHODS)
+				{
+					ret = 0;
+					goto CLEANUP;
+				}
+				methods[(*p_nmethods) ++] = callee;
+				continue;
+			}
+			if(DVM_INSTANCE != ins->opcode || (DVM_FLAG_INSTANCE_SGET != ins->flags && DVM_FLAG_INSTANCE_SPUT != ins->flags)) 
+				continue;
+			uint32_t addr = cesk_static_field_query(ins->operands[1].payload.string, ins->operands[2].payload.string);
+			if(CESK_STORE_ADDR_NULL == addr)
+			{
+				ret = 0;
+				goto CLEANUP;
+			}
+			if(_cesk_method_footprint_append(p_statics, p_size, p_capacity, addr) < 0) goto CLEANUP;
+		}
+		for(i = 0; i < block->nbranches; i ++)
+		{
+			const dalvik_block_t* target = block->branches[i].block;
+			if(block->branches[i].disabled || DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(block->branches[i]) || NULL == target) continue;
+			if(visited[target->index]) continue;
+			visited[target->index] = 1;
+			stack[sp ++] = target;
+		}
+	}
+	ret = 1;
+CLEANUP:
+	if(NULL != stack) free(stack);
+	if(NULL != visited) free(visited);
+	return ret;
+}
+/**
+ * @brief collect the static fields accessed by the method and all the methods it might call
+ * @details the blocks reachable from the entry are scanned for the sget and sput instructions, and the callees
+ *          are scanned transitively. The callee whose footprint is memoized is not scanned again. If some callee 
+ *          can not be resolved statically, it might touch any static field, so the footprint is unknown
+ * @param code the entry block of the method
+ * @param p_statics the buffer used to return the addresses of the static fields, which should be freed by the caller
+ * @param p_count the buffer used to return the number of static fields
+ * @return 1 if the footprint is known, 0 if it's unknown, < 0 indicates an error
+ **/
+static inline int _cesk_method_footprint_scan(const dalvik_block_t* code, uint32_t** p_statics, uint32_t* p_count)
+{
+	*p_statics = NULL;
+	*p_count = 0;
+	const dalvik_block_t* methods[CESK_METHOD_FOOTPRINT_MAX_METHODS];
+	uint32_t nmethods = 0, size = 0, capacity = 0, i, k;
+	uint32_t* statics = NULL;
+	int ret = 1;
+	methods[nmethods ++] = code;
+	for(k = 0; k < nmethods && ret > 0; k ++)
+	{
+		const _cesk_method_footprint_t* memo = (k > 0) ? _cesk_method_footprint_find(methods[k]) : NULL;
+		if(NULL == memo)
+		{
+			ret = _cesk_method_footprint_scan_method(methods[k], methods, &nmethods, &statics, &size, &capacity);
+			continue;
+		}
+		/* the footprint of the callee already covers the methods it calls */
+		if(memo->unknown) ret = 0;
+		for(i = 0; i < memo->nstatics && ret > 0; i ++)
+			if(_cesk_method_footprint_append(&statics, &size, &capacity, memo->statics[i]) < 0) ret = -1;
+	}
+	if(ret <= 0)
+	{
+		if(NULL != statics) free(statics);
+		return ret;
+	}
+	/* sort and remove the duplicates */
+	if(size > 0) qsort(statics, size, sizeof(uint32_t), _cesk_method_footprint_comp);
+	uint32_t count = 0;
+	for(i = 0; i < size; i ++)
+		if(0 == count || statics[count - 1] != statics[i])
+			statics[count ++] = statics[i];
+	*p_statics = statics;
+	*p_count = count;
+	return 1;
+}
+/**
+ * @brief get the static fields a method can touch, the result is memoized
+ * @param code the entry block of the method
+ * @return the footprint, NULL if the method might touch any static field
+ **/
+static inline const _cesk_method_footprint_t* _cesk_method_get_footprint(const dalvik_block_t* code)
+{
+	_cesk_method_footprint_t* node = _cesk_method_footprint_find(code);
+	if(NULL != node) return node->unknown ? NULL : node;
+	uint32_t* statics;
+	uint32_t nstatics;
+	int rc = _cesk_method_footprint_scan(code, &statics, &nstatics);
+	if(rc < 0) return NULL;
+	node = (_cesk_method_footprint_t*)malloc(sizeof(_cesk_method_footprint_t) + sizeof(uint32_t) * nstatics);
+	if(NULL == node)
+	{
+		LOG_ERROR("can not allocate memory for the footprint of the method");
+		if(NULL != statics) free(statics);
+		return NULL;
+	}
+	node->code = code;
+	node->unknown = (0 == rc);
+	node->nstatics = nstatics;
+	if(nstatics > 0) memcpy(node->statics, statics, sizeof(uint32_t) * nstatics);
+	if(NULL != statics) free(statics);
+	uint32_t h = (uint32_t)(((uintptr_t)code) / sizeof(void*)) % CESK_METHOD_FOOTPRINT_TABLE_SIZE;
+	node->next = _cesk_method_footprint[h];
+	_cesk_method_footprint[h] = node;
+	LOG_DEBUG("the footprint of the method at %p has %u static fields (unknown = %u)", code, nstatics, node->unknown);
+	return node->unknown ? NULL : node;
+}
+/**
+ * @brief the hash code of the projection of the frame to the part the method can touch
+ * @param code the entry block of the method
+ * @param frame the input frame
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_method_frame_hashcode(const dalvik_block_t* code, const cesk_frame_t* frame)
+{
+	const _cesk_method_footprint_t* footprint = _cesk_method_get_footprint(code);
+	/* the canonical hash code is used, so that the isomorphic frames are in the same slot */
+	if(NULL == footprint) return cesk_frame_canonical_hashcode(frame, NULL, 0);
+	return cesk_frame_canonical_hashcode(frame, footprint->statics, footprint->nstatics);
+}
+/**
+ * @brief check if the projections of two input frames to the part the method can touch are equal
+ * @param code the entry block of the method
+ * @param first the first frame
+ * @param second the second frame
+ * @return 1 if they are equal, 0 otherwise
+ **/
+static inline int _cesk_method_frame_equal(const dalvik_block_t* code, const cesk_frame_t* first, const cesk_frame_t* second)
+{
+	const _cesk_method_footprint_t* footprint = _cesk_method_get_footprint(code);
+	if(NULL == footprint) return cesk_frame_equal(first, second);
+	return cesk_frame_projection_equal(first, second, footprint->statics, footprint->nstatics);
+}
+/**
+ * @brief check if the projections of two input frames to the part the method can touch are isomorphic
+ * @param code the entry block of the method
+ * @param first the first frame
+ * @param second the second frame
+ * @return 1 if they are isomorphic, 0 otherwise
+ **/
+static inline int _cesk_method_frame_isomorphic(const dalvik_block_t* code, const cesk_frame_t* first, const cesk_frame_t* second)
+{
+	const _cesk_method_footprint_t* footprint = _cesk_method_get_footprint(code);
+	if(NULL == footprint) return cesk_frame_isomorphic(first, second, NULL, 0);
+	return cesk_frame_isomorphic(first, second, footprint->statics, footprint->nstatics);
+}
+/**
+ * @brief translate the result of a cache node to an isomorphic input frame
+ * @param code the entry block of the method
+ * @param node the cache node
+ * @param frame the input frame which is isomorphic to the input frame of the node
+ * @return the translated result, NULL if the result can not be translated
+ **/
+static inline cesk_diff_t* _cesk_method_rename_result(const dalvik_block_t* code, const _cesk_method_cache_node_t* node, const cesk_frame_t* frame)
+{
+	const _cesk_method_footprint_t* footprint = _cesk_method_get_footprint(code);
+	const uint32_t* statics = (NULL == footprint) ? NULL : footprint->statics;
+	uint32_t nstatics = (NULL == footprint) ? 0 : footprint->nstatics;
+	uint32_t from_count, to_count;
+	const uint32_t* from = cesk_frame_canonical_order(node->frame, statics, nstatics, &from_count);
+	const uint32_t* to = cesk_frame_canonical_order(frame, statics, nstatics, &to_count);
+	if(NULL == from || NULL == to || from_count != to_count) return NULL;
+	return cesk_diff_rename(node->result, from, to, from_count);
+}
+/**
+ * @brief the hash code used by the method analyzer cache, the key is the code block and current stack frame,
+ *        or the code block and the abstract calling context
  * @param code current code block
  * @param frame current stack frame
+ * @param key the abstract calling context
  * @return the hashcode computed from the input key pair
  **/
-static inline hashval_t _cesk_method_cache_hash(const dalvik_block_t* code, const cesk_frame_t* frame)
+static inline hashval_t _cesk_method_cache_hash(const dalvik_block_t* code, const cesk_frame_t* frame, const cesk_policy_key_t* key)
 {
 	return (((((uintptr_t)code)&0xffffffffu) * (((uintptr_t)code)&0xffffffffu)) + 
 		   0x35fbc27 * (((uint64_t)((uintptr_t)code))>>32)) ^  /* for 32 bit machine, this part is 0 */
-		   cesk_frame_hashcode(frame);
+		   (CESK_POLICY_FULL == key->policy.type ? _cesk_method_frame_hashcode(code, frame) : cesk_policy_key_hashcode(key));
 }
 /**
  * @brief allocate a new cache node 
  * @param code current code block
  * @param frame current stack frame
+ * @param key the abstract calling context
  * @return the pointer to the newly created cache node, NULL indicates there's some error
  **/
-static inline _cesk_method_cache_node_t* _cesk_method_cache_node_new(const dalvik_block_t* code, const cesk_frame_t* frame)
+static inline _cesk_method_cache_node_t* _cesk_method_cache_node_new(const dalvik_block_t* code, const cesk_frame_t* frame, const cesk_policy_key_t* key)
 {
 	_cesk_method_cache_node_t* ret = (_cesk_method_cache_node_t*)malloc(sizeof(_cesk_method_cache_node_t));
 	if(NULL == ret) 
@@ -151,6 +496,7 @@ static inline _cesk_method_cache_node_t* _cesk_method_cache_node_new(const dalvi
 	/* we can not make modifications in the input frame, so we need to fork the frame before we start */
 	ret->frame = cesk_frame_fork(frame);
 	ret->code = code;
+	ret->key = *key;
 	ret->result = NULL;
 	ret->next = NULL;
 	ret->rtable = NULL;
@@ -162,12 +508,13 @@ static inline _cesk_method_cache_node_t* _cesk_method_cache_node_new(const dalvi
  *       should guareentee this
  * @param code current code block
  * @param frame current stack frame
+ * @param key the abstract calling context
  * @return the pointer to the newly inserted node, NULL indicates there's some error
  **/
-static inline _cesk_method_cache_node_t* _cesk_method_cache_insert(const dalvik_block_t* code, const cesk_frame_t* frame)
+static inline _cesk_method_cache_node_t* _cesk_method_cache_insert(const dalvik_block_t* code, const cesk_frame_t* frame, const cesk_policy_key_t* key)
 {
-	hashval_t h = _cesk_method_cache_hash(code, frame);
-	_cesk_method_cache_node_t* node = _cesk_method_cache_node_new(code, frame);
+	hashval_t h = _cesk_method_cache_hash(code, frame, key);
+	_cesk_method_cache_node_t* node = _cesk_method_cache_node_new(code, frame, key);
 	if(NULL == node)
 	{
 		LOG_ERROR("can not allocate node for method analyzer cache");
@@ -179,51 +526,180 @@ static inline _cesk_method_cache_node_t* _cesk_method_cache_insert(const dalvik_
 }
 /**
  * @brief find if there's an record in the cache matches the input key
+ * @details the node with an equal frame is preferred, otherwise a node with an isomorphic frame is returned
  * @param code the current code block
  * @param frame the current stack frame
+ * @param key the abstract calling context
+ * @param p_renamed the buffer used to return if the frame of the node is isomorphic rather than equal to the input frame
  * @return the pointer to the node that matches the input key pair, NULL indicates nothing found
  **/
-static inline _cesk_method_cache_node_t* _cesk_method_cache_find(const dalvik_block_t* code, const cesk_frame_t* frame)
+static inline _cesk_method_cache_node_t* _cesk_method_cache_find(const dalvik_block_t* code, const cesk_frame_t* frame, const cesk_policy_key_t* key, int* p_renamed)
 {
-	hashval_t h = _cesk_method_cache_hash(code, frame);
+	hashval_t h = _cesk_method_cache_hash(code, frame, key);
 	_cesk_method_cache_node_t* node;
+	_cesk_method_cache_node_t* isomorphic = NULL;
+	*p_renamed = 0;
 	for(node = _cesk_method_cache[h%CESK_METHOD_CAHCE_SIZE]; NULL != node; node = node->next)
+	{
 		/* each piece of code is a signleton in the memory that is why we just compare the address */
-		if(node->code == code && cesk_frame_equal(frame, node->frame))  
-			return node;
+		if(node->code != code || !cesk_policy_key_equal(key, &node->key)) continue;
+		if(_cesk_method_frame_equal(code, frame, node->frame)) return node;
+		if(NULL == isomorphic && _cesk_method_frame_isomorphic(code, frame, node->frame)) isomorphic = node;
+	}
+	if(NULL != isomorphic) *p_renamed = 1;
+	return isomorphic;
+}
+/**
+ * @brief abstract the input frame with the abstract calling context. If there's a previous invocation
+ *        with the same abstract calling context and the same store, the input frame is joined with the 
+ *        input frame of the previous invocation, so that all these invocations share one analysis result.
+ * @param code the current code block
+ * @param frame the current stack frame
+ * @param key the abstract calling context
+ * @return the joined frame, NULL if the frame can not be joined with any previous frame 
+ **/
+static inline cesk_frame_t* _cesk_method_cache_join(const dalvik_block_t* code, const cesk_frame_t* frame, const cesk_policy_key_t* key)
+{
+	if(CESK_POLICY_FULL == key->policy.type) return NULL;
+	hashval_t h = _cesk_method_cache_hash(code, frame, key);
+	_cesk_method_cache_node_t* node;
+	/* the newest node is the nearest to the head of the list, and its frame covers the previous ones */
+	for(node = _cesk_method_cache[h%CESK_METHOD_CAHCE_SIZE]; NULL != node; node = node->next)
+		if(node->code == code && cesk_policy_key_equal(key, &node->key) && node->frame->size == frame->size &&
+		   cesk_static_table_equal(node->frame->statics, frame->statics) &&
+		   cesk_store_equal(node->frame->store, frame->store))
+			break;
+	if(NULL == node || cesk_frame_equal(frame, node->frame)) return NULL;
+	PERF_INC(method_cache_merged);
+	cesk_frame_t* ret = cesk_frame_fork(node->frame);
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not fork the frame");
+		return NULL;
+	}
+	int i;
+	for(i = 0; i < frame->size; i ++)
+	{
+		cesk_set_iter_t iter;
+		uint32_t addr;
+		if(NULL == cesk_set_iter(frame->regs[i], &iter))
+		{
+			LOG_ERROR("can not iterate the register %d", i);
+			goto ERR;
+		}
+		while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+			if(cesk_frame_register_push(ret, i, addr, 1, NULL, NULL) < 0)
+			{
+				LOG_ERROR("can not join the register %d", i);
+				goto ERR;
+			}
+		if(cesk_set_merge_tags(ret->regs[i], frame->regs[i]) < 0)
+		{
+			LOG_ERROR("can not join the tags of register %d", i);
+			goto ERR;
+		}
+	}
+	return ret;
+ERR:
+	cesk_frame_free(ret);
 	return NULL;
 }
 
+/**
+ * @brief the size of an analyzer context
+ * @param nslots the number of block slots
+ * @return the size in bytes
+ **/
+static inline size_t _cesk_method_context_size(uint32_t nslots)
+{
+	return sizeof(_cesk_method_context_t) + nslots * (sizeof(_cesk_method_block_context_t) + sizeof(uint32_t));
+}
+/**
+ * @brief allocate an empty analyzer context for a method with nslots blocks, the context is taken from
+ *        the context pool if there's a free one with exactly the same size
+ * @param nslots the number of block slots
+ * @return the newly allocated context, NULL indicates an error
+ **/
+static inline _cesk_method_context_t* _cesk_method_context_alloc(uint32_t nslots)
+{
+	size_t size = _cesk_method_context_size(nslots);
+	_cesk_method_context_t* ret = NULL;
+	if(nslots <= CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS && NULL != _cesk_method_context_pool[nslots])
+	{
+		ret = _cesk_method_context_pool[nslots];
+		_cesk_method_context_pool[nslots] = ret->next;
+		_cesk_method_context_pool_count[nslots] --;
+		PERF_INC(context_pool_hit);
+	}
+	else
+	{
+		ret = (_cesk_method_context_t*)malloc(size);
+		if(NULL == ret) return NULL;
+		PERF_INC(context_pool_miss);
+	}
+	memset(ret, 0, size);
+	ret->nslots = nslots;
+	ret->Q = (uint32_t*)(ret->blocks + nslots);
+	PERF_CODE(
+		perf_counters.context_bytes += size;
+		if(perf_counters.context_peak_bytes < perf_counters.context_bytes)
+			perf_counters.context_peak_bytes = perf_counters.context_bytes;
+	);
+	return ret;
+}
+/**
+ * @brief return the memory of an analyzer context to the context pool
+ * @param context the context
+ * @return nothing
+ **/
+static inline void _cesk_method_context_release(_cesk_method_context_t* context)
+{
+	uint32_t nslots = context->nslots;
+	PERF_CODE(perf_counters.context_bytes -= _cesk_method_context_size(nslots));
+	if(nslots <= CESK_METHOD_CONTEXT_POOL_MAX_NBLOCKS && _cesk_method_context_pool_count[nslots] < CESK_METHOD_CONTEXT_POOL_DEPTH)
+	{
+		context->next = _cesk_method_context_pool[nslots];
+		_cesk_method_context_pool[nslots] = context;
+		_cesk_method_context_pool_count[nslots] ++;
+	}
+	else
+		free(context);
+}
 /** 
- * @brief explore the code block graph and save the pointer to all blocks in
- *        _cesk_method_block_list, so that we can prepare the block context for this
- *        function. 
+ * @brief explore the code block graph, fill the code field of the block context for each reachable block
+ *        and count the number of inputs of each block
+ * @details the exploration uses the analyzer queue as the DFS stack, because each block is pushed at most once
+ * @param context the analyzer context
  * @param entry the entry pointer
- * @todo  for perforamnce reason, this funcution should also been cached to accelereate the recursive 
- *        function calls
  * @return < 0 indicates an error
  **/
-static inline int _cesk_method_explore_code(const dalvik_block_t* entry)
+static inline int _cesk_method_explore_code(_cesk_method_context_t* context, const dalvik_block_t* entry)
 {  
 	if(NULL == entry) return 0;
-	LOG_DEBUG("found block #%d", entry->index);
-	_cesk_method_block_list[entry->index] = entry;
-	/* update the maximum block index for current function */ 
-	if(_cesk_method_block_max_idx < entry->index || _cesk_method_block_max_idx == 0xffffffffu)
-		_cesk_method_block_max_idx = entry->index;
-	int i;
-	for(i = 0; i < entry->nbranches; i ++)
+	uint32_t sp = 0;
+	context->blocks[entry->index].code = entry;
+	context->Q[sp ++] = entry->index;
+	while(sp > 0)
 	{
-		const dalvik_block_branch_t* branch = entry->branches + i;
-		if(branch->disabled ||    /* a disabled branch ? */
-		  (0 == branch->conditional && DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch))) /* a return branch, which means no target block */
-			continue;
-		_cesk_method_block_ninputs[branch->block->index] ++;   /* update the number of inputs the target block depends on */
-		if(NULL != _cesk_method_block_list[branch->block->index]) continue;   /* we have visit the target block before? ok skip it */
-		if(_cesk_method_explore_code(branch->block) < 0)
+		const dalvik_block_t* block = context->blocks[context->Q[--sp]].code;
+		LOG_DEBUG("found block #%d", block->index);
+		int i;
+		for(i = 0; i < block->nbranches; i ++)
 		{
-			LOG_ERROR("can not explore the code blocks from block #%d", branch->block->index);
-			return -1;
+			const dalvik_block_branch_t* branch = block->branches + i;
+			if(branch->disabled ||    /* a disabled branch ? */
+			  (0 == branch->conditional && DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch))) /* a return branch, which means no target block */
+				continue;
+			if(branch->block->index >= context->nslots)
+			{
+				LOG_ERROR("block #%d is out of the block graph of %s.%s", branch->block->index, entry->info->class, entry->info->method);
+				return -1;
+			}
+			_cesk_method_block_context_t* target = context->blocks + branch->block->index;
+			target->ninputs ++;   /* update the number of inputs the target block depends on */
+			if(NULL != target->code) continue;   /* we have visit the target block before? ok skip it */
+			target->code = branch->block;
+			context->Q[sp ++] = branch->block->index;
 		}
 	}
 	return 0;
@@ -253,6 +729,7 @@ static inline void _cesk_method_context_free(_cesk_method_context_t* context)
 				if(NULL != block->inputs[i].prv_inversion) cesk_diff_free(block->inputs[i].prv_inversion);
 				if(NULL != block->inputs[i].cur_inversion) cesk_diff_free(block->inputs[i].cur_inversion);
 				if(NULL != block->inputs[i].cur_diff) cesk_diff_free(block->inputs[i].cur_diff);
+				if(NULL != block->inputs[i].pending) cesk_diff_free(block->inputs[i].pending);
 				if(NULL != block->inputs[i].frame) cesk_frame_free(block->inputs[i].frame);
 			}
 			free(block->inputs);
@@ -262,7 +739,7 @@ static inline void _cesk_method_context_free(_cesk_method_context_t* context)
 	//if(NULL != context->rtable) cesk_reloc_table_free(context->rtable);
 	if(NULL != context->atable) cesk_alloctab_free(context->atable);
 	if(NULL != context->result_buffer) cesk_diff_buffer_free(context->result_buffer);
-	free(context);
+	_cesk_method_context_release(context);
 }
 /**
  * @brief initialize the method analyzer
@@ -278,27 +755,19 @@ static inline _cesk_method_context_t* _cesk_method_context_new(
 {
 	static uint32_t tick = 0;
 	_cesk_method_context_t* ret;
-	_cesk_method_block_max_ninputs = 0;
-	_cesk_method_block_max_idx = 0xfffffffful;
-	memset(_cesk_method_block_list, 0, sizeof(_cesk_method_block_list));
-	memset(_cesk_method_block_ninputs, 0, sizeof(_cesk_method_block_ninputs));
-	memset(_cesk_method_block_inputs_used, 0, sizeof(_cesk_method_block_inputs_used));
-	/* first explore all blocks belongs to this method */
-	if(_cesk_method_explore_code(entry) < 0)
-	{
-		LOG_ERROR("can not explor the code block graph");
-		return NULL;
-	}
-	/* construct context */
-	size_t context_size = sizeof(_cesk_method_context_t) + (_cesk_method_block_max_idx + 1) * sizeof(_cesk_method_block_context_t);
-	ret = (_cesk_method_context_t*)malloc(context_size);
+	/* the context is sized to the number of blocks in the block graph */
+	ret = _cesk_method_context_alloc(entry->info->nblocks);
 	if(NULL == ret)
 	{
 		LOG_ERROR("can not allocate memory for analyzer context");
 		return NULL;
 	}
-	memset(ret, 0, context_size);
-	ret->nslots = _cesk_method_block_max_idx + 1;
+	/* first explore all blocks belongs to this method */
+	if(_cesk_method_explore_code(ret, entry) < 0)
+	{
+		LOG_ERROR("can not explor the code block graph");
+		goto ERR;
+	}
 	ret->tick = tick ++;
 	/* set the input frame */
 	ret->input_frame = frame;
@@ -326,14 +795,12 @@ static inline _cesk_method_context_t* _cesk_method_context_new(
 	}
 	/* initialize all context for every blocks */
 	int i;
-	for(i = 0; i < _cesk_method_block_max_idx + 1; i ++)
+	for(i = 0; i < ret->nslots; i ++)
 	{
 		/* skip block not reachable */
-		if(NULL == _cesk_method_block_list[i]) continue;
-		/* initialize the i-th code block */
-		ret->blocks[i].code = _cesk_method_block_list[i];
+		if(NULL == ret->blocks[i].code) continue;
 		/* if there's an output, we should allocate the input_index for this block */
-		if(_cesk_method_block_list[i]->nbranches > 1 || !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(_cesk_method_block_list[i]->branches[0]))
+		if(ret->blocks[i].code->nbranches > 1 || !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(ret->blocks[i].code->branches[0]))
 		{
 			ret->blocks[i].input_index = (uint32_t*)malloc(ret->blocks[i].code->nbranches * sizeof(uint32_t));
 			if(NULL == ret->blocks[i].input_index)
@@ -374,7 +841,6 @@ static inline _cesk_method_context_t* _cesk_method_context_new(
 			if(NULL == ret->blocks[t].inputs)
 			{
 				size_t inputs_size;
-				ret->blocks[t].ninputs = _cesk_method_block_ninputs[t];
 				inputs_size = sizeof(_cesk_method_block_input_t) * ret->blocks[t].ninputs;
 				ret->blocks[t].inputs = (_cesk_method_block_input_t*)malloc(inputs_size);
 				if(NULL == ret->blocks[t].inputs)
@@ -384,47 +850,41 @@ static inline _cesk_method_context_t* _cesk_method_context_new(
 				}
 				memset(ret->blocks[t].inputs, 0, inputs_size);
 			}
-			/* append this branch to the input table */
-			/* so why inputs[0]? because for each time we append one input in the block context,
-			 * we keep moving the input pointer to the next empty slot that is avaliable for the 
-			 * future input branches. */
-			ret->blocks[t].inputs[0].block = ret->blocks + i;
-			ret->blocks[t].inputs[0].index = j;
-			ret->blocks[t].inputs[0].frame = cesk_frame_fork(frame);
-			if(NULL == ret->blocks[t].inputs[0].frame)
+			/* append this branch to the input table, the queue position is not used until the analysis 
+			 * starts, so we use it as the number of input slots that are already used */
+			_cesk_method_block_input_t* input = ret->blocks[t].inputs + ret->blocks[t].queue_position;
+			input->block = ret->blocks + i;
+			input->index = j;
+			input->frame = cesk_frame_fork(frame);
+			if(NULL == input->frame)
 			{
 				LOG_ERROR("failed to duplicate the input frame");
 				goto ERR;
 			}
 			/* share the allocation table among all blocks in this method invocation context */
-			cesk_frame_set_alloctab(ret->blocks[t].inputs[0].frame, ret->atable);
-			ret->blocks[t].inputs[0].prv_inversion = cesk_diff_empty();
-			if(NULL == ret->blocks[t].inputs[0].prv_inversion)
+			cesk_frame_set_alloctab(input->frame, ret->atable);
+			input->prv_inversion = cesk_diff_empty();
+			if(NULL == input->prv_inversion)
 			{
 				goto DIFFERR;
 			}
-			ret->blocks[t].inputs[0].cur_inversion = cesk_diff_empty();
-			if(NULL == ret->blocks[t].inputs[0].cur_inversion)
+			input->cur_inversion = cesk_diff_empty();
+			if(NULL == input->cur_inversion)
 			{
 				goto DIFFERR;
 			}
-			ret->blocks[t].inputs[0].cur_diff = cesk_diff_empty();
-			if(NULL == ret->blocks[t].inputs[0].cur_diff)
+			input->cur_diff = cesk_diff_empty();
+			if(NULL == input->cur_diff)
 			{
 				goto DIFFERR;
 			}
 			/* now we update the input_index array */
-			ret->blocks[i].input_index[j] = _cesk_method_block_inputs_used[t] ++;
-			/* this is why we use inputs[0] */
-			ret->blocks[t].inputs ++;
+			ret->blocks[i].input_index[j] = ret->blocks[t].queue_position ++;
 		}
 	}
-	/* restore the input pointer */
-	for(i = 0; i < _cesk_method_block_max_idx + 1; i ++)
-	{
-		if(NULL == _cesk_method_block_list[i]) continue;
-		ret->blocks[i].inputs -= ret->blocks[i].ninputs;
-	}
+	/* reset the queue positions */
+	for(i = 0; i < ret->nslots; i ++)
+		ret->blocks[i].queue_position = 0;
 	/* assign a id to current closure */
 	static uint32_t next_closure_id = 0;
 	ret->closure_id = next_closure_id ++;
@@ -450,19 +910,35 @@ static inline int _cesk_method_compute_next_input(_cesk_method_context_t* ctx, _
 	/* for the multiple way diff, we merge use the factorize function, so we need diff in each way,
 	 * and the output frame applied each diff */
 	uint32_t nways = 0;    /* how many ways of diff needs to be merged */
-	cesk_diff_t* term_diff[CESK_METHOD_MAX_NBLOCKS];
-	const cesk_frame_t* term_frame[CESK_METHOD_MAX_NBLOCKS];
+	cesk_diff_t* diff_buf[CESK_METHOD_MAX_STACK_INPUTS];
+	const cesk_frame_t* frame_buf[CESK_METHOD_MAX_STACK_INPUTS];
+	cesk_diff_t** term_diff = diff_buf;
+	const cesk_frame_t** term_frame = frame_buf;
+	/* a block with lots of inputs does not fit in the stack */
+	if(blkctx->ninputs > CESK_METHOD_MAX_STACK_INPUTS)
+	{
+		term_diff = (cesk_diff_t**)malloc(blkctx->ninputs * sizeof(cesk_diff_t*));
+		term_frame = (const cesk_frame_t**)malloc(blkctx->ninputs * sizeof(cesk_frame_t*));
+		if(NULL == term_diff || NULL == term_frame)
+		{
+			LOG_ERROR("can not allocate memory for the input terms of block #%d", blkctx->code->index);
+			goto ERR;
+		}
+	}
 	for(i = 0; i < blkctx->ninputs; i ++)
 	{
 		_cesk_method_block_input_t*   input = blkctx->inputs + i;                    /* current input */
 		_cesk_method_block_context_t* sourctx = ctx->blocks + input->block->code->index;   /* the context of the source block */
 		/* if there's no modification since the last computation */
-		if(blkctx->timestamp > sourctx->timestamp)
+		if(blkctx->timestamp > sourctx->timestamp || input->pruned)
 		{
 			LOG_DEBUG("this block uses the input from block #%d, but there's no modification on the block, so skipping", sourctx->code->index);
-			/* we actually needs an empty diff for this, because there's no modification */
+			/* we actually needs an empty diff for this, because there's no modification, unless the branch
+			 * has been pruned, in which case the pending diff already contains the youngest output diff */
 			term_frame[nways] = input->frame;
-			term_diff[nways] = cesk_diff_empty();
+			term_diff[nways] = (NULL != input->pending) ? input->pending : cesk_diff_empty();
+			input->pending = NULL;
+			input->pruned = 0;
 			if(NULL == term_diff[nways])
 			{
 				LOG_ERROR("can not allocate a new indentity diff");
@@ -473,14 +949,19 @@ static inline int _cesk_method_compute_next_input(_cesk_method_context_t* ctx, _
 		}
 		/* so this is the input that has been modified since last intepration of current block, we need to compute the output diff for that */
 		
-		/* output_diff = prv_inversion * input_diff * cur_diff */
-		cesk_diff_t* factors[] = {input->prv_inversion, sourctx->input_diff, input->cur_diff};
-		term_diff[nways] = cesk_diff_apply(3, factors);
+		/* output_diff = pending * prv_inversion * input_diff * cur_diff */
+		cesk_diff_t* factors[] = {input->pending, input->prv_inversion, sourctx->input_diff, input->cur_diff};
+		if(NULL == input->pending)
+			term_diff[nways] = cesk_diff_apply(3, factors + 1);
+		else
+			term_diff[nways] = cesk_diff_apply(4, factors);
 		if(NULL == term_diff[nways]) 
 		{
 			LOG_ERROR("can not compute prv_inversion * input_diff * cur_diff");
 			goto ERR;
 		}
+		if(NULL != input->pending) cesk_diff_free(input->pending);
+		input->pending = NULL;
 		term_frame[nways] = input->frame;
 		nways ++;
 	}
@@ -494,6 +975,7 @@ static inline int _cesk_method_compute_next_input(_cesk_method_context_t* ctx, _
 	/* clean up */
 	for(i = 0; i < nways; i ++)
 		cesk_diff_free(term_diff[i]);
+	nways = 0;
 	
 	if(cesk_diff_sub(result, blkctx->input_diff) < 0)
 	{
@@ -504,12 +986,16 @@ static inline int _cesk_method_compute_next_input(_cesk_method_context_t* ctx, _
 	cesk_diff_free(blkctx->input_diff);
 	blkctx->input_diff = result;
 	blkctx->timestamp = ctx->rear;
+	if(term_diff != diff_buf) free(term_diff);
+	if(term_frame != frame_buf) free(term_frame);
 	return 0;
 ERR:
 	for(i = 0; i < nways; i ++)
 	{
 		if(NULL != term_diff) cesk_diff_free(term_diff[i]);
 	}
+	if(term_diff != diff_buf) free(term_diff);
+	if(term_frame != frame_buf) free(term_frame);
 	return -1;
 }
 /**
@@ -531,6 +1017,189 @@ static inline int _cesk_method_get_branch_constrain_diff(
 	*inv_buf = cesk_diff_empty();
 	return 0;
 }
+/**
+ * @brief get the numeric value of an operand of a branch condition
+ * @details an object reference in the register is not null, so it's a nonzero value
+ * @param frame the output frame of the block
+ * @param operand the operand
+ * @param p_bounded the buffer for if the value is known precisely enough to prune a branch, which means the
+ *        operand is a constant, or every value in the register is either an object reference or bounded
+ * @return the constant address, CESK_STORE_ADDR_EMPTY if the value is unknown
+ **/
+static inline uint32_t _cesk_method_branch_operand_value(const cesk_frame_t* frame, const dalvik_operand_t* operand, int* p_bounded)
+{
+	*p_bounded = 1;
+	if(operand->header.info.is_const) return cesk_store_const_addr_from_operand(operand);
+	uint32_t reg = CESK_FRAME_GENERAL_REG(operand->payload.uint16);
+	cesk_set_iter_t iter;
+	if(reg >= frame->size || NULL == cesk_set_iter(frame->regs[reg], &iter)) return CESK_STORE_ADDR_EMPTY;
+	uint32_t ret = CESK_STORE_ADDR_EMPTY;
+	uint32_t addr;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		if(!CESK_STORE_ADDR_IS_CONST(addr)) addr = CESK_STORE_ADDR_NEG | CESK_STORE_ADDR_POS;
+		else if(!cesk_arithmetic_is_bounded(addr)) *p_bounded = 0;
+		ret = cesk_arithmetic_join(ret, addr);
+	}
+	return ret;
+}
+/**
+ * @brief check if a dead register can be cleared
+ * @details only the registers that hold nothing but constants are cleared. The objects are kept, because the
+ *          register might hold the last reference to the object in the store of the callee, which is still
+ *          used by the caller, and clearing the register deallocates the object
+ * @param set the value of the register
+ * @return the result
+ **/
+static inline int _cesk_method_register_clearable(const cesk_set_t* set)
+{
+	if(0 == cesk_set_size(set)) return 0;
+	cesk_set_iter_t iter;
+	if(NULL == cesk_set_iter(set, &iter)) return 0;
+	uint32_t addr;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+		if(!CESK_STORE_ADDR_IS_CONST(addr)) return 0;
+	return 1;
+}
+/**
+ * @brief count the registers in the frame that are dead at the entry of the block and can be cleared
+ * @param code the code block
+ * @param frame the frame
+ * @return the number of registers
+ **/
+static inline uint32_t _cesk_method_count_dead_registers(const dalvik_block_t* code, const cesk_frame_t* frame)
+{
+	if(NULL == code->live_in) return 0;
+	uint32_t reg, ret = 0;
+	for(reg = 0; reg < code->nregs && CESK_FRAME_GENERAL_REG(reg) < frame->size; reg ++)
+		if(!DALVIK_BLOCK_REG_IS_LIVE(code, reg) && _cesk_method_register_clearable(frame->regs[CESK_FRAME_GENERAL_REG(reg)]))
+			ret ++;
+	return ret;
+}
+/**
+ * @brief clear the registers that are dead at the entry of the block and can be cleared, so that the 
+ *        frames only differ in the dead registers are equal
+ * @param code the code block
+ * @param frame the frame
+ * @param diff_buf the diff buffer, NULL if the diff is not needed
+ * @param inv_buf the inversion buffer, NULL if the inversion is not needed
+ * @return the number of registers cleared, < 0 indicates an error
+ **/
+static inline int _cesk_method_clear_dead_registers(const dalvik_block_t* code, cesk_frame_t* frame, cesk_diff_buffer_t* diff_buf, cesk_diff_buffer_t* inv_buf)
+{
+	if(NULL == code->live_in) return 0;
+	uint32_t reg;
+	int ret = 0;
+	for(reg = 0; reg < code->nregs && CESK_FRAME_GENERAL_REG(reg) < frame->size; reg ++)
+	{
+		if(DALVIK_BLOCK_REG_IS_LIVE(code, reg) || !_cesk_method_register_clearable(frame->regs[CESK_FRAME_GENERAL_REG(reg)])) continue;
+		if(cesk_frame_register_clear(frame, CESK_FRAME_GENERAL_REG(reg), diff_buf, inv_buf) < 0)
+		{
+			LOG_ERROR("can not clear the dead register v%d", reg);
+			return -1;
+		}
+		PERF_INC(dead_register_cleared);
+		ret ++;
+	}
+	return ret;
+}
+/**
+ * @brief clear the registers that are dead at the entry of the target block in the output frame of a branch
+ * @param target the target block of the branch
+ * @param frame the output frame of the branch
+ * @param p_diff the buffer used to return the diff, NULL if nothing is cleared
+ * @param p_inv the buffer used to return the inversion, NULL if nothing is cleared
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_method_clear_branch_frame(const dalvik_block_t* target, cesk_frame_t* frame, cesk_diff_t** p_diff, cesk_diff_t** p_inv)
+{
+	*p_diff = *p_inv = NULL;
+	if(0 == _cesk_method_count_dead_registers(target, frame)) return 0;
+	cesk_diff_buffer_t* dbuf = cesk_diff_buffer_new(0, 0);
+	cesk_diff_buffer_t* ibuf = cesk_diff_buffer_new(1, 0);
+	if(NULL == dbuf || NULL == ibuf)
+	{
+		LOG_ERROR("can not allocate the diff buffers");
+		goto ERR;
+	}
+	if(_cesk_method_clear_dead_registers(target, frame, dbuf, ibuf) < 0) goto ERR;
+	*p_diff = cesk_diff_from_buffer(dbuf);
+	*p_inv = cesk_diff_from_buffer(ibuf);
+	if(NULL == *p_diff || NULL == *p_inv)
+	{
+		LOG_ERROR("can not build the diff of the cleared registers");
+		goto ERR;
+	}
+	cesk_diff_buffer_free(dbuf);
+	cesk_diff_buffer_free(ibuf);
+	return 0;
+ERR:
+	if(NULL != dbuf) cesk_diff_buffer_free(dbuf);
+	if(NULL != ibuf) cesk_diff_buffer_free(ibuf);
+	if(NULL != *p_diff) cesk_diff_free(*p_diff);
+	if(NULL != *p_inv) cesk_diff_free(*p_inv);
+	*p_diff = *p_inv = NULL;
+	return -1;
+}
+/**
+ * @brief check if the control flow might go through a branch, using the output frame of the block
+ * @details the check is done only in the interval domain. The conditional branches are checked against their
+ *          conditions, and the fall-through branch of an if block is taken when the condition of the other 
+ *          branch does not hold. Other branches are always feasible. A condition on a value that is only 
+ *          known by its sign class never prunes the branch, because the sign lattice is not exact for the 
+ *          conversions, the division and the bitwise operations.
+ * @param code the code block
+ * @param index the index of the branch
+ * @param frame the output frame of the block
+ * @return 1 if the branch might be taken, 0 if it's infeasible
+ **/
+static inline int _cesk_method_branch_feasible(const dalvik_block_t* code, uint32_t index, const cesk_frame_t* frame)
+{
+	if(CESK_ARITHMETIC_DOMAIN_INTERVAL != cesk_arithmetic_domain) return 1;
+	const dalvik_block_branch_t* branch = code->branches + index;
+	int negative = 0;
+	if(!branch->conditional)
+	{
+		if(1 != index || 2 != code->nbranches || !code->branches[0].conditional || code->branches[0].left_inst)
+			return 1;
+		branch = code->branches;
+		negative = 1;
+	}
+	int left_bounded = 1, right_bounded;
+	uint32_t left = branch->left_inst ? cesk_arithmetic_const(branch->ileft[0]) : _cesk_method_branch_operand_value(frame, branch->left, &left_bounded);
+	uint32_t right = _cesk_method_branch_operand_value(frame, branch->right, &right_bounded);
+	if(CESK_STORE_ADDR_EMPTY == left || CESK_STORE_ADDR_EMPTY == right || !left_bounded || !right_bounded) return 1;
+	uint32_t diff = cesk_arithmetic_sub(left, right);
+	return (CESK_STORE_ADDR_CONST_CONTAIN(diff, NEG) && (branch->lt ^ negative)) ||
+	       (CESK_STORE_ADDR_CONST_CONTAIN(diff, ZERO) && (branch->eq ^ negative)) ||
+	       (CESK_STORE_ADDR_CONST_CONTAIN(diff, POS) && (branch->gt ^ negative));
+}
+/**
+ * @brief defer the youngest output diff of a pruned branch, the target block sees the diff
+ *        when it computes its input next time
+ * @param blkctx the context of the source block
+ * @param input_ctx the input context
+ * @return < 0 indicates an error
+ **/
+static inline int _cesk_method_defer_input(_cesk_method_block_context_t* blkctx, _cesk_method_block_input_t* input_ctx)
+{
+	/* pending = pending * prv_inversion * input_diff * cur_diff */
+	cesk_diff_t* factors[] = {input_ctx->pending, input_ctx->prv_inversion, blkctx->input_diff, input_ctx->cur_diff};
+	cesk_diff_t* pending;
+	if(NULL == input_ctx->pending)
+		pending = cesk_diff_apply(3, factors + 1);
+	else
+		pending = cesk_diff_apply(4, factors);
+	if(NULL == pending)
+	{
+		LOG_ERROR("can not compute the pending diff of the pruned branch");
+		return -1;
+	}
+	if(NULL != input_ctx->pending) cesk_diff_free(input_ctx->pending);
+	input_ctx->pending = pending;
+	input_ctx->pruned = 1;
+	return 0;
+}
 /**
  * @brief compute the input frame of a given branch
  * @param context the analyzer context
@@ -659,30 +1328,76 @@ static inline int _cesk_method_return(
 cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame, const void* caller, cesk_reloc_table_t** p_rtab)
 {
 	LOG_DEBUG("start analyzing code block graph at %p with frame %p (hashcode = %u)", code, frame, cesk_frame_hashcode(frame));
+	/* the arguments never read by the method do not make a difference, so they are removed before the cache lookup */
+	cesk_frame_t* stripped = NULL;
+	if(_cesk_method_count_dead_registers(code, frame) > 0)
+	{
+		if(NULL == (stripped = cesk_frame_fork(frame)) || _cesk_method_clear_dead_registers(code, stripped, NULL, NULL) < 0)
+		{
+			LOG_ERROR("can not clear the dead registers in the input frame");
+			if(NULL != stripped) cesk_frame_free(stripped);
+			return NULL;
+		}
+		frame = stripped;
+	}
+	/* compute the abstract calling context */
+	cesk_policy_key_t key;
+	if(cesk_policy_key(code, frame, caller, &key) < 0)
+	{
+		LOG_ERROR("can not compute the abstract calling context");
+		if(NULL != stripped) cesk_frame_free(stripped);
+		return NULL;
+	}
+	/* then abstract the input frame, the joined frame is used as the input frame from now on */
+	cesk_frame_t* joined = _cesk_method_cache_join(code, frame, &key);
+	if(NULL != joined)
+	{
+		LOG_DEBUG("the input frame is joined with the previous frame in the same abstract calling context");
+		frame = joined;
+	}
 	/* first we try to find in the cache for this state */
-	_cesk_method_cache_node_t* node = _cesk_method_cache_find(code, frame);
+	int renamed;
+	cesk_diff_t* renamed_result = NULL;
+	_cesk_method_cache_node_t* node = _cesk_method_cache_find(code, frame, &key, &renamed);
+	if(NULL != node && renamed && NULL != node->result && NULL == (renamed_result = _cesk_method_rename_result(code, node, frame)))
+	{
+		LOG_DEBUG("the result of the isomorphic invocation context can not be translated, analyze the method again");
+		node = NULL;
+	}
 	if(NULL != node)
 	{
+		PERF_INC(method_cache_hit);
 		LOG_DEBUG("ya, there's an node is actually about this invocation context, there's no need to look at this method");
 		if(NULL == node->result)
 		{
 			LOG_DEBUG("oh? This context won't return, it's a trap. I don't wanna go inside it");
+			if(NULL != joined) cesk_frame_free(joined);
+			if(NULL != stripped) cesk_frame_free(stripped);
 			*p_rtab = NULL;
 			return cesk_diff_empty();
 		}
 		else
 		{
 			LOG_DEBUG("I find I did previous work on this invocation context!");
+			if(NULL != joined) cesk_frame_free(joined);
+			if(NULL != stripped) cesk_frame_free(stripped);
 			*p_rtab = node->rtable;
+			if(NULL != renamed_result)
+			{
+				PERF_INC(method_cache_renamed);
+				return renamed_result;
+			}
 			return cesk_diff_fork(node->result);
 		}
 	}
 	
+	PERF_INC(method_cache_miss);
+	PERF_CODE(uint32_t perf_iterations = 0);
 	cesk_diff_t* result = NULL;
 	_cesk_method_context_t* context = NULL;
 	
 	/* insert current node to the cache, tell others I've ever been here */
-	node = _cesk_method_cache_insert(code, frame);
+	node = _cesk_method_cache_insert(code, frame, &key);
 	if(NULL == node)
 	{
 		LOG_ERROR("can not allocate a new node in method analyzer cache");
@@ -695,6 +1410,7 @@ cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame
 		LOG_ERROR("can not create context");
 		goto ERR;
 	}
+	context->key = &node->key;
 
 	cesk_method_print_backtrace(context);
 	
@@ -704,8 +1420,9 @@ cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame
 	
 	while(context->front < context->rear)
 	{
+		PERF_CODE(perf_iterations ++);
 		/* current block context */
-		_cesk_method_block_context_t *blkctx = context->blocks + context->Q[(context->front++)%CESK_METHOD_MAX_NBLOCKS];
+		_cesk_method_block_context_t *blkctx = context->blocks + context->Q[(context->front++)%context->nslots];
 		LOG_DEBUG("current block : block #%d", blkctx->code->index);
 #if LOG_LEVEL >= 6
 		LOG_DEBUG("========block info==========");
@@ -797,11 +1514,23 @@ cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame
 			cesk_frame_print_debug(input_ctx->frame);
 			LOG_DEBUG("=============End of Frame================");
 
+			/* the operands of the branch might be dead in the target block, so check the branch before they are cleared */
+			int feasible = _cesk_method_branch_feasible(blkctx->code, i, input_ctx->frame);
+			cesk_diff_t *c_diff = NULL;
+			cesk_diff_t *c_inv  = NULL;
+			if(_cesk_method_clear_branch_frame(target_ctx->code, input_ctx->frame, &c_diff, &c_inv) < 0)
+			{
+				LOG_ERROR("can not clear the dead registers of block #%d", target_ctx->code->index);
+				goto ERR;
+			}
+
 			/* compute new branch analysis diff */
-			cesk_diff_t* buf[] = {b_diff, res.diff};
-			cesk_diff_t* ibuf[] = {res.inverse, b_inv};
-			cesk_diff_t* cur_diff = cesk_diff_apply(2, buf);
-			cesk_diff_t* cur_inversion = cesk_diff_apply(2, ibuf);
+			cesk_diff_t* buf[] = {b_diff, res.diff, c_diff};
+			cesk_diff_t* ibuf[] = {c_inv, res.inverse, b_inv};
+			cesk_diff_t* cur_diff = cesk_diff_apply(NULL == c_diff ? 2 : 3, buf);
+			cesk_diff_t* cur_inversion = NULL == c_inv ? cesk_diff_apply(2, ibuf + 1) : cesk_diff_apply(3, ibuf);
+			if(NULL != c_diff) cesk_diff_free(c_diff);
+			if(NULL != c_inv) cesk_diff_free(c_inv);
 			if(NULL == cur_diff || NULL == cur_inversion)
 			{
 				LOG_ERROR("failed to compute the analysis diff after interpretation of this branch");
@@ -816,20 +1545,29 @@ cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame
 			LOG_DEBUG("prv_insersion = %s", cesk_diff_to_string(input_ctx->prv_inversion, NULL, 0));
 			LOG_DEBUG("cur_insersion = %s", cesk_diff_to_string(input_ctx->cur_inversion, NULL, 0));
 			LOG_DEBUG("cur_diff = %s", cesk_diff_to_string(input_ctx->cur_diff, NULL, 0));
+			/* clean up */
+			cesk_diff_free(res.diff);
+			cesk_diff_free(res.inverse);
+			cesk_diff_free(b_diff);
+			cesk_diff_free(b_inv);
 			/* finally, update the queue and timestamp */
 			uint32_t target_qp = target_ctx->queue_position;
+			if(!feasible)
+			{
+				/* the control flow can not go through this branch, so the target block is not scheduled */
+				LOG_DEBUG("the branch from block #%d to block #%d is infeasible, pruned", blkctx->code->index, target_ctx->code->index);
+				PERF_INC(branch_pruned);
+				if(_cesk_method_defer_input(blkctx, input_ctx) < 0) goto ERR;
+				continue;
+			}
+			input_ctx->pruned = 0;
 			/* if the target context is not in the queue, enqueu */
 			if(target_qp < context->front)
 			{
 				target_ctx->queue_position = context->rear;
-				context->Q[context->rear%CESK_METHOD_MAX_NBLOCKS] = target_ctx->code->index;
+				context->Q[context->rear%context->nslots] = target_ctx->code->index;
 				context->rear ++;
 			}	
-			/* clean up */
-			cesk_diff_free(res.diff);
-			cesk_diff_free(res.inverse);
-			cesk_diff_free(b_diff);
-			cesk_diff_free(b_inv);
 		}
 	}
 
@@ -856,14 +1594,19 @@ cesk_diff_t* cesk_method_analyze(const dalvik_block_t* code, cesk_frame_t* frame
 	node->result = result;
 	*p_rtab = node->rtable = context->rtable;
 	_cesk_method_context_free(context);
+	if(NULL != joined) cesk_frame_free(joined);
+	if(NULL != stripped) cesk_frame_free(stripped);
+	PERF_CODE(if(NULL != code->info) perf_method_analyzed(code->info->class, code->info->method, code->info, perf_iterations));
 	LOG_DEBUG("---------------------");
 	LOG_DEBUG("Function return with diff = %s", cesk_diff_to_string(result, NULL, 0));
 	LOG_DEBUG("---------------------");
 	return cesk_diff_fork(result);
 ERR:
 	if(result) cesk_diff_free(result);
-	if(context->rtable) cesk_reloc_table_free(context->rtable);
+	if(context && context->rtable) cesk_reloc_table_free(context->rtable);
 	if(context) _cesk_method_context_free(context);
+	if(NULL != joined) cesk_frame_free(joined);
+	if(NULL != stripped) cesk_frame_free(stripped);
 	return NULL;
 }
 void cesk_method_print_backtrace(const void* method_context)
@@ -873,7 +1616,7 @@ void cesk_method_print_backtrace(const void* method_context)
 	LOG_DEBUG("================stack bracktrace==================");
 	for(;NULL != context; context = context->caller)
 	{
-		uint32_t blk = context->Q[(context->front - 1)%CESK_METHOD_MAX_NBLOCKS];
+		uint32_t blk = context->Q[(context->front - 1)%context->nslots];
 		if(context->front == 0)  blk = 0;
 		LOG_DEBUG("%s.%s @ block#%d(from instruction 0x%x to 0x%x)", 
 				context->blocks[blk].code->info->class, 
@@ -923,7 +1666,7 @@ const dalvik_block_t* cesk_method_context_get_current_block(const void* context)
 {
 	if(NULL == context) return NULL;
 	const _cesk_method_context_t *frame_context = (const _cesk_method_context_t*)context;
-	uint32_t blk = frame_context->Q[(frame_context->front - 1)%CESK_METHOD_MAX_NBLOCKS];
+	uint32_t blk = frame_context->Q[(frame_context->front - 1)%frame_context->nslots];
 	if(frame_context->front == 0)  blk = 0;
 	return frame_context->blocks[blk].code;
 }
@@ -939,3 +1682,9 @@ uint32_t cesk_method_context_get_closure_id(const void* context)
 	const _cesk_method_context_t *frame_context = (const _cesk_method_context_t*)context;
 	return frame_context->closure_id;
 }
+const cesk_policy_key_t* cesk_method_context_get_policy_key(const void* context)
+{
+	if(NULL == context) return NULL;
+	const _cesk_method_context_t *frame_context = (const _cesk_method_context_t*)context;
+	return frame_context->key;
+}
@@ -16,7 +16,61 @@
 #include <cesk/cesk_object.h>
 
 #include <bci/bci_nametab.h>
-cesk_object_t* cesk_object_new(const char* classpath)
+/**
+ * @brief the node of the per-class layout cache
+ * @details the layout of an instance only depends on its class, so that we compute the
+ *          layout once and keep an object template for each class. The template has
+ *          all fields initialized to CESK_STORE_ADDR_NULL, but the tag set of template
+ *          is NULL and the built-in section is never initialized
+ **/
+typedef struct _cesk_object_layout_t {
+	const char* classpath;                  /*!< the class path of this layout */
+	cesk_object_t* template;                /*!< the object template */
+	struct _cesk_object_layout_t* next;     /*!< the next pointer in the hash table */
+} cesk_object_layout_t;
+
+/** @brief the layout cache */
+static cesk_object_layout_t* _cesk_object_layout_cache[CESK_OBJECT_LAYOUT_CACHE_SIZE];
+
+int cesk_object_init()
+{
+	memset(_cesk_object_layout_cache, 0, sizeof(_cesk_object_layout_cache));
+	return 0;
+}
+void cesk_object_finalize()
+{
+	int i;
+	for(i = 0; i < CESK_OBJECT_LAYOUT_CACHE_SIZE; i ++)
+	{
+		cesk_object_layout_t* ptr;
+		for(ptr = _cesk_object_layout_cache[i]; NULL != ptr;)
+		{
+			cesk_object_layout_t* cur = ptr;
+			ptr = ptr->next;
+			free(cur->template);
+			free(cur);
+		}
+		_cesk_object_layout_cache[i] = NULL;
+	}
+}
+/**
+ * @brief the hash function for the layout cache
+ * @param classpath the class path
+ * @return the hash code
+ **/
+static inline hashval_t _cesk_object_layout_hash(const char* classpath)
+{
+	return (((uintptr_t)classpath) * MH_MULTIPLY) % CESK_OBJECT_LAYOUT_CACHE_SIZE;
+}
+/**
+ * @brief resolve the inheritance path of the class and build an object template for it
+ * @param classpath the class path
+ * @param p_complete if the whole inheritance path is resolved, *p_complete will be 1, otherwise 0.
+ *        A template that is not complete should not be cached, because the missing class might
+ *        be loaded later
+ * @return the object template, NULL indicates error
+ **/
+static inline cesk_object_t* _cesk_object_layout_build(const char* classpath, int* p_complete)
 {
 	int field_count = 0;
 	int class_count = 0;
@@ -24,6 +78,7 @@ cesk_object_t* cesk_object_new(const char* classpath)
 	int nbci = 0;
 	const bci_class_wrap_t* bci_class[CESK_OBJECT_MAX_BUILTIN_CLASSES];
 	const dalvik_class_t* classes[CESK_OBJECT_MAX_USER_DEFINED_CLASSES]; 
+	*p_complete = 1;
 	/* find classes inheritation relationship to determine its memory layout */
 	for(;NULL != classpath;)
 	{
@@ -51,6 +106,7 @@ cesk_object_t* cesk_object_new(const char* classpath)
 			}
 			/* not a built-in class, so we don't know the type of this class. */
 			LOG_WARNING("can not find class %s", classpath);
+			*p_complete = 0;
 			break;
 		}
 		int i;
@@ -77,7 +133,7 @@ cesk_object_t* cesk_object_new(const char* classpath)
 	cesk_object_t* object = (cesk_object_t*)malloc(size);
 	if(NULL == object)
 	{
-		LOG_ERROR("can not allocate memory for new object %s", classes[0]->path);
+		LOG_ERROR("can not allocate memory for the object template");
 		return NULL;
 	}
 	
@@ -122,6 +178,48 @@ cesk_object_t* cesk_object_new(const char* classpath)
 	object->depth = class_count + nbci;
 	object->nbuiltin = nbci;
 	object->size = size;
+	object->tags = NULL;
+	return object;
+}
+cesk_object_t* cesk_object_new(const char* classpath)
+{
+	hashval_t h = _cesk_object_layout_hash(classpath);
+	cesk_object_layout_t* layout;
+	for(layout = _cesk_object_layout_cache[h]; NULL != layout && layout->classpath != classpath; layout = layout->next);
+	if(NULL == layout)
+	{
+		int complete;
+		cesk_object_t* template = _cesk_object_layout_build(classpath, &complete);
+		if(NULL == template) return NULL;
+		/* if we can not resolve the entire inheritance path, do not cache it, just use the object directly */
+		if(!complete)
+		{
+			template->tags = tag_set_empty();
+			return template;
+		}
+		layout = (cesk_object_layout_t*)malloc(sizeof(cesk_object_layout_t));
+		if(NULL == layout)
+		{
+			LOG_ERROR("can not allocate memory for the layout cache of class %s", classpath);
+			free(template);
+			return NULL;
+		}
+		layout->classpath = classpath;
+		layout->template = template;
+		layout->next = _cesk_object_layout_cache[h];
+		_cesk_object_layout_cache[h] = layout;
+		LOG_DEBUG("object layout of class %s has been added to layout cache", classpath);
+	}
+	const cesk_object_t* template = layout->template;
+	cesk_object_t* object = (cesk_object_t*)malloc(template->size);
+	if(NULL == object)
+	{
+		LOG_ERROR("can not allocate memory for new object %s", classpath);
+		return NULL;
+	}
+	memcpy(object, template, template->size);
+	if(NULL != template->builtin)
+		object->builtin = (cesk_object_struct_t*)(((char*)object) + CESK_OBJECT_FIELD_OFS(template, template->builtin));
 	object->tags = tag_set_empty();
 	return object;
 }
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <cesk/cesk_policy.h>
+#include <cesk/cesk_method.h>
+#include <cesk/cesk_object.h>
+#include <cesk/cesk_store.h>
+#include <dalvik/dalvik_memberdict.h>
+/**
+ * @brief a rule that selects the policy for the classes with a prefix
+ **/
+typedef struct _cesk_policy_rule_t {
+	char*         prefix;    /*!< the class path prefix */
+	size_t        length;    /*!< the length of the prefix */
+	cesk_policy_t policy;    /*!< the policy */
+	struct _cesk_policy_rule_t* next;  /*!< the next rule */
+} _cesk_policy_rule_t;
+/**
+ * @brief the names of the policies
+ **/
+static const char* const _cesk_policy_name[CESK_POLICY_NUM_OF_TYPES] = {
+	[CESK_POLICY_FULL]     = "full",
+	[CESK_POLICY_CALLSITE] = "callsite",
+	[CESK_POLICY_OBJECT]   = "object",
+	[CESK_POLICY_TYPE]     = "type"
+};
+/**
+ * @brief the default policy
+ **/
+static cesk_policy_t _cesk_policy_default;
+/**
+ * @brief the prefix rules
+ **/
+static _cesk_policy_rule_t* _cesk_policy_rules;
+
+int cesk_policy_init()
+{
+	_cesk_policy_default.type = CESK_POLICY_FULL;
+	_cesk_policy_default.k = 0;
+	_cesk_policy_rules = NULL;
+	const char* spec = getenv("ADAMPOLICY");
+	if(NULL != spec && 0 != strlen(spec) && cesk_policy_parse(spec) < 0)
+	{
+		LOG_ERROR("invalid context-sensitivity policy %s", spec);
+		return -1;
+	}
+	return 0;
+}
+void cesk_policy_reset()
+{
+	_cesk_policy_rule_t* rule;
+	for(rule = _cesk_policy_rules; NULL != rule;)
+	{
+		_cesk_policy_rule_t* current = rule;
+		rule = rule->next;
+		free(current->prefix);
+		free(current);
+	}
+	_cesk_policy_rules = NULL;
+	_cesk_policy_default.type = CESK_POLICY_FULL;
+	_cesk_policy_default.k = 0;
+}
+void cesk_policy_finalize()
+{
+	cesk_policy_reset();
+}
+int cesk_policy_set(const char* prefix, uint32_t type, uint32_t k)
+{
+	if(type >= CESK_POLICY_NUM_OF_TYPES || (CESK_POLICY_FULL != type && (k == 0 || k > CESK_POLICY_MAX_K)))
+	{
+		LOG_ERROR("invalid policy (type = %u, k = %u)", type, k);
+		return -1;
+	}
+	if(CESK_POLICY_FULL == type) k = 0;
+	if(NULL == prefix)
+	{
+		_cesk_policy_default.type = type;
+		_cesk_policy_default.k = k;
+		return 0;
+	}
+	_cesk_policy_rule_t* rule;
+	for(rule = _cesk_policy_rules; NULL != rule && strcmp(rule->prefix, prefix); rule = rule->next);
+	if(NULL == rule)
+	{
+		rule = (_cesk_policy_rule_t*)malloc(sizeof(_cesk_policy_rule_t));
+		if(NULL == rule)
+		{
+			LOG_ERROR("can not allocate memory for the policy rule");
+			return -1;
+		}
+		rule->length = strlen(prefix);
+		rule->prefix = (char*)malloc(rule->length + 1);
+		if(NULL == rule->prefix)
+		{
+			LOG_ERROR("can not allocate memory for the prefix");
+			free(rule);
+			return -1;
+		}
+		memcpy(rule->prefix, prefix, rule->length + 1);
+		rule->next = _cesk_policy_rules;
+		_cesk_policy_rules = rule;
+	}
+	rule->policy.type = type;
+	rule->policy.k = k;
+	return 0;
+}
+int cesk_policy_parse(const char* spec)
+{
+	int count = 0;
+	char buf[1024];
+	while(NULL != spec && 0 != *spec)
+	{
+		/* copy the item to the buffer */
+		size_t len = strcspn(spec, ",");
+		if(len >= sizeof(buf))
+		{
+			LOG_ERROR("policy item is too long");
+			return -1;
+		}
+		memcpy(buf, spec, len);
+		buf[len] = 0;
+		spec += len;
+		if(*spec == ',') spec ++;
+		if(0 == len) continue;
+		/* [prefix=]policy[:k] */
+		char* prefix = NULL;
+		char* name = buf;
+		char* eq = strchr(buf, '=');
+		if(NULL != eq)
+		{
+			*eq = 0;
+			prefix = buf;
+			name = eq + 1;
+		}
+		uint32_t k = 1;
+		char* colon = strchr(name, ':');
+		if(NULL != colon)
+		{
+			*colon = 0;
+			char* end;
+			k = strtoul(colon + 1, &end, 10);
+			if(*end != 0)
+			{
+				LOG_ERROR("invalid context depth %s", colon + 1);
+				return -1;
+			}
+		}
+		uint32_t type;
+		for(type = 0; type < CESK_POLICY_NUM_OF_TYPES && strcmp(_cesk_policy_name[type], name); type ++);
+		if(CESK_POLICY_NUM_OF_TYPES == type)
+		{
+			LOG_ERROR("unknown policy %s", name);
+			return -1;
+		}
+		if(cesk_policy_set(prefix, type, k) < 0)
+		{
+			LOG_ERROR("can not set the policy %s", name);
+			return -1;
+		}
+		count ++;
+	}
+	return count;
+}
+const cesk_policy_t* cesk_policy_get(const char* classpath)
+{
+	const cesk_policy_t* ret = &_cesk_policy_default;
+	size_t length = 0;
+	const _cesk_policy_rule_t* rule;
+	if(NULL == classpath) return ret;
+	for(rule = _cesk_policy_rules; NULL != rule; rule = rule->next)
+		if(rule->length >= length && 0 == strncmp(classpath, rule->prefix, rule->length))
+		{
+			ret = &rule->policy;
+			length = rule->length;
+		}
+	return ret;
+}
+/**
+ * @brief append an element to the key, the elements beyond the capacity are ignored
+ * @param key the key
+ * @param elem the element
+ * @return nothing
+ **/
+static inline void _cesk_policy_key_append(cesk_policy_key_t* key, uintptr_t elem)
+{
+	if(key->size < CESK_POLICY_KEY_SIZE) key->elem[key->size ++] = elem;
+}
+/**
+ * @brief find the register holds the receiver of the method
+ * @param code the block graph of the method
+ * @param frame the input frame
+ * @return the index of the register in frame->regs, or -1 if the method is a static method
+ **/
+static inline int _cesk_policy_receiver_reg(const dalvik_block_t* code, const cesk_frame_t* frame)
+{
+	const dalvik_method_t* method = dalvik_memberdict_get_method(code->info->class, code->info->method, code->info->signature, code->info->return_type);
+	if(NULL == method || (method->flags & DALVIK_ATTRS_STATIC)) return -1;
+	/* the arguments are in the last registers, and the receiver is the first one */
+	uint32_t nargs = 1;
+	int i;
+	for(i = 0; NULL != code->info->signature[i]; i ++)
+	{
+		uint32_t typecode = code->info->signature[i]->typecode;
+		nargs += (DALVIK_TYPECODE_LONG == typecode || DALVIK_TYPECODE_DOUBLE == typecode || DALVIK_TYPECODE_WIDE == typecode) ? 2 : 1;
+	}
+	if(nargs > frame->size - 2) return -1;
+	return frame->size - nargs;
+}
+/**
+ * @brief append the receiver level of an object or type context, the elements of the level are sorted
+ * @param key the key
+ * @param type the kind of the policy
+ * @param frame the input frame
+ * @param reg the register holds the receiver
+ * @return nothing
+ **/
+static inline void _cesk_policy_key_append_receiver(cesk_policy_key_t* key, uint32_t type, const cesk_frame_t* frame, int reg)
+{
+	uint32_t begin = key->size;
+	cesk_set_iter_t iter;
+	uint32_t addr;
+	if(NULL == cesk_set_iter(frame->regs[reg], &iter)) return;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+	{
+		uintptr_t elem;
+		if(CESK_STORE_ADDR_IS_CONST(addr)) continue;
+		if(CESK_POLICY_OBJECT == type) elem = addr;
+		else
+		{
+			if(CESK_STORE_ADDR_IS_OBJ(addr) && addr / CESK_STORE_BLOCK_NSLOTS >= frame->store->nblocks) continue;
+			cesk_value_const_t* value = cesk_store_get_ro(frame->store, addr);
+			if(NULL == value || CESK_TYPE_OBJECT != value->type) continue;
+			elem = (uintptr_t)cesk_object_classpath(value->pointer.object);
+		}
+		/* insert the element, and keep the level sorted and unique */
+		uint32_t i;
+		for(i = begin; i < key->size && key->elem[i] < elem; i ++);
+		if(i < key->size && key->elem[i] == elem) continue;
+		if(key->size == CESK_POLICY_KEY_SIZE) continue;
+		memmove(key->elem + i + 1, key->elem + i, (key->size - i) * sizeof(uintptr_t));
+		key->elem[i] = elem;
+		key->size ++;
+	}
+}
+int cesk_policy_key(const dalvik_block_t* code, const cesk_frame_t* frame, const void* caller, cesk_policy_key_t* key)
+{
+	if(NULL == code || NULL == frame || NULL == key)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	key->policy = *cesk_policy_get(NULL == code->info ? NULL : code->info->class);
+	key->size = 0;
+	uint32_t level = 0;
+	switch(key->policy.type)
+	{
+		case CESK_POLICY_FULL:
+			break;
+		case CESK_POLICY_CALLSITE:
+			for(; NULL != caller && level < key->policy.k; caller = cesk_method_context_get_caller_context(caller), level ++)
+				_cesk_policy_key_append(key, (uintptr_t)cesk_method_context_get_current_block(caller));
+			break;
+		case CESK_POLICY_OBJECT:
+		case CESK_POLICY_TYPE:
+			if(NULL != code->info)
+			{
+				int reg = _cesk_policy_receiver_reg(code, frame);
+				if(reg >= 0)
+				{
+					_cesk_policy_key_append_receiver(key, key->policy.type, frame, reg);
+					_cesk_policy_key_append(key, CESK_POLICY_KEY_SEPARATOR);
+					level ++;
+				}
+			}
+			/* then the enclosing contexts, a static method inherits the context of the caller */
+			if(NULL != caller && level < key->policy.k)
+			{
+				const cesk_policy_key_t* caller_key = cesk_method_context_get_policy_key(caller);
+				uint32_t i;
+				if(NULL != caller_key && caller_key->policy.type == key->policy.type)
+					for(i = 0; i < caller_key->size && level < key->policy.k; i ++)
+					{
+						_cesk_policy_key_append(key, caller_key->elem[i]);
+						if(CESK_POLICY_KEY_SEPARATOR == caller_key->elem[i]) level ++;
+					}
+			}
+			break;
+		default:
+			LOG_ERROR("unknown policy %u", key->policy.type);
+			return -1;
+	}
+	return 0;
+}
+hashval_t cesk_policy_key_hashcode(const cesk_policy_key_t* key)
+{
+	hashval_t ret = key->policy.type * MH_MULTIPLY + key->policy.k;
+	uint32_t i;
+	for(i = 0; i < key->size; i ++)
+		ret = ret * MH_MULTIPLY + (hashval_t)(key->elem[i] ^ (((uint64_t)key->elem[i]) >> 32));
+	return ret;
+}
+int cesk_policy_key_equal(const cesk_policy_key_t* first, const cesk_policy_key_t* second)
+{
+	if(first->policy.type != second->policy.type || first->policy.k != second->policy.k) return 0;
+	if(first->size != second->size) return 0;
+	return 0 == memcmp(first->elem, second->elem, first->size * sizeof(uintptr_t));
+}
+const char* cesk_policy_to_string(const cesk_policy_t* policy, char* buf, size_t sz)
+{
+	static char _buf[32];
+	if(NULL == buf)
+	{
+		buf = _buf;
+		sz = sizeof(_buf);
+	}
+	if(NULL == policy || policy->type >= CESK_POLICY_NUM_OF_TYPES) snprintf(buf, sz, "(invalid)");
+	else if(CESK_POLICY_FULL == policy->type) snprintf(buf, sz, "%s", _cesk_policy_name[policy->type]);
+	else snprintf(buf, sz, "%s:%u", _cesk_policy_name[policy->type], policy->k);
+	return buf;
+}
+void cesk_policy_dump(FILE* fp)
+{
+	fprintf(fp, "default: %s\n", cesk_policy_to_string(&_cesk_policy_default, NULL, 0));
+	const _cesk_policy_rule_t* rule;
+	for(rule = _cesk_policy_rules; NULL != rule; rule = rule->next)
+		fprintf(fp, "%s*: %s\n", rule->prefix, cesk_policy_to_string(&rule->policy, NULL, 0));
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <log.h>
+#include <perf.h>
 #include <const_assertion.h>
 #include <cesk/cesk_set.h>
 #include <tag/tag_set.h>
@@ -124,6 +125,7 @@ static inline cesk_set_node_t* _cesk_set_node_alloc(int type)
 			return NULL;
 	}
 	cesk_set_node_t* ret = (cesk_set_node_t*)malloc(size);
+	PERF_ALLOC(PERF_ALLOC_SET, size);
 	if(NULL == ret)
 	{
 		LOG_ERROR("can not allocate memory for node");
@@ -275,6 +277,7 @@ cesk_set_t* cesk_set_fork(const cesk_set_t* sour)
 		return NULL;
 	}
 	cesk_set_t* ret = (cesk_set_t*)malloc(sizeof(cesk_set_t));
+	PERF_ALLOC(PERF_ALLOC_SET, sizeof(cesk_set_t));
 	if(NULL == ret) return NULL;
 	/* set the set index */
 	ret->set_idx = sour->set_idx;
@@ -286,6 +289,7 @@ cesk_set_t* cesk_set_fork(const cesk_set_t* sour)
 cesk_set_t* cesk_set_empty_set()
 {
 	cesk_set_t* ret = (cesk_set_t*)malloc(sizeof(cesk_set_t));
+	PERF_ALLOC(PERF_ALLOC_SET, sizeof(cesk_set_t));
 	if(NULL == ret) return NULL;
 
 	ret->set_idx = _cesk_empty_set->set_idx;
@@ -3,8 +3,10 @@
 #include <stdio.h>
 
 #include <log.h>
+#include <perf.h>
 
 #include <cesk/cesk_store.h>
+#include <cesk/cesk_arithmetic.h>
 
 #define HASH_INC(addr,val,reuse) ((addr * MH_MULTIPLY + cesk_value_hashcode(val))^((reuse) * ~MH_MULTIPLY))
 #define HASH_CMP(addr,val,reuse) ((addr * MH_MULTIPLY + cesk_value_compute_hashcode(val))^((reuse) * ~MH_MULTIPLY))
@@ -17,6 +19,7 @@ static inline cesk_store_block_t* _cesk_store_block_duplicate(cesk_store_block_t
 {
 	/* copy the store block */
 	cesk_store_block_t* new_block = (cesk_store_block_t*)malloc(CESK_STORE_BLOCK_SIZE);
+	PERF_ALLOC(PERF_ALLOC_STORE, CESK_STORE_BLOCK_SIZE);
 	if(NULL == new_block) 
 	{
 		LOG_ERROR("can not allocate memory for new block");
@@ -175,6 +178,7 @@ static inline cesk_store_block_t* _cesk_store_getblock_rw(cesk_store_t* store, u
 cesk_store_t* cesk_store_empty_store()
 {
    cesk_store_t* ret = (cesk_store_t*)malloc(sizeof(cesk_store_t));
+   PERF_ALLOC(PERF_ALLOC_STORE, sizeof(cesk_store_t));
    if(NULL == ret)
    {
 	   LOG_ERROR("can not allocate memory for empty store");
@@ -374,6 +378,7 @@ cesk_store_t* cesk_store_fork(const cesk_store_t* store)
 	size_t size = sizeof(cesk_store_t);
 	size_t block_size = sizeof(cesk_store_block_t*) * store->nblocks;
 	cesk_store_t* ret = (cesk_store_t*)malloc(size);
+	PERF_ALLOC(PERF_ALLOC_STORE, size);
 	if(NULL == ret)
 	{
 		LOG_ERROR("can not allocate memory for new store");
@@ -385,6 +390,7 @@ cesk_store_t* cesk_store_fork(const cesk_store_t* store)
 	if(ret->nblocks > 0)
 	{
 		cesk_store_block_t** blocks = (cesk_store_block_t**)malloc(block_size);
+		PERF_ALLOC(PERF_ALLOC_STORE, block_size);
 		memcpy(blocks, store->blocks, block_size);
 		ret->blocks = blocks;
 	}
@@ -458,6 +464,24 @@ int cesk_store_get_reuse(const cesk_store_t* store, uint32_t addr)
 	}
 	return block->slots[offset].reuse;
 }
+const cesk_alloc_param_t* cesk_store_get_alloc_param(const cesk_store_t* store, uint32_t addr)
+{
+	if(CESK_STORE_ADDR_NULL == (addr = _cesk_store_make_object_address(store, addr))) return NULL;
+	uint32_t block_idx = addr / CESK_STORE_BLOCK_NSLOTS;
+	uint32_t offset    = addr % CESK_STORE_BLOCK_NSLOTS;
+	if(block_idx >= store->nblocks)
+	{
+		LOG_ERROR("out of memory");
+		return NULL;
+	}
+	const cesk_store_block_t* block = store->blocks[block_idx];
+	if(NULL == block)
+	{
+		LOG_ERROR("ooops, this should not happen");
+		return NULL;
+	}
+	return &block->slots[offset].param;
+}
 int cesk_store_set_reuse(cesk_store_t* store, uint32_t addr)
 {
 	if(CESK_STORE_ADDR_NULL == (addr = _cesk_store_make_object_address(store, addr))) return -1;
@@ -648,6 +672,7 @@ uint32_t cesk_store_allocate(cesk_store_t* store, const cesk_alloc_param_t* para
 			blocks = (cesk_store_block_t**)realloc(store->blocks , sizeof(cesk_store_block_t*) * (store->nblocks + 1));
 		else
 			blocks = (cesk_store_block_t**)malloc(sizeof(cesk_store_block_t*));
+		PERF_ALLOC(PERF_ALLOC_STORE, sizeof(cesk_store_block_t*));
 		//store = realloc(store, sizeof(cesk_store_t) + sizeof(cesk_store_block_t*) * (store->nblocks + 1));
 		if(NULL == blocks)
 		{
@@ -657,6 +682,7 @@ uint32_t cesk_store_allocate(cesk_store_t* store, const cesk_alloc_param_t* para
 		store->blocks = blocks;
 		//(*p_store) = store;
 		store->blocks[store->nblocks] = (cesk_store_block_t*)malloc(CESK_STORE_BLOCK_SIZE);
+		PERF_ALLOC(PERF_ALLOC_STORE, CESK_STORE_BLOCK_SIZE);
 		if(NULL ==  store->blocks[store->nblocks])
 		{
 			LOG_ERROR("can not allocate a new page for the block");
@@ -856,7 +882,7 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand)
 		LOG_ERROR("can not create a value from a non-constant operand");
 		return CESK_STORE_ADDR_NULL;
 	}
-	int intval = 0;
+	int64_t intval = 0;
 	switch(operand->header.info.type)
 	{
 		case DVM_OPERAND_TYPE_LONG:
@@ -878,7 +904,7 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand)
 			intval = 1;
 		else 
 			intval = 0;
-		goto num;
+		goto sign;
 		case DVM_OPERAND_TYPE_FLOAT:
 		if(operand->payload.real32 < -1e-20)
 			intval = -1;
@@ -886,10 +912,13 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand)
 			intval = 1;
 		else 
 			intval = 0;
-		goto num;
+		goto sign;
 		case DVM_OPERAND_TYPE_CHAR:
 		intval = operand->payload.int8;
 num:
+		/* the integral value might be refined by the numeric domain */
+		return cesk_arithmetic_const(intval);
+sign:
 		if(intval > 0)
 			return CESK_STORE_ADDR_POS;
 		else if(intval < 0)
@@ -4,6 +4,7 @@
  **/
 #include <stdio.h>
 #include <log.h>
+#include <perf.h>
 #include <cesk/cesk_value.h>
 #include <dalvik/dalvik_instruction.h>
 
@@ -21,6 +22,7 @@ static cesk_value_t*  _cesk_value_list = NULL;
 static inline cesk_value_t* _cesk_value_alloc(uint32_t type)
 {
 	cesk_value_t* ret = (cesk_value_t*)malloc(sizeof(cesk_value_t));
+	PERF_ALLOC(PERF_ALLOC_VALUE, sizeof(cesk_value_t));
 	if(NULL == ret) return NULL;
 	ret->type = type;
 	ret->refcnt = 0;
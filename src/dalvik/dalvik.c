@@ -5,6 +5,11 @@
 int dalvik_static_field_count = 0;
 int dalvik_init(void)
 {
+	if(dalvik_loader_init() < 0)
+	{
+		LOG_ERROR("can not initialize dalvik_loader.c");
+		return -1;
+	}
 	if(dalvik_instruction_init() < 0)
 	{
 		LOG_ERROR("can not initialize dalvik_instruction.c");
@@ -25,6 +30,11 @@ int dalvik_init(void)
 		LOG_ERROR("can not intialize dalvik_type.c");
 		return -1;
 	}
+	if(dalvik_hierarchy_init() < 0)
+	{
+		LOG_ERROR("can not intialize dalvik_hierarchy.c");
+		return -1;
+	}
 	if(dalvik_memberdict_init() < 0)
 	{
 		LOG_ERROR("can not intialize dalvik_memberdict.c");
@@ -35,6 +45,16 @@ int dalvik_init(void)
 		LOG_ERROR("can not intialize dalvik_exception.c");
 		return -1;
 	}
+	if(dalvik_prepass_init() < 0)
+	{
+		LOG_ERROR("can not initialize dalvik_prepass.c");
+		return -1;
+	}
+	if(dalvik_liveness_init() < 0)
+	{
+		LOG_ERROR("can not initialize dalvik_liveness.c");
+		return -1;
+	}
 	if(dalvik_block_init() < 0)
 	{
 		LOG_ERROR("can not initialize dalvik_block.c");
@@ -45,9 +65,13 @@ int dalvik_init(void)
 void dalvik_finalize(void)
 {
 	dalvik_block_finalize();
+	dalvik_liveness_finalize();
+	dalvik_prepass_finalize();
 	dalvik_exception_finalize();
 	dalvik_memberdict_finalize();
+	dalvik_hierarchy_finalize();
 	dalvik_instruction_finalize();
 	dalvik_label_finalize();
 	dalvik_type_finalize();
+	dalvik_loader_finalize();
 }
@@ -5,11 +5,17 @@
 #include <string.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include <log.h>
 #include <vector.h>
+#include <perf.h>
 
 #include <dalvik/dalvik_block.h>
+#include <dalvik/dalvik_loader.h>
+#include <dalvik/dalvik_prepass.h>
+#include <dalvik/dalvik_liveness.h>
 /** 
  * @brief The data struture for block cache 
  * @details For performance reseason, we store the result of 
@@ -27,16 +33,32 @@ typedef struct _dalvik_block_cache_node_t{
 	const char*     classpath;		/*!<the class path contains this method */
 	const dalvik_type_t * const * typelist; /*!<excepted type of arguments */
 	const dalvik_type_t* returntype; /*!< the return type of the function */
+	size_t          nblocks;    /*!<the number of block indices in the graph */
 	dalvik_block_t* block;	/*!<the analysis result. */
+	uint32_t*       liveness;   /*!<the memory of the liveness bitmaps of all the blocks in the graph */
+	void*           compact;    /*!<the memory of the compact encoding of all the blocks in the graph */
 	struct _dalvik_block_cache_node_t * next; /*!<the next pointer used in hash table */
 } dalvik_block_cache_node_t;
 CONST_ASSERTION_FIRST(dalvik_block_cache_node_t, methodname);
 CONST_ASSERTION_FOLLOWS(dalvik_block_cache_node_t, methodname, classpath);
 CONST_ASSERTION_FOLLOWS(dalvik_block_cache_node_t, classpath, typelist);
 CONST_ASSERTION_FOLLOWS(dalvik_block_cache_node_t, typelist, returntype);
+CONST_ASSERTION_FOLLOWS(dalvik_block_cache_node_t, returntype, nblocks);
 
 static dalvik_block_cache_node_t* _dalvik_block_cache[DALVIK_BLOCK_CACHE_SIZE];
 
+/** @brief the root of the class hierarchy, which is a built-in class */
+static const char* _dalvik_block_root;
+
+int dalvik_block_loop_info_enabled = 0;
+
+/** @brief the exception dispatch table shared by all the blocks without exception handler */
+static const dalvik_block_exception_table_t _dalvik_block_exception_table_empty = {
+	.nentries = 0,
+	.catch_all = DALVIK_BLOCK_INDEX_INVALID,
+	.catch_all_order = DALVIK_BLOCK_INDEX_INVALID
+};
+
 /** 
  * @brief allocate a hash table node reference a given block 
  * @param class the class path of the method 
@@ -64,6 +86,9 @@ static inline dalvik_block_cache_node_t* _dalvik_block_cache_node_alloc(
 	ret->returntype = dalvik_type_clone(type);
 	ret->methodname = method;
 	ret->classpath = class;
+	ret->nblocks = 0;
+	ret->liveness = NULL;
+	ret->compact = NULL;
 	ret->next = NULL;
 	return ret;
 }
@@ -77,6 +102,8 @@ static inline void _dalvik_block_cache_node_free(dalvik_block_cache_node_t* bloc
 	if(NULL == block) return;
 	if(block->typelist != NULL) dalvik_type_list_free((dalvik_type_t**)block->typelist); 
 	if(block->returntype != NULL) dalvik_type_free((dalvik_type_t*)block->returntype);
+	if(block->liveness != NULL) free(block->liveness);
+	if(block->compact != NULL) free(block->compact);
 	free(block);
 }
 /**
@@ -145,6 +172,12 @@ static inline hashval_t _dalvik_block_hash(const char* class, const char* method
 int dalvik_block_init()
 {
 	memset(_dalvik_block_cache, 0, sizeof(_dalvik_block_cache));
+	dalvik_block_loop_info_enabled = 0;
+	if(NULL == (_dalvik_block_root = stringpool_query("java/lang/Object")))
+	{
+		LOG_ERROR("can not query the class path of the root class");
+		return -1;
+	}
 	return 0;
 }
 /**
@@ -167,6 +200,7 @@ void dalvik_block_finalize()
 			_dalvik_block_cache_node_free(tmp);
 		}
 	}
+	dalvik_block_loop_info_enabled = 0;
 }
 /**
  * @brief Sort the instruction by the offset. this order is equavalient to the 
@@ -180,6 +214,30 @@ static int _dalvik_block_key_comp(const void* this, const void* that)
 {
 	return (*(int*)this) - (*(int*)that);
 }
+/**
+ * @brief double the size of the key instruction array
+ * @param buf the buffer on the stack
+ * @param p_key the key instruction array, which is updated to the new array
+ * @param p_size the size of the array, which is updated to the new size
+ * @return the new array, NULL indicates an error
+ **/
+static inline uint32_t* _dalvik_block_key_grow(uint32_t* buf, uint32_t** p_key, size_t* p_size)
+{
+	uint32_t* key;
+	if(*p_key == buf)
+	{
+		/* the first time we run out of the stack buffer, move to the heap */
+		if(NULL != (key = (uint32_t*)malloc(sizeof(uint32_t) * *p_size * 2)))
+			memcpy(key, buf, sizeof(uint32_t) * *p_size);
+	}
+	else
+		key = (uint32_t*)realloc(*p_key, sizeof(uint32_t) * *p_size * 2);
+	if(NULL == key) return NULL;
+	LOG_DEBUG("the key instruction list grows from %zu to %zu", *p_size, *p_size * 2);
+	*p_key = key;
+	*p_size *= 2;
+	return key;
+}
 /**
  * @brief Tranverse all instructions in this method, figure out which is key instruction that we really take care
  * and return the offset of the address in the array.
@@ -193,13 +251,18 @@ static int _dalvik_block_key_comp(const void* this, const void* that)
  * 	   Actually, key instruction is the last instruction in each basic block 
  *
  * @param entry_point the entry point of this function
- * @param key the memory used to store the key instructions
- * @param size the memory size in how many number of int32_t.
+ * @param buf the buffer on the stack used to store the key instructions
+ * @param p_key the buffer used to return the key instruction array, which is either buf or 
+ *        a heap buffer if there are more than size key instructions. The heap buffer should
+ *        be freed by the caller, even if the function fails
+ * @param p_size the size of the key instruction array in how many number of uint32_t
  * @return the number of key instructions, < 0 indicates an error
  **/
-static inline int _dalvik_block_get_key_instruction_list(uint32_t entry_point, uint32_t* key, size_t size)
+static inline int _dalvik_block_get_key_instruction_list(uint32_t entry_point, uint32_t* buf, uint32_t** p_key, size_t* p_size)
 {
 	uint32_t kcnt = 0;
+	uint32_t* key = buf;
+	*p_key = buf;
 	uint32_t inst;
 	const dalvik_instruction_t * current_inst = NULL;
 /* using this we can push an instruction to the key instruction list */
@@ -211,10 +274,13 @@ static inline int _dalvik_block_get_key_instruction_list(uint32_t entry_point, u
 	}\
 	else\
 	{\
-		if(kcnt >= size)\
+		if(kcnt >= *p_size)\
 		{\
-			LOG_ERROR("excepting %zu key instructions, got more than that. Try to adjust constant DALVIK_BLOCK_MAX_KEYS", size);\
-			return 0;\
+			if(NULL == (key = _dalvik_block_key_grow(buf, p_key, p_size)))\
+			{\
+				LOG_ERROR("can not grow the key instruction list to %zu elements", *p_size * 2);\
+				return -1;\
+			}\
 		}\
 		key[kcnt ++] = tmp;\
 		LOG_DEBUG("add a new key instruction #%d", key[kcnt-1]);\
@@ -343,8 +409,40 @@ static inline dalvik_block_t* _dalvik_block_new(size_t nbranches)
 	if(NULL == ret) return NULL;
 	memset(ret, 0, size);
 	ret->nbranches = nbranches;
+	ret->handlers = &_dalvik_block_exception_table_empty;
 	return ret;
 }
+/**
+ * @brief allocate a new code block with nbranches, and the exception dispatch table follows the branches
+ *        in the same memory, so that the table is freed with the block
+ * @param nbranches the number of branches that this block have
+ * @param nentries the number of entries in the exception dispatch table
+ * @return the newly created block, the table is empty
+ **/
+static inline dalvik_block_t* _dalvik_block_new_with_handlers(size_t nbranches, size_t nentries)
+{
+	size_t bsize = sizeof(dalvik_block_t) + sizeof(dalvik_block_branch_t) * nbranches;
+	size_t size = bsize + sizeof(dalvik_block_exception_table_t) + sizeof(dalvik_block_exception_entry_t) * nentries;
+	dalvik_block_t* ret = (dalvik_block_t*)malloc(size);
+	if(NULL == ret) return NULL;
+	memset(ret, 0, size);
+	ret->nbranches = nbranches;
+	dalvik_block_exception_table_t* table = (dalvik_block_exception_table_t*)(((char*)ret) + bsize);
+	table->catch_all = table->catch_all_order = DALVIK_BLOCK_INDEX_INVALID;
+	ret->handlers = table;
+	return ret;
+}
+/**
+ * @brief the compare function used to sort the exception dispatch table
+ **/
+static int _dalvik_block_exception_entry_comp(const void* this, const void* that)
+{
+	const dalvik_block_exception_entry_t* left = (const dalvik_block_exception_entry_t*)this;
+	const dalvik_block_exception_entry_t* right = (const dalvik_block_exception_entry_t*)that;
+	if(left->exception < right->exception) return -1;
+	if(left->exception > right->exception) return 1;
+	return (left->order < right->order) ? -1 : (left->order > right->order);
+}
 /** 
  * @brief find the block id using the instruction id
  * @param inst the instruction id
@@ -436,10 +534,12 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst_if(const dalvik_instru
 	   inst->flags == DVM_FLAG_IF_GE)
 		block->branches[0].eq = 1;
 	if(inst->flags == DVM_FLAG_IF_LE ||
-	   inst->flags == DVM_FLAG_IF_LT)
+	   inst->flags == DVM_FLAG_IF_LT ||
+	   inst->flags == DVM_FLAG_IF_NE)
 		block->branches[0].lt = 1;
 	if(inst->flags == DVM_FLAG_IF_GE ||
-	   inst->flags == DVM_FLAG_IF_GT)
+	   inst->flags == DVM_FLAG_IF_GT ||
+	   inst->flags == DVM_FLAG_IF_NE)
 		block->branches[0].gt = 1;
 	
 	LOG_DEBUG("possible path block %d --> %"PRIuPTR,  index, block->branches[0].block_id[0]);
@@ -480,7 +580,13 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst_switch(const dalvik_in
 			block->branches[j].eq = 1;
 			LOG_DEBUG("possible path block %d --> %"PRIuPTR, index, block->branches[j].block_id[0]);
 		}
+		/* the last label is the default branch, which is an unconditional jump */
 		block->branches[nb-1].conditional = 0;
+		block->branches[nb-1].left_inst = 0;
+		block->branches[nb-1].eq = 0;
+		block->branches[nb-1].left = NULL;
+		block->branches[nb-1].right = NULL;
+		DALVIK_BLOCK_BRANCH_UNCOND_TYPE_SET_JUMP(block->branches[nb-1]);
 	}
 	else if(DVM_FLAG_SWITCH_SPARSE == inst->flags)
 	{
@@ -539,7 +645,8 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst(const dalvik_instructi
 	dalvik_exception_handler_set_t* hptr;
 	for(hptr = inst->handler_set; NULL != hptr; hptr = hptr->next, branch_count ++);
 
-	dalvik_block_t* block = _dalvik_block_new(branch_count);  /* only 1 path is possible, but there might be expcetion handlers */
+	/* only 1 path is possible, but there might be expcetion handlers */
+	dalvik_block_t* block = (branch_count > 1) ? _dalvik_block_new_with_handlers(branch_count, branch_count - 1) : _dalvik_block_new(branch_count);
 	if(NULL == block)
 	{
 		LOG_ERROR("can not allocate memory for the instruction");
@@ -571,6 +678,34 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst(const dalvik_instructi
 		block->branches[i].handler[0] = hptr->handler->handler_label;
 		DALVIK_BLOCK_BRANCH_UNCOND_TYPE_SET_EXCEPTION(block->branches[i]);
 	}
+	if(branch_count > 1)
+	{
+		/* build the exception dispatch table, only the first handler for each exception class is kept */
+		dalvik_block_exception_table_t* table = (dalvik_block_exception_table_t*)block->handlers;
+		for(i = 1; i < branch_count; i ++)
+		{
+			if(block->branches[i].disabled || !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_EXCEPTION(block->branches[i])) continue;
+			if(NULL == block->branches[i].exception[0])
+			{
+				if(DALVIK_BLOCK_INDEX_INVALID == table->catch_all)
+				{
+					table->catch_all = i;
+					table->catch_all_order = i - 1;
+				}
+				continue;
+			}
+			table->entries[table->nentries].exception = block->branches[i].exception[0];
+			table->entries[table->nentries].order = i - 1;
+			table->entries[table->nentries].branch = i;
+			table->nentries ++;
+		}
+		qsort(table->entries, table->nentries, sizeof(dalvik_block_exception_entry_t), _dalvik_block_exception_entry_comp);
+		uint32_t j, n = 0;
+		for(j = 0; j < table->nentries; j ++)
+			if(0 == n || table->entries[n - 1].exception != table->entries[j].exception)
+				table->entries[n ++] = table->entries[j];
+		table->nentries = n;
+	}
 	return block;
 }
 /**
@@ -655,72 +790,237 @@ static inline int _dalvik_block_build_graph(uint32_t entry, dalvik_block_t** blo
 	return 0;
 ERROR:
 	for(i = 0; i < kcnt; i ++)
-		if(blocks[i] == NULL)
+		if(blocks[i] != NULL)
 			free(blocks[i]);
 	return -1;
 }
 /**
- * @brief DFS the block graph so that we can determine the reachability for each block
- * @param block the block graph
- * @param visit_status the result of this BFS, 1 means it's reachable
- * @return nothing
+ * @brief check if the branch leads to another block in the graph
+ * @param branch the branch
+ * @return the result
  **/
-static void inline _dalvik_block_graph_dfs(const dalvik_block_t * block, uint32_t* visit_status)
+static inline int _dalvik_block_branch_is_edge(const dalvik_block_branch_t* branch)
 {
-	if(NULL == block) return;
-	if(visit_status[block->index] == 1) return;  /*visited*/
-	visit_status[block->index] = 1;
-	int i;
-	for(i = 0; i < block->nbranches; i ++)
-		if(!block->branches[i].disabled && !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(block->branches[i]))
-			_dalvik_block_graph_dfs(block->branches[i].block, visit_status);  
+	return !branch->disabled && !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch) && NULL != branch->block;
 }
-dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* methodname, const dalvik_type_t * const * typelist, const dalvik_type_t* rtype)
+/**
+ * @brief find the nearest common dominator of two blocks
+ * @param a the index of the first block
+ * @param b the index of the second block
+ * @param idom the immediate dominator array
+ * @param rpo the reverse post-order number array
+ * @return the index of the common dominator
+ **/
+static inline uint32_t _dalvik_block_dom_intersect(uint32_t a, uint32_t b, const uint32_t* idom, const uint32_t* rpo)
 {
-	if(NULL == classpath || NULL == methodname)
+	while(a != b)
 	{
-		LOG_ERROR("class path and method name can not be NULL");
-		return NULL;
+		while(rpo[a] > rpo[b]) a = idom[a];
+		while(rpo[b] > rpo[a]) b = idom[b];
 	}
-	LOG_DEBUG("get block graph of method %s/%s", classpath, methodname);
-	hashval_t h = _dalvik_block_hash(classpath, methodname, typelist, rtype) % DALVIK_BLOCK_CACHE_SIZE;
-	/* try to find the block graph in the cache */
-	dalvik_block_cache_node_t* p;
-	for(p = _dalvik_block_cache[h]; NULL != p; p = p->next)
+	return a;
+}
+/**
+ * @brief compute the reverse post-order, the dominator tree and the loop nesting of a linked block graph
+ * @details the dominator tree and the loop nesting are only computed if dalvik_block_loop_info_enabled is set,
+ *          otherwise idom is DALVIK_BLOCK_INDEX_INVALID and loop_depth is 0 for every reachable block.
+ *          The dominator tree is computed with the iterative algorithm by Cooper, Harvey and Kennedy.
+ *          A branch to a block that dominates the source block is a back edge, and the natural loop of
+ *          the back edge is all the blocks that reach the source without passing the loop header.
+ *          The graph is traversed with explicit stacks, so that a huge method does not overflow the
+ *          system stack
+ * @param blocks the block array, only the blocks reachable from blocks[0] is considered
+ * @param kcnt the size of the block array
+ * @param reachable the buffer used to return the reachability of each block, 1 means it's reachable
+ * @return < 0 indicates an error
+ **/
+static inline int _dalvik_block_graph_analyze(dalvik_block_t** blocks, uint32_t kcnt, uint32_t* reachable)
+{
+	int ret = -1;
+	uint32_t i, j, k;
+	/* stack, next, order, rpo, idom, mark, pred_begin (kcnt + 1) */
+	uint32_t* mem = (uint32_t*)malloc(sizeof(uint32_t) * (7 * kcnt + 1));
+	uint32_t* preds = NULL;
+	if(NULL == mem)
 	{
-		if(p->methodname == methodname &&
-		   p->classpath  == classpath &&
-		   dalvik_type_list_equal(typelist, p->typelist))
+		LOG_ERROR("can not allocate memory for the graph analysis");
+		return -1;
+	}
+	uint32_t* stack = mem;
+	uint32_t* next  = stack + kcnt;
+	uint32_t* order = next + kcnt;
+	uint32_t* rpo   = order + kcnt;
+	uint32_t* idom  = rpo + kcnt;
+	uint32_t* mark  = idom + kcnt;
+	uint32_t* pred_begin = mark + kcnt;
+	/* Step 1: post-order DFS, the post-order is stored in the tail of the order array reversely */
+	for(i = 0; i < kcnt; i ++)
+		rpo[i] = idom[i] = mark[i] = DALVIK_BLOCK_INDEX_INVALID;
+	uint32_t sp = 0, n = kcnt;
+	stack[sp ++] = 0;
+	next[0] = 0;
+	rpo[0] = 0;    /* mark visited */
+	while(sp > 0)
+	{
+		uint32_t b = stack[sp - 1];
+		if(next[b] < blocks[b]->nbranches)
 		{
-			LOG_DEBUG("found the block graph in cache");
-			return p->block;
+			const dalvik_block_branch_t* branch = blocks[b]->branches + (next[b] ++);
+			if(!_dalvik_block_branch_is_edge(branch)) continue;
+			uint32_t t = branch->block->index;
+			if(DALVIK_BLOCK_INDEX_INVALID != rpo[t]) continue;
+			rpo[t] = 0;
+			next[t] = 0;
+			stack[sp ++] = t;
 		}
+		else
+			order[-- n] = stack[-- sp];
 	}
-	/* there's no graph for this method in the cache, genterate one */
-	const dalvik_method_t* method = dalvik_memberdict_get_method(classpath, methodname, typelist, rtype);
-	if(NULL == method) 
+	/* move the reverse post-order to the beginning of the array */
+	uint32_t nreach = kcnt - n;
+	memmove(order, order + n, sizeof(uint32_t) * nreach);
+	memset(reachable, 0, sizeof(uint32_t) * kcnt);
+	for(i = 0; i < nreach; i ++)
 	{
-		LOG_DEBUG("can not find method %s/%s", classpath, methodname);
-		return NULL;
+		rpo[order[i]] = blocks[order[i]]->rpo = i;
+		blocks[order[i]]->idom = DALVIK_BLOCK_INDEX_INVALID;
+		blocks[order[i]]->loop_depth = 0;
+		blocks[order[i]]->loop_header = 0;
+		reachable[order[i]] = 1;
 	}
-	LOG_DEBUG("find method %s/%s, entry point@%d", classpath, methodname, method->entry);
-
-	uint32_t key[DALVIK_BLOCK_MAX_KEYS];     /* the maximum key instruction we are expecting */
-	dalvik_block_t* blocks[DALVIK_BLOCK_MAX_KEYS] = {}; /* block list */ 
+	if(!dalvik_block_loop_info_enabled)
+	{
+		ret = 0;
+		goto ERR;
+	}
+	/* Step 2: the predecessor lists (CSR) */
+	memset(pred_begin, 0, sizeof(uint32_t) * (kcnt + 1));
+	for(k = 0; k < nreach; k ++)
+	{
+		const dalvik_block_t* block = blocks[order[k]];
+		for(j = 0; j < block->nbranches; j ++)
+			if(_dalvik_block_branch_is_edge(block->branches + j))
+				pred_begin[block->branches[j].block->index + 1] ++;
+	}
+	for(i = 0; i < kcnt; i ++)
+		pred_begin[i + 1] += pred_begin[i];
+	if(pred_begin[kcnt] > 0 && NULL == (preds = (uint32_t*)malloc(sizeof(uint32_t) * pred_begin[kcnt])))
+	{
+		LOG_ERROR("can not allocate memory for the predecessor lists");
+		goto ERR;
+	}
+	memcpy(next, pred_begin, sizeof(uint32_t) * kcnt);
+	for(k = 0; k < nreach; k ++)
+	{
+		const dalvik_block_t* block = blocks[order[k]];
+		for(j = 0; j < block->nbranches; j ++)
+			if(_dalvik_block_branch_is_edge(block->branches + j))
+				preds[next[block->branches[j].block->index] ++] = block->index;
+	}
+	/* Step 3: the dominator tree */
+	idom[0] = 0;
+	int changed = 1;
+	while(changed)
+	{
+		changed = 0;
+		for(k = 1; k < nreach; k ++)
+		{
+			uint32_t b = order[k];
+			uint32_t new_idom = DALVIK_BLOCK_INDEX_INVALID;
+			for(j = pred_begin[b]; j < pred_begin[b + 1]; j ++)
+			{
+				uint32_t p = preds[j];
+				if(DALVIK_BLOCK_INDEX_INVALID == idom[p]) continue;
+				new_idom = (DALVIK_BLOCK_INDEX_INVALID == new_idom) ? p : _dalvik_block_dom_intersect(p, new_idom, idom, rpo);
+			}
+			if(idom[b] != new_idom)
+			{
+				idom[b] = new_idom;
+				changed = 1;
+			}
+		}
+	}
+	for(k = 0; k < nreach; k ++)
+		blocks[order[k]]->idom = idom[order[k]];
+	/* Step 4: the natural loops, all the back edges to the same header forms one loop */
+	for(k = 0; k < nreach; k ++)
+	{
+		uint32_t h = order[k];
+		int is_header = 0;
+		sp = 0;
+		mark[h] = h;
+		for(j = pred_begin[h]; j < pred_begin[h + 1]; j ++)
+		{
+			uint32_t p = preds[j];
+			/* is (p, h) a back edge, i.e. h dominates p ? */
+			uint32_t x;
+			for(x = p; x != h && x != 0; x = idom[x]);
+			if(x != h) continue;
+			is_header = 1;
+			if(mark[p] == h) continue;
+			mark[p] = h;
+			stack[sp ++] = p;
+		}
+		if(!is_header) continue;
+		LOG_DEBUG("block #%u is a loop header", h);
+		blocks[h]->loop_header = 1;
+		blocks[h]->loop_depth ++;
+		while(sp > 0)
+		{
+			uint32_t b = stack[-- sp];
+			blocks[b]->loop_depth ++;
+			for(j = pred_begin[b]; j < pred_begin[b + 1]; j ++)
+			{
+				uint32_t p = preds[j];
+				if(mark[p] == h) continue;
+				mark[p] = h;
+				stack[sp ++] = p;
+			}
+		}
+	}
+	ret = 0;
+ERR:
+	free(mem);
+	if(NULL != preds) free(preds);
+	return ret;
+}
+/**
+ * @brief build the block graph of a method
+ * @note this function does not touch any global state except the memory allocator, so that it can be 
+ *       called from multiple threads. The pre-pass reads the member dictionary, which is not changed once
+ *       all the classes are loaded
+ * @param method the method
+ * @param node the cache node for this graph, which is used as the info field of each block
+ * @return the entry block of the graph, NULL indicates an error
+ **/
+static inline dalvik_block_t* _dalvik_block_build(const dalvik_method_t* method, dalvik_block_cache_node_t* node)
+{
+	uint32_t key_buf[DALVIK_BLOCK_MAX_KEYS];     /* the key instructions, most of the methods fit in the stack */
+	dalvik_block_t* blocks_buf[DALVIK_BLOCK_MAX_KEYS] = {}; /* block list */ 
+	uint32_t* key = NULL;
+	dalvik_block_t** blocks = blocks_buf;
+	size_t size = DALVIK_BLOCK_MAX_KEYS;
+	dalvik_block_t* ret = NULL;
 	
 	/* Step 1: Scan the method, get a list of key instructions */
-	int32_t kcnt = _dalvik_block_get_key_instruction_list(method->entry, key, sizeof(key)/sizeof(*key));
+	int32_t kcnt = _dalvik_block_get_key_instruction_list(method->entry, key_buf, &key, &size);
 	if(kcnt < 0) 
 	{
 		LOG_ERROR("can not generate the key instruction list");
-		return NULL;
+		goto CLEANUP;
+	}
+	if(0 == kcnt) goto CLEANUP;
+	if(kcnt > DALVIK_BLOCK_MAX_KEYS && NULL == (blocks = (dalvik_block_t**)calloc(kcnt, sizeof(dalvik_block_t*))))
+	{
+		LOG_ERROR("can not allocate the block list for %d blocks", kcnt);
+		goto CLEANUP;
 	}
 	
 	/* Step 2: Bult the graph */
-	if(_dalvik_block_build_graph(method->entry, blocks, DALVIK_BLOCK_MAX_KEYS, key, kcnt) < 0)
+	if(_dalvik_block_build_graph(method->entry, blocks, kcnt, key, kcnt) < 0)
 	{
-		LOG_ERROR("can not build block graph for method %s/%s", classpath, methodname);
-		return NULL;
+		LOG_ERROR("can not build block graph for method %s/%s", method->path, method->name);
+		goto CLEANUP;
 	}
 
 	/* Step 3: Ok, link the program */
@@ -742,54 +1042,279 @@ dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* meth
 		}
 	}
 
-	/* Step 4: Reachablity check */
-	/* then, we delete all unreachable blocks */
+	/* Step 4: Disable the branches that can never be taken, the blocks only reachable from them are deleted below */
+	int npruned = dalvik_prepass_prune(blocks, kcnt, method->num_regs);
+	if(npruned < 0)
+		LOG_WARNING("the pre-pass failed on method %s/%s, no branch is pruned", method->path, method->name);
+	else if(npruned > 0)
+		LOG_DEBUG("%d infeasible branches are disabled in method %s/%s", npruned, method->path, method->name);
+
+	/* Step 5: Reachablity check, the dominator tree and the loops */
 	uint32_t* visit_flags = key;          /* here we reuse the memory for key to store the visit flags */
-	memset(key, 0, sizeof(key));
-	/* ok, DFS the graph */
-	_dalvik_block_graph_dfs(blocks[0], visit_flags);
-	
-	/* insert the block graph to the cache */
-	dalvik_block_cache_node_t* node = _dalvik_block_cache_node_alloc(classpath, methodname, typelist , rtype, blocks[0]);
-	if(NULL == node) 
+	if(_dalvik_block_graph_analyze(blocks, kcnt, visit_flags) < 0)
 	{
-		LOG_ERROR("can not allocte memory for cache node, the block is to be freed");
-		_dalvik_block_graph_free(blocks[0]);
-		return NULL;
+		LOG_ERROR("can not analyze the block graph for method %s/%s", method->path, method->name);
+		for(i = 0; i < kcnt; i ++)
+			free(blocks[i]);
+		goto CLEANUP;
 	}
 
-#if LOG_LEVEL >= 6
-	int block_cnt = 0;
-#endif
 	/* then, delete all block that never visited */
 	for(i = 0; i < kcnt; i ++)
 	{
 		LOG_DEBUG("block #%d@%p reachability = %d", blocks[i]->index, blocks[i], visit_flags[blocks[i]->index]);
-		if(blocks[i] != NULL && visit_flags[blocks[i]->index] == 0)
+		if(visit_flags[blocks[i]->index] == 0)
 		{
 			LOG_DEBUG("delete unreachable block %d", blocks[i]->index);
 			free(blocks[i]);
+			blocks[i] = NULL;
 		}
 		else
 		{
 			blocks[i]->nregs = method->num_regs;
 			*(void**)&blocks[i]->info = node;
-#if LOG_LEVEL >= 6
-			block_cnt ++;
-#endif
 		}
 	}
+	node->nblocks = kcnt;
+
+	/* Step 6: The registers live at the entry of each block, all the registers are live if it fails */
+	if(dalvik_liveness_compute(blocks, kcnt, method->num_regs, &node->liveness) < 0)
+		LOG_WARNING("can not compute the liveness of the registers in method %s/%s", method->path, method->name);
+
+	/* Step 7: Encode the instructions for the analyzer */
+	if(dalvik_compact_encode(blocks, kcnt, &node->compact) < 0)
+	{
+		LOG_ERROR("can not encode the instructions in method %s/%s", method->path, method->name);
+		for(i = 0; i < kcnt; i ++)
+			if(NULL != blocks[i]) free(blocks[i]);
+		goto CLEANUP;
+	}
+	ret = blocks[0];
+CLEANUP:
+	if(NULL != key && key != key_buf) free(key);
+	if(blocks != blocks_buf) free(blocks);
+	return ret;
+}
+dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* methodname, const dalvik_type_t * const * typelist, const dalvik_type_t* rtype)
+{
+	if(NULL == classpath || NULL == methodname)
+	{
+		LOG_ERROR("class path and method name can not be NULL");
+		return NULL;
+	}
+	LOG_DEBUG("get block graph of method %s/%s", classpath, methodname);
+	hashval_t h = _dalvik_block_hash(classpath, methodname, typelist, rtype) % DALVIK_BLOCK_CACHE_SIZE;
+	/* try to find the block graph in the cache */
+	dalvik_block_cache_node_t* p;
+	for(p = _dalvik_block_cache[h]; NULL != p; p = p->next)
+	{
+		if(p->methodname == methodname &&
+		   p->classpath  == classpath &&
+		   dalvik_type_list_equal(typelist, p->typelist))
+		{
+			LOG_DEBUG("found the block graph in cache");
+			PERF_INC(block_cache_hit);
+			return p->block;
+		}
+	}
+	/* there's no graph for this method in the cache, genterate one */
+	PERF_INC(block_cache_miss);
+	const dalvik_method_t* method = dalvik_memberdict_get_method(classpath, methodname, typelist, rtype);
+	if(NULL == method) 
+	{
+		LOG_DEBUG("can not find method %s/%s", classpath, methodname);
+		return NULL;
+	}
+	LOG_DEBUG("find method %s/%s, entry point@%d", classpath, methodname, method->entry);
+
+	dalvik_block_cache_node_t* node = _dalvik_block_cache_node_alloc(classpath, methodname, typelist , rtype, NULL);
+	if(NULL == node) 
+	{
+		LOG_ERROR("can not allocte memory for cache node");
+		return NULL;
+	}
+	node->block = _dalvik_block_build(method, node);
+	if(NULL == node->block)
+	{
+		LOG_ERROR("can not build the block graph for method %s/%s", classpath, methodname);
+		_dalvik_block_cache_node_free(node);
+		return NULL;
+	}
 
 	/* insert the result to cache and return */
 	node->next = _dalvik_block_cache[h];
 	_dalvik_block_cache[h] = node;
 
-	LOG_DEBUG("block graph for function %s/%s with type [%s] with return type %s has been cached (contains %d blocks)", 
+	LOG_DEBUG("block graph for function %s/%s with type [%s] with return type %s has been cached (contains %zu block slots)", 
 			   classpath,
 			   methodname,
 			   dalvik_type_list_to_string(typelist,NULL, 0),
 			   dalvik_type_to_string(rtype, NULL, 0),
-			   block_cnt);
-	return blocks[0];
+			   node->nblocks);
+	return node->block;
+}
+/**
+ * @brief the work list of a precomputing thread
+ **/
+typedef struct {
+	const dalvik_method_t**     methods;   /*!< all the methods to build */
+	dalvik_block_cache_node_t** nodes;     /*!< the cache nodes for the methods */
+	uint32_t                    count;     /*!< the number of methods */
+	uint32_t                    begin;     /*!< the first method this thread builds */
+	uint32_t                    step;      /*!< this thread builds method begin, begin + step, ... */
+} _dalvik_block_precompute_work_t;
+/**
+ * @brief the precomputing thread
+ * @param data the work list
+ * @return nothing
+ **/
+static void* _dalvik_block_precompute_thread(void* data)
+{
+	const _dalvik_block_precompute_work_t* work = (const _dalvik_block_precompute_work_t*)data;
+	uint32_t i;
+	for(i = work->begin; i < work->count; i += work->step)
+		work->nodes[i]->block = _dalvik_block_build(work->methods[i], work->nodes[i]);
+	return NULL;
+}
+int dalvik_block_precompute(int nthreads)
+{
+	int ret = -1;
+	uint32_t i, count = 0;
+	vector_t* methods = vector_new(sizeof(const dalvik_method_t*));
+	dalvik_block_cache_node_t** nodes = NULL;
+	const dalvik_method_t** todo = NULL;
+	if(NULL == methods)
+	{
+		LOG_ERROR("can not allocate the method list");
+		return -1;
+	}
+	if(dalvik_memberdict_get_methods(methods) < 0)
+	{
+		LOG_ERROR("can not get the method list");
+		goto CLEANUP;
+	}
+	size_t nmethods = vector_size(methods);
+	nodes = (dalvik_block_cache_node_t**)malloc(sizeof(dalvik_block_cache_node_t*) * (nmethods + 1));
+	todo = (const dalvik_method_t**)malloc(sizeof(const dalvik_method_t*) * (nmethods + 1));
+	if(NULL == nodes || NULL == todo)
+	{
+		LOG_ERROR("can not allocate the work list");
+		goto CLEANUP;
+	}
+	/* the cache nodes are allocated here, because the type lists are cloned */
+	for(i = 0; i < nmethods; i ++)
+	{
+		const dalvik_method_t* method = *(const dalvik_method_t**)vector_get(methods, i);
+		if(DALVIK_INSTRUCTION_INVALID == method->entry) continue;
+		hashval_t h = _dalvik_block_hash(method->path, method->name, method->args_type, method->return_type) % DALVIK_BLOCK_CACHE_SIZE;
+		const dalvik_block_cache_node_t* p;
+		for(p = _dalvik_block_cache[h]; NULL != p; p = p->next)
+			if(p->methodname == method->name && p->classpath == method->path && dalvik_type_list_equal(method->args_type, p->typelist))
+				break;
+		if(NULL != p) continue;
+		if(NULL == (nodes[count] = _dalvik_block_cache_node_alloc(method->path, method->name, method->args_type, method->return_type, NULL)))
+		{
+			LOG_ERROR("can not allocate cache node for method %s/%s", method->path, method->name);
+			goto CLEANUP;
+		}
+		todo[count ++] = method;
+	}
+	if(nthreads <= 0) nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if(nthreads > DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS) nthreads = DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS;
+	if(nthreads > count) nthreads = count;
+	if(nthreads <= 0) nthreads = 1;
+#if LOG_LEVEL >= 6
+	/* the debug messages use the static buffers of the to_string functions */
+	nthreads = 1;
+#endif
+	LOG_DEBUG("building %u block graphs with %d threads", count, nthreads);
+	pthread_t threads[DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS];
+	int started[DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS] = {};
+	_dalvik_block_precompute_work_t work[DALVIK_BLOCK_PRECOMPUTE_MAX_THREADS];
+	int t;
+	for(t = 0; t < nthreads; t ++)
+	{
+		work[t].methods = todo;
+		work[t].nodes = nodes;
+		work[t].count = count;
+		work[t].begin = t;
+		work[t].step = nthreads;
+		/* the first part of the work is done by the current thread */
+		if(t > 0 && pthread_create(threads + t, NULL, _dalvik_block_precompute_thread, work + t) == 0)
+			started[t] = 1;
+	}
+	for(t = 0; t < nthreads; t ++)
+	{
+		if(started[t]) 
+			pthread_join(threads[t], NULL);
+		else
+			/* the work of the thread that can not be started is done by the current thread */
+			_dalvik_block_precompute_thread(work + t);
+	}
+	/* finally, insert the graphs into the cache */
+	int nbuilt = 0;
+	for(i = 0; i < count; i ++)
+	{
+		if(NULL == nodes[i]->block)
+		{
+			LOG_WARNING("can not build the block graph for method %s/%s", todo[i]->path, todo[i]->name);
+			_dalvik_block_cache_node_free(nodes[i]);
+			continue;
+		}
+		hashval_t h = _dalvik_block_hash(nodes[i]->classpath, nodes[i]->methodname, nodes[i]->typelist, nodes[i]->returntype) % DALVIK_BLOCK_CACHE_SIZE;
+		nodes[i]->next = _dalvik_block_cache[h];
+		_dalvik_block_cache[h] = nodes[i];
+		nbuilt ++;
+	}
+	count = 0;
+	LOG_DEBUG("%d block graphs are precomputed", nbuilt);
+	ret = nbuilt;
+CLEANUP:
+	for(i = 0; i < count; i ++)
+		_dalvik_block_cache_node_free(nodes[i]);
+	if(NULL != nodes) free(nodes);
+	if(NULL != todo) free(todo);
+	vector_free(methods);
+	return ret;
+}
+int dalvik_block_exception_dispatch(const dalvik_block_t* block, const char* exception)
+{
+	if(NULL == block || NULL == exception)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	const dalvik_block_exception_table_t* table = block->handlers;
+	uint32_t best = table->catch_all;
+	uint32_t best_order = table->catch_all_order;
+	if(0 == table->nentries) return (DALVIK_BLOCK_INDEX_INVALID == best) ? DALVIK_BLOCK_EXCEPTION_UNCAUGHT : (int)best;
+	/* walk up the class hierarchy, the handler for a super class catches the exception as well.
+	 * The exception class is only known at the throw site, so the walk can not be done when the table is built */
+	const char* path;
+	uint32_t depth;
+	for(path = exception, depth = 0; NULL != path && best_order > 0; depth ++)
+	{
+		int l = 0, r = table->nentries;
+		while(r - l > 0)
+		{
+			int m = (l + r) / 2;
+			if(table->entries[m].exception < path) l = m + 1;
+			else r = m;
+		}
+		if(l < table->nentries && table->entries[l].exception == path && table->entries[l].order < best_order)
+		{
+			best = table->entries[l].branch;
+			best_order = table->entries[l].order;
+		}
+		if(path == _dalvik_block_root) break;
+		const dalvik_class_t* class = dalvik_memberdict_get_class(path);
+		if(NULL == class || depth >= DALVIK_BLOCK_MAX_HIERARCHY_DEPTH)
+		{
+			/* a super type we can not see might be caught by any handler that comes earlier */
+			LOG_DEBUG("the super class of %s is unknown, the exception might be caught by any handler", path);
+			return DALVIK_BLOCK_EXCEPTION_ANY;
+		}
+		path = class->super;
+	}
+	return (DALVIK_BLOCK_INDEX_INVALID == best) ? DALVIK_BLOCK_EXCEPTION_UNCAUGHT : (int)best;
 }
-
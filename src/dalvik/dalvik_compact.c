@@ -0,0 +1,164 @@
+/**
+ * @file dalvik_compact.c
+ * @brief implementation of the compact instruction encoding
+ * @details The instructions of the graph are scanned twice, the first pass counts the instructions
+ *          and the constant operands, so that all the arrays can be carved from one piece of memory,
+ *          and the second pass fills the arrays.
+ **/
+#include <stdlib.h>
+#include <string.h>
+
+#include <dalvik/dalvik_compact.h>
+#include <dalvik/dalvik_block.h>
+
+/**
+ * @brief encode a register operand
+ * @param operand the operand
+ * @return the register code, DALVIK_COMPACT_REG_NONE indicates the operand can not be encoded
+ **/
+static inline uint16_t _dalvik_compact_reg(const dalvik_operand_t* operand)
+{
+	if(operand->header.info.is_const) return DALVIK_COMPACT_REG_CONST;
+	if(DVM_OPERAND_TYPE_EXCEPTION == operand->header.info.type) return DALVIK_COMPACT_REG_EXCEPTION;
+	if(operand->header.info.is_result) return DALVIK_COMPACT_REG_RESULT;
+	if(operand->payload.uint16 >= DALVIK_COMPACT_REG_CONST)
+	{
+		LOG_ERROR("register v%u is out of the range of the compact encoding", operand->payload.uint16);
+		return DALVIK_COMPACT_REG_NONE;
+	}
+	return operand->payload.uint16;
+}
+/**
+ * @brief classify an instruction
+ * @param ins the instruction
+ * @param p_nregs the buffer used to return how many operands are encoded as registers
+ * @param p_nconsts the buffer used to return how many constant operands should be copied to the side table
+ * @return the dispatch index
+ **/
+static inline uint8_t _dalvik_compact_classify(const dalvik_instruction_t* ins, int* p_nregs, int* p_nconsts)
+{
+	*p_nregs = 0;
+	*p_nconsts = 0;
+	switch(ins->opcode)
+	{
+		case DVM_NOP:
+			return DALVIK_COMPACT_OP_NOP;
+		case DVM_MOVE:
+			*p_nregs = 2;
+			return ins->operands[0].header.info.size ? DALVIK_COMPACT_OP_MOVE_WIDE : DALVIK_COMPACT_OP_MOVE;
+		case DVM_CONST:
+			if(DVM_OPERAND_TYPE_STRING == ins->operands[1].header.info.type)
+				return DALVIK_COMPACT_OP_CONST_STRING;
+			*p_nregs = 1;
+			*p_nconsts = 1;
+			return DALVIK_COMPACT_OP_CONST;
+		case DVM_CMP:
+			*p_nregs = 3;
+			return ins->operands[1].header.info.size ? DALVIK_COMPACT_OP_CMP_WIDE : DALVIK_COMPACT_OP_CMP;
+		case DVM_UNOP:
+			*p_nregs = 2;
+			return DALVIK_COMPACT_OP_UNOP;
+		case DVM_BINOP:
+			*p_nregs = 3;
+			*p_nconsts = ins->operands[1].header.info.is_const + ins->operands[2].header.info.is_const;
+			return DALVIK_COMPACT_OP_BINOP;
+		case DVM_INSTANCE:
+			return DALVIK_COMPACT_OP_INSTANCE;
+		case DVM_INVOKE:
+			return DALVIK_COMPACT_OP_INVOKE;
+		case DVM_MONITOR:
+			return DALVIK_COMPACT_OP_MONITOR;
+		default:
+			return DALVIK_COMPACT_OP_OTHER;
+	}
+}
+int dalvik_compact_encode(dalvik_block_t** blocks, uint32_t kcnt, void** p_result)
+{
+	if(NULL == blocks || NULL == p_result)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	*p_result = NULL;
+	/* the first pass, count the instructions and constants */
+	uint32_t i, nblocks = 0, ninst = 0, nconsts = 0;
+	for(i = 0; i < kcnt; i ++)
+	{
+		if(NULL == blocks[i]) continue;
+		nblocks ++;
+		uint32_t j;
+		for(j = blocks[i]->begin; j < blocks[i]->end; j ++)
+		{
+			int nregs, nc;
+			_dalvik_compact_classify(dalvik_instruction_get(j), &nregs, &nc);
+			nconsts += nc;
+		}
+		ninst += blocks[i]->end - blocks[i]->begin;
+	}
+	/* the arrays are placed in the decreasing order of alignment */
+	size_t size = sizeof(dalvik_compact_t) * nblocks +
+	              sizeof(dalvik_operand_t) * nconsts +
+	              sizeof(uint32_t) * ninst +
+	              sizeof(uint16_t) * ninst * DALVIK_COMPACT_NREGS +
+	              sizeof(uint8_t) * ninst * 2;
+	char* mem = (char*)malloc(size);
+	if(NULL == mem)
+	{
+		LOG_ERROR("can not allocate memory for the compact encoding");
+		return -1;
+	}
+	dalvik_compact_t* compact = (dalvik_compact_t*)mem;
+	dalvik_operand_t* consts = (dalvik_operand_t*)(compact + nblocks);
+	uint32_t* aux = (uint32_t*)(consts + nconsts);
+	uint16_t* regs = (uint16_t*)(aux + ninst);
+	uint8_t* flags = (uint8_t*)(regs + ninst * DALVIK_COMPACT_NREGS);
+	uint8_t* op = flags + ninst;
+
+	/* the second pass, fill the arrays */
+	uint32_t k = 0, c = 0;
+	for(i = 0; i < kcnt; i ++)
+	{
+		if(NULL == blocks[i]) continue;
+		compact->op = op + k;
+		compact->flags = flags + k;
+		compact->regs = regs + k * DALVIK_COMPACT_NREGS;
+		compact->aux = aux + k;
+		compact->consts = consts;
+		blocks[i]->compact = compact ++;
+		uint32_t j;
+		for(j = blocks[i]->begin; j < blocks[i]->end; j ++, k ++)
+		{
+			const dalvik_instruction_t* ins = dalvik_instruction_get(j);
+			int nregs, nc, r;
+			op[k] = _dalvik_compact_classify(ins, &nregs, &nc);
+			flags[k] = ins->flags;
+			aux[k] = nc > 0 ? c : DALVIK_COMPACT_AUX_NONE;
+			for(r = 0; r < DALVIK_COMPACT_NREGS; r ++)
+			{
+				uint16_t* reg = regs + k * DALVIK_COMPACT_NREGS + r;
+				if(r >= nregs)
+				{
+					*reg = DALVIK_COMPACT_REG_NONE;
+					continue;
+				}
+				if(DALVIK_COMPACT_REG_NONE == (*reg = _dalvik_compact_reg(ins->operands + r)))
+				{
+					LOG_ERROR("can not encode instruction %s", dalvik_instruction_to_string(ins, NULL, 0));
+					goto ERR;
+				}
+				if(DALVIK_COMPACT_REG_CONST == *reg)
+					consts[c ++] = ins->operands[r];
+			}
+			/* the constant operand of a const instruction is not a register */
+			if(DALVIK_COMPACT_OP_CONST == op[k])
+				consts[c ++] = ins->operands[1];
+		}
+	}
+	*p_result = mem;
+	return 0;
+ERR:
+	for(i = 0; i < kcnt; i ++)
+		if(NULL != blocks[i]) blocks[i]->compact = NULL;
+	free(mem);
+	return -1;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file dalvik_hierarchy.c
+ * @brief implementation of the class hierarchy index
+ **/
+#include <string.h>
+
+#include <log.h>
+#include <vector.h>
+
+#include <dalvik/dalvik_hierarchy.h>
+#include <dalvik/dalvik_memberdict.h>
+#include <dalvik/dalvik_loader.h>
+/**
+ * @brief the node in the class hierarchy index
+ * @details a node is created for each class path that is either registered
+ *          or referenced as a super class / interface by a registered class.
+ *          For the class paths that are referenced but not loaded, the class
+ *          field is NULL
+ **/
+typedef struct _dalvik_hierarchy_node_t {
+	const char* path;                          /*!< the class path */
+	const dalvik_class_t* class;               /*!< the class definition, NULL if this class is not loaded */
+	vector_t* subclasses;                      /*!< the direct subclasses, NULL if there's no subclass */
+	vector_t* implementors;                    /*!< the classes that directly implement this interface, NULL if there's none */
+	uint32_t  visited;                         /*!< the id of the last traversal that visited this node */
+	struct _dalvik_hierarchy_node_t* next;     /*!< the next node in the hash table */
+} dalvik_hierarchy_node_t;
+
+/** @brief the hash table for the index */
+static dalvik_hierarchy_node_t* _dalvik_hierarchy_hash_table[DALVIK_HIERARCHY_SIZE];
+/** @brief the traversal id, used to mark visited nodes */
+static uint32_t _dalvik_hierarchy_traversal_id;
+/** @brief the result of last traversal */
+static vector_t* _dalvik_hierarchy_result;
+/** @brief the DFS stack */
+static vector_t* _dalvik_hierarchy_stack;
+/** @brief the number of classes which are not loaded but have loaded subclasses or implementors */
+static uint32_t _dalvik_hierarchy_num_unresolved;
+
+int dalvik_hierarchy_init()
+{
+	memset(_dalvik_hierarchy_hash_table, 0, sizeof(_dalvik_hierarchy_hash_table));
+	_dalvik_hierarchy_traversal_id = 0;
+	_dalvik_hierarchy_num_unresolved = 0;
+	_dalvik_hierarchy_result = vector_new(sizeof(dalvik_hierarchy_node_t*));
+	_dalvik_hierarchy_stack = vector_new(sizeof(dalvik_hierarchy_node_t*));
+	if(NULL == _dalvik_hierarchy_result || NULL == _dalvik_hierarchy_stack)
+	{
+		LOG_ERROR("can not create the traversal buffer for class hierarchy index");
+		return -1;
+	}
+	return 0;
+}
+void dalvik_hierarchy_finalize()
+{
+	int i;
+	for(i = 0; i < DALVIK_HIERARCHY_SIZE; i ++)
+	{
+		dalvik_hierarchy_node_t* ptr;
+		for(ptr = _dalvik_hierarchy_hash_table[i]; NULL != ptr;)
+		{
+			dalvik_hierarchy_node_t* old = ptr;
+			ptr = ptr->next;
+			if(NULL != old->subclasses) vector_free(old->subclasses);
+			if(NULL != old->implementors) vector_free(old->implementors);
+			free(old);
+		}
+		_dalvik_hierarchy_hash_table[i] = NULL;
+	}
+	if(NULL != _dalvik_hierarchy_result) vector_free(_dalvik_hierarchy_result);
+	if(NULL != _dalvik_hierarchy_stack) vector_free(_dalvik_hierarchy_stack);
+	_dalvik_hierarchy_result = NULL;
+	_dalvik_hierarchy_stack = NULL;
+	_dalvik_hierarchy_num_unresolved = 0;
+}
+/**
+ * @brief the hash function of the index
+ * @param classpath the class path
+ * @return the hash code
+ **/
+static inline hashval_t _dalvik_hierarchy_hash(const char* classpath)
+{
+	return (((uintptr_t)classpath) * MH_MULTIPLY) % DALVIK_HIERARCHY_SIZE;
+}
+/**
+ * @brief find the node for the class path
+ * @param classpath the class path
+ * @param create if the node does not exist, create a new one
+ * @return the node, NULL if not found or error
+ **/
+static inline dalvik_hierarchy_node_t* _dalvik_hierarchy_find(const char* classpath, int create)
+{
+	hashval_t h = _dalvik_hierarchy_hash(classpath);
+	dalvik_hierarchy_node_t* ptr;
+	for(ptr = _dalvik_hierarchy_hash_table[h]; NULL != ptr && ptr->path != classpath; ptr = ptr->next);
+	if(NULL != ptr || !create) return ptr;
+	ptr = (dalvik_hierarchy_node_t*)malloc(sizeof(dalvik_hierarchy_node_t));
+	if(NULL == ptr)
+	{
+		LOG_ERROR("can not allocate memory for the hierarchy node of class %s", classpath);
+		return NULL;
+	}
+	ptr->path = classpath;
+	ptr->class = NULL;
+	ptr->subclasses = NULL;
+	ptr->implementors = NULL;
+	ptr->visited = 0;
+	ptr->next = _dalvik_hierarchy_hash_table[h];
+	_dalvik_hierarchy_hash_table[h] = ptr;
+	return ptr;
+}
+/**
+ * @brief append a node to the edge list
+ * @param p_list the pointer to the edge list, the list will be created if it's NULL
+ * @param node the node to append
+ * @return < 0 indicates error
+ **/
+static inline int _dalvik_hierarchy_add_edge(vector_t** p_list, dalvik_hierarchy_node_t* node)
+{
+	if(NULL == *p_list && NULL == (*p_list = vector_new(sizeof(dalvik_hierarchy_node_t*))))
+	{
+		LOG_ERROR("can not create edge list");
+		return -1;
+	}
+	return vector_pushback(*p_list, &node);
+}
+/**
+ * @brief check if the node is a class which is not loaded but has loaded subclasses or implementors,
+ *        the root class java/lang/Object is not counted because it has no super type
+ * @param node the node
+ * @return 1 if the node is unresolved, 0 if it's not
+ **/
+static inline int _dalvik_hierarchy_is_unresolved(const dalvik_hierarchy_node_t* node)
+{
+	if(NULL != node->class || (NULL == node->subclasses && NULL == node->implementors)) return 0;
+	return 0 != strcmp(node->path, "java/lang/Object");
+}
+/**
+ * @brief add an edge from the super type to the class, and keep the number of unresolved nodes
+ * @param super the node of the super class or the interface
+ * @param p_list the pointer to the edge list of the super type
+ * @param node the node of the class
+ * @return < 0 indicates error
+ **/
+static inline int _dalvik_hierarchy_link(dalvik_hierarchy_node_t* super, vector_t** p_list, dalvik_hierarchy_node_t* node)
+{
+	int unresolved = _dalvik_hierarchy_is_unresolved(super);
+	if(_dalvik_hierarchy_add_edge(p_list, node) < 0) return -1;
+	if(!unresolved && _dalvik_hierarchy_is_unresolved(super)) _dalvik_hierarchy_num_unresolved ++;
+	return 0;
+}
+int dalvik_hierarchy_add_class(const dalvik_class_t* class)
+{
+	if(NULL == class || NULL == class->path)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(class->path, 1);
+	if(NULL == node) return -1;
+	if(NULL != node->class)
+	{
+		LOG_ERROR("class %s has been added to the hierarchy index twice", class->path);
+		return -1;
+	}
+	if(_dalvik_hierarchy_is_unresolved(node)) _dalvik_hierarchy_num_unresolved --;
+	node->class = class;
+	if(NULL != class->super)
+	{
+		dalvik_hierarchy_node_t* super = _dalvik_hierarchy_find(class->super, 1);
+		if(NULL == super || _dalvik_hierarchy_link(super, &super->subclasses, node) < 0)
+		{
+			LOG_ERROR("can not add class %s as a subclass of %s", class->path, class->super);
+			return -1;
+		}
+	}
+	int i;
+	for(i = 0; i < DALVIK_CLASS_MAX_NUM_IMPLEMENTS && NULL != class->implements[i]; i ++)
+	{
+		dalvik_hierarchy_node_t* interface = _dalvik_hierarchy_find(class->implements[i], 1);
+		if(NULL == interface || _dalvik_hierarchy_link(interface, &interface->implementors, node) < 0)
+		{
+			LOG_ERROR("can not add class %s as an implementor of %s", class->path, class->implements[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+/**
+ * @brief push the nodes in the edge list to the DFS stack if it's not visited yet
+ * @param list the edge list
+ * @return < 0 indicates error
+ **/
+static inline int _dalvik_hierarchy_push_edges(const vector_t* list)
+{
+	if(NULL == list) return 0;
+	size_t i;
+	for(i = 0; i < vector_size(list); i ++)
+	{
+		dalvik_hierarchy_node_t* node = *(dalvik_hierarchy_node_t**)vector_get(list, i);
+		if(node->visited == _dalvik_hierarchy_traversal_id) continue;
+		node->visited = _dalvik_hierarchy_traversal_id;
+		if(vector_pushback(_dalvik_hierarchy_stack, &node) < 0) return -1;
+	}
+	return 0;
+}
+/**
+ * @brief collect all the nodes reachable from the root node, the result is in _dalvik_hierarchy_result
+ *        and the root node is not included
+ * @param root the root node
+ * @param follow_implementors if we need to follow the implementor edges
+ * @return the number of nodes collected, < 0 indicates error
+ **/
+static inline int _dalvik_hierarchy_collect(dalvik_hierarchy_node_t* root, int follow_implementors)
+{
+	_dalvik_hierarchy_result->size = 0;
+	_dalvik_hierarchy_stack->size = 0;
+	if(NULL == root) return 0;
+	_dalvik_hierarchy_traversal_id ++;
+	root->visited = _dalvik_hierarchy_traversal_id;
+	if(_dalvik_hierarchy_push_edges(root->subclasses) < 0) return -1;
+	if(follow_implementors && _dalvik_hierarchy_push_edges(root->implementors) < 0) return -1;
+	while(vector_size(_dalvik_hierarchy_stack) > 0)
+	{
+		dalvik_hierarchy_node_t* node = *(dalvik_hierarchy_node_t**)vector_get(_dalvik_hierarchy_stack, vector_size(_dalvik_hierarchy_stack) - 1);
+		_dalvik_hierarchy_stack->size --;
+		if(vector_pushback(_dalvik_hierarchy_result, &node) < 0) return -1;
+		if(_dalvik_hierarchy_push_edges(node->subclasses) < 0) return -1;
+		if(follow_implementors && _dalvik_hierarchy_push_edges(node->implementors) < 0) return -1;
+	}
+	return vector_size(_dalvik_hierarchy_result);
+}
+int dalvik_hierarchy_get_subclasses(const char* classpath, int transitive, const char** p_class_path, size_t bufsize)
+{
+	if(NULL == classpath || NULL == p_class_path)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	/* the hierarchy is complete only if all the indexed classes are loaded */
+	dalvik_loader_load_all();
+	dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(classpath, 0);
+	if(NULL == node) return 0;
+	const vector_t* list = node->subclasses;
+	if(transitive)
+	{
+		if(_dalvik_hierarchy_collect(node, 0) < 0)
+		{
+			LOG_ERROR("can not traverse the subclasses of %s", classpath);
+			return -1;
+		}
+		list = _dalvik_hierarchy_result;
+	}
+	if(NULL == list) return 0;
+	int ret;
+	for(ret = 0; ret < vector_size(list) && ret < bufsize; ret ++)
+		p_class_path[ret] = (*(dalvik_hierarchy_node_t**)vector_get(list, ret))->path;
+	return ret;
+}
+int dalvik_hierarchy_get_implementors(const char* classpath, const char** p_class_path, size_t bufsize)
+{
+	if(NULL == classpath || NULL == p_class_path)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	/* the hierarchy is complete only if all the indexed classes are loaded */
+	dalvik_loader_load_all();
+	dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(classpath, 0);
+	if(NULL == node) return 0;
+	int n = _dalvik_hierarchy_collect(node, 1);
+	if(n < 0)
+	{
+		LOG_ERROR("can not traverse the implementors of %s", classpath);
+		return -1;
+	}
+	int i, ret = 0;
+	for(i = 0; i < n && ret < bufsize; i ++)
+	{
+		const dalvik_hierarchy_node_t* impl = *(dalvik_hierarchy_node_t**)vector_get(_dalvik_hierarchy_result, i);
+		/* sub-interfaces are not implementors */
+		if(NULL == impl->class || impl->class->is_interface) continue;
+		p_class_path[ret ++] = impl->path;
+	}
+	return ret;
+}
+int dalvik_hierarchy_get_overriders(
+		const char* classpath,
+		const char* methodname,
+		const dalvik_type_t * const * typelist,
+		const dalvik_type_t* rtype,
+		const char** p_class_path,
+		size_t bufsize)
+{
+	if(NULL == classpath || NULL == methodname || NULL == p_class_path)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	/* the hierarchy is complete only if all the indexed classes are loaded */
+	dalvik_loader_load_all();
+	int ret = 0;
+	if(bufsize > 0 && NULL != dalvik_memberdict_get_method(classpath, methodname, typelist, rtype))
+		p_class_path[ret ++] = classpath;
+	dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(classpath, 0);
+	if(NULL == node) return ret;
+	int n = _dalvik_hierarchy_collect(node, 1);
+	if(n < 0)
+	{
+		LOG_ERROR("can not traverse the class hierarchy under %s", classpath);
+		return -1;
+	}
+	int i;
+	for(i = 0; i < n && ret < bufsize; i ++)
+	{
+		const dalvik_hierarchy_node_t* sub = *(dalvik_hierarchy_node_t**)vector_get(_dalvik_hierarchy_result, i);
+		if(NULL != dalvik_memberdict_get_method(sub->path, methodname, typelist, rtype))
+			p_class_path[ret ++] = sub->path;
+	}
+	return ret;
+}
+/**
+ * @brief the recursive part of the subtype check
+ * @param classpath the class path
+ * @param target the target type
+ * @param depth the depth of the recursion
+ * @return 1 if the target is reachable, 0 if it's not
+ **/
+static inline int _dalvik_hierarchy_is_subtype(const char* classpath, const char* target, uint32_t depth)
+{
+	if(classpath == target) return 1;
+	if(depth >= DALVIK_HIERARCHY_MAX_DEPTH) return 0;
+	const dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(classpath, 0);
+	if(NULL == node || NULL == node->class) return 0;
+	int i;
+	for(i = 0; i < DALVIK_CLASS_MAX_NUM_IMPLEMENTS && NULL != node->class->implements[i]; i ++)
+		if(_dalvik_hierarchy_is_subtype(node->class->implements[i], target, depth + 1)) return 1;
+	return NULL != node->class->super && _dalvik_hierarchy_is_subtype(node->class->super, target, depth + 1);
+}
+uint32_t dalvik_hierarchy_num_unresolved()
+{
+	return _dalvik_hierarchy_num_unresolved;
+}
+int dalvik_hierarchy_is_subtype(const char* classpath, const char* target)
+{
+	if(NULL == classpath || NULL == target) return 0;
+	return _dalvik_hierarchy_is_subtype(classpath, target, 0);
+}
+/**
+ * @brief find the class that provides the method for an instance of the class
+ * @param classpath the class of the instance
+ * @param methodname the method name
+ * @param typelist the argument type list
+ * @param rtype the return type
+ * @return the class path of the class defines the method, NULL if not found
+ **/
+static inline const char* _dalvik_hierarchy_lookup_method(
+		const char* classpath,
+		const char* methodname,
+		const dalvik_type_t * const * typelist,
+		const dalvik_type_t* rtype)
+{
+	for(;NULL != classpath;)
+	{
+		if(NULL != dalvik_memberdict_get_method(classpath, methodname, typelist, rtype)) return classpath;
+		const dalvik_class_t* class = dalvik_memberdict_get_class(classpath);
+		if(NULL == class) return NULL;
+		classpath = class->super;
+	}
+	return NULL;
+}
+const char* dalvik_hierarchy_resolve_monomorphic(
+		const char* classpath,
+		const char* methodname,
+		const dalvik_type_t * const * typelist,
+		const dalvik_type_t* rtype)
+{
+	if(NULL == classpath || NULL == methodname) return NULL;
+	dalvik_loader_load_all();
+	const char* ret = NULL;
+	const dalvik_class_t* class = dalvik_memberdict_get_class(classpath);
+	/* the static type itself is a possible receiver type if it's a concrete class */
+	if(NULL != class && !class->is_interface)
+	{
+		ret = _dalvik_hierarchy_lookup_method(classpath, methodname, typelist, rtype);
+		if(NULL == ret) return NULL;
+	}
+	dalvik_hierarchy_node_t* node = _dalvik_hierarchy_find(classpath, 0);
+	if(NULL == node) return ret;
+	int n = _dalvik_hierarchy_collect(node, 1);
+	if(n < 0)
+	{
+		LOG_ERROR("can not traverse the class hierarchy under %s", classpath);
+		return NULL;
+	}
+	int i;
+	for(i = 0; i < n; i ++)
+	{
+		const dalvik_hierarchy_node_t* sub = *(dalvik_hierarchy_node_t**)vector_get(_dalvik_hierarchy_result, i);
+		if(NULL == sub->class || sub->class->is_interface) continue;
+		const char* target = _dalvik_hierarchy_lookup_method(sub->path, methodname, typelist, rtype);
+		if(NULL == target) return NULL;
+		if(NULL == ret) ret = target;
+		else if(ret != target) return NULL;
+	}
+	return ret;
+}
@@ -12,6 +12,7 @@
 #include <log.h>
 #include <dalvik/dalvik_instruction.h>
 #include <sexp.h>
+#include <stringpool.h>
 #include <dalvik/dalvik_tokens.h>
 #include <debug.h>
 
@@ -23,64 +24,73 @@ int dalvik_instruction_count = 0;
  * @brief The instruction pool, all instruction is allcoated in the pool,
  *        So that we do not need to free the memory for the instruction,
  *        because all memory will be freed when the fianlization fucntion 
- *        is called
- *        NOTICE that the memory address of an instruction might be change
- *        after they are allocated, so *use the instruction ID rather than 
- *        the pointer* to instruction as references to instruction.
+ *        is called.
+ *        The pool is a list of fixed-size pages, only the page table is
+ *        reallocated when the pool grows, so the address of an instruction
+ *        never changes, even if a class is loaded during the analysis
  **/
-dalvik_instruction_t* dalvik_instruction_pool = NULL;
+dalvik_instruction_t** dalvik_instruction_pages = NULL;
 
 /** 
- * @brief The capacity of the pool, although the sizeof the pool can increase dynamically,
- * 		   But it's a relateively slow operation to reallocate the memory for the pool,
- * 		   so that, we must set up a proper initial value of the size. 
+ * @brief The capacity of the page table
  **/
-static size_t _dalvik_instruction_pool_capacity = DALVIK_POOL_INIT_SIZE;
+static size_t _dalvik_instruction_pool_npages_cap = DALVIK_POOL_INIT_SIZE;
 
 /**
- * @brief The size of the instruction pool (in bytes) 
+ * @brief The number of pages in the pool
+ **/
+static size_t _dalvik_instruction_pool_npages = 0;
+
+/**
+ * @brief The number of instructions in the pool
  **/
 static size_t _dalvik_instruction_pool_size = 0;
 
 /** 
- * @brief double the size of the instruction pool when there's no space for a new instruction 
+ * @brief append a new page to the instruction pool
+ * @return < 0 indicates an error
  **/
-static int _dalvik_instruction_pool_resize()
+static int _dalvik_instruction_pool_grow()
 {
-	LOG_DEBUG("resize dalvik instruction pool from %zu to %zu", _dalvik_instruction_pool_capacity, 
-															  _dalvik_instruction_pool_capacity *2);
-	dalvik_instruction_t* old_pool;
-	
-	if(NULL == dalvik_instruction_pool) 
+	if(NULL == dalvik_instruction_pages) 
 	{
-		LOG_ERROR("can not resize an uninitialized pool");
+		LOG_ERROR("can not grow an uninitialized pool");
 		return -1;
 	}
-	
-	old_pool = dalvik_instruction_pool;
-	
-	dalvik_instruction_pool = realloc(old_pool, sizeof(dalvik_instruction_t) * _dalvik_instruction_pool_capacity * 2);
-
-	if(NULL == dalvik_instruction_pool) 
+	if(_dalvik_instruction_pool_npages >= _dalvik_instruction_pool_npages_cap)
+	{
+		LOG_DEBUG("resize the page table of dalvik instruction pool from %zu to %zu", 
+		          _dalvik_instruction_pool_npages_cap, _dalvik_instruction_pool_npages_cap * 2);
+		dalvik_instruction_t** new_pages = realloc(dalvik_instruction_pages, 
+		                                           sizeof(dalvik_instruction_t*) * _dalvik_instruction_pool_npages_cap * 2);
+		if(NULL == new_pages)
+		{
+			LOG_ERROR("can not double the size of the page table: %s", strerror(errno));
+			return -1;
+		}
+		dalvik_instruction_pages = new_pages;
+		_dalvik_instruction_pool_npages_cap *= 2;
+	}
+	dalvik_instruction_t* page = (dalvik_instruction_t*)malloc(sizeof(dalvik_instruction_t) * DALVIK_POOL_PAGE_SIZE);
+	if(NULL == page)
 	{
-		LOG_ERROR("can not double the size of instruction pool: %s", strerror(errno));
-		dalvik_instruction_pool = old_pool;
+		LOG_ERROR("can not allocate a new page for the instruction pool: %s", strerror(errno));
 		return -1;
 	}
-
-	_dalvik_instruction_pool_capacity *= 2;
+	dalvik_instruction_pages[_dalvik_instruction_pool_npages ++] = page;
 	return 0;
 }
 int dalvik_instruction_init( void )
 {
 	_dalvik_instruction_pool_size = 0;
-	if(NULL == dalvik_instruction_pool) 
+	_dalvik_instruction_pool_npages = 0;
+	if(NULL == dalvik_instruction_pages) 
 	{
 		LOG_DEBUG("there's no space for instruction pool, create a new pool");
-		dalvik_instruction_pool = 
-			(dalvik_instruction_t*)malloc(sizeof(dalvik_instruction_t) * _dalvik_instruction_pool_capacity);
+		dalvik_instruction_pages = 
+			(dalvik_instruction_t**)malloc(sizeof(dalvik_instruction_t*) * _dalvik_instruction_pool_npages_cap);
 	}
-	if(NULL == dalvik_instruction_pool)
+	if(NULL == dalvik_instruction_pages)
 	{
 		LOG_ERROR("can not allocate instruction pool");
 		return -1;
@@ -92,31 +102,38 @@ int dalvik_instruction_init( void )
 int dalvik_instruction_finalize( void )
 {
 	int i;
-	if(NULL != dalvik_instruction_pool)
+	if(NULL != dalvik_instruction_pages)
 	{
 		for(i = 0; i < _dalvik_instruction_pool_size; i ++)
 			/* we must take care about the additional data attached to instructions */
-			dalvik_instruction_free(dalvik_instruction_pool + i);
+			dalvik_instruction_free((dalvik_instruction_t*)dalvik_instruction_get(i));
 		/* ok, deallocate the pool */
-		free(dalvik_instruction_pool);
+		for(i = 0; i < _dalvik_instruction_pool_npages; i ++)
+			free(dalvik_instruction_pages[i]);
+		free(dalvik_instruction_pages);
+		dalvik_instruction_pages = NULL;
+		_dalvik_instruction_pool_npages = 0;
+		_dalvik_instruction_pool_size = 0;
 	}
 	return 0;
 }
 
 dalvik_instruction_t* dalvik_instruction_new( void )
 {
-	/* if pool is full, try to increase the size of the pool */
-	if(_dalvik_instruction_pool_size >= _dalvik_instruction_pool_capacity)
+	/* if pool is full, append a new page to the pool */
+	if(_dalvik_instruction_pool_size >= _dalvik_instruction_pool_npages * DALVIK_POOL_PAGE_SIZE)
 	{
-		if(_dalvik_instruction_pool_resize() < 0) 
+		if(_dalvik_instruction_pool_grow() < 0) 
 		{
-			LOG_ERROR("can't resize the instruction pool, allocation failed");
+			LOG_ERROR("can't grow the instruction pool, allocation failed");
 			return NULL;
 		}
 	}
-	dalvik_instruction_t* val = dalvik_instruction_pool + (_dalvik_instruction_pool_size ++);
+	uint32_t index = _dalvik_instruction_pool_size ++;
+	dalvik_instruction_t* val = (dalvik_instruction_t*)dalvik_instruction_get(index);
 	memset(val, 0, sizeof(dalvik_instruction_t));
 	
+	val->index = index;
 	val->next = DALVIK_INSTRUCTION_INVALID;
 	return val;
 }
@@ -1240,6 +1257,27 @@ __DI_CONSTRUCTOR(INVOKE)
 			__DI_SETUP_OPERANDPTR(2, DVM_OPERAND_FLAG_CONST | DVM_OPERAND_FLAG_TYPE(DVM_OPERAND_TYPE_TYPELIST), array);
 		}
 	}
+	/* the label names of the array data are reused by different methods, so the label is resolved in the 
+	 * scope of current method, rather than by name at the time the call is analyzed */
+	if(DALVIK_TOKEN_FILL_ARRAY_DATA == field)
+	{
+		const dalvik_type_t* label_type = buf->operands[2].payload.typelist[0];
+		if(NULL == label_type || DALVIK_TYPECODE_OBJECT != label_type->typecode || strlen(label_type->data.object.path) <= 13)
+		{
+			LOG_ERROR("invalid label for the array data");
+			return -1;
+		}
+		dalvik_instruction_invoke_annotation_t annotation = {
+			.target = 0,
+			.labelid = dalvik_label_get_label_id(stringpool_query(label_type->data.object.path + 13))
+		};
+		if(annotation.labelid < 0)
+		{
+			LOG_ERROR("can not resolve the label of the array data");
+			return -1;
+		}
+		if(_dalvik_instruction_write_annotation(buf, &annotation, sizeof(annotation)) < 0) return -1;
+	}
 	return 0;
 }
 /** 
@@ -1785,9 +1823,15 @@ __DI_CONSTRUCTOR(UINVOKE)
 		return -1;
 	}
 	int rc = _dalvik_instruction_INVOKE(next, buf);
-	uint32_t tid = __DI_REGNUM(target);
+	if(rc < 0) return rc;
+	dalvik_instruction_invoke_annotation_t annotation = {
+		.labelid = -1
+	};
+	if(DALVIK_TOKEN_FILL_ARRAY_DATA == buf->operands[1].payload.methpath)
+		dalvik_instruction_read_annotation(buf, &annotation, sizeof(annotation));
+	annotation.target = __DI_REGNUM(target);
 	buf->flags |= DVM_FLAG_INVOKE_ANNOTATION;
-	__DI_WRITE_ANNOTATION(tid, sizeof(tid));
+	__DI_WRITE_ANNOTATION(annotation, sizeof(annotation));
 	return rc;
 }
 __DI_CONSTRUCTOR(DATA)
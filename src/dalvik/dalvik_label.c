@@ -1,6 +1,12 @@
 /**
  * @file dalvik_label.c
  * @brief impkementation of label table which map label --> label index and jump table which maps label id --> instruction id
+ * @details The label names are resolved in a scope. While a method is being parsed, the labels are
+ *          resolved in the method scope, which is released when the method is done, so that the same
+ *          label name can be used in different methods. The label ids are unique in the process, because
+ *          the instructions refer the jump table by label id. The label of the array data which is used by
+ *          the builtin method &lt;fill_array_data&gt; is also resolved to a label id when the call is parsed.
+ *          Outside a method, the labels are resolved in the global scope.
  **/
 #include <dalvik/dalvik_label.h>
 #include <string.h>
@@ -12,90 +18,194 @@ int dalvik_label_count = 0;
 #endif
 
 /**
- * @brief map label id --> jump table 
+ * @brief map label id --> jump table
  **/
-uint32_t dalvik_label_jump_table[DAVLIK_LABEL_POOL_SIZE];
+uint32_t* dalvik_label_jump_table = NULL;
+/**
+ * @brief the capacity of the jump table
+ **/
+static uint32_t _dalvik_label_jump_table_size = 0;
 
 /**
- * @brief the type for label map (label name --> label index)
+ * @brief an entry of the label map (label name --> label index)
  **/
-typedef struct _dalvik_label_map_t {
-	const char* label;
-	uint32_t    idx;
-	struct _dalvik_label_map_t* next;
+typedef struct {
+	const char* label;  /*!< the label name, NULL if the slot is empty */
+	uint32_t    idx;    /*!< the label id */
 } dalvik_label_map_t;
 
 /**
- * @brief the hash table for the label map
+ * @brief a label scope, which is an open addressing hash table
+ **/
+typedef struct {
+	dalvik_label_map_t* slots;  /*!< the slots */
+	uint32_t size;              /*!< the number of slots, which is a power of 2 */
+	uint32_t count;             /*!< how many labels are there in the scope */
+} dalvik_label_scope_t;
+
+/**
+ * @brief the global scope
+ **/
+static dalvik_label_scope_t _dalvik_label_global;
+/**
+ * @brief the scope of the method that is being parsed
+ **/
+static dalvik_label_scope_t _dalvik_label_method;
+/**
+ * @brief if we are inside a method scope
  **/
-static dalvik_label_map_t* _dalvik_label_map_table[DAVLIK_LABEL_POOL_SIZE];
+static int _dalvik_label_in_method;
 /**
  * @brief how many label are there in the table
  **/
-static int _dalvik_label_count;
+static uint32_t _dalvik_label_count;
+
+/**
+ * @brief find the slot for the label in the scope
+ * @param scope the scope
+ * @param label the label name
+ * @return the slot, which is either the slot of the label or the empty slot the label should be placed
+ **/
+static inline dalvik_label_map_t* _dalvik_label_scope_find(const dalvik_label_scope_t* scope, const char* label)
+{
+	uint32_t idx = ((uintptr_t)label * MH_MULTIPLY) & (scope->size - 1);
+	for(; NULL != scope->slots[idx].label && scope->slots[idx].label != label; idx = (idx + 1) & (scope->size - 1));
+	return scope->slots + idx;
+}
+/**
+ * @brief make sure the scope has room for one more label
+ * @param scope the scope
+ * @return < 0 indicates an error
+ **/
+static inline int _dalvik_label_scope_reserve(dalvik_label_scope_t* scope)
+{
+	if(2 * (scope->count + 1) <= scope->size) return 0;
+	dalvik_label_scope_t new_scope = {
+		.size = (0 == scope->size) ? DALVIK_LABEL_SCOPE_INIT_SIZE : scope->size * 2,
+		.count = scope->count
+	};
+	new_scope.slots = (dalvik_label_map_t*)calloc(new_scope.size, sizeof(dalvik_label_map_t));
+	if(NULL == new_scope.slots)
+	{
+		LOG_ERROR("can not allocate memory for the label scope");
+		return -1;
+	}
+	uint32_t i;
+	for(i = 0; i < scope->size; i ++)
+		if(NULL != scope->slots[i].label)
+			*_dalvik_label_scope_find(&new_scope, scope->slots[i].label) = scope->slots[i];
+	free(scope->slots);
+	*scope = new_scope;
+	return 0;
+}
+/**
+ * @brief get the scope that is used to resolve the label names
+ * @return the scope
+ **/
+static inline dalvik_label_scope_t* _dalvik_label_current_scope(void)
+{
+	return _dalvik_label_in_method ? &_dalvik_label_method : &_dalvik_label_global;
+}
+/**
+ * @brief allocate a new label id
+ * @return the label id, < 0 indicates an error
+ **/
+static inline int _dalvik_label_new_id(void)
+{
+	if(_dalvik_label_count >= _dalvik_label_jump_table_size)
+	{
+		uint32_t size = (0 == _dalvik_label_jump_table_size) ? DALVIK_LABEL_JUMP_TABLE_INIT_SIZE : _dalvik_label_jump_table_size * 2;
+		uint32_t* table = (uint32_t*)realloc(dalvik_label_jump_table, sizeof(uint32_t) * size);
+		if(NULL == table)
+		{
+			LOG_ERROR("can not grow the jump table");
+			return -1;
+		}
+		memset(table + _dalvik_label_jump_table_size, -1, sizeof(uint32_t) * (size - _dalvik_label_jump_table_size));
+		dalvik_label_jump_table = table;
+		_dalvik_label_jump_table_size = size;
+	}
+	return _dalvik_label_count ++;
+}
 
 int dalvik_label_init(void)
 {
 	_dalvik_label_count = 0;
-	memset(_dalvik_label_map_table, 0, sizeof(_dalvik_label_map_table));
-	memset(dalvik_label_jump_table, -1, sizeof(dalvik_label_jump_table)); 
+	_dalvik_label_in_method = 0;
+	memset(&_dalvik_label_global, 0, sizeof(_dalvik_label_global));
+	memset(&_dalvik_label_method, 0, sizeof(_dalvik_label_method));
+	dalvik_label_jump_table = NULL;
+	_dalvik_label_jump_table_size = 0;
 	LOG_DEBUG("Dalvik Label Pool initialized");
 	return 0;
 }
 void dalvik_label_finalize(void)
 {
-	int i;
-	for(i = 0; i < DAVLIK_LABEL_POOL_SIZE; i ++)
+	if(NULL != _dalvik_label_global.slots) free(_dalvik_label_global.slots);
+	if(NULL != _dalvik_label_method.slots) free(_dalvik_label_method.slots);
+	if(NULL != dalvik_label_jump_table) free(dalvik_label_jump_table);
+	memset(&_dalvik_label_global, 0, sizeof(_dalvik_label_global));
+	memset(&_dalvik_label_method, 0, sizeof(_dalvik_label_method));
+	dalvik_label_jump_table = NULL;
+	_dalvik_label_jump_table_size = 0;
+}
+int dalvik_label_scope_begin(void)
+{
+	if(_dalvik_label_in_method)
 	{
-		dalvik_label_map_t* ptr;
-		for(ptr = _dalvik_label_map_table[i]; ptr; )
-		{
-			dalvik_label_map_t* this = ptr;
-			ptr = ptr->next;
-			free(this);
-		}
+		LOG_ERROR("the method scope is already opened");
+		return -1;
 	}
+	_dalvik_label_in_method = 1;
+	return 0;
+}
+void dalvik_label_scope_end(void)
+{
+	if(!_dalvik_label_in_method) return;
+	_dalvik_label_in_method = 0;
+	if(0 == _dalvik_label_method.count) return;
+	memset(_dalvik_label_method.slots, 0, sizeof(dalvik_label_map_t) * _dalvik_label_method.size);
+	_dalvik_label_method.count = 0;
 }
 int dalvik_label_exists(const char* label)
 {
-	int idx = ((uintptr_t)label * MH_MULTIPLY)%DAVLIK_LABEL_POOL_SIZE;
-	dalvik_label_map_t* ptr;
-	for(ptr = _dalvik_label_map_table[idx]; ptr; ptr = ptr->next)
-		if(ptr->label == label) return 1;
-	return 0;
+	const dalvik_label_scope_t* scope = _dalvik_label_current_scope();
+	if(0 == scope->count) return 0;
+	return NULL != _dalvik_label_scope_find(scope, label)->label;
 }
 int dalvik_label_get_label_id(const char* label)
 {
-	int idx = ((uintptr_t)label * MH_MULTIPLY)%DAVLIK_LABEL_POOL_SIZE;
-	dalvik_label_map_t* ptr;
-	for(ptr = _dalvik_label_map_table[idx]; ptr; ptr = ptr->next)
-		if(ptr->label == label) 
+	dalvik_label_scope_t* scope = _dalvik_label_current_scope();
+	if(scope->count > 0)
+	{
+		const dalvik_label_map_t* ptr = _dalvik_label_scope_find(scope, label);
+		if(NULL != ptr->label)
 		{
 			LOG_DEBUG("Find label map %s --> %d", label, ptr->idx);
 			return ptr->idx;
 		}
+	}
 	LOG_DEBUG("Creating new mapping for label %s", label);
 
 #ifdef PARSER_COUNT
 	dalvik_label_count ++;
 #endif
 	/* if label not found, create one */
-
-	ptr = (dalvik_label_map_t*)malloc(sizeof(dalvik_label_map_t));
-	if(NULL == ptr) 
+	if(_dalvik_label_scope_reserve(scope) < 0)
 	{
 		LOG_ERROR("can not create mapping %s -> %d", label, _dalvik_label_count);
 		return -1;
 	}
-	if(_dalvik_label_count >= DAVLIK_LABEL_POOL_SIZE) 
+	int idx = _dalvik_label_new_id();
+	if(idx < 0)
 	{
 		LOG_ERROR("too many labels");
 		return -1;
 	}
+	dalvik_label_map_t* ptr = _dalvik_label_scope_find(scope, label);
 	ptr->label = label;
-	ptr->idx   = _dalvik_label_count ++;
-	ptr->next  = _dalvik_label_map_table[idx];
-	_dalvik_label_map_table[idx] = ptr;
+	ptr->idx   = idx;
+	scope->count ++;
 	LOG_DEBUG("Find label map %s --> %d", label, ptr->idx);
 	return ptr->idx;
 }
@@ -0,0 +1,193 @@
+/**
+ * @file dalvik_liveness.c
+ * @brief implementation of the register liveness analysis
+ * @details The use set (the registers read before written) and the def set (the registers
+ *          written) of each block are computed first, and then the live-in sets are solved
+ *          backward until the fix point. An exception might be thrown before any instruction
+ *          in the block is executed, so the registers live at the exception handlers are live
+ *          at the entry of the block regardless of the def set.
+ **/
+#include <stdlib.h>
+#include <string.h>
+
+#include <dalvik/dalvik_liveness.h>
+#include <dalvik/dalvik_instruction.h>
+
+int dalvik_liveness_enabled = 1;
+
+int dalvik_liveness_init()
+{
+	const char* spec = getenv("ADAMLIVENESS");
+	dalvik_liveness_enabled = (NULL == spec || 0 != strcmp(spec, "0"));
+	if(!dalvik_liveness_enabled) LOG_DEBUG("the liveness analysis is disabled");
+	return 0;
+}
+void dalvik_liveness_finalize()
+{
+	dalvik_liveness_enabled = 1;
+}
+/**
+ * @brief set the bits of the registers occupied by an operand in the bitmap
+ * @param bitmap the bitmap
+ * @param nregs the number of registers
+ * @param operand the operand, the operands other than a general register are ignored
+ * @param mask the registers in this bitmap are not set, NULL means no mask
+ * @return nothing
+ **/
+static inline void _dalvik_liveness_set(uint32_t* bitmap, uint32_t nregs, const dalvik_operand_t* operand, const uint32_t* mask)
+{
+	if(NULL == operand || operand->header.info.is_const || operand->header.info.is_result) return;
+	if(DVM_OPERAND_TYPE_EXCEPTION == operand->header.info.type || DVM_OPERAND_TYPE_VOID == operand->header.info.type) return;
+	uint32_t reg = operand->payload.uint16;
+	uint32_t last = reg;
+	if(operand->header.info.size ||
+	   DVM_OPERAND_TYPE_LONG == operand->header.info.type ||
+	   DVM_OPERAND_TYPE_DOUBLE == operand->header.info.type)
+		last ++;
+	for(; reg <= last && reg < nregs; reg ++)
+		if(NULL == mask || !(mask[reg / 32] & (1u << (reg % 32))))
+			bitmap[reg / 32] |= 1u << (reg % 32);
+}
+/**
+ * @brief check if the first operand of the instruction is a destination register
+ * @param inst the instruction
+ * @return the result
+ **/
+static inline int _dalvik_liveness_writes_first(const dalvik_instruction_t* inst)
+{
+	switch(inst->opcode)
+	{
+		case DVM_MOVE:
+		case DVM_CONST:
+		case DVM_CMP:
+		case DVM_UNOP:
+		case DVM_BINOP:
+			return 1;
+		case DVM_INSTANCE:
+			return DVM_FLAG_INSTANCE_OF == inst->flags ||
+			       DVM_FLAG_INSTANCE_NEW == inst->flags ||
+			       DVM_FLAG_INSTANCE_GET == inst->flags ||
+			       DVM_FLAG_INSTANCE_SGET == inst->flags;
+		case DVM_ARRAY:
+			return DVM_FLAG_ARRAY_LENGTH == inst->flags ||
+			       DVM_FLAG_ARRAY_NEW == inst->flags ||
+			       DVM_FLAG_ARRAY_GET == inst->flags;
+	}
+	return 0;
+}
+/**
+ * @brief update the use set and the def set of a block with the next instruction
+ * @param use the use set
+ * @param def the def set
+ * @param nregs the number of registers
+ * @param inst the instruction
+ * @return nothing
+ **/
+static inline void _dalvik_liveness_transfer(uint32_t* use, uint32_t* def, uint32_t nregs, const dalvik_instruction_t* inst)
+{
+	uint32_t i, first = 0;
+	if(_dalvik_liveness_writes_first(inst)) first = 1;
+	for(i = first; i < inst->num_operands; i ++)
+		_dalvik_liveness_set(use, nregs, inst->operands + i, def);
+	if(DVM_INVOKE == inst->opcode && (inst->flags & DVM_FLAG_INVOKE_RANGE) && inst->num_operands > 5)
+	{
+		uint32_t reg;
+		for(reg = inst->operands[4].payload.uint16; reg <= inst->operands[5].payload.uint16 && reg < nregs; reg ++)
+			if(!(def[reg / 32] & (1u << (reg % 32))))
+				use[reg / 32] |= 1u << (reg % 32);
+	}
+	/* the register the annotation of an invocation writes is not counted as a def, which only makes
+	 * more registers live */
+	if(first) _dalvik_liveness_set(def, nregs, inst->operands, NULL);
+}
+int dalvik_liveness_compute(dalvik_block_t** blocks, uint32_t kcnt, uint32_t nregs, uint32_t** p_result)
+{
+	if(NULL == blocks || 0 == kcnt || NULL == p_result)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	*p_result = NULL;
+	if(!dalvik_liveness_enabled || 0 == nregs) return 0;
+	uint32_t nwords = DALVIK_LIVENESS_NWORDS(nregs);
+	uint32_t i, j, k;
+	/* the live-in sets are returned, the use and def sets are freed here */
+	uint32_t* live = (uint32_t*)calloc(nwords * kcnt, sizeof(uint32_t));
+	uint32_t* mem = (uint32_t*)calloc(nwords * (2 * kcnt + 1), sizeof(uint32_t));
+	if(NULL == live || NULL == mem)
+	{
+		LOG_ERROR("can not allocate memory for the liveness analysis");
+		if(NULL != live) free(live);
+		if(NULL != mem) free(mem);
+		return -1;
+	}
+	uint32_t* use = mem;
+	uint32_t* def = use + nwords * kcnt;
+	uint32_t* out = def + nwords * kcnt;
+	for(i = 0; i < kcnt; i ++)
+	{
+		const dalvik_block_t* block = blocks[i];
+		if(NULL == block) continue;
+		uint32_t* buse = use + nwords * block->index;
+		uint32_t* bdef = def + nwords * block->index;
+		for(j = block->begin; j < block->end; j ++)
+			_dalvik_liveness_transfer(buse, bdef, nregs, dalvik_instruction_get(j));
+		/* the operands of the branches are read after all the instructions */
+		for(j = 0; j < block->nbranches; j ++)
+		{
+			const dalvik_block_branch_t* branch = block->branches + j;
+			if(branch->conditional)
+			{
+				if(!branch->left_inst) _dalvik_liveness_set(buse, nregs, branch->left, bdef);
+				_dalvik_liveness_set(buse, nregs, branch->right, bdef);
+			}
+			else if(DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch) && !branch->left_inst)
+				_dalvik_liveness_set(buse, nregs, branch->left, bdef);
+		}
+		memcpy(live + nwords * block->index, buse, sizeof(uint32_t) * nwords);
+	}
+	/* the blocks are numbered in the order of the instructions, so the backward iteration converges fast */
+	int changed = 1;
+	while(changed)
+	{
+		changed = 0;
+		for(i = kcnt; i > 0; i --)
+		{
+			const dalvik_block_t* block = blocks[i - 1];
+			if(NULL == block) continue;
+			uint32_t* blive = live + nwords * block->index;
+			memset(out, 0, sizeof(uint32_t) * nwords);
+			for(j = 0; j < block->nbranches; j ++)
+			{
+				const dalvik_block_branch_t* branch = block->branches + j;
+				if(branch->disabled || NULL == branch->block || DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch)) continue;
+				const uint32_t* tlive = live + nwords * branch->block->index;
+				int exception = DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_EXCEPTION(*branch);
+				for(k = 0; k < nwords; k ++)
+				{
+					out[k] |= tlive[k];
+					if(exception && (tlive[k] & ~blive[k]))
+					{
+						blive[k] |= tlive[k];
+						changed = 1;
+					}
+				}
+			}
+			const uint32_t* bdef = def + nwords * block->index;
+			for(k = 0; k < nwords; k ++)
+			{
+				uint32_t value = out[k] & ~bdef[k];
+				if(value & ~blive[k])
+				{
+					blive[k] |= value;
+					changed = 1;
+				}
+			}
+		}
+	}
+	for(i = 0; i < kcnt; i ++)
+		if(NULL != blocks[i]) blocks[i]->live_in = live + nwords * blocks[i]->index;
+	free(mem);
+	*p_result = live;
+	return 0;
+}
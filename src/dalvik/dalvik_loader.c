@@ -2,11 +2,14 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 
 #include <dalvik/dalvik_loader.h>
 #include <dalvik/dalvik_class.h>
+#include <dalvik/dalvik_instruction.h>
+#include <stringpool.h>
 #include <debug.h>
 #ifdef PARSER_COUNT
 extern int dalvik_method_count;
@@ -15,6 +18,50 @@ extern int dalvik_label_count;
 extern int dalvik_field_count;
 extern int dalvik_class_count;
 #endif
+extern int dalvik_static_field_count;
+/**
+ * @brief the node of the class index
+ **/
+typedef struct _dalvik_loader_index_node_t {
+	const char* class_path;     /*!< the class path */
+	const char* file;           /*!< the file contains the class definition (pooled string) */
+	long        offset;         /*!< the offset of the class definition in the file */
+	size_t      length;         /*!< the length of the class definition */
+	uint32_t    static_base;    /*!< the first static field index reserved for this class */
+	uint32_t    nstatic;        /*!< the number of static fields in this class */
+	int         loaded;         /*!< if this class has been loaded */
+	struct _dalvik_loader_index_node_t* next;  /*!< the next node in the hash table */
+} dalvik_loader_index_node_t;
+/** @brief the class index */
+static dalvik_loader_index_node_t* _dalvik_loader_index[DALVIK_LOADER_INDEX_SIZE];
+/** @brief the number of classes that are indexed but not loaded */
+static uint32_t _dalvik_loader_pending;
+/** @brief the number of classes that are loaded or indexed by the loader */
+static uint32_t _dalvik_loader_num_classes;
+int dalvik_loader_init()
+{
+	memset(_dalvik_loader_index, 0, sizeof(_dalvik_loader_index));
+	_dalvik_loader_pending = 0;
+	_dalvik_loader_num_classes = 0;
+	return 0;
+}
+void dalvik_loader_finalize()
+{
+	int i;
+	for(i = 0; i < DALVIK_LOADER_INDEX_SIZE; i ++)
+	{
+		dalvik_loader_index_node_t* node;
+		for(node = _dalvik_loader_index[i]; NULL != node;)
+		{
+			dalvik_loader_index_node_t* cur = node;
+			node = node->next;
+			free(cur);
+		}
+		_dalvik_loader_index[i] = NULL;
+	}
+	_dalvik_loader_pending = 0;
+	_dalvik_loader_num_classes = 0;
+}
 int _dalvik_loader_filter(const struct dirent* ent)
 {
 	if(ent->d_name[0] == '.') return 0;
@@ -103,7 +150,7 @@ int dalvik_loader_from_directory(const char* path)
 					goto ERR;
 				}
 				sexp_free(sexp);
-				
+				_dalvik_loader_num_classes ++;
 			}
 		}
 	}
@@ -120,6 +167,339 @@ ERR:
 	LOG_ERROR("dalvik loader is returninng a failure");
 	return -1;
 }
+/**
+ * @brief find a class in the class index
+ * @param class_path the class path
+ * @return the index node, NULL if not found
+ **/
+static inline dalvik_loader_index_node_t* _dalvik_loader_index_find(const char* class_path)
+{
+	dalvik_loader_index_node_t* node;
+	for(node = _dalvik_loader_index[((uintptr_t)class_path * MH_MULTIPLY) % DALVIK_LOADER_INDEX_SIZE];
+		NULL != node && node->class_path != class_path;
+		node = node->next);
+	return node;
+}
+/**
+ * @brief read the next token in the class definition, the parentheses are returned as a single
+ *        character token, a string literal is returned with the quotes
+ * @param p the current position
+ * @param end the end of the buffer
+ * @param p_len the buffer used to return the length of the token
+ * @return the beginning of the token, NULL if there's no more token
+ **/
+static inline const char* _dalvik_loader_next_token(const char** p, const char* end, size_t* p_len)
+{
+	const char* ptr = *p;
+	for(; ptr < end; ptr ++)
+	{
+		if(*ptr == ';')
+			for(; ptr < end && *ptr != '\n'; ptr ++);
+		else if(*ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r' && *ptr != ',')
+			break;
+	}
+	if(ptr >= end) return NULL;
+	const char* begin = ptr;
+	if(*ptr == '(' || *ptr == ')') 
+		ptr ++;
+	else if(*ptr == '"')
+	{
+		for(ptr ++; ptr < end && *ptr != '"'; ptr ++)
+			if(*ptr == '\\') ptr ++;
+		ptr ++;
+	}
+	else
+		for(; ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r' && 
+			  *ptr != ',' && *ptr != '(' && *ptr != ')' && *ptr != ';' && *ptr != '"'; ptr ++);
+	if(ptr > end) ptr = end;
+	*p = ptr;
+	*p_len = ptr - begin;
+	return begin;
+}
+/**
+ * @brief check if the token equals the string
+ * @param tok the token
+ * @param len the length of the token
+ * @param str the string
+ * @return the result
+ **/
+static inline int _dalvik_loader_token_equal(const char* tok, size_t len, const char* str)
+{
+	return NULL != tok && strlen(str) == len && memcmp(tok, str, len) == 0;
+}
+/**
+ * @brief skip the rest of the list
+ * @param p the current position, which is right after the open parenthesis
+ * @param end the end of the buffer
+ * @param p_static if not NULL, set to 1 if there's a token `static' in the list
+ * @return nothing
+ **/
+static inline void _dalvik_loader_skip_list(const char** p, const char* end, int* p_static)
+{
+	int depth = 1;
+	size_t len;
+	const char* tok;
+	while(depth > 0 && NULL != (tok = _dalvik_loader_next_token(p, end, &len)))
+	{
+		if(_dalvik_loader_token_equal(tok, len, "(")) depth ++;
+		else if(_dalvik_loader_token_equal(tok, len, ")")) depth --;
+		else if(NULL != p_static && _dalvik_loader_token_equal(tok, len, "static")) *p_static = 1;
+	}
+}
+/**
+ * @brief scan a class definition and add it to the index, without parsing it
+ * @param file the file name (pooled)
+ * @param buf the content of the file
+ * @param begin the beginning of the class definition
+ * @param end the end of the class definition
+ * @return < 0 indicates an error
+ **/
+static inline int _dalvik_loader_index_class(const char* file, const char* buf, const char* begin, const char* end)
+{
+	const char* p = begin;
+	size_t len;
+	const char* tok;
+	char path[4096];
+	/* (class (attrs ...) path */
+	tok = _dalvik_loader_next_token(&p, end, &len);
+	tok = _dalvik_loader_next_token(&p, end, &len);
+	if(!_dalvik_loader_token_equal(tok, len, "class") && !_dalvik_loader_token_equal(tok, len, "interface"))
+	{
+		LOG_WARNING("ignore the S-Expression in file %s at offset %ld, which is not a class definition", file, (long)(begin - buf));
+		return 0;
+	}
+	tok = _dalvik_loader_next_token(&p, end, &len);
+	if(_dalvik_loader_token_equal(tok, len, "("))
+	{
+		_dalvik_loader_skip_list(&p, end, NULL);
+		tok = _dalvik_loader_next_token(&p, end, &len);
+	}
+	if(NULL == tok || len >= sizeof(path) || tok[0] == '(' || tok[0] == ')')
+	{
+		LOG_ERROR("invalid class definition in file %s at offset %ld", file, (long)(begin - buf));
+		return -1;
+	}
+	memcpy(path, tok, len);
+	path[len] = 0;
+	const char* class_path = stringpool_query(path);
+	if(NULL != _dalvik_loader_index_find(class_path))
+	{
+		LOG_WARNING("duplicated definition of class %s in file %s, ignored", class_path, file);
+		return 0;
+	}
+	/* count the static fields, so that we can reserve the static field indices for this class */
+	uint32_t nstatic = 0;
+	while(NULL != (tok = _dalvik_loader_next_token(&p, end, &len)))
+	{
+		if(!_dalvik_loader_token_equal(tok, len, "(")) continue;
+		tok = _dalvik_loader_next_token(&p, end, &len);
+		int is_static = 0;
+		if(_dalvik_loader_token_equal(tok, len, "field"))
+		{
+			tok = _dalvik_loader_next_token(&p, end, &len);
+			if(_dalvik_loader_token_equal(tok, len, "("))
+				_dalvik_loader_skip_list(&p, end, &is_static);
+			else if(_dalvik_loader_token_equal(tok, len, ")"))
+				continue;
+		}
+		else if(_dalvik_loader_token_equal(tok, len, ")")) 
+			continue;
+		_dalvik_loader_skip_list(&p, end, NULL);
+		nstatic += is_static;
+	}
+	dalvik_loader_index_node_t* node = (dalvik_loader_index_node_t*)malloc(sizeof(dalvik_loader_index_node_t));
+	if(NULL == node)
+	{
+		LOG_ERROR("can not allocate memory for the class index");
+		return -1;
+	}
+	node->class_path = class_path;
+	node->file = file;
+	node->offset = begin - buf;
+	node->length = end - begin;
+	node->static_base = dalvik_static_field_count;
+	node->nstatic = nstatic;
+	node->loaded = 0;
+	/* the static field indices are assigned when the class is indexed, so that the range of static fields is
+	 * fixed before the analysis starts */
+	dalvik_static_field_count += nstatic;
+	uint32_t h = ((uintptr_t)class_path * MH_MULTIPLY) % DALVIK_LOADER_INDEX_SIZE;
+	node->next = _dalvik_loader_index[h];
+	_dalvik_loader_index[h] = node;
+	_dalvik_loader_pending ++;
+	_dalvik_loader_num_classes ++;
+	LOG_DEBUG("indexed class %s at %s:%ld (%zu bytes, %u static fields)", class_path, file, node->offset, node->length, nstatic);
+	return 0;
+}
+/**
+ * @brief index all the classes in a file
+ * @param file the file name (pooled)
+ * @return < 0 indicates an error
+ **/
+static inline int _dalvik_loader_index_file(const char* file)
+{
+	FILE* fp = fopen(file, "r");
+	if(NULL == fp)
+	{
+		LOG_WARNING("can not open file \"%s\", %s", file, strerror(errno));
+		return 0;
+	}
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	char* buf = (char*)malloc(size + 1);
+	if(NULL == buf)
+	{
+		LOG_ERROR("can not allocate memory for file %s", file);
+		fclose(fp);
+		return -1;
+	}
+	size = fread(buf, 1, size, fp);
+	fclose(fp);
+	buf[size] = 0;
+	/* find the top level S-Expressions */
+	int depth = 0;
+	const char* begin = NULL;
+	const char* p;
+	const char* end = buf + size;
+	for(p = buf; p < end; p ++)
+	{
+		if(*p == ';')
+			for(; p < end && *p != '\n'; p ++);
+		else if(*p == '"')
+			for(p ++; p < end && *p != '"'; p ++)
+			{
+				if(*p == '\\') p ++;
+			}
+		else if(*p == '(')
+		{
+			if(0 == depth ++) begin = p;
+		}
+		else if(*p == ')' && depth > 0 && 0 == -- depth)
+		{
+			if(_dalvik_loader_index_class(file, buf, begin, p + 1) < 0)
+			{
+				free(buf);
+				return -1;
+			}
+		}
+	}
+	free(buf);
+	return 0;
+}
+int dalvik_loader_index_directory(const char* path)
+{
+	struct dirent **result = NULL;
+	int num_dirent = scandir(path, &result, _dalvik_loader_filter, alphasort);
+	int i, rc = 0;
+	if(num_dirent < 0)
+	{
+		LOG_ERROR("can not open directory %s: %s", path, strerror(errno));
+		return -1;
+	}
+	for(i = 0; i < num_dirent; i ++)
+	{
+		char filename[1024];
+		snprintf(filename, sizeof(filename), "%s/%s", path, result[i]->d_name);
+		if(rc < 0) continue;
+		if(result[i]->d_type == DT_DIR)
+			rc = dalvik_loader_index_directory(filename);
+		else
+			rc = _dalvik_loader_index_file(stringpool_query(filename));
+		if(rc < 0) LOG_ERROR("failed to index %s", filename);
+	}
+	for(i = 0; i < num_dirent; i ++)
+		free(result[i]);
+	free(result);
+	LOG_DEBUG("%u classes are waiting for being loaded", _dalvik_loader_pending);
+	return rc;
+}
+/**
+ * @brief parse a class in the index
+ * @param node the index node
+ * @return < 0 indicates an error
+ **/
+static inline int _dalvik_loader_load_node(dalvik_loader_index_node_t* node)
+{
+	/* mark it first, so that we never try to load a broken class again */
+	node->loaded = 1;
+	_dalvik_loader_pending --;
+	LOG_DEBUG("loading class %s from %s:%ld", node->class_path, node->file, node->offset);
+	FILE* fp = fopen(node->file, "r");
+	if(NULL == fp)
+	{
+		LOG_ERROR("can not open file %s: %s", node->file, strerror(errno));
+		return -1;
+	}
+	char* buf = (char*)malloc(node->length + 1);
+	if(NULL == buf)
+	{
+		LOG_ERROR("can not allocate memory for class %s", node->class_path);
+		fclose(fp);
+		return -1;
+	}
+	if(fseek(fp, node->offset, SEEK_SET) < 0 || fread(buf, 1, node->length, fp) != node->length)
+	{
+		LOG_ERROR("can not read class %s from file %s", node->class_path, node->file);
+		fclose(fp);
+		free(buf);
+		return -1;
+	}
+	fclose(fp);
+	buf[node->length] = 0;
+	sexpression_t* sexp;
+	if(NULL == sexp_parse(buf, &sexp))
+	{
+		if(SEXP_EOF != sexp) sexp_free(sexp);
+		free(buf);
+		LOG_ERROR("can not parse the definition of class %s", node->class_path);
+		return -1;
+	}
+	free(buf);
+	/* the static fields use the indices reserved when the class was indexed */
+	int saved_static_count = dalvik_static_field_count;
+	dalvik_static_field_count = node->static_base;
+	const dalvik_class_t* class = dalvik_class_from_sexp(sexp);
+	if(dalvik_static_field_count != node->static_base + node->nstatic)
+		LOG_WARNING("class %s has %u static fields, but %u are reserved", node->class_path, 
+		            dalvik_static_field_count - node->static_base, node->nstatic);
+	dalvik_static_field_count = saved_static_count;
+	sexp_free(sexp);
+	if(NULL == class)
+	{
+		LOG_ERROR("can not parse the definition of class %s", node->class_path);
+		return -1;
+	}
+	return 0;
+}
+int dalvik_loader_load_class(const char* class_path)
+{
+	if(0 == _dalvik_loader_pending || NULL == class_path) return 0;
+	dalvik_loader_index_node_t* node = _dalvik_loader_index_find(class_path);
+	if(NULL == node || node->loaded) return 0;
+	if(_dalvik_loader_load_node(node) < 0) return -1;
+	return 1;
+}
+int dalvik_loader_load_all()
+{
+	int i, rc = 0;
+	for(i = 0; i < DALVIK_LOADER_INDEX_SIZE && _dalvik_loader_pending > 0; i ++)
+	{
+		dalvik_loader_index_node_t* node;
+		for(node = _dalvik_loader_index[i]; NULL != node; node = node->next)
+			if(!node->loaded && _dalvik_loader_load_node(node) < 0)
+				rc = -1;
+	}
+	return rc;
+}
+uint32_t dalvik_loader_num_pending()
+{
+	return _dalvik_loader_pending;
+}
+uint32_t dalvik_loader_num_classes()
+{
+	return _dalvik_loader_num_classes;
+}
 #ifdef PARSER_COUNT
 void dalvik_loader_summary()
 {
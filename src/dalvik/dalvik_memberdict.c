@@ -5,7 +5,10 @@
 #include <dalvik/dalvik_class.h>
 #include <dalvik/dalvik_method.h>
 #include <dalvik/dalvik_field.h>
+#include <dalvik/dalvik_hierarchy.h>
+#include <dalvik/dalvik_loader.h>
 #include <debug.h>
+#include <vector.h>
 
 #define _TYPE_METHOD 0
 #define _TYPE_FIELD 1
@@ -24,10 +27,28 @@ typedef struct _dalvik_memberdict_node_t {
 } dalvik_memberdict_node_t;
 
 dalvik_memberdict_node_t* _dalvik_memberdict_hash_table[DALVIK_MEMBERDICT_SIZE];
+/**
+ * @brief the secondary index for prefix queries
+ * @details all nodes of the member dictionary sorted by &lt;class path, member name&gt;.
+ *          The registration function just appends the new node at the end of the
+ *          index and marks it unsorted, the index is sorted before the next query.
+ **/
+static vector_t* _dalvik_memberdict_sorted_index;
+/**
+ * @brief if the sorted index needs to be sorted again
+ **/
+static int _dalvik_memberdict_sorted_index_dirty;
 
 int dalvik_memberdict_init()
 {
 	memset(_dalvik_memberdict_hash_table, 0, sizeof(_dalvik_memberdict_hash_table));
+	_dalvik_memberdict_sorted_index = vector_new(sizeof(dalvik_memberdict_node_t*));
+	if(NULL == _dalvik_memberdict_sorted_index)
+	{
+		LOG_ERROR("can not create the sorted index for member dictionary");
+		return -1;
+	}
+	_dalvik_memberdict_sorted_index_dirty = 0;
 	return 0;
 }
 void dalvik_memberdict_finalize()
@@ -60,6 +81,8 @@ void dalvik_memberdict_finalize()
 			free(old);
 		}
 	}
+	if(NULL != _dalvik_memberdict_sorted_index) vector_free(_dalvik_memberdict_sorted_index);
+	_dalvik_memberdict_sorted_index = NULL;
 }
 /**
  * @brief check wether or not p is a prefix of s
@@ -69,13 +92,77 @@ void dalvik_memberdict_finalize()
  **/
 static inline int _dalvik_memberdict_check_prefix(const char* p, const char* s)
 {
-	int ret = 1;
 	if(NULL == p) return NULL == s;
-	for(;*p && s && *s && ret; ret = (*(p++) == *(s++)));
-	return ret;
+	if(NULL == s) return 0 == *p;
+	for(;*p && *p == *s; p ++, s ++);
+	return 0 == *p;
+}
+/**
+ * @brief compare two strings, NULL is less than any string
+ * @param a
+ * @param b
+ * @return the compare result same as strcmp
+ **/
+static inline int _dalvik_memberdict_strcmp(const char* a, const char* b)
+{
+	if(a == b) return 0;
+	if(NULL == a) return -1;
+	if(NULL == b) return 1;
+	return strcmp(a, b);
+}
+/**
+ * @brief the compare function used to sort the index
+ * @param left
+ * @param right
+ * @return the compare result
+ **/
+static int _dalvik_memberdict_node_compare(const void* left, const void* right)
+{
+	const dalvik_memberdict_node_t* a = *(const dalvik_memberdict_node_t* const*)left;
+	const dalvik_memberdict_node_t* b = *(const dalvik_memberdict_node_t* const*)right;
+	int rc = _dalvik_memberdict_strcmp(a->class_path, b->class_path);
+	if(0 != rc) return rc;
+	return _dalvik_memberdict_strcmp(a->member_name, b->member_name);
+}
+/**
+ * @brief get the i-th node in the sorted index
+ * @param idx the index
+ * @return the node
+ **/
+static inline const dalvik_memberdict_node_t* _dalvik_memberdict_sorted_index_get(int idx)
+{
+	return *(const dalvik_memberdict_node_t**)vector_get(_dalvik_memberdict_sorted_index, idx);
+}
+/**
+ * @brief find the first node in the sorted index whose class path is not less than the prefix
+ * @param prefix the class path prefix
+ * @return the index of the node
+ **/
+static inline int _dalvik_memberdict_sorted_index_lower_bound(const char* prefix)
+{
+	if(_dalvik_memberdict_sorted_index_dirty)
+	{
+		qsort(_dalvik_memberdict_sorted_index->data, 
+			  vector_size(_dalvik_memberdict_sorted_index), 
+			  sizeof(dalvik_memberdict_node_t*), 
+			  _dalvik_memberdict_node_compare);
+		_dalvik_memberdict_sorted_index_dirty = 0;
+	}
+	int l = 0, r = vector_size(_dalvik_memberdict_sorted_index);
+	while(l < r)
+	{
+		int m = (l + r) / 2;
+		if(strcmp(_dalvik_memberdict_sorted_index_get(m)->class_path, prefix) < 0)
+			l = m + 1;
+		else
+			r = m;
+	}
+	return l;
 }
 /**
  * @brief get the list of members
+ * @details the nodes with the class path prefix are consecutive in the sorted index,
+ *          so that we locate the first one with a binary search and scan the range
  * @param class_path_prefix the prefix of the class path
  * @param member_name_prefix the prefix of the member name
  * @param p_class_path the buffer to return the class path
@@ -95,21 +182,21 @@ static inline int _dalvik_memberdict_member_match(
 		size_t bufsize)
 {
 	int ret = 0;
+	/* all class path are not NULL */
+	if(NULL == class_path_prefix) return 0;
 	int i;
-	for(i = 0; i < DALVIK_MEMBERDICT_SIZE && ret < bufsize; i ++)
+	int size = vector_size(_dalvik_memberdict_sorted_index);
+	for(i = _dalvik_memberdict_sorted_index_lower_bound(class_path_prefix); i < size && ret < bufsize; i ++)
 	{
-		dalvik_memberdict_node_t* ptr;
-		for(ptr = _dalvik_memberdict_hash_table[i]; NULL != ptr; ptr = ptr->next)
+		const dalvik_memberdict_node_t* ptr = _dalvik_memberdict_sorted_index_get(i);
+		if(!_dalvik_memberdict_check_prefix(class_path_prefix, ptr->class_path)) break;
+		if(_dalvik_memberdict_check_prefix(member_name_prefix, ptr->member_name))
 		{
-			if(_dalvik_memberdict_check_prefix(class_path_prefix, ptr->class_path) &&
-			   _dalvik_memberdict_check_prefix(member_name_prefix, ptr->member_name))
-			{
-				if(NULL != p_class_path) p_class_path[ret] = ptr->class_path;
-				if(NULL != p_member_name) p_member_name[ret] = ptr->member_name;
-				if(NULL != p_signature) p_signature[ret] = ptr->args;
-				if(NULL != p_return_type) p_return_type[ret] = ptr->rtype;
-				ret ++;
-			}
+			if(NULL != p_class_path) p_class_path[ret] = ptr->class_path;
+			if(NULL != p_member_name) p_member_name[ret] = ptr->member_name;
+			if(NULL != p_signature) p_signature[ret] = ptr->args;
+			if(NULL != p_return_type) p_return_type[ret] = ptr->rtype;
+			ret ++;
 		}
 	}
 	return ret;
@@ -181,6 +268,12 @@ static inline int _dalvik_memberdict_register_object(
 	ptr->type = type;
 	ptr->next = _dalvik_memberdict_hash_table[idx];
 	_dalvik_memberdict_hash_table[idx] = ptr;
+	if(vector_pushback(_dalvik_memberdict_sorted_index, &ptr) < 0)
+	{
+		LOG_ERROR("can not add %s.%s to the sorted index", class_path, object_name);
+		return -1;
+	}
+	_dalvik_memberdict_sorted_index_dirty = 1;
 	switch(type)
 	{
 		case _TYPE_CLASS:
@@ -218,7 +311,9 @@ int dalvik_memberdict_register_field(const char* class_path, dalvik_field_t* fie
 int dalvik_memberdict_register_class(const char* class_path, dalvik_class_t* class)
 {
 	if(NULL == class) return -1;
-	return _dalvik_memberdict_register_object(class_path, NULL, NULL, NULL, _TYPE_CLASS, class);
+	if(_dalvik_memberdict_register_object(class_path, NULL, NULL, NULL, _TYPE_CLASS, class) < 0) return -1;
+	/* keep the class hierarchy index in sync */
+	return dalvik_hierarchy_add_class(class);
 }
 /** 
  * @brief find an object from the member dict with key <classpath, name, typelist, return_type> 
@@ -250,6 +345,9 @@ static inline const void* _dalvik_memberdict_find_object(
 			return ptr->object;
 		}
 	}
+	/* the class may be indexed but not loaded yet, load it and try again */
+	if(dalvik_loader_load_class(path) > 0)
+		return _dalvik_memberdict_find_object(path, name, args, rtype, type);
 	return NULL;
 }
 
@@ -274,6 +372,7 @@ const dalvik_class_t* dalvik_memberdict_get_class(const char* class_path)
 }
 int dalvik_memberdict_find_class_by_prefix(const char* prefix, const char** p_class_path, size_t bufsize)
 {
+	dalvik_loader_load_all();
 	return _dalvik_memberdict_member_match(prefix, NULL, p_class_path, NULL, NULL, NULL, bufsize);
 }
 int dalvik_memberdict_find_member_by_prefix(
@@ -285,5 +384,30 @@ int dalvik_memberdict_find_member_by_prefix(
 		const dalvik_type_t ** p_rettype,
 		size_t bufsize)
 {
+	dalvik_loader_load_all();
 	return _dalvik_memberdict_member_match(class_prefix, method_prefix, p_class_path, p_method_name, p_signature, p_rettype, bufsize);
 }
+int dalvik_memberdict_get_methods(vector_t* result)
+{
+	if(NULL == result)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	dalvik_loader_load_all();
+	int i, ret = 0;
+	int size = vector_size(_dalvik_memberdict_sorted_index);
+	for(i = 0; i < size; i ++)
+	{
+		const dalvik_memberdict_node_t* ptr = _dalvik_memberdict_sorted_index_get(i);
+		if(_TYPE_METHOD != ptr->type) continue;
+		const dalvik_method_t* method = (const dalvik_method_t*)ptr->object;
+		if(vector_pushback(result, (void*)&method) < 0)
+		{
+			LOG_ERROR("can not append method %s.%s to the result", ptr->class_path, ptr->member_name);
+			return -1;
+		}
+		ret ++;
+	}
+	return ret;
+}
@@ -56,6 +56,8 @@ dalvik_method_t* dalvik_method_from_sexp(const sexpression_t* sexp, const char*
 	method->path = class_path;
 	method->file = file;
 	method->name = name;
+	method->num_regs = 0;
+	method->entry = DALVIK_INSTRUCTION_INVALID;   /* abstract and native methods do not have any instruction */
 
 	/* Setup the type of argument list */
 	int i;
@@ -95,6 +97,11 @@ dalvik_method_t* dalvik_method_from_sexp(const sexpression_t* sexp, const char*
 												*/
 	label_sp  = 0;
 	dalvik_exception_handler_t* excepthandler[DALVIK_MAX_CATCH_BLOCK] = {};
+	if(dalvik_label_scope_begin() < 0)
+	{
+		LOG_ERROR("can not open the label scope for the method");
+		goto ERR;
+	}
 	dalvik_exception_handler_set_t* current_ehset = NULL;
 	int number_of_exception_handler = 0;
 	for(;body != SEXP_NIL;)
@@ -243,8 +250,10 @@ dalvik_method_t* dalvik_method_from_sexp(const sexpression_t* sexp, const char*
 			}
 		}
 	}
+	dalvik_label_scope_end();
 	return method;
 ERR:
+	dalvik_label_scope_end();
 	dalvik_method_free(method);
 	return NULL;
 }
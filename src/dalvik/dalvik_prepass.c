@@ -0,0 +1,562 @@
+/**
+ * @file dalvik_prepass.c
+ * @brief implementation of the register-only pre-pass
+ * @details The abstract value of a register is a set of kinds (negative, zero, positive and
+ *          non-null object), optionally refined by the exact integer value or the exact class
+ *          of the object. The null reference is represented by zero, as the bytecode does.
+ *          The states at the block entries are computed by a worklist algorithm, and the
+ *          branches that are never found feasible from a reachable block are disabled.
+ **/
+#include <stdlib.h>
+#include <string.h>
+
+#include <stringpool.h>
+
+#include <dalvik/dalvik_prepass.h>
+#include <dalvik/dalvik_memberdict.h>
+
+/** @brief the value might be negative */
+#define _DALVIK_PREPASS_NEG  0x1u
+/** @brief the value might be zero (or null) */
+#define _DALVIK_PREPASS_ZERO 0x2u
+/** @brief the value might be positive */
+#define _DALVIK_PREPASS_POS  0x4u
+/** @brief the value might be a non-null object */
+#define _DALVIK_PREPASS_OBJ  0x8u
+/** @brief all the numeric kinds */
+#define _DALVIK_PREPASS_NUM  (_DALVIK_PREPASS_NEG | _DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_POS)
+/** @brief any value */
+#define _DALVIK_PREPASS_ANY  (_DALVIK_PREPASS_NUM | _DALVIK_PREPASS_OBJ)
+
+/**
+ * @brief the abstract value of a register
+ **/
+typedef struct {
+	uint8_t     kind;   /*!< the possible kinds of the value, 0 means the register is not reached yet */
+	uint8_t     exact;  /*!< if the value is exactly the integer value */
+	int32_t     value;  /*!< the integer value, only valid when exact is set */
+	const char* type;   /*!< the exact class of the non-null object, NULL if unknown */
+} _dalvik_prepass_value_t;
+
+/** @brief the class path of the root class */
+static const char* _dalvik_prepass_root;
+
+int dalvik_prepass_enabled = 1;
+
+int dalvik_prepass_init()
+{
+	const char* spec = getenv("ADAMPREPASS");
+	dalvik_prepass_enabled = (NULL == spec || 0 != strcmp(spec, "0"));
+	if(!dalvik_prepass_enabled) LOG_DEBUG("the pre-pass is disabled");
+	if(NULL == (_dalvik_prepass_root = stringpool_query("java/lang/Object")))
+	{
+		LOG_ERROR("can not query the class path of the root class");
+		return -1;
+	}
+	return 0;
+}
+void dalvik_prepass_finalize()
+{
+	_dalvik_prepass_root = NULL;
+	dalvik_prepass_enabled = 1;
+}
+/**
+ * @brief make a value of the given kinds
+ * @param kind the kinds
+ * @return the value
+ **/
+static inline _dalvik_prepass_value_t _dalvik_prepass_kind(uint8_t kind)
+{
+	_dalvik_prepass_value_t ret = {
+		.kind = kind
+	};
+	return ret;
+}
+/**
+ * @brief make an exact integer value
+ * @param value the integer
+ * @return the abstract value
+ **/
+static inline _dalvik_prepass_value_t _dalvik_prepass_exact(int32_t value)
+{
+	_dalvik_prepass_value_t ret = {
+		.kind  = (value < 0) ? _DALVIK_PREPASS_NEG : (value > 0 ? _DALVIK_PREPASS_POS : _DALVIK_PREPASS_ZERO),
+		.exact = 1,
+		.value = value
+	};
+	return ret;
+}
+/**
+ * @brief join the source value into the destination
+ * @param dest the destination value
+ * @param sour the source value
+ * @return 1 if the destination is changed, 0 if not
+ **/
+static inline int _dalvik_prepass_join(_dalvik_prepass_value_t* dest, const _dalvik_prepass_value_t* sour)
+{
+	if(0 == sour->kind) return 0;
+	if(0 == dest->kind)
+	{
+		*dest = *sour;
+		return 1;
+	}
+	_dalvik_prepass_value_t result = {
+		.kind  = dest->kind | sour->kind,
+		.exact = dest->exact && sour->exact && dest->value == sour->value,
+		.value = dest->value
+	};
+	if(!(dest->kind & _DALVIK_PREPASS_OBJ)) result.type = sour->type;
+	else if(!(sour->kind & _DALVIK_PREPASS_OBJ) || dest->type == sour->type) result.type = dest->type;
+	if(!result.exact) result.value = 0;
+	if(result.kind == dest->kind && result.exact == dest->exact && result.value == dest->value && result.type == dest->type)
+		return 0;
+	*dest = result;
+	return 1;
+}
+/**
+ * @brief check if the operand occupies a register pair
+ * @param operand the operand
+ * @return the result
+ **/
+static inline int _dalvik_prepass_is_wide(const dalvik_operand_t* operand)
+{
+	return operand->header.info.size ||
+	       DVM_OPERAND_TYPE_LONG == operand->header.info.type ||
+	       DVM_OPERAND_TYPE_DOUBLE == operand->header.info.type;
+}
+/**
+ * @brief read the value of an operand
+ * @param regs the register states
+ * @param nregs the number of registers
+ * @param operand the operand
+ * @return the value, an unknown value if the operand can not be evaluated
+ **/
+static inline _dalvik_prepass_value_t _dalvik_prepass_read(const _dalvik_prepass_value_t* regs, uint32_t nregs, const dalvik_operand_t* operand)
+{
+	if(operand->header.info.is_const)
+	{
+		if(DVM_OPERAND_TYPE_INT == operand->header.info.type && !operand->header.info.size)
+			return _dalvik_prepass_exact(operand->payload.int32);
+		return _dalvik_prepass_kind(_DALVIK_PREPASS_ANY);
+	}
+	if(operand->header.info.is_result) return regs[nregs];
+	if(operand->payload.uint16 >= nregs || 0 == regs[operand->payload.uint16].kind)
+		return _dalvik_prepass_kind(_DALVIK_PREPASS_ANY);
+	return regs[operand->payload.uint16];
+}
+/**
+ * @brief write a value to the register (pair) of the operand
+ * @param regs the register states
+ * @param nregs the number of registers
+ * @param operand the destination operand
+ * @param value the value
+ * @return nothing
+ **/
+static inline void _dalvik_prepass_write(_dalvik_prepass_value_t* regs, uint32_t nregs, const dalvik_operand_t* operand, _dalvik_prepass_value_t value)
+{
+	uint32_t reg = operand->payload.uint16;
+	if(reg < nregs) regs[reg] = value;
+	if(_dalvik_prepass_is_wide(operand) && reg + 1 < nregs)
+	{
+		/* the exact value is only tracked for the 32 bit integers */
+		value.exact = 0;
+		value.value = 0;
+		regs[reg + 1] = value;
+		if(reg < nregs) regs[reg] = value;
+	}
+}
+/**
+ * @brief get the possible signs of a value, which is compared with another value
+ * @param value the value
+ * @param other the other value
+ * @return the set of signs
+ **/
+static inline uint8_t _dalvik_prepass_sign(const _dalvik_prepass_value_t* value, const _dalvik_prepass_value_t* other)
+{
+	if(0 == value->kind) return _DALVIK_PREPASS_NUM;
+	uint8_t ret = value->kind & _DALVIK_PREPASS_NUM;
+	/* a non-null object is different from null, but we know nothing about two references */
+	if(value->kind & _DALVIK_PREPASS_OBJ)
+		ret |= (other->exact && 0 == other->value) ? (_DALVIK_PREPASS_NEG | _DALVIK_PREPASS_POS) : _DALVIK_PREPASS_NUM;
+	return ret;
+}
+/**
+ * @brief get the possible signs of left - right
+ * @param left the left value
+ * @param right the right value
+ * @return the set of signs
+ **/
+static inline uint8_t _dalvik_prepass_compare(const _dalvik_prepass_value_t* left, const _dalvik_prepass_value_t* right)
+{
+	if(left->exact && right->exact)
+		return _dalvik_prepass_exact(left->value < right->value ? -1 : (left->value > right->value ? 1 : 0)).kind;
+	uint8_t ls = _dalvik_prepass_sign(left, right);
+	uint8_t rs = _dalvik_prepass_sign(right, left);
+	uint8_t ret = 0;
+	int i, j;
+	for(i = 0; i < 3; i ++)
+		for(j = 0; j < 3; j ++)
+		{
+			if(!(ls & (1 << i)) || !(rs & (1 << j))) continue;
+			/* i, j = 0, 1, 2 for negative, zero, positive */
+			if(1 == j) ret |= (1 << i);
+			else if(1 == i) ret |= (1 << (2 - j));
+			else if(i != j) ret |= (1 << i);
+			else ret |= _DALVIK_PREPASS_NUM;
+		}
+	return ret;
+}
+/**
+ * @brief check if the instances of a class are instances of the target class
+ * @param classpath the class path
+ * @param target the target class path
+ * @param depth the depth of the recursion
+ * @return 1 if it is, 0 if it's not, < 0 if we can not tell because some super type is not loaded
+ **/
+static inline int _dalvik_prepass_is_subtype(const char* classpath, const char* target, uint32_t depth)
+{
+	if(classpath == target) return 1;
+	if(classpath == _dalvik_prepass_root) return 0;
+	if(depth >= DALVIK_PREPASS_MAX_HIERARCHY_DEPTH) return -1;
+	const dalvik_class_t* class = dalvik_memberdict_get_class(classpath);
+	if(NULL == class) return -1;
+	int ret = 0, i;
+	for(i = 0; NULL != class->implements[i]; i ++)
+	{
+		int rc = _dalvik_prepass_is_subtype(class->implements[i], target, depth + 1);
+		if(rc > 0) return rc;
+		if(rc < 0) ret = rc;
+	}
+	if(NULL != class->super)
+	{
+		int rc = _dalvik_prepass_is_subtype(class->super, target, depth + 1);
+		if(0 != rc) return rc;
+	}
+	return ret;
+}
+/**
+ * @brief the result of the instance-of instruction
+ * @param value the value of the object
+ * @param operand the type operand
+ * @return the result
+ **/
+static inline _dalvik_prepass_value_t _dalvik_prepass_instance_of(const _dalvik_prepass_value_t* value, const dalvik_operand_t* operand)
+{
+	if(value->kind == _DALVIK_PREPASS_ZERO) return _dalvik_prepass_exact(0);
+	const char* target = NULL;
+	if(DVM_OPERAND_TYPE_CLASS == operand->header.info.type)
+		target = operand->payload.string;
+	else if(DVM_OPERAND_TYPE_TYPEDESC == operand->header.info.type && DALVIK_TYPECODE_OBJECT == operand->payload.type->typecode)
+		target = operand->payload.type->data.object.path;
+	_dalvik_prepass_value_t unknown = _dalvik_prepass_kind(_DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_POS);
+	/* the value is either null or an object of the exact class */
+	if(NULL == target || NULL == value->type || (value->kind & ~(_DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_OBJ))) return unknown;
+	int rc = _dalvik_prepass_is_subtype(value->type, target, 0);
+	if(0 == rc) return _dalvik_prepass_exact(0);
+	if(rc > 0 && !(value->kind & _DALVIK_PREPASS_ZERO)) return _dalvik_prepass_exact(1);
+	return unknown;
+}
+/**
+ * @brief the value of the register after a check-cast instruction succeeds
+ * @details the register holds either null or an instance of the target class afterwards, so the numeric
+ *          kinds are dropped. If the exact class of the object is not a sub type of the target, only null
+ *          passes the cast.
+ * @param value the value of the register before the check-cast
+ * @param operand the type operand
+ * @return the refined value
+ **/
+static inline _dalvik_prepass_value_t _dalvik_prepass_check_cast(const _dalvik_prepass_value_t* value, const dalvik_operand_t* operand)
+{
+	const char* target = NULL;
+	if(DVM_OPERAND_TYPE_CLASS == operand->header.info.type)
+		target = operand->payload.string;
+	else if(DVM_OPERAND_TYPE_TYPEDESC == operand->header.info.type && DALVIK_TYPECODE_OBJECT == operand->payload.type->typecode)
+		target = operand->payload.type->data.object.path;
+	if((value->kind & _DALVIK_PREPASS_OBJ) && NULL != value->type && NULL != target && 0 == _dalvik_prepass_is_subtype(value->type, target, 0))
+		return _dalvik_prepass_exact(0);
+	_dalvik_prepass_value_t ret = *value;
+	ret.kind &= (_DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_OBJ);
+	/* a value which is known to be a number can not pass the cast, and the fall through is dead */
+	if(0 == ret.kind) return _dalvik_prepass_kind(_DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_OBJ);
+	if(_DALVIK_PREPASS_ZERO == ret.kind) return _dalvik_prepass_exact(0);
+	ret.exact = 0;
+	ret.value = 0;
+	return ret;
+}
+/**
+ * @brief the result of an arithmetic instruction on two exact 32 bit integers
+ * @param flags the instruction flags
+ * @param a the first operand
+ * @param b the second operand
+ * @param result the buffer for the result
+ * @return 1 if the result is computed, 0 if it's not tracked
+ **/
+static inline int _dalvik_prepass_binop(uint32_t flags, int32_t a, int32_t b, int32_t* result)
+{
+	/* the arithmetic wraps around, so it's done on the unsigned integers */
+	uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+	switch(flags)
+	{
+		case DVM_FLAG_BINOP_ADD:  *result = (int32_t)(ua + ub); return 1;
+		case DVM_FLAG_BINOP_SUB:  *result = (int32_t)(ua - ub); return 1;
+		case DVM_FLAG_BINOP_RSUB: *result = (int32_t)(ub - ua); return 1;
+		case DVM_FLAG_BINOP_MUL:  *result = (int32_t)(ua * ub); return 1;
+		case DVM_FLAG_BINOP_AND:  *result = (int32_t)(ua & ub); return 1;
+		case DVM_FLAG_BINOP_OR:   *result = (int32_t)(ua | ub); return 1;
+		case DVM_FLAG_BINOP_XOR:  *result = (int32_t)(ua ^ ub); return 1;
+	}
+	return 0;
+}
+/**
+ * @brief the transfer function of an instruction
+ * @param regs the register states, the last one is the result register
+ * @param nregs the number of registers
+ * @param inst the instruction
+ * @return nothing
+ **/
+static inline void _dalvik_prepass_transfer(_dalvik_prepass_value_t* regs, uint32_t nregs, const dalvik_instruction_t* inst)
+{
+	const dalvik_operand_t* ops = inst->operands;
+	_dalvik_prepass_value_t any = _dalvik_prepass_kind(_DALVIK_PREPASS_ANY);
+	_dalvik_prepass_value_t num = _dalvik_prepass_kind(_DALVIK_PREPASS_NUM);
+	_dalvik_prepass_value_t obj = _dalvik_prepass_kind(_DALVIK_PREPASS_OBJ);
+	_dalvik_prepass_value_t a, b;
+	int32_t value;
+	switch(inst->opcode)
+	{
+		case DVM_MOVE:
+			if(DVM_OPERAND_TYPE_EXCEPTION == ops[1].header.info.type)
+				_dalvik_prepass_write(regs, nregs, ops, obj);
+			else
+			{
+				a = _dalvik_prepass_read(regs, nregs, ops + 1);
+				if(!_dalvik_prepass_is_wide(ops) || ops[1].header.info.is_result)
+					_dalvik_prepass_write(regs, nregs, ops, a);
+				else if(ops[0].payload.uint16 < nregs && ops[0].payload.uint16 + 1 < nregs)
+				{
+					/* the register pair is copied as it is */
+					b = (ops[1].payload.uint16 + 1 < nregs) ? regs[ops[1].payload.uint16 + 1] : any;
+					regs[ops[0].payload.uint16] = a;
+					regs[ops[0].payload.uint16 + 1] = b;
+				}
+				else _dalvik_prepass_write(regs, nregs, ops, any);
+			}
+			break;
+		case DVM_CONST:
+			if(DVM_OPERAND_TYPE_INT != ops[1].header.info.type)
+				_dalvik_prepass_write(regs, nregs, ops, obj);
+			else if(ops[1].header.info.size)
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_kind(ops[1].payload.int64 < 0 ? _DALVIK_PREPASS_NEG :
+				                                                             (ops[1].payload.int64 > 0 ? _DALVIK_PREPASS_POS : _DALVIK_PREPASS_ZERO)));
+			else
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_exact(ops[1].payload.int32));
+			break;
+		case DVM_INSTANCE:
+			switch(inst->flags)
+			{
+				case DVM_FLAG_INSTANCE_OF:
+					a = _dalvik_prepass_read(regs, nregs, ops + 1);
+					_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_instance_of(&a, ops + 2));
+					break;
+				case DVM_FLAG_INSTANCE_NEW:
+					obj.type = ops[1].payload.string;
+					_dalvik_prepass_write(regs, nregs, ops, obj);
+					break;
+				case DVM_FLAG_INSTANCE_GET:
+				case DVM_FLAG_INSTANCE_SGET:
+					_dalvik_prepass_write(regs, nregs, ops, any);
+					break;
+			}
+			break;
+		case DVM_ARRAY:
+			switch(inst->flags)
+			{
+				case DVM_FLAG_ARRAY_LENGTH:
+					_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_kind(_DALVIK_PREPASS_ZERO | _DALVIK_PREPASS_POS));
+					break;
+				case DVM_FLAG_ARRAY_NEW:
+					_dalvik_prepass_write(regs, nregs, ops, obj);
+					break;
+				case DVM_FLAG_ARRAY_FILLED_NEW:
+				case DVM_FLAG_ARRAY_FILLED_NEW_RANGE:
+					regs[nregs] = obj;
+					break;
+				case DVM_FLAG_ARRAY_GET:
+					_dalvik_prepass_write(regs, nregs, ops, any);
+					break;
+			}
+			break;
+		case DVM_CMP:
+			if(DVM_OPERAND_TYPE_LONG == ops[1].header.info.type)
+			{
+				a = _dalvik_prepass_read(regs, nregs, ops + 1);
+				b = _dalvik_prepass_read(regs, nregs, ops + 2);
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_kind(_dalvik_prepass_compare(&a, &b)));
+			}
+			else
+				/* the NaN and the negative zero makes the comparison of the bits meaningless */
+				_dalvik_prepass_write(regs, nregs, ops, num);
+			break;
+		case DVM_UNOP:
+			a = _dalvik_prepass_read(regs, nregs, ops + 1);
+			if(a.exact && DVM_OPERAND_TYPE_INT == ops[1].header.info.type && DVM_FLAG_UOP_NEG == inst->flags)
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_exact((int32_t)(0u - (uint32_t)a.value)));
+			else if(a.exact && DVM_OPERAND_TYPE_INT == ops[1].header.info.type && DVM_FLAG_UOP_NOT == inst->flags)
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_exact(~a.value));
+			else
+				_dalvik_prepass_write(regs, nregs, ops, num);
+			break;
+		case DVM_BINOP:
+			a = _dalvik_prepass_read(regs, nregs, ops + 1);
+			b = _dalvik_prepass_read(regs, nregs, ops + 2);
+			if(a.exact && b.exact && DVM_OPERAND_TYPE_INT == ops[0].header.info.type &&
+			   _dalvik_prepass_binop(inst->flags, a.value, b.value, &value))
+				_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_exact(value));
+			else
+				_dalvik_prepass_write(regs, nregs, ops, num);
+			break;
+		case DVM_CHECK_CAST:
+			a = _dalvik_prepass_read(regs, nregs, ops);
+			_dalvik_prepass_write(regs, nregs, ops, _dalvik_prepass_check_cast(&a, ops + 1));
+			break;
+		case DVM_INVOKE:
+			regs[nregs] = any;
+			break;
+		/* the other instructions do not write any register */
+	}
+}
+/**
+ * @brief check if a branch might be taken
+ * @details the default branch of an if block is taken iff the condition of the conditional
+ *          branch does not hold. The other unconditional branches are always feasible.
+ * @param block the block
+ * @param index the branch index
+ * @param regs the register states at the end of the block
+ * @param nregs the number of registers
+ * @return 1 if the branch might be taken, 0 if it's infeasible
+ **/
+static inline int _dalvik_prepass_branch_feasible(const dalvik_block_t* block, uint32_t index, const _dalvik_prepass_value_t* regs, uint32_t nregs)
+{
+	const dalvik_block_branch_t* branch = block->branches + index;
+	int negative = 0;
+	if(!branch->conditional)
+	{
+		if(1 != index || 2 != block->nbranches || !block->branches[0].conditional || block->branches[0].left_inst)
+			return 1;
+		branch = block->branches;
+		negative = 1;
+	}
+	_dalvik_prepass_value_t left = branch->left_inst ? _dalvik_prepass_exact(branch->ileft[0]) : _dalvik_prepass_read(regs, nregs, branch->left);
+	_dalvik_prepass_value_t right = _dalvik_prepass_read(regs, nregs, branch->right);
+	uint8_t diff = _dalvik_prepass_compare(&left, &right);
+	return ((diff & _DALVIK_PREPASS_NEG) && (branch->lt ^ negative)) ||
+	       ((diff & _DALVIK_PREPASS_ZERO) && (branch->eq ^ negative)) ||
+	       ((diff & _DALVIK_PREPASS_POS) && (branch->gt ^ negative));
+}
+int dalvik_prepass_prune(dalvik_block_t** blocks, uint32_t kcnt, uint32_t nregs)
+{
+	if(NULL == blocks || 0 == kcnt)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	if(!dalvik_prepass_enabled) return 0;
+	/* one more slot for the result register */
+	size_t width = nregs + 1;
+	if(width * (kcnt + 2) > DALVIK_PREPASS_MAX_CELLS)
+	{
+		LOG_DEBUG("the method is too large for the pre-pass, skipped");
+		return 0;
+	}
+	int ret = -1;
+	uint32_t i, j, nbranches = 0;
+	for(i = 0; i < kcnt; i ++)
+		if(NULL != blocks[i]) nbranches += blocks[i]->nbranches;
+	/* the block entry states, the current state, the exception state */
+	_dalvik_prepass_value_t* states = (_dalvik_prepass_value_t*)calloc(width * (kcnt + 2), sizeof(_dalvik_prepass_value_t));
+	/* queue, in-queue flags, the offsets of the feasible flags */
+	uint32_t* mem = (uint32_t*)malloc(sizeof(uint32_t) * (3 * kcnt + 1));
+	uint8_t* feasible = (uint8_t*)calloc(nbranches + 1, 1);
+	if(NULL == states || NULL == mem || NULL == feasible)
+	{
+		LOG_ERROR("can not allocate memory for the pre-pass");
+		goto CLEANUP;
+	}
+	_dalvik_prepass_value_t* current = states + width * kcnt;
+	_dalvik_prepass_value_t* exception = current + width;
+	uint32_t* queue = mem;
+	uint32_t* queued = queue + kcnt;
+	uint32_t* offset = queued + kcnt;
+	for(i = 0, offset[0] = 0; i < kcnt; i ++)
+	{
+		queued[i] = 0;
+		offset[i + 1] = offset[i] + (NULL != blocks[i] ? blocks[i]->nbranches : 0);
+	}
+
+	/* nothing is known at the entry */
+	for(i = 0; i < width; i ++)
+		states[i] = _dalvik_prepass_kind(_DALVIK_PREPASS_ANY);
+	uint32_t head = 0, count = 1;
+	queue[0] = 0;
+	queued[0] = 1;
+	while(count > 0)
+	{
+		const dalvik_block_t* block = blocks[queue[head]];
+		head = (head + 1) % kcnt;
+		count --;
+		queued[block->index] = 0;
+		memcpy(current, states + width * block->index, sizeof(_dalvik_prepass_value_t) * width);
+		memcpy(exception, current, sizeof(_dalvik_prepass_value_t) * width);
+		for(i = block->begin; i < block->end; i ++)
+		{
+			/* an exception might be thrown before any instruction */
+			for(j = 0; j < width; j ++)
+				_dalvik_prepass_join(exception + j, current + j);
+			_dalvik_prepass_transfer(current, nregs, dalvik_instruction_get(i));
+		}
+		for(i = 0; i < block->nbranches; i ++)
+		{
+			const dalvik_block_branch_t* branch = block->branches + i;
+			if(branch->disabled || DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch) || NULL == branch->block) continue;
+			const _dalvik_prepass_value_t* output = current;
+			if(DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_EXCEPTION(*branch))
+				output = exception;
+			else if(!_dalvik_prepass_branch_feasible(block, i, current, nregs))
+				continue;
+			feasible[offset[block->index] + i] = 1;
+			uint32_t target = branch->block->index;
+			int changed = 0;
+			for(j = 0; j < width; j ++)
+				changed |= _dalvik_prepass_join(states + width * target + j, output + j);
+			if(changed && !queued[target])
+			{
+				queue[(head + count) % kcnt] = target;
+				queued[target] = 1;
+				count ++;
+			}
+		}
+	}
+
+	/* disable the branches of the reachable blocks which are never taken */
+	ret = 0;
+	for(i = 0; i < kcnt; i ++)
+	{
+		dalvik_block_t* block = blocks[i];
+		if(NULL == block || 0 == states[width * i].kind) continue;
+		for(j = 0; j < block->nbranches; j ++)
+		{
+			dalvik_block_branch_t* branch = block->branches + j;
+			if(branch->disabled || DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(*branch) || NULL == branch->block) continue;
+			if(feasible[offset[i] + j]) continue;
+			LOG_DEBUG("the branch from block #%d to block #%d is infeasible, disabled", block->index, branch->block->index);
+			branch->disabled = 1;
+			branch->block = NULL;
+			ret ++;
+		}
+	}
+CLEANUP:
+	if(NULL != states) free(states);
+	if(NULL != mem) free(mem);
+	if(NULL != feasible) free(feasible);
+	return ret;
+}
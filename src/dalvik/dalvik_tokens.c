@@ -135,6 +135,7 @@ static const char* _dalvik_token_defs[DALVIK_MAX_NUM_KEYWORDS] = {
 	[116]="_invoke",
 	[117]="volatile",
 	[118]="native",
+	[119]="<fill_array_data>",
 	NULL
 }; 
 int dalvik_tokens_init(void)
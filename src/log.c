@@ -4,8 +4,261 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 static char _log_path[8][128] = {};
 static FILE* _log_fp[8] = {};
+
+int log_filter_generation = 0;
+/** @brief the global level threshold */
+static int _log_threshold = DEBUG;
+/** @brief the module filters */
+static struct {
+	char module[128];   /*!< the prefix of the source file name */
+	int  level;         /*!< the level threshold */
+} _log_filters[LOG_MAX_FILTERS];
+/** @brief the number of module filters */
+static int _log_nfilters = 0;
+/** @brief if we write the log in binary format */
+static int _log_binary = 0;
+/** @brief if we use the background writer */
+static int _log_async = 0;
+
+/**
+ * @brief the ring buffer for asynchronous logging
+ * @details each thread writes to its own ring buffer, and the background writer is the only
+ *          reader, so the ring buffer is single-producer-single-consumer and needs no lock.
+ *          A record in the ring buffer begins with a log_ring_record_t and it never wraps around
+ *          the end of the buffer, a padding record is used instead.
+ **/
+typedef struct _log_ring_t {
+	uint64_t head;                   /*!< the write position, only changed by the producer */
+	uint64_t tail;                   /*!< the read position, only changed by the writer thread */
+	struct _log_ring_t* next;        /*!< the next ring buffer in the list */
+	char data[LOG_RING_SIZE];        /*!< the buffer */
+} log_ring_t;
+/** @brief the header of a record in the ring buffer */
+typedef struct {
+	uint32_t size;    /*!< the size of the record including this header */
+	int32_t  level;   /*!< the log level, -1 for a padding record */
+} log_ring_record_t;
+/** @brief align the record size, so that the record header is always aligned */
+#define _LOG_RING_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+/** @brief the list of all ring buffers */
+static log_ring_t* _log_ring_list = NULL;
+/** @brief the mutex protects the ring list */
+static pthread_mutex_t _log_ring_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** @brief the ring buffer of current thread */
+static __thread log_ring_t* _log_ring = NULL;
+/** @brief the key used to release the ring buffer when a thread exits */
+static pthread_key_t _log_ring_key;
+/** @brief if the key of the ring buffer is created */
+static int _log_ring_key_created = 0;
+/** @brief the background writer thread */
+static pthread_t _log_writer;
+/** @brief if the background writer is running */
+static int _log_writer_running = 0;
+/** @brief set to 1 to stop the writer */
+static volatile int _log_writer_stop = 0;
+
+/**
+ * @brief parse the name of a log level
+ * @param name the level name
+ * @return the level, < 0 if it's not a level name
+ **/
+static inline int _log_level_from_name(const char* name)
+{
+#define     _STR_TO_ID(lvl) if(strcmp(name, #lvl) == 0) return lvl
+	_STR_TO_ID(DEBUG);
+	_STR_TO_ID(TRACE);
+	_STR_TO_ID(INFO);
+	_STR_TO_ID(NOTICE);
+	_STR_TO_ID(WARNING);
+	_STR_TO_ID(ERROR);
+	_STR_TO_ID(FATAL);
+#undef      _STR_TO_ID
+	return -1;
+}
+/**
+ * @brief handle the directives that is not an output redirection
+ * @param type the directive
+ * @param arg1 the first argument
+ * @param arg2 the second argument, NULL if there's no second argument
+ * @return 1 if the line is handled, 0 if this is not such directive
+ **/
+static inline int _log_config_directive(const char* type, const char* arg1, const char* arg2)
+{
+	if(strcmp(type, "level") == 0)
+	{
+		int level = _log_level_from_name(arg1);
+		if(level < 0) fprintf(stderr, "warning: unknown log level %s\n", arg1);
+		else log_set_filter(NULL, level);
+		return 1;
+	}
+	if(strcmp(type, "filter") == 0)
+	{
+		int level = (NULL == arg2)?-1:_log_level_from_name(arg2);
+		if(level < 0) fprintf(stderr, "warning: invalid log filter for %s\n", arg1);
+		else log_set_filter(arg1, level);
+		return 1;
+	}
+	if(strcmp(type, "async") == 0)
+	{
+		_log_async = (strcmp(arg1, "on") == 0);
+		return 1;
+	}
+	if(strcmp(type, "format") == 0)
+	{
+		_log_binary = (strcmp(arg1, "binary") == 0);
+		return 1;
+	}
+	return 0;
+}
+/**
+ * @brief write the records to the log files
+ * @param data the records
+ * @param size the size of the data
+ * @param p_used the buffer used to return which log file is written
+ * @return nothing
+ **/
+static inline void _log_ring_write(const char* data, size_t size, int* p_used)
+{
+	size_t ofs;
+	for(ofs = 0; ofs < size;)
+	{
+		const log_ring_record_t* record = (const log_ring_record_t*)(data + ofs);
+		if(record->level >= 0)
+		{
+			const char* payload = (const char*)(record + 1);
+			size_t len = strnlen(payload, record->size - sizeof(log_ring_record_t));
+			if(_log_binary)
+			{
+				const log_binary_record_t* brec = (const log_binary_record_t*)payload;
+				len = sizeof(log_binary_record_t) + brec->file_len + brec->function_len + brec->message_len;
+			}
+			fwrite(payload, 1, len, _log_fp[record->level]);
+			p_used[record->level] = 1;
+		}
+		ofs += record->size;
+	}
+}
+/**
+ * @brief drain all ring buffers
+ * @return the number of bytes drained
+ **/
+static inline size_t _log_ring_drain()
+{
+	int used[8] = {};
+	size_t ret = 0;
+	log_ring_t* ring;
+	pthread_mutex_lock(&_log_ring_list_mutex);
+	for(ring = _log_ring_list; NULL != ring; ring = ring->next)
+	{
+		uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		uint64_t tail = ring->tail;
+		while(tail < head)
+		{
+			/* write the longest consecutive piece at once */
+			size_t begin = tail & (LOG_RING_SIZE - 1);
+			size_t size = head - tail;
+			if(begin + size > LOG_RING_SIZE) size = LOG_RING_SIZE - begin;
+			_log_ring_write(ring->data + begin, size, used);
+			tail += size;
+			ret += size;
+		}
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&_log_ring_list_mutex);
+	int i;
+	for(i = 0; i < 8; i ++)
+		if(used[i]) fflush(_log_fp[i]);
+	return ret;
+}
+/**
+ * @brief the background writer
+ * @param arg unused
+ * @return NULL
+ **/
+static void* _log_writer_main(void* arg)
+{
+	for(;;)
+	{
+		int stop = _log_writer_stop;
+		if(0 == _log_ring_drain())
+		{
+			if(stop) break;
+			usleep(LOG_WRITER_INTERVAL);
+		}
+	}
+	return NULL;
+}
+/**
+ * @brief release the ring buffer of a thread which is exiting
+ * @details the records in the buffer are drained by the writer first, and then the buffer
+ *          is removed from the list
+ * @param data the ring buffer
+ * @return nothing
+ **/
+static void _log_ring_release(void* data)
+{
+	log_ring_t* ring = (log_ring_t*)data;
+	if(NULL == ring) return;
+	if(_log_writer_running)
+	{
+		while(__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) < ring->head)
+			usleep(LOG_WRITER_INTERVAL);
+	}
+	pthread_mutex_lock(&_log_ring_list_mutex);
+	log_ring_t** p;
+	for(p = &_log_ring_list; NULL != *p && ring != *p; p = &(*p)->next);
+	if(NULL != *p) *p = ring->next;
+	pthread_mutex_unlock(&_log_ring_list_mutex);
+	free(ring);
+	_log_ring = NULL;
+}
+/**
+ * @brief get the ring buffer of current thread
+ * @return the ring buffer, NULL indicates error
+ **/
+static inline log_ring_t* _log_ring_get()
+{
+	if(NULL != _log_ring) return _log_ring;
+	log_ring_t* ring = (log_ring_t*)malloc(sizeof(log_ring_t));
+	if(NULL == ring) return NULL;
+	ring->head = ring->tail = 0;
+	pthread_mutex_lock(&_log_ring_list_mutex);
+	ring->next = _log_ring_list;
+	_log_ring_list = ring;
+	pthread_mutex_unlock(&_log_ring_list_mutex);
+	/* the buffer is released when the thread exits */
+	if(_log_ring_key_created) pthread_setspecific(_log_ring_key, ring);
+	return _log_ring = ring;
+}
+/**
+ * @brief reserve space in the ring buffer, wait for the writer if the buffer is full
+ * @param ring the ring buffer
+ * @param size the size of the space (aligned)
+ * @return the pointer to the reserved space
+ **/
+static inline log_ring_record_t* _log_ring_reserve(log_ring_t* ring, size_t size)
+{
+	size_t begin = ring->head & (LOG_RING_SIZE - 1);
+	size_t padding = 0;
+	if(begin + size > LOG_RING_SIZE) padding = LOG_RING_SIZE - begin;
+	while(ring->head + padding + size - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > LOG_RING_SIZE)
+		usleep(LOG_WRITER_INTERVAL);
+	if(padding > 0)
+	{
+		log_ring_record_t* pad = (log_ring_record_t*)(ring->data + begin);
+		pad->size = padding;
+		pad->level = -1;
+		__atomic_store_n(&ring->head, ring->head + padding, __ATOMIC_RELEASE);
+		begin = 0;
+	}
+	return (log_ring_record_t*)(ring->data + begin);
+}
 int log_init()
 {
 	FILE* default_fp = stderr;
@@ -43,27 +296,19 @@ int log_init()
 			*end = 0;
 			int rc = sscanf(begin, "%s%s%s", type, path, mode);
 			if(rc < 2) continue;
-			if(rc == 2) 
+			if(_log_config_directive(type, path, (rc == 3)?mode:NULL)) continue;
+			if(rc == 2)
 			{
 				mode[0] = 'w';
 				mode[1] = '0';
 			}
 			int level;
-#define     _STR_TO_ID(name) else if(strcmp(type, #name) == 0) level = name
-			if(0);
-			_STR_TO_ID(DEBUG);
-			_STR_TO_ID(TRACE);
-			_STR_TO_ID(INFO);
-			_STR_TO_ID(NOTICE);
-			_STR_TO_ID(WARNING);
-			_STR_TO_ID(ERROR);
-			_STR_TO_ID(FATAL);
-			else if(strcmp(type, "default") == 0)
+			if(strcmp(type, "default") == 0)
 				level = 7;
-			else continue;
-#undef      _STR_TO_ID
+			else if((level = _log_level_from_name(type)) < 0)
+				continue;
 
-			FILE* outfile = NULL; 
+			FILE* outfile = NULL;
 			if(strcmp(path, "<stdin>") == 0) outfile = stdin;
 			else if(strcmp(path, "<stdout>") == 0) outfile = stdout;
 			else if(strcmp(path, "<stderr>") == 0) outfile = stderr;
@@ -84,7 +329,7 @@ int log_init()
 			if(_log_fp[level] != NULL)
 			{
 				int i;
-				/* more than one log file, override */ 
+				/* more than one log file, override */
 				FILE* unused = _log_fp[level];
 				for(i = 0; i < 8; i ++)
 					if(_log_fp[i] == unused && i != level)
@@ -110,11 +355,47 @@ int log_init()
 		}
 	}
 	if(NULL != fp) fclose(fp);
+	if(_log_async)
+	{
+		if(!_log_ring_key_created && 0 == pthread_key_create(&_log_ring_key, _log_ring_release))
+			_log_ring_key_created = 1;
+		_log_writer_stop = 0;
+		if(pthread_create(&_log_writer, NULL, _log_writer_main, NULL) != 0)
+		{
+			fprintf(stderr, "warning: can not start the log writer, fallback to synchronous logging\n");
+			_log_async = 0;
+		}
+		else _log_writer_running = 1;
+	}
 	return 0;
 }
 void log_finalize()
 {
 	int i, j;
+	if(_log_writer_running)
+	{
+		/* the writer drains all ring buffers before it exits */
+		_log_writer_stop = 1;
+		pthread_join(_log_writer, NULL);
+		_log_writer_running = 0;
+		_log_async = 0;
+	}
+	/* the buffers of the threads still running are freed below, so the destructor should not be called any more */
+	if(_log_ring_key_created)
+	{
+		pthread_setspecific(_log_ring_key, NULL);
+		pthread_key_delete(_log_ring_key);
+		_log_ring_key_created = 0;
+	}
+	pthread_mutex_lock(&_log_ring_list_mutex);
+	while(NULL != _log_ring_list)
+	{
+		log_ring_t* ring = _log_ring_list;
+		_log_ring_list = ring->next;
+		free(ring);
+	}
+	_log_ring = NULL;
+	pthread_mutex_unlock(&_log_ring_list_mutex);
 	for(i = 0; i < 8; i ++)
 		if(_log_fp[i] != NULL &&
 		   _log_fp[i] != stdin &&
@@ -128,18 +409,130 @@ void log_finalize()
 			fclose(unused);
 		}
 }
-void log_write(int level, const char* file, const char* function, int line, const char* fmt, ...)
+int log_filter_check(int level, const char* file)
+{
+	const char* p;
+	for(p = file; *p ; p ++)
+		if(*p == '/') file = p + 1;
+	/* the longest prefix wins */
+	int threshold = _log_threshold;
+	size_t matched = 0;
+	int i;
+	for(i = 0; i < _log_nfilters; i ++)
+	{
+		size_t len = strlen(_log_filters[i].module);
+		if(len >= matched && strncmp(file, _log_filters[i].module, len) == 0)
+		{
+			threshold = _log_filters[i].level;
+			matched = len;
+		}
+	}
+	return level <= threshold;
+}
+int log_set_filter(const char* module, int level)
+{
+	if(level < FATAL || level > DEBUG) return -1;
+	if(NULL == module)
+		_log_threshold = level;
+	else
+	{
+		int i;
+		for(i = 0; i < _log_nfilters && strcmp(_log_filters[i].module, module) != 0; i ++);
+		if(i == _log_nfilters)
+		{
+			if(_log_nfilters >= LOG_MAX_FILTERS || strlen(module) >= sizeof(_log_filters[i].module)) return -1;
+			strcpy(_log_filters[_log_nfilters ++].module, module);
+		}
+		_log_filters[i].level = level;
+	}
+	log_filter_generation ++;
+	return 0;
+}
+void log_flush()
+{
+	if(!_log_writer_running) return;
+	log_ring_t* ring = _log_ring;
+	if(NULL == ring) return;
+	while(__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) < ring->head)
+		usleep(LOG_WRITER_INTERVAL);
+}
+/**
+ * @brief format a log record
+ * @param buf the output buffer
+ * @param size the size of the output buffer
+ * @param level the log level
+ * @param file the file name
+ * @param function the function name
+ * @param line the line number
+ * @param fmt the formating string
+ * @param ap the arguments
+ * @return the size of the record
+ **/
+static inline size_t _log_format(char* buf, size_t size, int level, const char* file, const char* function, int line, const char* fmt, va_list ap)
 {
 	static const char LevelChar[] = "FEWNITD";
-	FILE* fp = _log_fp[level];
+	int rc;
+	if(_log_binary)
+	{
+		log_binary_record_t* record = (log_binary_record_t*)buf;
+		char* p = buf + sizeof(log_binary_record_t);
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		record->magic = LOG_BINARY_MAGIC;
+		record->level = level;
+		record->reserved = 0;
+		record->line = line;
+		record->timestamp = ts.tv_sec * 1000000000ull + ts.tv_nsec;
+		record->file_len = strlen(file);
+		record->function_len = strlen(function);
+		if(sizeof(log_binary_record_t) + record->file_len + record->function_len + 1 > size)
+			record->file_len = record->function_len = 0;
+		memcpy(p, file, record->file_len);
+		p += record->file_len;
+		memcpy(p, function, record->function_len);
+		p += record->function_len;
+		rc = vsnprintf(p, buf + size - p, fmt, ap);
+		if(rc < 0) rc = 0;
+		if(rc >= buf + size - p) rc = buf + size - p - 1;
+		record->message_len = rc;
+		return p + rc - buf;
+	}
+	rc = snprintf(buf, size, "%c[%s@%s:%d] ", LevelChar[level], function, file, line);
+	if(rc < 0 || rc >= size) rc = 0;
+	size_t len = rc;
+	rc = vsnprintf(buf + len, size - len - 1, fmt, ap);
+	if(rc < 0) rc = 0;
+	if(rc >= size - len - 1) rc = size - len - 2;
+	len += rc;
+	buf[len ++] = '\n';
+	buf[len] = 0;
+	return len;
+}
+void log_write(int level, const char* file, const char* function, int line, const char* fmt, ...)
+{
+	static __thread char buf[LOG_MAX_RECORD_SIZE];
 	va_list ap;
 	const char* p;
 	for(p = file; *p ; p ++)
 		if(*p == '/') file = p + 1;
-	fprintf(fp,"%c[%s@%s:%d] ",LevelChar[level],function,file,line);
 	va_start(ap,fmt);
-	vfprintf(fp, fmt, ap);
+	size_t len = _log_format(buf, sizeof(buf), level, file, function, line, fmt, ap);
 	va_end(ap);
-	fprintf(fp, "\n");
-	fflush(fp);
+	log_ring_t* ring = _log_async?_log_ring_get():NULL;
+	if(NULL == ring)
+	{
+		FILE* fp = _log_fp[level];
+		fwrite(buf, 1, len, fp);
+		fflush(fp);
+		return;
+	}
+	size_t size = _LOG_RING_ALIGN(sizeof(log_ring_record_t) + len + 1);
+	log_ring_record_t* record = _log_ring_reserve(ring, size);
+	record->size = size;
+	record->level = level;
+	memcpy(record + 1, buf, len);
+	((char*)(record + 1))[len] = 0;
+	__atomic_store_n(&ring->head, ring->head + size, __ATOMIC_RELEASE);
+	/* make sure the fatal log is written before the program dies */
+	if(FATAL == level) log_flush();
 }
@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include <perf.h>
+#include <log.h>
+perf_counters_t perf_counters;
+/** @brief the counters for a method */
+typedef struct _perf_method_node_t {
+	const void* key;                    /*!< the key identifies the method */
+	const char* class;                  /*!< the class path */
+	const char* method;                 /*!< the method name */
+	uint64_t    analyzed;               /*!< how many times this method is analyzed */
+	uint64_t    iterations;             /*!< the total number of fix-point iterations */
+	struct _perf_method_node_t* next;   /*!< the next node in the hash table */
+} perf_method_node_t;
+/** @brief the per-method counters */
+static perf_method_node_t* _perf_method_table[PERF_METHOD_TABLE_SIZE];
+/** @brief the names of opcodes */
+static const char* const _perf_opcode_name[DVM_NUM_OF_OPCODE] = {
+	[DVM_NOP]        = "nop",
+	[DVM_MOVE]       = "move",
+	[DVM_RETURN]     = "return",
+	[DVM_CONST]      = "const",
+	[DVM_MONITOR]    = "monitor",
+	[DVM_CHECK_CAST] = "check-cast",
+	[DVM_INSTANCE]   = "instance",
+	[DVM_ARRAY]      = "array",
+	[DVM_THROW]      = "throw",
+	[DVM_GOTO]       = "goto",
+	[DVM_SWITCH]     = "switch",
+	[DVM_CMP]        = "cmp",
+	[DVM_IF]         = "if",
+	[DVM_INVOKE]     = "invoke",
+	[DVM_UNOP]       = "unop",
+	[DVM_BINOP]      = "binop"
+};
+/** @brief the names of the modules */
+static const char* const _perf_module_name[PERF_ALLOC_NUM_OF_MODULE] = {
+	[PERF_ALLOC_STORE] = "store",
+	[PERF_ALLOC_SET]   = "set",
+	[PERF_ALLOC_DIFF]  = "diff",
+	[PERF_ALLOC_VALUE] = "value"
+};
+int perf_init()
+{
+	memset(&perf_counters, 0, sizeof(perf_counters));
+	memset(_perf_method_table, 0, sizeof(_perf_method_table));
+	return 0;
+}
+void perf_finalize()
+{
+#ifdef PERF_COUNT
+	const char* path = getenv("ADAMPERF");
+	if(NULL == path || 0 == strlen(path)) path = PERF_DEFAULT_OUTPUT;
+	FILE* fp = fopen(path, "w");
+	if(NULL == fp)
+		LOG_WARNING("can not open file %s for the instrumentation counters", path);
+	else
+	{
+		perf_dump(fp);
+		fclose(fp);
+	}
+#endif
+	int i;
+	for(i = 0; i < PERF_METHOD_TABLE_SIZE; i ++)
+	{
+		perf_method_node_t* node;
+		for(node = _perf_method_table[i]; NULL != node;)
+		{
+			perf_method_node_t* cur = node;
+			node = node->next;
+			free(cur);
+		}
+		_perf_method_table[i] = NULL;
+	}
+}
+void perf_method_analyzed(const char* class, const char* method, const void* key, uint32_t iterations)
+{
+	uint32_t h = ((uintptr_t)key >> 3) % PERF_METHOD_TABLE_SIZE;
+	perf_method_node_t* node;
+	for(node = _perf_method_table[h]; NULL != node && node->key != key; node = node->next);
+	if(NULL == node)
+	{
+		node = (perf_method_node_t*)malloc(sizeof(perf_method_node_t));
+		if(NULL == node)
+		{
+			LOG_WARNING("can not allocate memory for the method counters");
+			return;
+		}
+		node->key = key;
+		node->class = class;
+		node->method = method;
+		node->analyzed = 0;
+		node->iterations = 0;
+		node->next = _perf_method_table[h];
+		_perf_method_table[h] = node;
+	}
+	node->analyzed ++;
+	node->iterations += iterations;
+}
+/**
+ * @brief write a JSON string
+ * @param fp the output file
+ * @param str the string
+ * @return nothing
+ **/
+static inline void _perf_dump_string(FILE* fp, const char* str)
+{
+	fputc('"', fp);
+	for(; NULL != str && *str; str ++)
+	{
+		if(*str == '"' || *str == '\\') fputc('\\', fp);
+		if((unsigned char)*str < 0x20) fprintf(fp, "\\u%04x", *str);
+		else fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+void perf_dump(FILE* fp)
+{
+	int i;
+	const char* sep = "";
+	fprintf(fp, "{\n");
+#ifdef PERF_COUNT
+	fprintf(fp, "\t\"enabled\": true,\n");
+#else
+	fprintf(fp, "\t\"enabled\": false,\n");
+#endif
+	fprintf(fp, "\t\"opcodes\": {");
+	for(i = 0; i < DVM_NUM_OF_OPCODE; i ++)
+	{
+		fprintf(fp, "%s\n\t\t\"%s\": {\"count\": %llu, \"cycles\": %llu}", sep, _perf_opcode_name[i],
+				(unsigned long long)perf_counters.opcode_count[i],
+				(unsigned long long)perf_counters.opcode_cycles[i]);
+		sep = ",";
+	}
+	fprintf(fp, "\n\t},\n");
+	fprintf(fp, "\t\"caches\": {\n");
+	fprintf(fp, "\t\t\"method_cache\": {\"hit\": %llu, \"miss\": %llu, \"merged\": %llu, \"renamed\": %llu},\n",
+			(unsigned long long)perf_counters.method_cache_hit,
+			(unsigned long long)perf_counters.method_cache_miss,
+			(unsigned long long)perf_counters.method_cache_merged,
+			(unsigned long long)perf_counters.method_cache_renamed);
+	fprintf(fp, "\t\t\"bci_summary\": {\"fast_path\": %llu, \"hit\": %llu, \"miss\": %llu},\n",
+			(unsigned long long)perf_counters.bci_fast_path,
+			(unsigned long long)perf_counters.bci_summary_hit,
+			(unsigned long long)perf_counters.bci_summary_miss);
+	fprintf(fp, "\t\t\"block_cache\": {\"hit\": %llu, \"miss\": %llu}\n",
+			(unsigned long long)perf_counters.block_cache_hit,
+			(unsigned long long)perf_counters.block_cache_miss);
+	fprintf(fp, "\t},\n");
+	fprintf(fp, "\t\"method_context\": {\"pool_hit\": %llu, \"pool_miss\": %llu, \"peak_bytes\": %llu},\n",
+			(unsigned long long)perf_counters.context_pool_hit,
+			(unsigned long long)perf_counters.context_pool_miss,
+			(unsigned long long)perf_counters.context_peak_bytes);
+	fprintf(fp, "\t\"analysis\": {\"branch_pruned\": %llu, \"dead_register_cleared\": %llu},\n",
+			(unsigned long long)perf_counters.branch_pruned,
+			(unsigned long long)perf_counters.dead_register_cleared);
+	fprintf(fp, "\t\"alloc\": {");
+	sep = "";
+	for(i = 0; i < PERF_ALLOC_NUM_OF_MODULE; i ++)
+	{
+		fprintf(fp, "%s\n\t\t\"%s\": {\"count\": %llu, \"bytes\": %llu}", sep, _perf_module_name[i],
+				(unsigned long long)perf_counters.alloc_count[i],
+				(unsigned long long)perf_counters.alloc_bytes[i]);
+		sep = ",";
+	}
+	fprintf(fp, "\n\t},\n");
+	fprintf(fp, "\t\"methods\": [");
+	sep = "";
+	for(i = 0; i < PERF_METHOD_TABLE_SIZE; i ++)
+	{
+		const perf_method_node_t* node;
+		for(node = _perf_method_table[i]; NULL != node; node = node->next)
+		{
+			fprintf(fp, "%s\n\t\t{\"class\": ", sep);
+			_perf_dump_string(fp, node->class);
+			fprintf(fp, ", \"method\": ");
+			_perf_dump_string(fp, node->method);
+			fprintf(fp, ", \"analyzed\": %llu, \"iterations\": %llu}",
+					(unsigned long long)node->analyzed,
+					(unsigned long long)node->iterations);
+			sep = ",";
+		}
+	}
+	fprintf(fp, "\n\t]\n}\n");
+}
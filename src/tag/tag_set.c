@@ -3,31 +3,58 @@
 #include <tag/tag_tracker.h>
 #define HASH_INIT 0x376514fbu
 /**
- * @brief the structure of an item in a tag set
+ * @brief the SIMD vector used by the bitset
  **/
-typedef struct {
-	uint32_t tid;   /*!< the tag id */
-	uint32_t resol; /*!< the resolution of this item */
-} _tag_set_item_t;
+typedef uint64_t _tag_set_vec_t __attribute__((__vector_size__(16)));
 /**
- * @brief the implementation of the tag set
+ * @brief the number of bits in a vector
+ **/
+#define _TAG_SET_VEC_BITS 128
+/**
+ * @brief the number of vectors in a bitset
+ **/
+#define _TAG_SET_NVEC ((TAG_SET_MAX_TAGS + _TAG_SET_VEC_BITS - 1) / _TAG_SET_VEC_BITS)
+/**
+ * @brief the number of resolution levels, each of them is a bit in the resolution value
+ **/
+#define _TAG_SET_NLEVELS 3
+/**
+ * @brief the content of a tag set, the k-th bit of level l is set if the tag k has the resolution
+ *        bit (1 << l). The contents are hash-consed, so equal tag sets share the same content
+ **/
+typedef struct _tag_set_content_t _tag_set_content_t;
+struct _tag_set_content_t {
+	_tag_set_vec_t level[_TAG_SET_NLEVELS][_TAG_SET_NVEC];  /*!< the bitset for each resolution level */
+	uint32_t refcnt;    /*!< the reference counter */
+	uint32_t size;      /*!< how many tags in the set */
+	hashval_t hashcode; /*!< the hashcode */
+	_tag_set_content_t* next;  /*!< the next content in the hash slot */
+};
+/**
+ * @brief the implementation of the tag set, the content is shared by all the tag sets with the same
+ *        tags, but each set has its own id, which is used by the tag tracker
  **/
 struct _tag_set_t {
 	uint32_t id;   /*!< a unique ID of this tag */
 	uint32_t refcnt;    /*!< the reference counter */
-	uint32_t size;      /*!< how many items in the set */
-	hashval_t hashcode; /*!< current hashcode */
-	_tag_set_item_t data[0];   /*!< the actual data set */
+	_tag_set_content_t* content; /*!< the content of the set */
+};
+/** @brief the content of the empty set **/
+static _tag_set_content_t _tag_set_empty_content = {
+	.refcnt = 1,
+	.size = 0,
+	.hashcode = HASH_INIT,
 };
-CONST_ASSERTION_LAST(tag_set_t, data);
-CONST_ASSERTION_SIZE(tag_set_t, data, 0);
 /** @brief the only empty in tag system **/
 static tag_set_t _tag_set_empty = {
 	.refcnt = 0,
-	.size = 0,
 	.id = 0,
-	.hashcode = HASH_INIT,
+	.content = &_tag_set_empty_content,
 };
+/**
+ * @brief the hash table for the contents
+ **/
+static _tag_set_content_t* _tag_set_content_hash[TAG_SET_HASH_SIZE];
 
 /**
  * @brief the convertor function
@@ -38,29 +65,148 @@ static uint32_t next_id = 0;
 static uint32_t next_set_idx = 1;
 /**
  * @brief compute the hashcode for a signle set item
- * @param item the set item
+ * @param tid the tag id
+ * @param resol the resolution
  * @return the hashcode
  **/
-static inline hashval_t _tag_set_item_hashcode(const _tag_set_item_t item)
+static inline hashval_t _tag_set_item_hashcode(uint32_t tid, uint32_t resol)
+{
+	return tid * (MH_MULTIPLY) + (resol * resol + 0x23fc * resol + MH_MULTIPLY * resol);
+}
+/**
+ * @brief get the resolution of a tag in the content
+ * @param content the content
+ * @param tid the tag id
+ * @return the resolution
+ **/
+static inline uint32_t _tag_set_content_resol(const _tag_set_content_t* content, uint32_t tid)
+{
+	uint32_t l, ret = 0;
+	for(l = 0; l < _TAG_SET_NLEVELS; l ++)
+		if((content->level[l][tid / _TAG_SET_VEC_BITS][(tid % _TAG_SET_VEC_BITS) / 64] >> (tid % 64)) & 1)
+			ret |= (1u << l);
+	return ret;
+}
+/**
+ * @brief set the resolution of a tag in the content
+ * @param content the content
+ * @param tid the tag id
+ * @param resol the resolution
+ * @return nothing
+ **/
+static inline void _tag_set_content_set_resol(_tag_set_content_t* content, uint32_t tid, uint32_t resol)
+{
+	uint32_t l;
+	for(l = 0; l < _TAG_SET_NLEVELS; l ++)
+	{
+		uint64_t* word = (uint64_t*)&content->level[l][tid / _TAG_SET_VEC_BITS] + (tid % _TAG_SET_VEC_BITS) / 64;
+		if(resol & (1u << l))
+			*word |= (1ull << (tid % 64));
+		else
+			*word &= ~(1ull << (tid % 64));
+	}
+}
+/**
+ * @brief get the union of all the levels, which is the set of the tags in the content
+ * @param content the content
+ * @param result the buffer for the result
+ * @return nothing
+ **/
+static inline void _tag_set_content_tags(const _tag_set_content_t* content, _tag_set_vec_t* result)
+{
+	uint32_t i;
+	for(i = 0; i < _TAG_SET_NVEC; i ++)
+		result[i] = content->level[0][i] | content->level[1][i] | content->level[2][i];
+}
+/**
+ * @brief find the next tag in the set of the tags
+ * @param tags the set of the tags
+ * @param from the tag id to start with
+ * @return the tag id, TAG_SET_MAX_TAGS if there's no more tags
+ **/
+static inline uint32_t _tag_set_tags_next(const _tag_set_vec_t* tags, uint32_t from)
+{
+	for(; from < _TAG_SET_NVEC * _TAG_SET_VEC_BITS; from = (from / 64 + 1) * 64)
+	{
+		uint64_t word = tags[from / _TAG_SET_VEC_BITS][(from % _TAG_SET_VEC_BITS) / 64] >> (from % 64);
+		if(word) return from + __builtin_ctzll(word);
+	}
+	return TAG_SET_MAX_TAGS;
+}
+/**
+ * @brief compute the size and the hashcode of the content
+ * @param content the content
+ * @return nothing
+ **/
+static inline void _tag_set_content_update(_tag_set_content_t* content)
+{
+	_tag_set_vec_t tags[_TAG_SET_NVEC];
+	_tag_set_content_tags(content, tags);
+	content->size = 0;
+	content->hashcode = HASH_INIT;
+	uint32_t tid;
+	for(tid = _tag_set_tags_next(tags, 0); tid < TAG_SET_MAX_TAGS; tid = _tag_set_tags_next(tags, tid + 1))
+	{
+		content->hashcode ^= _tag_set_item_hashcode(tid, _tag_set_content_resol(content, tid));
+		content->size ++;
+	}
+}
+/**
+ * @brief find the content equal to the given one in the hash table, if there's no such content, insert a copy of it
+ * @param content the content, the size and the hashcode should be computed
+ * @return the content in the hash table with one more reference, NULL on error
+ **/
+static inline _tag_set_content_t* _tag_set_content_intern(const _tag_set_content_t* content)
 {
-	return item.tid * (MH_MULTIPLY) + (item.resol * item.resol + 0x23fc * item.resol + MH_MULTIPLY * item.resol);
+	uint32_t slot = content->hashcode % TAG_SET_HASH_SIZE;
+	_tag_set_content_t* ptr;
+	for(ptr = _tag_set_content_hash[slot]; NULL != ptr; ptr = ptr->next)
+		if(ptr->hashcode == content->hashcode && 0 == memcmp(ptr->level, content->level, sizeof(content->level)))
+		{
+			ptr->refcnt ++;
+			return ptr;
+		}
+	_tag_set_content_t* ret = (_tag_set_content_t*)malloc(sizeof(_tag_set_content_t));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the tag set content");
+		return NULL;
+	}
+	memcpy(ret, content, sizeof(_tag_set_content_t));
+	ret->refcnt = 1;
+	ret->next = _tag_set_content_hash[slot];
+	_tag_set_content_hash[slot] = ret;
+	return ret;
 }
 /**
- * @brief allocate a new set with N slots
- * @param N the number of slots
+ * @brief decrease the reference counter of a content
+ * @param content the content
+ * @return nothing
+ **/
+static inline void _tag_set_content_decref(_tag_set_content_t* content)
+{
+	if(0 != --content->refcnt) return;
+	_tag_set_content_t** ptr;
+	for(ptr = _tag_set_content_hash + content->hashcode % TAG_SET_HASH_SIZE; *ptr != content; ptr = &(*ptr)->next);
+	*ptr = content->next;
+	free(content);
+}
+/**
+ * @brief allocate a new set
+ * @param content the content of the set, the reference of the content is taken by the set
  * @return the newly allocated memory for the set, NULL indicates error
  **/
-static inline tag_set_t* _tag_set_new(size_t N)
+static inline tag_set_t* _tag_set_new(_tag_set_content_t* content)
 {
-	tag_set_t* ret = (tag_set_t*)malloc(sizeof(tag_set_t) + sizeof(_tag_set_item_t) * N);
+	tag_set_t* ret = (tag_set_t*)malloc(sizeof(tag_set_t));
 	if(NULL == ret)
 	{
-		LOG_ERROR("can not allocate a new tag set with %zu slots", N);
+		LOG_ERROR("can not allocate a new tag set");
+		_tag_set_content_decref(content);
 		return NULL;
 	}
-	ret->size = 0;
 	ret->refcnt = 0;
-	ret->hashcode = HASH_INIT; /* just a magic number */
+	ret->content = content;
 	ret->id = (next_set_idx ++);
 	return ret;
 }
@@ -83,25 +229,23 @@ static inline void _tag_set_decref(tag_set_t* set)
 	if(0 == --set->refcnt)
 	{
 		LOG_DEBUG("tag set at host memory %p is dead, free it", set);
+		_tag_set_content_decref(set->content);
 		free(set);
 	}
 }
 /**
- * @brief duplicate the tag set
+ * @brief duplicate the tag set, the content is shared with the input set
  * @param set the input tag set
  * @return the result tag set
  **/
 static inline tag_set_t* _tag_set_duplicate(tag_set_t* set, int fresh_idx)
 {
 	if(NULL == set) return NULL;
-	tag_set_t* ret = _tag_set_new(set->size);
+	set->content->refcnt ++;
+	tag_set_t* ret = _tag_set_new(set->content);
 	if(NULL == ret) return NULL;
-	memcpy(ret->data, set->data, sizeof(_tag_set_item_t) * set->size);
-	ret->hashcode = set->hashcode;
-	ret->size = set->size;
 	if(fresh_idx)
 	{
-		ret->id = next_set_idx ++;
 		LOG_DEBUG("TAG_TRACKER: Create tag_set #%u%s from #%u%s", ret->id, tag_set_to_string(ret, NULL, 0), set->id, tag_set_to_string(ret, NULL, 0));
 		if(tag_tracker_register_tagset(ret->id, ret, &set->id, 1) < 0)
 		{
@@ -117,6 +261,15 @@ static inline tag_set_t* _tag_set_duplicate(tag_set_t* set, int fresh_idx)
 int tag_set_init()
 {
 	_tag_set_incref(&_tag_set_empty);
+	/* the empty content is also in the hash table, so that all the empty sets share it */
+	uint32_t slot = HASH_INIT % TAG_SET_HASH_SIZE;
+	_tag_set_content_t* ptr;
+	for(ptr = _tag_set_content_hash[slot]; NULL != ptr && ptr != &_tag_set_empty_content; ptr = ptr->next);
+	if(NULL == ptr)
+	{
+		_tag_set_empty_content.next = _tag_set_content_hash[slot];
+		_tag_set_content_hash[slot] = &_tag_set_empty_content;
+	}
 	
 	tag_fs_init();
 
@@ -124,7 +277,20 @@ int tag_set_init()
 }
 void tag_set_finalize()
 {
-	/* do nothing just follow the protocol */
+	/* free all the interned contents, except the static content of the empty set */
+	uint32_t i;
+	for(i = 0; i < TAG_SET_HASH_SIZE; i ++)
+	{
+		_tag_set_content_t* ptr;
+		for(ptr = _tag_set_content_hash[i]; NULL != ptr;)
+		{
+			_tag_set_content_t* cur = ptr;
+			ptr = ptr->next;
+			if(cur != &_tag_set_empty_content) free(cur);
+		}
+		_tag_set_content_hash[i] = NULL;
+	}
+	_tag_set_empty_content.next = NULL;
 }
 tag_set_t* tag_set_empty()
 {
@@ -139,22 +305,28 @@ tag_set_t* tag_set_from_array(const uint32_t* tags, const uint32_t* resols, size
 		return NULL;
 	}
 	if(N == 0) return tag_set_empty();
-	tag_set_t* ret = _tag_set_new(N);
-	if(NULL == ret) return NULL;
+	_tag_set_content_t content;
+	memset(&content, 0, sizeof(content));
 	int i;
 	for(i = 0; i < N; i ++)
 	{
-		ret->data[i].tid = tags[i];
-		ret->data[i].resol = resols[i];
-		ret->hashcode ^= _tag_set_item_hashcode(ret->data[i]);
 		if(i > 0 && tags[i - 1] >= tags[i])
 		{
 			LOG_ERROR("tags array is not strictly increasing");
-			free(ret);
 			return NULL;
 		}
+		if(tags[i] >= TAG_SET_MAX_TAGS)
+		{
+			LOG_ERROR("invalid tag id %u", tags[i]);
+			return NULL;
+		}
+		_tag_set_content_set_resol(&content, tags[i], resols[i]);
 	}
-	ret->size = N;
+	_tag_set_content_update(&content);
+	_tag_set_content_t* interned = _tag_set_content_intern(&content);
+	if(NULL == interned) return NULL;
+	tag_set_t* ret = _tag_set_new(interned);
+	if(NULL == ret) return NULL;
 	_tag_set_incref(ret);
 	LOG_DEBUG("TAG_TRACKER: Tag Set Creation #%u", ret->id);
 	if(tag_tracker_register_tagset(ret->id, ret, NULL, 0) < 0)
@@ -176,19 +348,13 @@ void tag_set_free(tag_set_t* set)
 }
 hashval_t tag_set_hashcode(const tag_set_t* set)
 {
-	return set->hashcode;
+	return set->content->hashcode;
 }
 int tag_set_equal(const tag_set_t* first, const tag_set_t* second)
 {
 	if(NULL == first || NULL == second) return -1;
-	if(first->size != second->size || first->hashcode != second->hashcode) return 0;
-	uint32_t i;
-	for(i = 0; i < first->size; i ++)
-	{
-		if(first->data[i].tid != second->data[i].tid ||
-		   first->data[i].resol != second->data[i].resol) return 0;
-	}
-	return 1;
+	/* the contents are hash-consed */
+	return first->content == second->content;
 }
 static inline const char* _tag_id_to_string(uint32_t id)
 {
@@ -210,9 +376,11 @@ const char* tag_set_to_string(const tag_set_t* ts, char* buf, size_t sz)
 	p += pret;\
 }while(0)
 	__PR("[");
-	int i;
-	for(i = 0; i < ts->size; i ++)
-		__PR("%s ", _tag_id_to_string(ts->data[i].tid));
+	_tag_set_vec_t tags[_TAG_SET_NVEC];
+	_tag_set_content_tags(ts->content, tags);
+	uint32_t tid;
+	for(tid = _tag_set_tags_next(tags, 0); tid < TAG_SET_MAX_TAGS; tid = _tag_set_tags_next(tags, tid + 1))
+		__PR("%s ", _tag_id_to_string(tid));
 	__PR("]");
 #undef __PR
 	return buf;
@@ -223,15 +391,15 @@ const char* tag_set_to_string(const tag_set_t* ts, char* buf, size_t sz)
 tag_set_t* tag_set_merge(const tag_set_t* first, const tag_set_t* second)
 {
 	if(NULL == first || NULL == second) return NULL;
-	if(0 == first->size && 0 == second->size) return tag_set_empty();
+	if(0 == first->content->size && 0 == second->content->size) return tag_set_empty();
 	/* try light weight copy if possible */
-	if(first == NULL || first->size == 0) 
+	if(first->content->size == 0) 
 	{
 		tag_set_t* ret = (tag_set_t*)second;
 		_tag_set_incref(ret);
 		return _tag_set_duplicate(ret, 1);
 	}
-	if(second == NULL || second->size == 0) 
+	if(second->content->size == 0) 
 	{
 		tag_set_t* ret = (tag_set_t*)first;
 		_tag_set_incref(ret);
@@ -243,36 +411,25 @@ tag_set_t* tag_set_merge(const tag_set_t* first, const tag_set_t* second)
 		_tag_set_incref(ret);
 		return _tag_set_duplicate(ret, 1);
 	}
-	size_t N = first->size + second->size;
-	tag_set_t* ret = _tag_set_new(N);
-	if(NULL == ret) return NULL;
-	/* do a merge sort */
-	uint32_t i, j;
-	for(i = j = 0; i < first->size || j < second->size; )
+	_tag_set_content_t* content;
+	if(first->content == second->content)
 	{
-		uint32_t current_id = 0xffffffffu;
-		if(i < first->size && first->data[i].tid < current_id) 
-			current_id = first->data[i].tid;
-		if(j < second->size && second->data[j].tid < current_id) 
-			current_id = second->data[j].tid;
-		uint32_t resol = 0;
-		if(i < first->size && current_id == first->data[i].tid)
-		{
-			resol |= first->data[i].resol;
-			i ++;
-		}
-		if(j < second->size && current_id == second->data[j].tid)
-		{
-			resol |= second->data[j].resol;
-			j ++;
-		}
-		if(resol == TAG_RES_NOTHING) continue;
-		ret->data[ret->size].tid = current_id;
-		ret->data[ret->size].resol = resol;
-		ret->hashcode ^= _tag_set_item_hashcode(ret->data[ret->size]);
-		ret->size ++;
-		LOG_DEBUG("append item <%d, %d>", current_id, resol);
+		content = first->content;
+		content->refcnt ++;
 	}
+	else
+	{
+		/* the union of each resolution level */
+		_tag_set_content_t buf;
+		uint32_t l, i;
+		for(l = 0; l < _TAG_SET_NLEVELS; l ++)
+			for(i = 0; i < _TAG_SET_NVEC; i ++)
+				buf.level[l][i] = first->content->level[l][i] | second->content->level[l][i];
+		_tag_set_content_update(&buf);
+		if(NULL == (content = _tag_set_content_intern(&buf))) return NULL;
+	}
+	tag_set_t* ret = _tag_set_new(content);
+	if(NULL == ret) return NULL;
 	LOG_DEBUG("TAG_TRACKER: Tag set Creation tag_set #%u from #%u and #%u", ret->id, first->id, second->id);
 	uint32_t input[] = {first->id, second->id};
 	if(tag_tracker_register_tagset(ret->id, ret, input, 2) < 0)
@@ -284,23 +441,19 @@ tag_set_t* tag_set_merge(const tag_set_t* first, const tag_set_t* second)
 }
 int tag_set_contains(const tag_set_t* set, uint32_t what)
 {
-	if(0 == set->size || what < set->data[0].tid || set->data[set->size-1].tid < what) return 0;
-	int l = 0, r = set->size;
-	while(r - l > 1)
-	{
-		int m = (l + r) / 2;
-		if(set->data[m].tid <= what) l = m;
-		else r = m;
-	}
-	return set->data[l].tid == what;
+	if(what >= TAG_SET_MAX_TAGS) return 0;
+	return 0 != _tag_set_content_resol(set->content, what);
 }
 tag_set_t* tag_set_change_resolution(tag_set_t* set, uint32_t tagid, uint32_t value)
 {
-	tag_set_t* prev_set = NULL;
+	if(!tag_set_contains(set, tagid))
+	{
+		LOG_ERROR("can not find the target tag id %u, so I can not modify the tag set", tagid);
+		return NULL;
+	}
 	/* before we actual modify the set, we should make sure we can modify it safely */
 	if(set->refcnt > 1)
 	{
-		prev_set = set;
 		LOG_DEBUG("modifying a tag set using by multiple values, copy it first");
 		set = _tag_set_duplicate(set, 0);
 		if(NULL == set)
@@ -309,33 +462,30 @@ tag_set_t* tag_set_change_resolution(tag_set_t* set, uint32_t tagid, uint32_t va
 			return NULL;
 		}
 	}
-	/* now we can modify it */
-	/* perform a binary search on the input set to find the target tagid */
-	if(0 == set->size || tagid < set->data[0].tid || tagid > set->data[set->size - 1].tid) goto ERR; 
-	int l = 0, r = set->size;
-	while(r - l > 1)
+	/* the content is shared, so we make a new one */
+	_tag_set_content_t buf;
+	memcpy(buf.level, set->content->level, sizeof(buf.level));
+	_tag_set_content_set_resol(&buf, tagid, value);
+	_tag_set_content_update(&buf);
+	_tag_set_content_t* content = _tag_set_content_intern(&buf);
+	if(NULL == content)
 	{
-		int m = (l + r) / 2;
-		if(set->data[m].tid <= tagid) l = m;
-		else r = m;
+		LOG_ERROR("can not create the new content");
+		return NULL;
 	}
-	if(set->data[l].tid != tagid) goto ERR;
-	set->hashcode ^= _tag_set_item_hashcode(set->data[l]);
-	set->data[l].resol = value;
-	set->hashcode ^= _tag_set_item_hashcode(set->data[l]);
+	_tag_set_content_decref(set->content);
+	set->content = content;
 	return set;
-ERR:
-	LOG_ERROR("can not find the target tag id %u, so I can not modify the tag set", tagid);
-	if(NULL != prev_set)
-	{
-		_tag_set_decref(set);
-		_tag_set_incref(prev_set);
-	}
-	return NULL;
 }
 
 void tag_set_register_handler(uint32_t* tagid, tag_set_to_string_callback_t to_string, tag_set_strreason_callback_t strreason)
 {
+	if(next_id >= TAG_SET_MAX_TAGS)
+	{
+		LOG_ERROR("too many tags");
+		*tagid = TAG_SET_MAX_TAGS;
+		return;
+	}
 	*tagid = next_id ++;
 	_tag_strreason[*tagid] = strreason;
 	_tag_tostring[*tagid] = to_string;
@@ -352,24 +502,43 @@ const char* tag_set_reason_code_to_string(uint32_t why)
 size_t tag_set_size(const tag_set_t* set)
 {
 	if(NULL == set) return 0;
-	return set->size;
+	return set->content->size;
+}
+/**
+ * @brief find the k-th tag in the set
+ * @param set the tag set
+ * @param k the index
+ * @return the tag id, TAG_SET_MAX_TAGS if not found
+ **/
+static inline uint32_t _tag_set_kth(const tag_set_t* set, uint32_t k)
+{
+	if(NULL == set || set->content->size <= k) return TAG_SET_MAX_TAGS;
+	_tag_set_vec_t tags[_TAG_SET_NVEC];
+	_tag_set_content_tags(set->content, tags);
+	uint32_t tid;
+	for(tid = _tag_set_tags_next(tags, 0); k > 0; tid = _tag_set_tags_next(tags, tid + 1), k --);
+	return tid;
 }
 uint32_t tag_set_get_tagid(const tag_set_t* set, uint32_t k)
 {
-	if(NULL == set || set->size <= k) return 0xfffffffful;
-	return set->data[k].tid;
+	uint32_t tid = _tag_set_kth(set, k);
+	if(TAG_SET_MAX_TAGS == tid) return 0xfffffffful;
+	return tid;
 }
 uint32_t tag_set_get_resol(const tag_set_t* set, uint32_t k)
 {
-	if(NULL == set || set->size <= k) return 0xfffffffful;
-	return set->data[k].resol;
+	uint32_t tid = _tag_set_kth(set, k);
+	if(TAG_SET_MAX_TAGS == tid) return 0xfffffffful;
+	return _tag_set_content_resol(set->content, tid);
 }
 hashval_t tag_set_compute_hashcode(const tag_set_t* set)
 {
 	hashval_t ret = HASH_INIT;
-	uint32_t i;
-	for(i = 0; i < set->size; i ++)
-		ret ^= _tag_set_item_hashcode(set->data[i]);
+	_tag_set_vec_t tags[_TAG_SET_NVEC];
+	_tag_set_content_tags(set->content, tags);
+	uint32_t tid;
+	for(tid = _tag_set_tags_next(tags, 0); tid < TAG_SET_MAX_TAGS; tid = _tag_set_tags_next(tags, tid + 1))
+		ret ^= _tag_set_item_hashcode(tid, _tag_set_content_resol(set->content, tid));
 	return ret;
 }
 uint32_t tag_set_id(const tag_set_t* set)
@@ -1,11 +1,17 @@
+#include <pthread.h>
 #include <tag/tag_tracker.h>
 /**
- * @brief the abstract virtual machine stack
+ * @brief the index for a node, a stack or an input tag set which does not exist
  **/
-typedef struct _tag_tracker_avm_stack_t{
-	uint32_t refcnt;   /*!< the reference counter */
-	uint32_t ip;       /*!< current instruction pointer */
-	struct _tag_tracker_avm_stack_t* next; /*!< the next element in stack */
+#define _TAG_TRACKER_NONE 0xfffffffful
+/**
+ * @brief a frame of the abstract virtual machine stack, the frames are hash-consed, so that
+ *        a call stack is stored once no matter how many tag sets are created under it
+ **/
+typedef struct {
+	uint32_t ip;         /*!< current instruction pointer */
+	uint32_t next;       /*!< the id of the next frame in stack, _TAG_TRACKER_NONE for the bottom of the stack */
+	uint32_t hash_next;  /*!< the next frame in the same hash slot */
 } _tag_tracker_avm_stack_t;
 /**
  * @brief the abstract virtual machine state
@@ -15,25 +21,32 @@ typedef struct {
 	uint32_t block;   /*!< the block index */
 	uint32_t target;  /*!< the target block index */
 	uint32_t instruction; /*!< the instruction index */
-	_tag_tracker_avm_stack_t* stack_info; /*< the stack info */
+	uint32_t stack;   /*!< the id of the stack, _TAG_TRACKER_NONE if there's no stack info */
 } _tag_tracker_avm_stat_t;
-/** 
- * @brief the hash node
+/**
+ * @brief the decoded header of a node record
+ * @details a node record in the arena is a sequence of varints:
+ *          tag set id, instruction + 1, stack id + 1, (number of tags << 1 | full),
+ *          [closure, block + 1, target + 1 if full], the tags (delta encoded), number of inputs,
+ *          the inputs (node index - input node index, 0 for an input which is not tracked)
  **/
-typedef struct _tag_tracker_hash_node_t _tag_tracker_hash_node_t;
-struct _tag_tracker_hash_node_t{
-	uint32_t what;   /*!< the index of the tag set */
-	_tag_tracker_avm_stat_t when; /*!< when this tag set created */
-	tag_set_t* set;   /*!< the tag set itself */
-	uint32_t visit_flag; /*!< the vistited flag */
-	_tag_tracker_hash_node_t* next; /*!< the next node */
-	size_t ninputs;
-	uint32_t inputs[0];
-};
+typedef struct {
+	uint32_t what;        /*!< the index of the tag set */
+	uint32_t instruction; /*!< the instruction which creates the tag set */
+	uint32_t stack;       /*!< the stack id */
+	uint32_t ntags;       /*!< the number of tags */
+	const uint8_t* tags;  /*!< the encoded tags */
+	uint32_t ninputs;     /*!< the number of inputs */
+	const uint8_t* inputs;/*!< the encoded inputs */
+} _tag_tracker_node_t;
 /**
- * @breif the hashtable
+ * @brief a frame of the depth first search
  **/
-_tag_tracker_hash_node_t* _tag_tracker_hash[TAG_TRACKER_HASH_SIZE];
+typedef struct {
+	uint32_t node;          /*!< the node index */
+	uint32_t remaining;     /*!< how many inputs are not visited yet */
+	const uint8_t* cursor;  /*!< the next input to visit */
+} _tag_tracker_dfs_frame_t;
 /**
  * @brief check if there's a currently opening transaction
  **/
@@ -42,145 +55,705 @@ static uint32_t _tag_tracker_sp = 0;
  * @brief the transaction detials
  **/
 static _tag_tracker_avm_stat_t _tag_tracker_current_stack[TAG_TRACKER_STACK_SIZE];
-
 /**
- * @brief increase the refcounter for the stack snapshot
- * @param stack the stack snapshot
- * @return < 0 for error
+ * @brief the current mode
  **/
-static inline int _tag_tracker_stack_incref(_tag_tracker_avm_stack_t* stack)
-{
-	if(NULL == stack) return -1;
-	stack->refcnt ++;
-	return 0;
-}
+static uint32_t _tag_tracker_mode = TAG_TRACKER_MODE_FULL;
 /**
- * @biref decrease the refcounter 
- * @param stack the stack snapshot
- * @return < 0 for error
+ * @brief the tags watched in tainted mode, empty means all the tags
+ **/
+static uint32_t _tag_tracker_watched[(TAG_SET_MAX_TAGS + 31) / 32];
+/**
+ * @brief the number of watched tags
+ **/
+static uint32_t _tag_tracker_nwatched = 0;
+/**
+ * @brief if the memory limit has been hit
+ **/
+static int _tag_tracker_full = 0;
+/**
+ * @brief the chunks of the node arena, a record never crosses the chunk boundary and never moves
+ **/
+static uint8_t** _tag_tracker_chunks = NULL;
+/**
+ * @brief the number of allocated chunks
+ **/
+static size_t _tag_tracker_nchunks = 0;
+/**
+ * @brief the capacity of the chunk array
+ **/
+static size_t _tag_tracker_chunk_cap = 0;
+/**
+ * @brief the used size of the arena, which is also the offset of the next record
+ **/
+static size_t _tag_tracker_arena_used = 0;
+/**
+ * @brief the hash-consed stack frames
+ **/
+static _tag_tracker_avm_stack_t* _tag_tracker_stacks = NULL;
+/**
+ * @brief the number of stack frames
+ **/
+static uint32_t _tag_tracker_nstacks = 0;
+/**
+ * @brief the capacity of the stack frame array
+ **/
+static size_t _tag_tracker_stacks_cap = 0;
+/**
+ * @brief the hash table of the stack frames
+ **/
+static uint32_t _tag_tracker_stack_hash[TAG_TRACKER_STACK_HASH_SIZE];
+/**
+ * @brief the records of the nodes of the provenance graph, in the order of registration. Because a tag set can
+ *        only be created from existing tag sets, the inputs of a node always have smaller node indices
+ **/
+static uint8_t** _tag_tracker_records = NULL;
+/**
+ * @brief the number of nodes
+ **/
+static uint32_t _tag_tracker_nnodes = 0;
+/**
+ * @brief the capacity of the record array
  **/
-static inline int _tag_tracker_stack_decref(_tag_tracker_avm_stack_t* stack)
+static size_t _tag_tracker_node_cap = 0;
+/**
+ * @brief the number of edges
+ **/
+static uint32_t _tag_tracker_nedges = 0;
+/**
+ * @brief tag set index --> node index
+ **/
+static uint32_t* _tag_tracker_tsid_map = NULL;
+/**
+ * @brief the capacity of the tag set index map
+ **/
+static size_t _tag_tracker_tsid_cap = 0;
+/**
+ * @brief the nodes which use node i as input are _tag_tracker_out_adj[_tag_tracker_out_off[i] .. _tag_tracker_out_off[i + 1]],
+ *        it's built when it's needed by a query
+ **/
+static uint32_t* _tag_tracker_out_off = NULL;
+/**
+ * @brief the output node indices
+ **/
+static uint32_t* _tag_tracker_out_adj = NULL;
+/**
+ * @brief how many nodes are covered by the output index
+ **/
+static uint32_t _tag_tracker_out_nnodes = 0;
+/**
+ * @brief the memoized reachability, _tag_tracker_reach[tag][node] is 0 for unknown, 1 for unreachable and 2 for reachable.
+ *        A node never changes after it's registered, so the memoized results remain valid when the graph grows
+ **/
+static uint8_t* _tag_tracker_reach[TAG_SET_MAX_TAGS];
+/**
+ * @brief the size of the reachability array of each tag
+ **/
+static uint32_t _tag_tracker_reach_size[TAG_SET_MAX_TAGS];
+/**
+ * @brief the visited flags of the current query
+ **/
+static uint32_t* _tag_tracker_visit = NULL;
+/**
+ * @brief the tick of the current query
+ **/
+static uint32_t _tag_tracker_tick = 0;
+/**
+ * @brief the search stack (or the search queue)
+ **/
+static _tag_tracker_dfs_frame_t* _tag_tracker_stack = NULL;
+/**
+ * @brief the size of the visited flags
+ **/
+static uint32_t _tag_tracker_query_size = 0;
+/**
+ * @brief the size of the search stack
+ **/
+static size_t _tag_tracker_stack_size = 0;
+/**
+ * @brief the mutex that protects the provenance graph, so that it's possible to query while analyzing
+ **/
+static pthread_mutex_t _tag_tracker_mutex = PTHREAD_MUTEX_INITIALIZER;
+/**
+ * @brief make sure the array has at least the given capacity
+ * @param array the pointer to the array
+ * @param cap the pointer to the capacity
+ * @param needed the required capacity
+ * @param elem_size the size of an element
+ * @return < 0 on error
+ **/
+static inline int _tag_tracker_reserve(void* array, size_t* cap, size_t needed, size_t elem_size)
 {
-	if(NULL == stack) return -1;
-	if(0 == --stack->refcnt)
+	if(needed <= *cap) return 0;
+	size_t new_cap = (*cap == 0) ? TAG_TRACKER_INIT_SIZE : *cap;
+	while(new_cap < needed) new_cap *= 2;
+	void* new_array = realloc(*(void**)array, new_cap * elem_size);
+	if(NULL == new_array)
 	{
-		if(NULL != stack->next) _tag_tracker_stack_decref(stack->next);
-		free(stack);
+		LOG_ERROR("can not allocate memory for the provenance graph");
+		return -1;
 	}
+	*(void**)array = new_array;
+	*cap = new_cap;
 	return 0;
 }
 /**
- * @brief make a stack snapshot for current stack
- * @param inst the current instruction pointer
- * @return the newly created object
+ * @brief write a varint
+ * @param ptr the output pointer
+ * @param value the value
+ * @return the pointer after the varint
  **/
-static inline _tag_tracker_avm_stack_t* _tag_tracker_stack_snapshot(uint32_t inst)
+static inline uint8_t* _tag_tracker_varint_write(uint8_t* ptr, uint32_t value)
 {
-	if(inst == DALVIK_INSTRUCTION_INVALID) return NULL;
-	_tag_tracker_avm_stack_t* ret = (_tag_tracker_avm_stack_t*)malloc(sizeof(_tag_tracker_avm_stack_t));
-	if(NULL == ret)
+	for(; value >= 0x80; value >>= 7)
+		*(ptr ++) = (uint8_t)(value | 0x80);
+	*(ptr ++) = (uint8_t)value;
+	return ptr;
+}
+/**
+ * @brief read a varint
+ * @param ptr the pointer to the input pointer, which will be moved after the varint
+ * @return the value
+ **/
+static inline uint32_t _tag_tracker_varint_read(const uint8_t** ptr)
+{
+	uint32_t ret = 0;
+	int shift = 0;
+	const uint8_t* p = *ptr;
+	for(; *p & 0x80; p ++, shift += 7)
+		ret |= ((uint32_t)(*p & 0x7f)) << shift;
+	ret |= ((uint32_t)*p) << shift;
+	*ptr = p + 1;
+	return ret;
+}
+/**
+ * @brief skip varints
+ * @param ptr the input pointer
+ * @param n how many varints to skip
+ * @return the pointer after the varints
+ **/
+static inline const uint8_t* _tag_tracker_varint_skip(const uint8_t* ptr, uint32_t n)
+{
+	for(; n > 0; n --)
+		for(; *(ptr ++) & 0x80;);
+	return ptr;
+}
+/**
+ * @brief allocate memory for a record in the arena
+ * @param size the upper bound of the size of the record
+ * @return the memory for the record, NULL on error or if the memory limit has been hit. The caller should
+ *         call _tag_tracker_arena_commit after the record is written
+ **/
+static inline uint8_t* _tag_tracker_arena_alloc(size_t size)
+{
+	if(size > TAG_TRACKER_ARENA_CHUNK_SIZE)
 	{
-		LOG_ERROR("can not create a new snapshot for current stack");
+		LOG_ERROR("the record is too large");
 		return NULL;
 	}
-	ret->refcnt = 0;
-	ret->ip = inst;
-	ret->next = NULL;
-	int i;
-	for(i = _tag_tracker_sp - 1; i >= 0 && NULL == _tag_tracker_current_stack[i].stack_info; i --);
-	if(i >= 0) 
+	size_t offset = _tag_tracker_arena_used % TAG_TRACKER_ARENA_CHUNK_SIZE;
+	if(0 == _tag_tracker_nchunks || offset + size > TAG_TRACKER_ARENA_CHUNK_SIZE)
 	{
-		ret->next = _tag_tracker_current_stack[i].stack_info;
-		_tag_tracker_stack_incref(ret->next);
+		if(TAG_TRACKER_MEMORY_LIMIT > 0 && (_tag_tracker_nchunks + 1) * TAG_TRACKER_ARENA_CHUNK_SIZE > TAG_TRACKER_MEMORY_LIMIT)
+		{
+			LOG_WARNING("the tag tracker hits the memory limit, the tag sets created after this point are not tracked");
+			_tag_tracker_full = 1;
+			return NULL;
+		}
+		if(_tag_tracker_reserve(&_tag_tracker_chunks, &_tag_tracker_chunk_cap, _tag_tracker_nchunks + 1, sizeof(uint8_t*)) < 0)
+			return NULL;
+		uint8_t* chunk = (uint8_t*)malloc(TAG_TRACKER_ARENA_CHUNK_SIZE);
+		if(NULL == chunk)
+		{
+			LOG_ERROR("can not allocate a new chunk for the arena");
+			return NULL;
+		}
+		_tag_tracker_chunks[_tag_tracker_nchunks ++] = chunk;
+		_tag_tracker_arena_used = (_tag_tracker_nchunks - 1) * TAG_TRACKER_ARENA_CHUNK_SIZE;
+		offset = 0;
 	}
+	return _tag_tracker_chunks[_tag_tracker_nchunks - 1] + offset;
+}
+/**
+ * @brief commit the record allocated by _tag_tracker_arena_alloc
+ * @param begin the begining of the record
+ * @param end the end of the record
+ * @return nothing
+ **/
+static inline void _tag_tracker_arena_commit(const uint8_t* begin, const uint8_t* end)
+{
+	_tag_tracker_arena_used += end - begin;
+}
+/**
+ * @brief intern a stack frame
+ * @param ip the instruction pointer
+ * @param next the next frame
+ * @return the id of the frame, _TAG_TRACKER_NONE on error
+ **/
+static inline uint32_t _tag_tracker_stack_intern(uint32_t ip, uint32_t next)
+{
+	uint32_t slot = ((ip * MH_MULTIPLY) ^ (next * MH_MULTIPLY * MH_MULTIPLY)) % TAG_TRACKER_STACK_HASH_SIZE;
+	uint32_t id;
+	for(id = _tag_tracker_stack_hash[slot]; _TAG_TRACKER_NONE != id; id = _tag_tracker_stacks[id].hash_next)
+		if(_tag_tracker_stacks[id].ip == ip && _tag_tracker_stacks[id].next == next)
+			return id;
+	if(_tag_tracker_reserve(&_tag_tracker_stacks, &_tag_tracker_stacks_cap, _tag_tracker_nstacks + 1, sizeof(_tag_tracker_avm_stack_t)) < 0)
+		return _TAG_TRACKER_NONE;
+	id = _tag_tracker_nstacks ++;
+	_tag_tracker_stacks[id].ip = ip;
+	_tag_tracker_stacks[id].next = next;
+	_tag_tracker_stacks[id].hash_next = _tag_tracker_stack_hash[slot];
+	_tag_tracker_stack_hash[slot] = id;
+	return id;
+}
+/**
+ * @brief make a stack snapshot for current stack
+ * @param inst the current instruction pointer
+ * @return the id of the stack, _TAG_TRACKER_NONE if there's no stack info
+ **/
+static inline uint32_t _tag_tracker_stack_snapshot(uint32_t inst)
+{
+	if(inst == DALVIK_INSTRUCTION_INVALID) return _TAG_TRACKER_NONE;
+	int i;
+	for(i = _tag_tracker_sp - 1; i >= 0 && _TAG_TRACKER_NONE == _tag_tracker_current_stack[i].stack; i --);
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	uint32_t ret = _tag_tracker_stack_intern(inst, (i >= 0) ? _tag_tracker_current_stack[i].stack : _TAG_TRACKER_NONE);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	if(_TAG_TRACKER_NONE == ret) LOG_ERROR("can not create a new snapshot for current stack");
 	return ret;
 }
 /**
- * @brief the hash code for tag-set index
- * @param tags_idx the tag-set index
- * @return the result hashcode
+ * @brief convert a stack id to the stack info returned to the caller
+ * @param stack the stack id
+ * @return the stack info
  **/
-hashval_t _tag_tracker_tagset_hashcode(uint32_t tags_idx)
+static inline void* _tag_tracker_stack_info(uint32_t stack)
 {
-	return tags_idx * MH_MULTIPLY;
+	return (_TAG_TRACKER_NONE == stack) ? NULL : (void*)((uintptr_t)stack + 1);
 }
-
 /**
- * @brief create a new hash node
- * @param tsid the tag-set index
- * @param avmst the abstract virtual machine status
- * @param set the tag-set
- * @return a newly created node, NULL if error
+ * @brief check if a tag set should be tracked in tainted mode
+ * @param tagset the tag set
+ * @return the result
  **/
-_tag_tracker_hash_node_t* _tag_tracker_hash_new(uint32_t tsid, const _tag_tracker_avm_stat_t avmst, const tag_set_t* set, size_t ninputs, const uint32_t* inputs)
+static inline int _tag_tracker_tainted(const tag_set_t* tagset)
 {
-	_tag_tracker_hash_node_t* ret = (_tag_tracker_hash_node_t*)malloc(sizeof(_tag_tracker_hash_node_t) + sizeof(uint32_t) * ninputs);
-	if(NULL == ret)
+	uint32_t i, size = tag_set_size(tagset);
+	if(0 == _tag_tracker_nwatched) return size > 0;
+	for(i = 0; i < size; i ++)
 	{
-		LOG_ERROR("can not allocate a new tracker hash node");
-		return 0;
+		uint32_t tag = tag_set_get_tagid(tagset, i);
+		if(tag < TAG_SET_MAX_TAGS && (_tag_tracker_watched[tag / 32] & (1u << (tag % 32)))) return 1;
 	}
-	ret->what = tsid;
-	ret->when = avmst;
-	ret->set = tag_set_fork(set);
-	ret->next = NULL;
-	ret->ninputs = ninputs;
-	ret->visit_flag = 0;
-	memcpy(ret->inputs, inputs, sizeof(uint32_t) * ninputs);
-	return ret;
+	return 0;
+}
+/**
+ * @brief find a node by the tag-set id
+ * @param tsid the tag-set id
+ * @return the node index, _TAG_TRACKER_NONE when not found
+ **/
+static inline uint32_t _tag_tracker_node_find(uint32_t tsid)
+{
+	if(tsid >= _tag_tracker_tsid_cap) return _TAG_TRACKER_NONE;
+	return _tag_tracker_tsid_map[tsid];
 }
 /**
- * @brief insert a new node to the hash, assume that there's no duplications
+ * @brief append a new node to the provenance graph, assume that there's no duplications
  * @param what the tag-set index
  * @param set the tag-set
  * @param avmst the avm status
- * @return the newly inserted node in the hash table, NULL if error
+ * @param ninputs how many inputs
+ * @param inputs the tag-set indices of the inputs
+ * @return < 0 on error
  **/
-static inline const _tag_tracker_hash_node_t* _tag_tracker_hash_insert(uint32_t what, const tag_set_t* set, const _tag_tracker_avm_stat_t avmst, size_t ninputs, const uint32_t* inputs)
+static inline int _tag_tracker_node_append(uint32_t what, const tag_set_t* set, const _tag_tracker_avm_stat_t* avmst, size_t ninputs, const uint32_t* inputs)
 {
-	uint32_t slot_id = _tag_tracker_tagset_hashcode(what) % TAG_TRACKER_HASH_SIZE;
-	_tag_tracker_hash_node_t* node = _tag_tracker_hash_new(what, avmst, set, ninputs, inputs);
-	if(NULL == node)
+	uint32_t i, ntracked = 0, full = (TAG_TRACKER_MODE_COMPACT != (_tag_tracker_mode & TAG_TRACKER_MODE_COMPACT));
+	uint32_t ntags = tag_set_size(set);
+	if(ninputs >= 128)
 	{
-		LOG_ERROR("can not create the node");
-		return NULL;
+		LOG_ERROR("too many inputs");
+		return -1;
+	}
+	if(_tag_tracker_mode & TAG_TRACKER_MODE_TAINTED)
+	{
+		/* only the tag sets reachable from a tainted source are tracked */
+		if(!_tag_tracker_tainted(set)) return 0;
+		for(i = 0; i < ninputs; i ++)
+			if(_TAG_TRACKER_NONE != _tag_tracker_node_find(inputs[i])) ntracked ++;
+		if(ninputs > 0 && 0 == ntracked) return 0;
 	}
-	if(NULL != avmst.stack_info) _tag_tracker_stack_incref(avmst.stack_info);
-	node->next = _tag_tracker_hash[slot_id];
-	_tag_tracker_hash[slot_id] = node;
-	return node;
+	if(_tag_tracker_reserve(&_tag_tracker_records, &_tag_tracker_node_cap, _tag_tracker_nnodes + 1, sizeof(uint8_t*)) < 0)
+		return -1;
+	size_t old_cap = _tag_tracker_tsid_cap;
+	if(_tag_tracker_reserve(&_tag_tracker_tsid_map, &_tag_tracker_tsid_cap, what + 1, sizeof(uint32_t)) < 0)
+		return -1;
+	if(old_cap < _tag_tracker_tsid_cap)
+		memset(_tag_tracker_tsid_map + old_cap, 0xff, sizeof(uint32_t) * (_tag_tracker_tsid_cap - old_cap));
+	uint8_t* begin = _tag_tracker_arena_alloc(5 * (8 + ntags + ninputs));
+	if(NULL == begin) return _tag_tracker_full ? 0 : -1;
+	uint8_t* ptr = begin;
+	ptr = _tag_tracker_varint_write(ptr, what);
+	ptr = _tag_tracker_varint_write(ptr, avmst->instruction + 1);
+	ptr = _tag_tracker_varint_write(ptr, avmst->stack + 1);
+	ptr = _tag_tracker_varint_write(ptr, (ntags << 1) | full);
+	if(full)
+	{
+		ptr = _tag_tracker_varint_write(ptr, avmst->closure);
+		ptr = _tag_tracker_varint_write(ptr, avmst->block + 1);
+		ptr = _tag_tracker_varint_write(ptr, avmst->target + 1);
+	}
+	uint32_t last = 0;
+	for(i = 0; i < ntags; i ++)
+	{
+		uint32_t tag = tag_set_get_tagid(set, i);
+		ptr = _tag_tracker_varint_write(ptr, tag - last);
+		last = tag;
+	}
+	uint8_t* ninputs_ptr = ptr;
+	ptr = _tag_tracker_varint_write(ptr, 0);
+	for(i = ntracked = 0; i < ninputs; i ++)
+	{
+		uint32_t input = _tag_tracker_node_find(inputs[i]);
+		if(_TAG_TRACKER_NONE == input && (_tag_tracker_mode & TAG_TRACKER_MODE_TAINTED)) continue;
+		ptr = _tag_tracker_varint_write(ptr, (_TAG_TRACKER_NONE == input) ? 0 : _tag_tracker_nnodes - input);
+		ntracked ++;
+	}
+	/* the number of inputs is less than 128, so it takes exactly one byte as the placeholder */
+	*ninputs_ptr = (uint8_t)ntracked;
+	_tag_tracker_arena_commit(begin, ptr);
+	_tag_tracker_tsid_map[what] = _tag_tracker_nnodes;
+	_tag_tracker_records[_tag_tracker_nnodes ++] = begin;
+	_tag_tracker_nedges += ntracked;
+	return 0;
 }
 /**
- * @brief find a node by the tag-set id
- * @param tsid the tag-set id
- * @return the node found, NULL when not found
+ * @brief decode the header of a node record
+ * @param node the node index
+ * @param buf the output buffer
+ * @return the decoded node
  **/
-static inline _tag_tracker_hash_node_t* _tag_tracker_hash_find(uint32_t tsid)
+static inline const _tag_tracker_node_t* _tag_tracker_node_get(uint32_t node, _tag_tracker_node_t* buf)
 {
-	uint32_t slot_id = _tag_tracker_tagset_hashcode(tsid) % TAG_TRACKER_HASH_SIZE;
-	_tag_tracker_hash_node_t* ptr;
-	for(ptr = _tag_tracker_hash[slot_id]; NULL != ptr && ptr->what != tsid; ptr = ptr->next);
-	return ptr;
+	const uint8_t* ptr = _tag_tracker_records[node];
+	buf->what = _tag_tracker_varint_read(&ptr);
+	buf->instruction = _tag_tracker_varint_read(&ptr) - 1;
+	buf->stack = _tag_tracker_varint_read(&ptr) - 1;
+	uint32_t flags = _tag_tracker_varint_read(&ptr);
+	if(flags & 1) ptr = _tag_tracker_varint_skip(ptr, 3);
+	buf->ntags = flags >> 1;
+	buf->tags = ptr;
+	ptr = _tag_tracker_varint_skip(ptr, buf->ntags);
+	buf->ninputs = _tag_tracker_varint_read(&ptr);
+	buf->inputs = ptr;
+	return buf;
 }
-int tag_tracker_init()
+/**
+ * @brief check if the node contains the tag
+ * @param node the decoded node
+ * @param tag_id the tag id
+ * @return the result
+ **/
+static inline int _tag_tracker_node_contains(const _tag_tracker_node_t* node, uint32_t tag_id)
 {
+	uint32_t i, tag = 0;
+	const uint8_t* ptr = node->tags;
+	for(i = 0; i < node->ntags && tag <= tag_id; i ++)
+		if((tag += _tag_tracker_varint_read(&ptr)) == tag_id) return 1;
 	return 0;
 }
-void tag_tracker_finalize()
+/**
+ * @brief read the next input of a node
+ * @param node the node index
+ * @param ptr the pointer to the cursor
+ * @return the input node index, _TAG_TRACKER_NONE if the input is not tracked
+ **/
+static inline uint32_t _tag_tracker_input_next(uint32_t node, const uint8_t** ptr)
 {
-	int i;
-	for(i = 0; i < TAG_TRACKER_HASH_SIZE; i ++)
+	uint32_t delta = _tag_tracker_varint_read(ptr);
+	return (0 == delta) ? _TAG_TRACKER_NONE : node - delta;
+}
+/**
+ * @brief check if a node ends a path, which means the node has no input or one of its inputs is not tracked
+ * @param node the node index
+ * @param decoded the decoded node
+ * @return the result
+ **/
+static inline int _tag_tracker_node_is_source(uint32_t node, const _tag_tracker_node_t* decoded)
+{
+	uint32_t i;
+	const uint8_t* ptr = decoded->inputs;
+	if(0 == decoded->ninputs) return 1;
+	for(i = 0; i < decoded->ninputs; i ++)
+		if(_TAG_TRACKER_NONE == _tag_tracker_input_next(node, &ptr)) return 1;
+	return 0;
+}
+/**
+ * @brief prepare the buffers for a query, and start a new query
+ * @return < 0 on error
+ **/
+static inline int _tag_tracker_query_begin()
+{
+	if(_tag_tracker_query_size < _tag_tracker_nnodes)
 	{
-		_tag_tracker_hash_node_t* ptr;
-		for(ptr = _tag_tracker_hash[i]; NULL != ptr; )
+		uint32_t* visit = (uint32_t*)realloc(_tag_tracker_visit, sizeof(uint32_t) * _tag_tracker_nnodes);
+		if(NULL == visit)
 		{
-			_tag_tracker_hash_node_t* cur = ptr;
-			ptr = ptr->next;
-			if(NULL != cur->set) tag_set_free(cur->set);
-			if(NULL != cur->when.stack_info) _tag_tracker_stack_decref(cur->when.stack_info);
-			free(cur);
+			LOG_ERROR("can not allocate the visited flags");
+			return -1;
 		}
+		_tag_tracker_visit = visit;
+		memset(_tag_tracker_visit + _tag_tracker_query_size, 0, sizeof(uint32_t) * (_tag_tracker_nnodes - _tag_tracker_query_size));
+		_tag_tracker_query_size = _tag_tracker_nnodes;
 	}
+	/* the reachability search pushes one frame per edge at most */
+	if(_tag_tracker_stack_size < _tag_tracker_nnodes + _tag_tracker_nedges + 1)
+	{
+		_tag_tracker_dfs_frame_t* stack = (_tag_tracker_dfs_frame_t*)realloc(_tag_tracker_stack, sizeof(_tag_tracker_dfs_frame_t) * (_tag_tracker_nnodes + _tag_tracker_nedges + 1));
+		if(NULL == stack)
+		{
+			LOG_ERROR("can not allocate the search stack");
+			return -1;
+		}
+		_tag_tracker_stack = stack;
+		_tag_tracker_stack_size = _tag_tracker_nnodes + _tag_tracker_nedges + 1;
+	}
+	if(0 == ++ _tag_tracker_tick)
+	{
+		memset(_tag_tracker_visit, 0, sizeof(uint32_t) * _tag_tracker_query_size);
+		_tag_tracker_tick = 1;
+	}
+	return 0;
+}
+/**
+ * @brief build the output index if there are nodes that are not covered
+ * @return < 0 on error
+ **/
+static inline int _tag_tracker_out_index_update()
+{
+	if(_tag_tracker_out_nnodes == _tag_tracker_nnodes && NULL != _tag_tracker_out_off) return 0;
+	uint32_t* off = (uint32_t*)realloc(_tag_tracker_out_off, sizeof(uint32_t) * (_tag_tracker_nnodes + 1));
+	if(NULL == off)
+	{
+		LOG_ERROR("can not allocate the output index");
+		return -1;
+	}
+	_tag_tracker_out_off = off;
+	uint32_t* adj = (uint32_t*)realloc(_tag_tracker_out_adj, sizeof(uint32_t) * (_tag_tracker_nedges + 1));
+	if(NULL == adj)
+	{
+		LOG_ERROR("can not allocate the output index");
+		return -1;
+	}
+	_tag_tracker_out_adj = adj;
+	/* counting sort by the input node */
+	memset(off, 0, sizeof(uint32_t) * (_tag_tracker_nnodes + 1));
+	uint32_t i, j;
+	_tag_tracker_node_t node;
+	for(i = 0; i < _tag_tracker_nnodes; i ++)
+	{
+		const uint8_t* ptr = _tag_tracker_node_get(i, &node)->inputs;
+		for(j = 0; j < node.ninputs; j ++)
+		{
+			uint32_t input = _tag_tracker_input_next(i, &ptr);
+			if(_TAG_TRACKER_NONE != input) off[input + 1] ++;
+		}
+	}
+	for(i = 0; i < _tag_tracker_nnodes; i ++)
+		off[i + 1] += off[i];
+	for(i = 0; i < _tag_tracker_nnodes; i ++)
+	{
+		const uint8_t* ptr = _tag_tracker_node_get(i, &node)->inputs;
+		for(j = 0; j < node.ninputs; j ++)
+		{
+			uint32_t input = _tag_tracker_input_next(i, &ptr);
+			if(_TAG_TRACKER_NONE != input) adj[off[input] ++] = i;
+		}
+	}
+	/* the offsets are shifted by the filling process, shift them back */
+	for(i = _tag_tracker_nnodes; i > 0; i --)
+		off[i] = off[i - 1];
+	off[0] = 0;
+	_tag_tracker_out_nnodes = _tag_tracker_nnodes;
+	return 0;
+}
+/**
+ * @brief check if there's a data-flow path which carries the tag from a source to the node, all the tag sets on the
+ *        path should contain the tag. The caller should start a query before calling this function
+ * @param tag_id the tag id
+ * @param node the node index
+ * @return 1 if reachable, 0 if not, < 0 on error
+ **/
+static inline int _tag_tracker_reachable(uint32_t tag_id, uint32_t node)
+{
+	if(tag_id >= TAG_SET_MAX_TAGS)
+	{
+		LOG_ERROR("invalid tag id %u", tag_id);
+		return -1;
+	}
+	if(_tag_tracker_reach_size[tag_id] < _tag_tracker_nnodes)
+	{
+		uint8_t* reach = (uint8_t*)realloc(_tag_tracker_reach[tag_id], _tag_tracker_nnodes);
+		if(NULL == reach)
+		{
+			LOG_ERROR("can not allocate the reachability memo for tag %u", tag_id);
+			return -1;
+		}
+		memset(reach + _tag_tracker_reach_size[tag_id], 0, _tag_tracker_nnodes - _tag_tracker_reach_size[tag_id]);
+		_tag_tracker_reach[tag_id] = reach;
+		_tag_tracker_reach_size[tag_id] = _tag_tracker_nnodes;
+	}
+	uint8_t* reach = _tag_tracker_reach[tag_id];
+	if(0 != reach[node]) return reach[node] - 1;
+	/* a node pushes its unknown inputs at most once, so the stack is never deeper than the number of edges */
+	uint32_t sp = 0;
+	_tag_tracker_node_t decoded;
+	_tag_tracker_stack[sp ++].node = node;
+	while(sp > 0)
+	{
+		uint32_t cur = _tag_tracker_stack[sp - 1].node;
+		if(0 != reach[cur])
+		{
+			sp --;
+			continue;
+		}
+		if(!_tag_tracker_node_contains(_tag_tracker_node_get(cur, &decoded), tag_id))
+		{
+			reach[cur] = 1;
+			sp --;
+			continue;
+		}
+		/* resolve all the inputs first, so that the memo covers every node a path query may visit */
+		uint32_t i, pending = 0;
+		const uint8_t* ptr = decoded.inputs;
+		for(i = 0; i < decoded.ninputs; i ++)
+		{
+			uint32_t input = _tag_tracker_input_next(cur, &ptr);
+			if(_TAG_TRACKER_NONE == input || 0 != reach[input]) continue;
+			_tag_tracker_stack[sp ++].node = input;
+			pending = 1;
+		}
+		if(pending) continue;
+		uint8_t result = 1;
+		ptr = decoded.inputs;
+		if(0 == decoded.ninputs) result = 2;
+		for(i = 0; i < decoded.ninputs && 2 != result; i ++)
+		{
+			uint32_t input = _tag_tracker_input_next(cur, &ptr);
+			if(_TAG_TRACKER_NONE == input || 2 == reach[input]) result = 2;
+		}
+		reach[cur] = result;
+		sp --;
+	}
+	return reach[node] - 1;
+}
+/**
+ * @brief parse the mode specification
+ * @param spec the mode specification, a comma separated list of "full", "compact" and "tainted"
+ * @return the mode, < 0 on error
+ **/
+static inline int _tag_tracker_mode_parse(const char* spec)
+{
+	int ret = TAG_TRACKER_MODE_FULL;
+	const char* ptr;
+	for(ptr = spec; *ptr; )
+	{
+		size_t len = strcspn(ptr, ",");
+		if(4 == len && 0 == strncmp(ptr, "full", len)) ret &= ~TAG_TRACKER_MODE_COMPACT;
+		else if(7 == len && 0 == strncmp(ptr, "compact", len)) ret |= TAG_TRACKER_MODE_COMPACT;
+		else if(7 == len && 0 == strncmp(ptr, "tainted", len)) ret |= TAG_TRACKER_MODE_TAINTED;
+		else return -1;
+		ptr += len;
+		if(',' == *ptr) ptr ++;
+	}
+	return ret;
+}
+int tag_tracker_init()
+{
+	memset(_tag_tracker_stack_hash, 0xff, sizeof(_tag_tracker_stack_hash));
+	memset(_tag_tracker_watched, 0, sizeof(_tag_tracker_watched));
+	_tag_tracker_nwatched = 0;
+	_tag_tracker_mode = TAG_TRACKER_MODE_FULL;
+	const char* spec = getenv("ADAMTRACKER");
+	if(NULL != spec && 0 != strlen(spec))
+	{
+		int mode = _tag_tracker_mode_parse(spec);
+		if(mode < 0)
+		{
+			LOG_ERROR("invalid tag tracker mode %s", spec);
+			return -1;
+		}
+		_tag_tracker_mode = mode;
+	}
+	return 0;
+}
+void tag_tracker_finalize()
+{
+	uint32_t i;
+	for(i = 0; i < TAG_SET_MAX_TAGS; i ++)
+	{
+		if(NULL != _tag_tracker_reach[i]) free(_tag_tracker_reach[i]);
+		_tag_tracker_reach[i] = NULL;
+		_tag_tracker_reach_size[i] = 0;
+	}
+	for(i = 0; i < _tag_tracker_nchunks; i ++)
+		free(_tag_tracker_chunks[i]);
+	free(_tag_tracker_chunks);
+	free(_tag_tracker_stacks);
+	free(_tag_tracker_records);
+	free(_tag_tracker_tsid_map);
+	free(_tag_tracker_out_off);
+	free(_tag_tracker_out_adj);
+	free(_tag_tracker_visit);
+	free(_tag_tracker_stack);
+	_tag_tracker_chunks = NULL;
+	_tag_tracker_stacks = NULL;
+	_tag_tracker_records = NULL;
+	_tag_tracker_tsid_map = _tag_tracker_out_off = _tag_tracker_out_adj = _tag_tracker_visit = NULL;
+	_tag_tracker_stack = NULL;
+	_tag_tracker_nnodes = _tag_tracker_nedges = _tag_tracker_out_nnodes = _tag_tracker_query_size = _tag_tracker_tick = _tag_tracker_nstacks = 0;
+	_tag_tracker_nchunks = _tag_tracker_chunk_cap = _tag_tracker_arena_used = _tag_tracker_stacks_cap = 0;
+	_tag_tracker_node_cap = _tag_tracker_tsid_cap = _tag_tracker_stack_size = 0;
+	_tag_tracker_full = 0;
+	_tag_tracker_sp = 0;
+}
+int tag_tracker_set_mode(uint32_t mode)
+{
+	if(mode & ~(TAG_TRACKER_MODE_COMPACT | TAG_TRACKER_MODE_TAINTED))
+	{
+		LOG_ERROR("invalid tag tracker mode %x", mode);
+		return -1;
+	}
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	_tag_tracker_mode = mode;
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return 0;
+}
+int tag_tracker_watch(uint32_t tag_id)
+{
+	if(tag_id >= TAG_SET_MAX_TAGS)
+	{
+		LOG_ERROR("invalid tag id %u", tag_id);
+		return -1;
+	}
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	if(0 == (_tag_tracker_watched[tag_id / 32] & (1u << (tag_id % 32))))
+	{
+		_tag_tracker_watched[tag_id / 32] |= (1u << (tag_id % 32));
+		_tag_tracker_nwatched ++;
+	}
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return 0;
+}
+size_t tag_tracker_memory_usage()
+{
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	size_t ret = _tag_tracker_nchunks * TAG_TRACKER_ARENA_CHUNK_SIZE +
+	             _tag_tracker_stacks_cap * sizeof(_tag_tracker_avm_stack_t) +
+	             _tag_tracker_node_cap * sizeof(uint8_t*) +
+	             _tag_tracker_tsid_cap * sizeof(uint32_t);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return ret;
 }
 /**
  * @brief open a transaction
@@ -202,10 +775,9 @@ int _tag_tracker_transaction_open(uint32_t closure, uint32_t instruction, uint32
 		.instruction = instruction,
 		.block = block,
 		.target = target,
-		.stack_info = _tag_tracker_stack_snapshot(instruction)
+		.stack = _tag_tracker_stack_snapshot(instruction)
 	};
 	_tag_tracker_current_stack[_tag_tracker_sp ++] = stat;
-	if(NULL != stat.stack_info) _tag_tracker_stack_incref(stat.stack_info);
 	return 0;
 }
 int tag_tracker_instruction_transaction_begin(uint32_t closure, uint32_t instruction)
@@ -223,64 +795,258 @@ int tag_tracker_branch_transaction_begin(uint32_t closure, uint32_t from, uint32
 }
 int tag_tracker_transaction_close()
 {
-	if(_tag_tracker_sp) _tag_tracker_stack_decref(_tag_tracker_current_stack[--_tag_tracker_sp].stack_info);
+	if(_tag_tracker_sp) _tag_tracker_sp --;
 	return 0;
 }
 int tag_tracker_register_tagset(uint32_t tsid, const tag_set_t* tagset, const uint32_t* inputs, uint32_t ninputs)
 {
-	if(!_tag_tracker_sp) return 0;
-	if(NULL == _tag_tracker_hash_insert(tsid, tagset, _tag_tracker_current_stack[_tag_tracker_sp - 1], ninputs, inputs)) 
-		return -1;
-	return 0;
+	if(!_tag_tracker_sp || _tag_tracker_full) return 0;
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	int rc = _tag_tracker_node_append(tsid, tagset, _tag_tracker_current_stack + _tag_tracker_sp - 1, ninputs, inputs);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return rc;
+}
+/**
+ * @brief copy the path on the search stack to a newly allocated buffer
+ * @param sp the stack pointer
+ * @param stack_info the pointer to return the stack info
+ * @return the newly allocated path, NULL on error
+ **/
+static inline uint32_t* _tag_tracker_path_emit(uint32_t sp, void** stack_info)
+{
+	uint32_t* ret = (uint32_t*)malloc(sizeof(uint32_t) * (sp + 1));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the path");
+		return NULL;
+	}
+	uint32_t i, len = 0;
+	_tag_tracker_node_t node;
+	if(NULL != stack_info) *stack_info = NULL;
+	for(i = 0; i < sp; i ++)
+	{
+		_tag_tracker_node_get(_tag_tracker_stack[i].node, &node);
+		if(DALVIK_INSTRUCTION_INVALID != node.instruction) ret[len ++] = node.instruction;
+		if(_TAG_TRACKER_NONE != node.stack && NULL != stack_info) *stack_info = _tag_tracker_stack_info(node.stack);
+	}
+	ret[len] = DALVIK_INSTRUCTION_INVALID;
+	return ret;
+}
+/**
+ * @brief push a node to the search stack
+ * @param sp the pointer to the stack pointer
+ * @param node the node index
+ * @return nothing
+ **/
+static inline void _tag_tracker_dfs_push(uint32_t* sp, uint32_t node)
+{
+	_tag_tracker_node_t decoded;
+	_tag_tracker_node_get(node, &decoded);
+	_tag_tracker_visit[node] = _tag_tracker_tick;
+	_tag_tracker_stack[*sp].node = node;
+	_tag_tracker_stack[*sp].remaining = decoded.ninputs;
+	_tag_tracker_stack[(*sp) ++].cursor = decoded.inputs;
 }
-static uint32_t** inst_buf;
-static void** _stack_info;
-static size_t _N;
-static int _tag_tracker_dfs(uint32_t tag_id, uint32_t tagset_id, int depth, uint32_t tick)
+/**
+ * @brief the implementation of the path query, the caller should hold the mutex
+ * @param tag_id the tag id to focus on
+ * @param tagset_id the id of tagset that we are instrested in
+ * @param instruction the path buffer
+ * @param N the size of buffer
+ * @param stack_info the buffer for the stack info
+ * @return the number of pathes found < 0 on error
+ **/
+static inline int _tag_tracker_get_path(uint32_t tag_id, uint32_t tagset_id, uint32_t** instruction, size_t N, void** stack_info)
 {
-	static uint32_t path[1024];
-	_tag_tracker_hash_node_t* node = _tag_tracker_hash_find(tagset_id);
-	if(NULL == node || node->ninputs == 0)
+	if(0 == N) return 0;
+	uint32_t root = _tag_tracker_node_find(tagset_id);
+	if(_TAG_TRACKER_NONE == root)
 	{
-		if(NULL == node) 
+		/* we know nothing about this tag set, so the only path is an empty one */
+		if(NULL == (instruction[0] = _tag_tracker_path_emit(0, stack_info))) return -1;
+		return 1;
+	}
+	if(_tag_tracker_query_begin() < 0) return -1;
+	int rc = _tag_tracker_reachable(tag_id, root);
+	if(rc <= 0) return rc;
+	/* each node is expanded once in one query, so that the search is linear to the size of the graph */
+	const uint8_t* reach = _tag_tracker_reach[tag_id];
+	uint32_t sp = 0, npath = 0;
+	_tag_tracker_dfs_push(&sp, root);
+	while(sp > 0 && npath < N)
+	{
+		_tag_tracker_dfs_frame_t* frame = _tag_tracker_stack + sp - 1;
+		if(0 == frame->remaining)
 		{
-			path[depth] = DALVIK_INSTRUCTION_INVALID;
+			_tag_tracker_node_t decoded;
+			if(0 == _tag_tracker_node_get(frame->node, &decoded)->ninputs)
+			{
+				/* this is where the tag comes from */
+				if(NULL == (instruction[npath] = _tag_tracker_path_emit(sp, (NULL == stack_info) ? NULL : stack_info + npath)))
+					return -1;
+				npath ++;
+			}
+			sp --;
+			continue;
 		}
-		else 
+		frame->remaining --;
+		uint32_t input = _tag_tracker_input_next(frame->node, &frame->cursor);
+		if(_TAG_TRACKER_NONE == input)
 		{
-			path[depth] = node->when.instruction, path[depth + 1] = DALVIK_INSTRUCTION_INVALID;
-			if(node->when.stack_info && _stack_info) *_stack_info = node->when.stack_info;
+			/* the input is not tracked, so the path ends here */
+			if(NULL == (instruction[npath] = _tag_tracker_path_emit(sp, (NULL == stack_info) ? NULL : stack_info + npath)))
+				return -1;
+			npath ++;
+			continue;
 		}
-		inst_buf[0] = (uint32_t*)malloc(sizeof(uint32_t) * (depth + 1));
-		memcpy(inst_buf[0], path, sizeof(uint32_t) * (depth + 1));
-		_N--;
-		inst_buf ++;
-		_stack_info ++;
-		return 1;
+		if(_tag_tracker_visit[input] == _tag_tracker_tick || 2 != reach[input]) continue;
+		_tag_tracker_dfs_push(&sp, input);
 	}
-	if(tick == node->visit_flag || !tag_set_contains(node->set, tag_id))
-		return 0;
-	node->visit_flag = tick;
-	if(node->when.instruction != DALVIK_INSTRUCTION_INVALID) path[depth ++] = node->when.instruction;
-	if(node->when.stack_info != NULL && _stack_info != NULL) *_stack_info = node->when.stack_info;
-	int i , rc = 0;
-	for(i = 0; i < node->ninputs; i ++)
-		rc += _tag_tracker_dfs(tag_id, node->inputs[i], depth, tick);
-	return rc;
+	return npath;
 }
 int tag_tracker_get_path(uint32_t tag_id, uint32_t tagset_id, uint32_t** instruction, size_t N, void** stack_info)
 {
-	inst_buf = instruction;
-	_N = N;
-	static int tick = 0;
+	if(NULL == instruction)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	int rc = _tag_tracker_get_path(tag_id, tagset_id, instruction, N, stack_info);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return rc;
+}
+int tag_tracker_reachable(uint32_t tag_id, uint32_t tagset_id)
+{
+	int rc = 0;
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	uint32_t node = _tag_tracker_node_find(tagset_id);
+	if(_TAG_TRACKER_NONE != node)
+	{
+		if(_tag_tracker_query_begin() < 0) rc = -1;
+		else rc = _tag_tracker_reachable(tag_id, node);
+	}
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return rc;
+}
+/**
+ * @brief the implementation of the shortest path query, the caller should hold the mutex
+ * @param tag_id the tag id to focus on
+ * @param tagset_id the id of tagset that we are instrested in
+ * @param buf the path buffer
+ * @param N the size of the buffer
+ * @param stack_info the pointer to return the stack info
+ * @return the length of the path, < 0 if there's no such path
+ **/
+static inline int _tag_tracker_shortest_path(uint32_t tag_id, uint32_t tagset_id, uint32_t* buf, size_t N, void** stack_info)
+{
+	uint32_t root = _tag_tracker_node_find(tagset_id);
+	if(_TAG_TRACKER_NONE == root || _tag_tracker_query_begin() < 0 || _tag_tracker_reachable(tag_id, root) <= 0)
+		return -1;
+	const uint8_t* reach = _tag_tracker_reach[tag_id];
+	/* breadth first search, the stack is used as the queue, and the remaining field is the position of the parent in the queue */
+	uint32_t head = 0, tail = 0;
+	_tag_tracker_node_t decoded;
+	_tag_tracker_visit[root] = _tag_tracker_tick;
+	_tag_tracker_stack[tail].node = root;
+	_tag_tracker_stack[tail ++].remaining = _TAG_TRACKER_NONE;
+	for(; head < tail; head ++)
+	{
+		uint32_t cur = _tag_tracker_stack[head].node, i;
+		if(_tag_tracker_node_is_source(cur, _tag_tracker_node_get(cur, &decoded))) break;
+		const uint8_t* ptr = decoded.inputs;
+		for(i = 0; i < decoded.ninputs; i ++)
+		{
+			uint32_t input = _tag_tracker_input_next(cur, &ptr);
+			if(_tag_tracker_visit[input] == _tag_tracker_tick || 2 != reach[input]) continue;
+			_tag_tracker_visit[input] = _tag_tracker_tick;
+			_tag_tracker_stack[tail].node = input;
+			_tag_tracker_stack[tail ++].remaining = head;
+		}
+	}
+	if(head == tail) return -1;
+	/* walk from the source back to the tag set, which is the reversed order of the path */
+	uint32_t k, len = 0;
 	if(NULL != stack_info) *stack_info = NULL;
-	_stack_info = stack_info;
-	return _tag_tracker_dfs(tag_id, tagset_id, 0, ++ tick);
+	for(k = head; _TAG_TRACKER_NONE != k; k = _tag_tracker_stack[k].remaining)
+	{
+		_tag_tracker_node_get(_tag_tracker_stack[k].node, &decoded);
+		if(NULL != stack_info && NULL == *stack_info) *stack_info = _tag_tracker_stack_info(decoded.stack);
+		if(DALVIK_INSTRUCTION_INVALID == decoded.instruction) continue;
+		if(len + 1 >= N)
+		{
+			LOG_ERROR("the path buffer is too small");
+			return -1;
+		}
+		buf[len ++] = decoded.instruction;
+	}
+	buf[len] = DALVIK_INSTRUCTION_INVALID;
+	for(k = 0; k < len / 2; k ++)
+	{
+		uint32_t tmp = buf[k];
+		buf[k] = buf[len - k - 1];
+		buf[len - k - 1] = tmp;
+	}
+	return len;
+}
+int tag_tracker_shortest_path(uint32_t tag_id, uint32_t tagset_id, uint32_t* buf, size_t N, void** stack_info)
+{
+	if(NULL == buf || 0 == N)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	int rc = _tag_tracker_shortest_path(tag_id, tagset_id, buf, N, stack_info);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return rc;
+}
+/**
+ * @brief the implementation of the sink query, the caller should hold the mutex
+ * @param tag_id the tag id
+ * @param buf the output buffer
+ * @param N the size of the buffer
+ * @return the number of sinks, < 0 on error
+ **/
+static inline int _tag_tracker_get_sinks(uint32_t tag_id, uint32_t* buf, size_t N)
+{
+	if(_tag_tracker_out_index_update() < 0 || _tag_tracker_query_begin() < 0) return -1;
+	uint32_t i, j;
+	int ret = 0;
+	_tag_tracker_node_t decoded;
+	/* the inputs of a node have smaller indices, so the memo of the inputs is ready when we reach the node */
+	for(i = 0; i < _tag_tracker_nnodes; i ++)
+	{
+		int rc = _tag_tracker_reachable(tag_id, i);
+		if(rc < 0) return -1;
+		if(0 == rc) continue;
+		for(j = _tag_tracker_out_off[i]; j < _tag_tracker_out_off[i + 1]; j ++)
+			if(_tag_tracker_node_contains(_tag_tracker_node_get(_tag_tracker_out_adj[j], &decoded), tag_id)) break;
+		if(j < _tag_tracker_out_off[i + 1]) continue;
+		if(ret < N) buf[ret] = _tag_tracker_node_get(i, &decoded)->what;
+		ret ++;
+	}
+	return ret;
+}
+int tag_tracker_get_sinks(uint32_t tag_id, uint32_t* buf, size_t N)
+{
+	if(NULL == buf && N > 0)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	int rc = _tag_tracker_get_sinks(tag_id, buf, N);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return rc;
 }
 uint32_t tag_tracker_stack_backtrace(void** stack_info)
 {
 	if(NULL == stack_info || NULL == *stack_info) return DALVIK_INSTRUCTION_INVALID;
-	_tag_tracker_avm_stack_t* current = (_tag_tracker_avm_stack_t*)*stack_info;
-	*stack_info = current->next;
-	return current->ip;
+	uint32_t id = (uint32_t)((uintptr_t)*stack_info - 1);
+	pthread_mutex_lock(&_tag_tracker_mutex);
+	uint32_t ip = _tag_tracker_stacks[id].ip;
+	*stack_info = _tag_tracker_stack_info(_tag_tracker_stacks[id].next);
+	pthread_mutex_unlock(&_tag_tracker_mutex);
+	return ip;
 }
@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <adam.h>
+/* the union of the sign bits of the constants in the result register of NumericTest/run */
+static uint32_t analyze(const dalvik_block_t* graph)
+{
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	cesk_set_iter_t iter;
+	assert(NULL != cesk_set_iter(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, &iter));
+	uint32_t addr, sign = CESK_STORE_ADDR_EMPTY;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+		sign |= cesk_arithmetic_sign(addr);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	cesk_method_clean_cache();
+	return sign;
+}
+int main()
+{
+	adam_init();
+	int64_t lo, hi;
+
+	/* the sign domain */
+	assert(0 == cesk_arithmetic_set_domain(CESK_ARITHMETIC_DOMAIN_SIGN));
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_const(3));
+	assert(CESK_STORE_ADDR_ZERO == cesk_arithmetic_const(0));
+	assert(CESK_STORE_ADDR_NEG == cesk_arithmetic_add(CESK_STORE_ADDR_NEG, CESK_STORE_ADDR_ZERO));
+
+	assert(CESK_ARITHMETIC_DOMAIN_INTERVAL == cesk_arithmetic_parse_domain("interval"));
+	assert(cesk_arithmetic_parse_domain("bogus") < 0);
+	assert(cesk_arithmetic_set_domain(CESK_ARITHMETIC_NUM_OF_DOMAINS) < 0);
+	assert(0 == cesk_arithmetic_set_domain(CESK_ARITHMETIC_DOMAIN_INTERVAL));
+
+	/* small constants are exact */
+	uint32_t three = cesk_arithmetic_const(3);
+	uint32_t minus_two = cesk_arithmetic_const(-2);
+	assert(CESK_STORE_ADDR_CONST_IS_REFINED(three));
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_sign(three));
+	assert(CESK_STORE_ADDR_CONST_CONTAIN(three, POS) && !CESK_STORE_ADDR_CONST_CONTAIN(three, ZERO));
+	assert(1 == cesk_arithmetic_range(three, &lo, &hi) && 3 == lo && 3 == hi);
+	assert(1 == cesk_arithmetic_range(minus_two, &lo, &hi) && -2 == lo && -2 == hi);
+	assert(CESK_STORE_ADDR_ZERO == cesk_arithmetic_const(0));
+	/* the large values are abstracted to the sign */
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_const(CESK_ARITHMETIC_MAX_MAGNITUDE + 1));
+	assert(CESK_STORE_ADDR_NEG == cesk_arithmetic_const(-1000));
+
+	/* arithmetic */
+	assert(cesk_arithmetic_const(1) == cesk_arithmetic_add(three, minus_two));
+	assert(cesk_arithmetic_const(5) == cesk_arithmetic_sub(three, minus_two));
+	assert(cesk_arithmetic_const(-6) == cesk_arithmetic_mul(three, minus_two));
+	assert(cesk_arithmetic_const(-3) == cesk_arithmetic_neg(three));
+	assert(CESK_STORE_ADDR_ZERO == cesk_arithmetic_sub(three, three));
+	assert(cesk_arithmetic_const(9) == cesk_arithmetic_mul(three, three));
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_mul(three, cesk_arithmetic_const(6)));
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_add(three, CESK_STORE_ADDR_POS));
+	assert(cesk_arithmetic_const(1) == cesk_arithmetic_signum(three));
+
+	/* join, the hull of the same sign class is an interval */
+	uint32_t one_to_three = cesk_arithmetic_join(cesk_arithmetic_const(2), three);
+	assert(CESK_STORE_ADDR_CONST_IS_REFINED(one_to_three));
+	assert(1 == cesk_arithmetic_range(one_to_three, &lo, &hi) && 1 == lo && 3 == hi);
+	assert(1 == cesk_arithmetic_range(cesk_arithmetic_add(one_to_three, cesk_arithmetic_const(1)), &lo, &hi) && 1 == lo && 4 == hi);
+	assert((CESK_STORE_ADDR_NEG | CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_POS) == cesk_arithmetic_add(one_to_three, minus_two));
+	/* different sign classes are joined in the sign lattice, so that 0 is not included */
+	assert((CESK_STORE_ADDR_NEG | CESK_STORE_ADDR_POS) == cesk_arithmetic_join(three, minus_two));
+	assert(three == cesk_arithmetic_join(CESK_STORE_ADDR_EMPTY, three));
+	assert(CESK_STORE_ADDR_POS == cesk_arithmetic_join(CESK_STORE_ADDR_POS, three));
+	assert((CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_POS) == cesk_arithmetic_join(CESK_STORE_ADDR_ZERO, three));
+
+	/* the division, the remainder and the conversion are not exact */
+	assert((CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_POS) == cesk_arithmetic_div(three, cesk_arithmetic_const(2)));
+	assert((CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_NEG) == cesk_arithmetic_div(three, minus_two));
+	assert((CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_POS) == cesk_arithmetic_rem(three, minus_two));
+	assert(CESK_STORE_ADDR_ZERO == cesk_arithmetic_rem(CESK_STORE_ADDR_ZERO, three));
+	assert(!cesk_arithmetic_is_bounded(cesk_arithmetic_rem(three, three)));
+	assert(three == cesk_arithmetic_convert(three));
+	assert(CESK_STORE_ADDR_NEG == cesk_arithmetic_convert(minus_two));
+	assert(!cesk_arithmetic_is_bounded(cesk_arithmetic_convert(minus_two)));
+	/* ~x = -x - 1 */
+	assert(cesk_arithmetic_const(-4) == cesk_arithmetic_complement(three));
+	assert(cesk_arithmetic_const(1) == cesk_arithmetic_complement(minus_two));
+	assert((CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_POS) == cesk_arithmetic_complement(CESK_STORE_ADDR_NEG));
+	assert(CESK_STORE_ADDR_NEG == cesk_arithmetic_complement(CESK_STORE_ADDR_ZERO));
+
+	/* NumericTest/run returns -1 only if 3 + (-2) <= 0, which never happens */
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) NumericTest (super java/lang/Object)"
+		"	(method (attrs public static) run() int (limit-registers 3)"
+		"		(const v0 3)"
+		"		(const v1 -2)"
+		"		(add-int v0 v0 v1)"
+		"		(if-lez v0 NumericTest_Lneg)"
+		"		(const v2 1)"
+		"		(return v2)"
+		"		(label NumericTest_Lneg)"
+		"		(const v2 -1)"
+		"		(return v2))"
+		/* 4 % 2 = 0 */
+		"	(method (attrs public static) rem() int (limit-registers 3)"
+		"		(const v0 4)"
+		"		(const v1 2)"
+		"		(rem-int v0 v0 v1)"
+		"		(if-nez v0 NumericTest_Lrem)"
+		"		(const v2 1)"
+		"		(return v2)"
+		"		(label NumericTest_Lrem)"
+		"		(const v2 -1)"
+		"		(return v2))"
+		/* ~3 = -4 */
+		"	(method (attrs public static) not() int (limit-registers 3)"
+		"		(const v0 3)"
+		"		(not-int v0 v0)"
+		"		(const v1 -4)"
+		"		(if-ne v0 v1 NumericTest_Lnot)"
+		"		(const v2 1)"
+		"		(return v2)"
+		"		(label NumericTest_Lnot)"
+		"		(const v2 -1)"
+		"		(return v2))"
+		/* (char)-3 = 65533 */
+		"	(method (attrs public static) convert() int (limit-registers 3)"
+		"		(const v0 -3)"
+		"		(int-to-char v0 v0)"
+		"		(if-ltz v0 NumericTest_Lconvert)"
+		"		(const v2 1)"
+		"		(return v2)"
+		"		(label NumericTest_Lconvert)"
+		"		(const v2 -1)"
+		"		(return v2)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+	const dalvik_block_t* graph = dalvik_block_from_method(stringpool_query("NumericTest"), stringpool_query("run"), noarg, tint);
+	assert(NULL != graph);
+
+	/* the infeasible branch is pruned */
+	assert(CESK_STORE_ADDR_POS == analyze(graph));
+
+	/* the branches are not pruned with the values that are only known by the sign */
+	const char* methods[] = {"rem", "not", "convert"};
+	int i;
+	for(i = 0; i < 3; i ++)
+	{
+		const dalvik_block_t* code = dalvik_block_from_method(stringpool_query("NumericTest"), stringpool_query(methods[i]), noarg, tint);
+		assert(NULL != code);
+		assert(CESK_STORE_ADDR_CONST_CONTAIN(analyze(code), POS));
+	}
+
+	/* the sign domain can not tell the sign of 3 + (-2), but the pre-pass has disabled the branch when the graph is built */
+	assert(0 == cesk_arithmetic_set_domain(CESK_ARITHMETIC_DOMAIN_SIGN));
+	assert(CESK_STORE_ADDR_POS == analyze(graph));
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include <adam.h>
+#include <assert.h>
+/* the object allocated by instruction #1 */
+static const cesk_alloc_param_t param = CESK_ALLOC_PARAM(1, 0);
+/* build a frame that holds a CanonTest object in v1, the field value of the object is the given constant,
+ * if collide is set, a dead cell is allocated first so that the object is placed at another address */
+static cesk_frame_t* build(uint32_t nregs, int collide, uint32_t value, uint32_t* p_addr)
+{
+	cesk_frame_t* frame = cesk_frame_new(nregs);
+	assert(NULL != frame);
+	if(collide)
+	{
+		/* find another instruction whose object falls in the same slot */
+		cesk_alloc_param_t other = CESK_ALLOC_PARAM(2, 0);
+		for(; cesk_alloc_param_hash(&other) % CESK_STORE_BLOCK_NSLOTS != cesk_alloc_param_hash(&param) % CESK_STORE_BLOCK_NSLOTS; other.inst ++);
+		uint32_t dead = cesk_store_allocate(frame->store, &other);
+		assert(CESK_STORE_ADDR_NULL != dead);
+		assert(0 == cesk_store_attach(frame->store, dead, cesk_value_empty_set()));
+		cesk_store_release_rw(frame->store, dead);
+	}
+	uint32_t addr = cesk_store_allocate(frame->store, &param);
+	assert(CESK_STORE_ADDR_NULL != addr);
+	cesk_value_t* objval = cesk_value_from_classpath(stringpool_query("CanonTest"));
+	assert(NULL != objval);
+	assert(0 == cesk_store_attach(frame->store, addr, objval));
+	/* the field is stored in a set cell */
+	cesk_alloc_param_t fparam = CESK_ALLOC_PARAM(1, 1);
+	uint32_t faddr = cesk_store_allocate(frame->store, &fparam);
+	assert(CESK_STORE_ADDR_NULL != faddr);
+	cesk_value_t* setval = cesk_value_empty_set();
+	assert(0 == cesk_set_push(setval->pointer.set, value));
+	assert(0 == cesk_store_attach(frame->store, faddr, setval));
+	cesk_store_release_rw(frame->store, faddr);
+	uint32_t* field = cesk_object_get(objval->pointer.object, stringpool_query("CanonTest"), stringpool_query("value"), NULL, NULL);
+	assert(NULL != field);
+	*field = faddr;
+	assert(0 < cesk_store_incref(frame->store, faddr));
+	cesk_store_release_rw(frame->store, addr);
+	assert(0 == cesk_set_push(frame->regs[CESK_FRAME_GENERAL_REG(1)], addr));
+	assert(0 < cesk_store_incref(frame->store, addr));
+	*p_addr = addr;
+	return frame;
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) CanonTest (super java/lang/Object)"
+		"	(field (attrs public) value int)"
+		"	(method (attrs public static) keep([object CanonTest]) int (limit-registers 2)"
+		"		(const v0 1)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	assert(NULL != sexp_parse("[object CanonTest]", &sexp));
+	dalvik_type_t* tobj = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* objarg[] = {tobj, NULL};
+
+	const dalvik_block_t* keep = dalvik_block_from_method(stringpool_query("CanonTest"), stringpool_query("keep"), objarg, tint);
+	assert(NULL != keep);
+
+	/* the two frames only differ in the address of the object */
+	uint32_t addr1, addr2, addr3;
+	cesk_frame_t* frame1 = build(keep->nregs, 0, CESK_STORE_ADDR_POS, &addr1);
+	cesk_frame_t* frame2 = build(keep->nregs, 1, CESK_STORE_ADDR_POS, &addr2);
+	cesk_frame_t* frame3 = build(keep->nregs, 1, CESK_STORE_ADDR_NEG, &addr3);
+	assert(addr1 != addr2);
+	assert(addr2 == addr3);
+	assert(0 == cesk_frame_equal(frame1, frame2));
+	assert(cesk_frame_canonical_hashcode(frame1, NULL, 0) == cesk_frame_canonical_hashcode(frame2, NULL, 0));
+	assert(1 == cesk_frame_isomorphic(frame1, frame2, NULL, 0));
+	/* but the value of the field still matters */
+	assert(0 == cesk_frame_isomorphic(frame1, frame3, NULL, 0));
+
+	/* the k-th address of the first frame corresponds to the k-th address of the second frame */
+	uint32_t count1, count2;
+	const uint32_t* order1 = cesk_frame_canonical_order(frame1, NULL, 0, &count1);
+	const uint32_t* order2 = cesk_frame_canonical_order(frame2, NULL, 0, &count2);
+	assert(NULL != order1);
+	assert(NULL != order2);
+	assert(2 == count1);
+	assert(count1 == count2);
+	assert(addr1 == order1[0]);
+	assert(addr2 == order2[0]);
+
+	/* so that a diff computed from the first frame can be applied to the second one */
+	cesk_diff_buffer_t* buf = cesk_diff_buffer_new(0, 0);
+	assert(NULL != buf);
+	cesk_value_t* setval = cesk_value_empty_set();
+	assert(0 == cesk_set_push(setval->pointer.set, CESK_STORE_ADDR_ZERO));
+	assert(0 == cesk_diff_buffer_append(buf, CESK_DIFF_STORE, order1[1], setval));
+	cesk_diff_t* diff = cesk_diff_from_buffer(buf);
+	cesk_diff_buffer_free(buf);
+	assert(NULL != diff);
+	cesk_diff_t* renamed = cesk_diff_rename(diff, order1, order2, count1);
+	assert(NULL != renamed);
+	assert(1 == renamed->offset[CESK_DIFF_STORE + 1] - renamed->offset[CESK_DIFF_STORE]);
+	assert(order2[1] == renamed->data[renamed->offset[CESK_DIFF_STORE]].addr);
+	cesk_diff_free(renamed);
+	/* an object address out of the list can not be renamed */
+	assert(NULL == cesk_diff_rename(diff, order1, order2, 1));
+	cesk_diff_free(diff);
+
+	/* and the invocations with the isomorphic frames share the cache entry */
+	cesk_reloc_table_t *rtab1, *rtab2;
+	cesk_diff_t* ret = cesk_method_analyze(keep, frame1, NULL, &rtab1);
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	ret = cesk_method_analyze(keep, frame2, NULL, &rtab2);
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	assert(rtab1 == rtab2);
+	cesk_method_clean_cache();
+
+	cesk_frame_free(frame1);
+	cesk_frame_free(frame2);
+	cesk_frame_free(frame3);
+	dalvik_type_free(tint);
+	dalvik_type_free(tobj);
+	adam_finalize();
+	return 0;
+}
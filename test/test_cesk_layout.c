@@ -0,0 +1,47 @@
+#include <adam.h>
+#include <assert.h>
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) LayoutBase (super java/lang/Object)"
+		"	(field (attrs public) a int))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse(
+		"(class (attrs public) LayoutTest (super LayoutBase)"
+		"	(field (attrs public) b int)"
+		"	(field (attrs public) c int))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	const char* classpath = stringpool_query("LayoutTest");
+	cesk_object_t* object = cesk_object_new(classpath);
+	assert(NULL != object);
+	/* LayoutTest, LayoutBase and the built-in java/lang/Object */
+	assert(3 == object->depth);
+	uint32_t* field = cesk_object_get(object, classpath, stringpool_query("b"), NULL, NULL);
+	assert(NULL != field);
+	assert(CESK_STORE_ADDR_NULL == *field);
+	*field = CESK_STORE_ADDR_ZERO;
+	assert(NULL != cesk_object_get(object, stringpool_query("LayoutBase"), stringpool_query("a"), NULL, NULL));
+
+	/* the second instance comes from the layout cache, the change to the first one is not in the template */
+	cesk_object_t* object_clone = cesk_object_new(classpath);
+	assert(NULL != object_clone);
+	assert(object->size == object_clone->size);
+	assert(object->depth == object_clone->depth);
+	assert(0 == cesk_object_equal(object, object_clone));
+	field = cesk_object_get(object_clone, classpath, stringpool_query("b"), NULL, NULL);
+	assert(NULL != field);
+	assert(CESK_STORE_ADDR_NULL == *field);
+	*field = CESK_STORE_ADDR_ZERO;
+	assert(1 == cesk_object_equal(object, object_clone));
+	assert(cesk_object_hashcode(object) == cesk_object_hashcode(object_clone));
+
+	cesk_object_free(object_clone);
+	cesk_object_free(object);
+	adam_finalize();
+	return 0;
+}
@@ -45,8 +45,8 @@ int main()
 	assert(ret->offset[CESK_DIFF_STORE + 1] - ret->offset[CESK_DIFF_STORE] == 0);
 	assert(ret->offset[CESK_DIFF_DEALLOC + 1] - ret->offset[CESK_DIFF_DEALLOC] == 0);
 	assert(ret->data[ret->offset[CESK_DIFF_REG]].addr == 0);
-	assert(cesk_set_size(ret->data[ret->offset[CESK_DIFF_REG]].arg.set) == 2);
-	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_POS));
+	/* 1 < 100 holds at the first test, so the pre-pass has pruned the loop body */
+	assert(cesk_set_size(ret->data[ret->offset[CESK_DIFF_REG]].arg.set) == 1);
 	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_ZERO));
 	cesk_frame_free(frame);
 	cesk_diff_free(ret);
@@ -491,6 +491,51 @@ int main()
 	cesk_frame_free(frame);
 	cesk_diff_free(ret); 
 
+	/* the pure built-in methods only write the result register */
+	assert(NULL != sexp_parse(
+		"(class (attrs public) pureCases (super java/lang/Object)"
+		"	(method (attrs public static) len() int (limit-registers 2)"
+		"		(const-string v0 \"hello\")"
+		"		(invoke-virtual {v0} java/lang/String/length () int)"
+		"		(move-result v1)"
+		"		(return v1))"
+		"	(method (attrs public static) hash() int (limit-registers 2)"
+		"		(const-string v0 \"hello\")"
+		"		(invoke-virtual {v0} java/lang/Object/hashCode () int)"
+		"		(move-result v1)"
+		"		(invoke-virtual {v0} java/lang/Object/hashCode () int)"
+		"		(move-result v1)"
+		"		(return v1)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	type[0] = NULL;
+	graph = dalvik_block_from_method(stringpool_query("pureCases"), stringpool_query("len"), type, tint);
+	assert(NULL != graph);
+	frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	ret = cesk_method_analyze(graph, frame, NULL, &rtable);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	assert(cesk_set_size(ret->data[ret->offset[CESK_DIFF_REG]].arg.set) == 1);
+	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_POS));
+	cesk_frame_free(frame);
+	cesk_diff_free(ret);
+
+	/* the second invocation of the const method is answered by the memoization table */
+	graph = dalvik_block_from_method(stringpool_query("pureCases"), stringpool_query("hash"), type, tint);
+	assert(NULL != graph);
+	frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	ret = cesk_method_analyze(graph, frame, NULL, &rtable);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	assert(cesk_set_size(ret->data[ret->offset[CESK_DIFF_REG]].arg.set) == 3);
+	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_NEG));
+	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_ZERO));
+	assert(cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, CESK_STORE_ADDR_POS));
+	cesk_frame_free(frame);
+	cesk_diff_free(ret);
+
 	dalvik_type_free(tint);
 	dalvik_type_free(tobj);
 
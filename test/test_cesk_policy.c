@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <string.h>
+#include <adam.h>
+/* analyze PolicyTest/run and return the value set of the result register */
+static int analyze(const dalvik_block_t* graph, uint32_t* neg, uint32_t* pos)
+{
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	const cesk_set_t* set = ret->data[ret->offset[CESK_DIFF_REG]].arg.set;
+	*neg = cesk_set_contain(set, CESK_STORE_ADDR_NEG);
+	*pos = cesk_set_contain(set, CESK_STORE_ADDR_POS);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	cesk_method_clean_cache();
+	return 0;
+}
+int main()
+{
+	adam_init();
+
+	/* the rules */
+	assert(3 == cesk_policy_parse("callsite:2,Policy=type,PolicyTest=object:3"));
+	const cesk_policy_t* policy = cesk_policy_get(stringpool_query("PolicyTestClass"));
+	assert(CESK_POLICY_OBJECT == policy->type && 3 == policy->k);
+	policy = cesk_policy_get(stringpool_query("PolicyOther"));
+	assert(CESK_POLICY_TYPE == policy->type && 1 == policy->k);
+	policy = cesk_policy_get(stringpool_query("Other"));
+	assert(CESK_POLICY_CALLSITE == policy->type && 2 == policy->k);
+	assert(0 == strcmp("callsite:2", cesk_policy_to_string(policy, NULL, 0)));
+	assert(cesk_policy_parse("bogus") < 0);
+	assert(cesk_policy_parse("callsite:0") < 0);
+	assert(cesk_policy_parse("callsite:x") < 0);
+	cesk_policy_reset();
+	assert(CESK_POLICY_FULL == cesk_policy_get(stringpool_query("PolicyTest"))->type);
+
+	/* PolicyTest/run passes 1 and then -1 to the same method from two call sites */
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) PolicyTest (super java/lang/Object)"
+		"	(method (attrs public static) id(int) int (limit-registers 2) (move v0 v1) (return v0))"
+		"	(method (attrs public static) run() int (limit-registers 3)"
+		"		(const v0 1)"
+		"		(invoke-static {v0} PolicyTest/id (int) int)"
+		"		(move-result v1)"
+		"		(const v0 -1)"
+		"		(invoke-static {v0} PolicyTest/id (int) int)"
+		"		(move-result v2)"
+		"		(return v2)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+	const dalvik_block_t* graph = dalvik_block_from_method(stringpool_query("PolicyTest"), stringpool_query("run"), noarg, tint);
+	assert(NULL != graph);
+
+	uint32_t neg, pos;
+	/* the two invocations are analyzed separately */
+	analyze(graph, &neg, &pos);
+	assert(neg && !pos);
+
+	/* the call sites are different, so are the calling contexts */
+	assert(1 == cesk_policy_parse("callsite:1"));
+	analyze(graph, &neg, &pos);
+	assert(neg && !pos);
+
+	/* a static method inherits the context of the caller, so the two invocations have the same abstract 
+	 * calling context, and the input frames are joined */
+	assert(1 == cesk_policy_parse("type:1"));
+	analyze(graph, &neg, &pos);
+	assert(neg && pos);
+
+	/* the policy for the prefix overrides the default one */
+	assert(1 == cesk_policy_parse("PolicyTest=full"));
+	analyze(graph, &neg, &pos);
+	assert(neg && !pos);
+
+	cesk_policy_reset();
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
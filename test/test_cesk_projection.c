@@ -0,0 +1,137 @@
+#include <adam.h>
+#include <assert.h>
+/* analyze the method with the given values in the static fields A and B, returns the relocation table */
+static cesk_reloc_table_t* analyze(const dalvik_block_t* graph, uint32_t a, uint32_t b)
+{
+	uint32_t addr_a = cesk_static_field_query(stringpool_query("ProjectionTest"), stringpool_query("A"));
+	uint32_t addr_b = cesk_static_field_query(stringpool_query("ProjectionTest"), stringpool_query("B"));
+	assert(CESK_STORE_ADDR_NULL != addr_a);
+	assert(CESK_STORE_ADDR_NULL != addr_b);
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	uint32_t reg = CESK_FRAME_GENERAL_REG(0);
+	assert(0 <= cesk_frame_register_load(frame, reg, a, NULL, NULL, NULL));
+	assert(0 <= cesk_frame_static_load_from_register(frame, addr_a, reg, NULL, NULL));
+	assert(0 <= cesk_frame_register_load(frame, reg, b, NULL, NULL, NULL));
+	assert(0 <= cesk_frame_static_load_from_register(frame, addr_b, reg, NULL, NULL));
+	assert(0 <= cesk_frame_register_clear(frame, reg, NULL, NULL));
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	return rtab;
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) ProjectionTest (super java/lang/Object)"
+		"	(field (attrs public static) A int)"
+		"	(field (attrs public static) B int)"
+		"	(method (attrs public static) read() int (limit-registers 1)"
+		"		(sget v0 ProjectionTest.A int)"
+		"		(return v0))"
+		"	(method (attrs public static) add(int) int (limit-registers 2)"
+		"		(sget v0 ProjectionTest.A int)"
+		"		(add-int v0 v0 v1)"
+		"		(return v0))"
+		"	(method (attrs public static) call() int (limit-registers 1)"
+		"		(const v0 1)"
+		"		(invoke-static {v0} ProjectionTest/add (int) int)"
+		"		(move-result v0)"
+		"		(return v0))"
+		"	(method (attrs public static) choose() int (limit-registers 2)"
+		"		(const v1 5)"
+		"		(packed-switch v1 0 ProjectionTest_L0 ProjectionTest_Ldefault)"
+		"		(label ProjectionTest_Ldefault)"
+		"		(sget v0 ProjectionTest.B int)"
+		"		(return v0)"
+		"		(label ProjectionTest_L0)"
+		"		(sget v0 ProjectionTest.A int)"
+		"		(return v0))"
+		"	(method (attrs public static) virtual1() int (limit-registers 1)"
+		"		(new-instance v0 ProjectionImpl)"
+		"		(invoke-interface {v0} ProjectionIface/get () int)"
+		"		(move-result v0)"
+		"		(return v0))"
+		"	(method (attrs public static) virtual2() int (limit-registers 1)"
+		"		(new-instance v0 ProjectionImpl)"
+		"		(invoke-interface {v0} ProjectionIface/get () int)"
+		"		(move-result v0)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse(
+		"(interface (attrs public abstract) ProjectionIface (super java/lang/Object)"
+		"	(method (attrs public abstract) get() int))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse(
+		"(class (attrs public) ProjectionImpl (super java/lang/Object) (implements ProjectionIface)"
+		"	(method (attrs public) get() int (limit-registers 2)"
+		"		(sget v0 ProjectionTest.A int)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+
+	const dalvik_block_t* read = dalvik_block_from_method(stringpool_query("ProjectionTest"), stringpool_query("read"), noarg, tint);
+	assert(NULL != read);
+	cesk_reloc_table_t* rtab = analyze(read, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	/* B is never touched by the method, so the call shares the cache entry */
+	assert(rtab == analyze(read, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_NEG));
+	/* but A is read by the method */
+	assert(rtab != analyze(read, CESK_STORE_ADDR_NEG, CESK_STORE_ADDR_POS));
+	cesk_method_clean_cache();
+
+	/* the footprint of the callee is included in the footprint of the caller */
+	const dalvik_block_t* call = dalvik_block_from_method(stringpool_query("ProjectionTest"), stringpool_query("call"), noarg, tint);
+	assert(NULL != call);
+	rtab = analyze(call, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	assert(rtab == analyze(call, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_NEG));
+	assert(rtab != analyze(call, CESK_STORE_ADDR_NEG, CESK_STORE_ADDR_POS));
+	cesk_method_clean_cache();
+
+	/* B is read on the default branch of the switch */
+	const dalvik_block_t* choose = dalvik_block_from_method(stringpool_query("ProjectionTest"), stringpool_query("choose"), noarg, tint);
+	assert(NULL != choose);
+	rtab = analyze(choose, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	assert(rtab != analyze(choose, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_NEG));
+	cesk_method_clean_cache();
+
+	/* the only implementor of the interface reads A */
+	const dalvik_block_t* virtual1 = dalvik_block_from_method(stringpool_query("ProjectionTest"), stringpool_query("virtual1"), noarg, tint);
+	assert(NULL != virtual1);
+	rtab = analyze(virtual1, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	assert(rtab == analyze(virtual1, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_NEG));
+	cesk_method_clean_cache();
+
+	/* ProjectionOther might implement the interface through ProjectionLib, which is not loaded */
+	assert(NULL != sexp_parse(
+		"(class (attrs public) ProjectionOther (super ProjectionLib)"
+		"	(method (attrs public) get() int (limit-registers 2)"
+		"		(sget v0 ProjectionTest.B int)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	const dalvik_block_t* virtual2 = dalvik_block_from_method(stringpool_query("ProjectionTest"), stringpool_query("virtual2"), noarg, tint);
+	assert(NULL != virtual2);
+	rtab = analyze(virtual2, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	assert(rtab != analyze(virtual2, CESK_STORE_ADDR_POS, CESK_STORE_ADDR_NEG));
+	cesk_method_clean_cache();
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include <adam.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+/* visit all the blocks in the graph */
+static int collect(const dalvik_block_t* entry, const dalvik_block_t** list, size_t n)
+{
+	if(NULL == entry || NULL != list[entry->index]) return 0;
+	assert(entry->index < n);
+	list[entry->index] = entry;
+	int i, ret = 1;
+	for(i = 0; i < entry->nbranches; i ++)
+		if(!entry->branches[i].disabled && !DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(entry->branches[i]))
+			ret += collect(entry->branches[i].block, list, n);
+	return ret;
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+
+	/* a method with more key instructions than the stack buffer */
+	int i, n = DALVIK_BLOCK_MAX_KEYS;
+	size_t size = 1024 + 128 * n;
+	char* text = (char*)malloc(size);
+	assert(NULL != text);
+	int len = snprintf(text, size, "(class (attrs public) BigMethod (super java/lang/Object) (method (attrs public static) run() int (limit-registers 3) (const v1 0)");
+	for(i = 0; i < n; i ++)
+		len += snprintf(text + len, size - len, " (const v0 %d) (if-eq v0 v1 BigMethod_L%d) (const v2 %d) (label BigMethod_L%d)", i, i, i, i);
+	snprintf(text + len, size - len, " (return v0)))");
+	assert(NULL != sexp_parse(text, &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	free(text);
+
+	assert(0 == dalvik_loader_from_directory("./test/cases/analyzer"));
+
+	/* build all the graphs with 4 threads, and then all of them are in the cache */
+	int nbuilt = dalvik_block_precompute(4);
+	assert(nbuilt > 0);
+	assert(0 == dalvik_block_precompute(4));
+
+	const dalvik_block_t* big = dalvik_block_from_method(stringpool_query("BigMethod"), stringpool_query("run"), noarg, tint);
+	assert(NULL != big);
+	assert(big->info->nblocks > DALVIK_BLOCK_MAX_KEYS);
+	const dalvik_block_t** list = (const dalvik_block_t**)calloc(big->info->nblocks, sizeof(dalvik_block_t*));
+	/* only the first if-eq is taken, the pre-pass has disabled the other ones */
+	assert(2 * n <= collect(big, list, big->info->nblocks));
+	/* the loop info is not computed unless it's requested */
+	for(i = 0; i < big->info->nblocks; i ++)
+	{
+		if(NULL == list[i]) continue;
+		assert(DALVIK_BLOCK_INDEX_INVALID == list[i]->idom);
+		assert(0 == list[i]->loop_depth);
+		assert(0 == list[i]->loop_header);
+	}
+	free(list);
+
+	/* the analyzer context is sized to the block graph, so there's no limit on the number of blocks */
+	cesk_frame_t* frame = cesk_frame_new(big->nregs);
+	assert(NULL != frame);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(big, frame, NULL, &rtab);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+
+	dalvik_block_loop_info_enabled = 1;
+	/* LoopTest/run contains one loop, the loop condition can not be decided by the pre-pass */
+	assert(NULL != sexp_parse(
+		"(class (attrs public) LoopTest (super java/lang/Object)"
+		"	(method (attrs public static) run() int (limit-registers 4)"
+		"		(const v1 0)"
+		"		(const v2 0)"
+		"		(const v3 100)"
+		"		(label LoopTest_Begin)"
+		"		(if-ge v1 v3 LoopTest_End)"
+		"		(add-int v2 v2 v1)"
+		"		(add-int/lit8 v1 v1 1)"
+		"		(goto LoopTest_Begin)"
+		"		(label LoopTest_End)"
+		"		(return v2)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	const dalvik_block_t* sum = dalvik_block_from_method(stringpool_query("LoopTest"), stringpool_query("run"), noarg, tint);
+	assert(NULL != sum);
+	const dalvik_block_t* blocks[64] = {};
+	assert(sum->info->nblocks <= 64);
+	int nblocks = collect(sum, blocks, 64);
+	assert(sum->rpo == 0);
+	assert(sum->idom == sum->index);
+	assert(sum->loop_depth == 0);
+	int nheaders = 0, nloop = 0;
+	for(i = 0; i < 64; i ++)
+	{
+		if(NULL == blocks[i]) continue;
+		assert(blocks[i]->rpo < nblocks);
+		/* the immediate dominator precedes the block in reverse post-order */
+		if(blocks[i] != sum) assert(blocks[blocks[i]->idom]->rpo < blocks[i]->rpo);
+		nheaders += blocks[i]->loop_header;
+		if(blocks[i]->loop_depth > 0) nloop ++;
+		assert(blocks[i]->loop_depth <= 1);
+	}
+	assert(1 == nheaders);
+	assert(nloop >= 2);
+
+	/* the exception dispatch table */
+	const char* classes = 
+		"(class (attrs public) ExcBase (super java/lang/Object))"
+		"(class (attrs public) ExcChild (super ExcBase))"
+		"(class (attrs public) ExcGrandChild (super ExcChild))"
+		"(class (attrs public) ExcOther (super java/lang/Object))"
+		"(class (attrs public) ExcOrphan (super ExcMissing))"
+		"(class (attrs public) ExcTest (super java/lang/Object)"
+		"	(method (attrs public static) run() int (limit-registers 2)"
+		"		(catch ExcChild from ExcTest_E1 to ExcTest_E2 using ExcTest_H1)"
+		"		(catch ExcBase from ExcTest_E1 to ExcTest_E2 using ExcTest_H2)"
+		"		(catch ExcChild from ExcTest_E1 to ExcTest_E2 using ExcTest_H2)"
+		"		(label ExcTest_E1)"
+		"		(const v0 1)"
+		"		(label ExcTest_E2)"
+		"		(return v0)"
+		"		(label ExcTest_H1)"
+		"		(const v0 2)"
+		"		(return v0)"
+		"		(label ExcTest_H2)"
+		"		(const v0 3)"
+		"		(return v0)))";
+	for(i = 0; i < 6; i ++)
+	{
+		assert(NULL != (classes = sexp_parse(classes, &sexp)));
+		assert(NULL != dalvik_class_from_sexp(sexp));
+		sexp_free(sexp);
+	}
+	const dalvik_block_t* exc = dalvik_block_from_method(stringpool_query("ExcTest"), stringpool_query("run"), noarg, tint);
+	assert(NULL != exc);
+	const dalvik_block_t* exc_blocks[16] = {};
+	assert(exc->info->nblocks <= 16);
+	collect(exc, exc_blocks, 16);
+	const dalvik_block_t* thrower = NULL;
+	const dalvik_block_exception_table_t* empty = NULL;
+	for(i = 0; i < 16; i ++)
+	{
+		if(NULL == exc_blocks[i]) continue;
+		if(exc_blocks[i]->nbranches > 1) thrower = exc_blocks[i];
+		else
+		{
+			/* the blocks without handler share the empty table */
+			assert(0 == exc_blocks[i]->handlers->nentries);
+			assert(NULL == empty || empty == exc_blocks[i]->handlers);
+			empty = exc_blocks[i]->handlers;
+			assert(DALVIK_BLOCK_EXCEPTION_UNCAUGHT == dalvik_block_exception_dispatch(exc_blocks[i], stringpool_query("ExcChild")));
+		}
+	}
+	assert(NULL != thrower && NULL != empty);
+	/* the duplicated handler for ExcChild is shadowed by the first one */
+	assert(2 == thrower->handlers->nentries);
+	int h1 = dalvik_block_exception_dispatch(thrower, stringpool_query("ExcChild"));
+	int h2 = dalvik_block_exception_dispatch(thrower, stringpool_query("ExcBase"));
+	assert(1 == h1 && 2 == h2);
+	assert(h1 == dalvik_block_exception_dispatch(thrower, stringpool_query("ExcGrandChild")));
+	assert(DALVIK_BLOCK_EXCEPTION_UNCAUGHT == dalvik_block_exception_dispatch(thrower, stringpool_query("ExcOther")));
+	/* the handler can not be decided if the hierarchy is incomplete */
+	assert(DALVIK_BLOCK_EXCEPTION_ANY == dalvik_block_exception_dispatch(thrower, stringpool_query("ExcUnknown")));
+	assert(DALVIK_BLOCK_EXCEPTION_ANY == dalvik_block_exception_dispatch(thrower, stringpool_query("ExcOrphan")));
+	assert(thrower->branches[h1].block != thrower->branches[h2].block);
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
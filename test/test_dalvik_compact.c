@@ -0,0 +1,78 @@
+#include <adam.h>
+#include <assert.h>
+int main()
+{
+	adam_init();
+	assert(0 == cesk_arithmetic_set_domain(CESK_ARITHMETIC_DOMAIN_INTERVAL));
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) CompactTest (super java/lang/Object)"
+		"	(method (attrs public static) run(long) int (limit-registers 6)"
+		"		(const-string v3 \"compact\")"
+		"		(const v0 1)"
+		"		(add-int/lit8 v1 v0 2)"
+		"		(move-wide v2 v4)"
+		"		(cmpl-double v0 v2 v4)"
+		"		(return v1)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	assert(NULL != sexp_parse("long", &sexp));
+	dalvik_type_t* tlong = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* args[] = {tlong, NULL};
+
+	const dalvik_block_t* graph = dalvik_block_from_method(stringpool_query("CompactTest"), stringpool_query("run"), args, tint);
+	assert(NULL != graph);
+	const dalvik_compact_t* code = graph->compact;
+	assert(NULL != code);
+	assert(graph->end - graph->begin >= 5);
+
+	/* the string constant is executed by the generic handler */
+	assert(DALVIK_COMPACT_OP_CONST_STRING == DALVIK_COMPACT_OP(code, 0));
+	assert(DALVIK_COMPACT_AUX_NONE == code->aux[0]);
+
+	/* the numeric constant is copied to the side table */
+	assert(DALVIK_COMPACT_OP_CONST == DALVIK_COMPACT_OP(code, 1));
+	assert(0 == DALVIK_COMPACT_REG(code, 1, 0));
+	assert(1 == DALVIK_COMPACT_CONST(code, 1, 0)->payload.int32);
+
+	/* the literal operand of a binary operation */
+	assert(DALVIK_COMPACT_OP_BINOP == DALVIK_COMPACT_OP(code, 2));
+	assert(DVM_FLAG_BINOP_ADD == code->flags[2]);
+	assert(1 == DALVIK_COMPACT_REG(code, 2, 0));
+	assert(0 == DALVIK_COMPACT_REG(code, 2, 1));
+	assert(DALVIK_COMPACT_REG_CONST == DALVIK_COMPACT_REG(code, 2, 2));
+	assert(cesk_arithmetic_const(2) == cesk_store_const_addr_from_operand(DALVIK_COMPACT_CONST(code, 2, 0)));
+
+	/* the register pairs */
+	assert(DALVIK_COMPACT_OP_MOVE_WIDE == DALVIK_COMPACT_OP(code, 3));
+	assert(2 == DALVIK_COMPACT_REG(code, 3, 0));
+	assert(4 == DALVIK_COMPACT_REG(code, 3, 1));
+	assert(DALVIK_COMPACT_REG_NONE == DALVIK_COMPACT_REG(code, 3, 2));
+	assert(DALVIK_COMPACT_OP_CMP_WIDE == DALVIK_COMPACT_OP(code, 4));
+	assert(DVM_CMP == dalvik_compact_opcode(DALVIK_COMPACT_OP(code, 4)));
+
+	/* and the analyzer gets the same result from the encoding */
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	assert(0 == cesk_set_push(frame->regs[CESK_FRAME_GENERAL_REG(4)], cesk_arithmetic_const(1)));
+	assert(0 == cesk_set_push(frame->regs[CESK_FRAME_GENERAL_REG(5)], cesk_arithmetic_const(1)));
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	assert(ret->offset[CESK_DIFF_REG + 1] - ret->offset[CESK_DIFF_REG] == 1);
+	assert(1 == cesk_set_size(ret->data[ret->offset[CESK_DIFF_REG]].arg.set));
+	assert(1 == cesk_set_contain(ret->data[ret->offset[CESK_DIFF_REG]].arg.set, cesk_arithmetic_const(3)));
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	cesk_method_clean_cache();
+
+	dalvik_type_free(tint);
+	dalvik_type_free(tlong);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <adam.h>
+static inline int contains(const char** list, int n, const char* what)
+{
+	int i;
+	for(i = 0; i < n; i ++)
+		if(list[i] == what) return 1;
+	return 0;
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sint;
+	assert(NULL != sexp_parse("int", &sint));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sint);
+	sexp_free(sint);
+	assert(NULL != tint);
+	const dalvik_type_t* type[1] = {};
+
+	assert(0 == dalvik_loader_from_directory("./test/cases/analyzer"));
+	assert(8 == dalvik_loader_num_classes());
+
+	const char* base = stringpool_query("BaseClass");
+	const char* test1 = stringpool_query("TestClass1");
+	const char* test2 = stringpool_query("TestClass2");
+	const char* getvalue = stringpool_query("getValue");
+	const char* buf[1024];
+	int n;
+
+	/* direct subclasses */
+	n = dalvik_hierarchy_get_subclasses(base, 0, buf, 1024);
+	assert(2 == n);
+	assert(contains(buf, n, test1));
+	assert(contains(buf, n, test2));
+	assert(0 == dalvik_hierarchy_get_subclasses(test1, 1, buf, 1024));
+
+	/* BaseClass is a subclass of java/lang/Object, although java/lang/Object is not loaded */
+	n = dalvik_hierarchy_get_subclasses(stringpool_query("java/lang/Object"), 1, buf, 1024);
+	assert(contains(buf, n, base));
+	assert(contains(buf, n, test1));
+	assert(contains(buf, n, test2));
+
+	/* getValue is defined in BaseClass and overridden by TestClass2 */
+	n = dalvik_hierarchy_get_overriders(base, getvalue, type, tint, buf, 1024);
+	assert(2 == n);
+	assert(contains(buf, n, base));
+	assert(contains(buf, n, test2));
+
+	/* so the call site BaseClass/getValue is polymorphic, but TestClass1/getValue is not */
+	assert(NULL == dalvik_hierarchy_resolve_monomorphic(base, getvalue, type, tint));
+	assert(base == dalvik_hierarchy_resolve_monomorphic(test1, getvalue, type, tint));
+	assert(test2 == dalvik_hierarchy_resolve_monomorphic(test2, getvalue, type, tint));
+
+	/* the subtype check only follows the loaded classes */
+	assert(1 == dalvik_hierarchy_is_subtype(test1, base));
+	assert(1 == dalvik_hierarchy_is_subtype(test1, stringpool_query("java/lang/Object")));
+	assert(0 == dalvik_hierarchy_is_subtype(base, test1));
+
+	/* HierarchySub implements the interface through HierarchyMissing, which is not loaded */
+	sexpression_t* sexp;
+	const char* classes[] = {
+		"(interface (attrs public abstract) HierarchyIface (super java/lang/Object)"
+		"	(method (attrs public abstract) getValue() int))",
+		"(class (attrs public) HierarchyImpl (super java/lang/Object) (implements HierarchyIface)"
+		"	(method (attrs public) getValue() int (limit-registers 2)"
+		"		(const v0 1)"
+		"		(return v0)))",
+		"(class (attrs public) HierarchySub (super HierarchyMissing)"
+		"	(method (attrs public) getValue() int (limit-registers 2)"
+		"		(const v0 2)"
+		"		(return v0)))",
+		NULL
+	};
+	int i;
+	for(i = 0; NULL != classes[i]; i ++)
+	{
+		assert(NULL != sexp_parse(classes[i], &sexp));
+		assert(NULL != dalvik_class_from_sexp(sexp));
+		sexp_free(sexp);
+	}
+	const char* iface = stringpool_query("HierarchyIface");
+	const char* impl = stringpool_query("HierarchyImpl");
+	const char* sub = stringpool_query("HierarchySub");
+	/* the call site is monomorphic for the loaded subtree only */
+	assert(impl == dalvik_hierarchy_resolve_monomorphic(iface, getvalue, type, tint));
+	assert(1 == dalvik_hierarchy_is_subtype(impl, iface));
+	assert(0 == dalvik_hierarchy_is_subtype(sub, iface));
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
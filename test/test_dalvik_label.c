@@ -29,6 +29,65 @@ int main()
 		assert(id == i);
 	}
 
+	/* the labels in a method scope are released when the method is done */
+	const char* l0 = stringpool_query("l0");
+	assert(0 == dalvik_label_scope_begin());
+	assert(dalvik_label_scope_begin() < 0);
+	assert(!dalvik_label_exists(l0));
+	int local = dalvik_label_get_label_id(l0);
+	assert(local >= 10000);
+	assert(local == dalvik_label_get_label_id(l0));
+	dalvik_label_scope_end();
+	assert(0 == dalvik_label_get_label_id(l0));
+
+	/* so the same label name can be used in different methods */
+	sexpression_t* sexp;
+	const char* text = 
+		"(class (attrs public) LabelTest (super java/lang/Object)"
+		"	(method (attrs public static) f() int (limit-registers 1)"
+		"		(const v0 1) (goto LabelTest_L) (label LabelTest_L) (return v0))"
+		"	(method (attrs public static) g() int (limit-registers 1)"
+		"		(const v0 2) (goto LabelTest_L) (label LabelTest_L) (return v0)))";
+	assert(NULL != sexp_parse(text, &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(!dalvik_label_exists(stringpool_query("LabelTest_L")));
+
+	/* the array data of <fill_array_data> is resolved in the method that makes the call */
+	const char* data_text = 
+		"(class (attrs public) LabelDataTest (super java/lang/Object)"
+		"	(method (attrs public static) f() void (limit-registers 1)"
+		"		(const v0 0)"
+		"		(invoke-static {v0} java/lang/reflect/Array/<fill_array_data> ([object __array_data_LabelTest_D]) void)"
+		"		(return-void)"
+		"		(label LabelTest_D) (data array (0x01) (0x02)))"
+		"	(method (attrs public static) g() void (limit-registers 1)"
+		"		(const v0 0)"
+		"		(invoke-static {v0} java/lang/reflect/Array/<fill_array_data> ([object __array_data_LabelTest_D]) void)"
+		"		(return-void)"
+		"		(label LabelTest_D) (data array (0xff)))"
+		")";
+	assert(NULL != sexp_parse(data_text, &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+	const char* names[] = {"f", "g"};
+	const int32_t first[] = {1, -1};
+	for(i = 0; i < 2; i ++)
+	{
+		const dalvik_method_t* method = dalvik_memberdict_get_method(stringpool_query("LabelDataTest"), stringpool_query(names[i]), noarg, DALVIK_TYPE_VOID);
+		assert(NULL != method);
+		const dalvik_instruction_t* ins = dalvik_instruction_get(dalvik_instruction_get(method->entry)->next);
+		assert(DVM_INVOKE == ins->opcode);
+		dalvik_instruction_invoke_annotation_t annotation;
+		dalvik_instruction_read_annotation(ins, &annotation, sizeof(annotation));
+		assert(annotation.labelid >= 0);
+		const dalvik_instruction_t* data = dalvik_instruction_get(dalvik_label_jump_table[annotation.labelid]);
+		assert(NULL != data);
+		assert(DVM_ARRAY == data->opcode && DVM_FLAG_ARRAY_DATA == data->flags);
+		assert(first[i] == *(const int32_t*)vector_get(data->operands[0].payload.data, 0));
+	}
+
 	adam_finalize();
 	return 0;
 }
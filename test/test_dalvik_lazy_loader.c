@@ -0,0 +1,47 @@
+#include <assert.h>
+#include <adam.h>
+extern int dalvik_static_field_count;
+int main()
+{
+	adam_init();
+	sexpression_t* sint;
+	assert(NULL != sexp_parse("int", &sint));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sint);
+	sexp_free(sint);
+	assert(NULL != tint);
+	const dalvik_type_t* type[1] = {};
+
+	/* nothing is parsed, but the static fields are reserved at index time */
+	assert(0 == dalvik_loader_index_directory("./test/cases/analyzer"));
+	assert(8 == dalvik_loader_num_pending());
+	assert(8 == dalvik_loader_num_classes());
+	assert(5 == dalvik_static_field_count);
+	assert(0 == dalvik_loader_load_class(stringpool_query("noSuchClass")));
+
+	/* the block graph builder loads testClass only */
+	const char* classpath = stringpool_query("testClass");
+	const dalvik_block_t* graph = dalvik_block_from_method(classpath, stringpool_query("neg"), type, tint);
+	assert(NULL != graph);
+	assert(7 == dalvik_loader_num_pending());
+	assert(0 == dalvik_loader_load_class(classpath));
+	assert(NULL != dalvik_memberdict_get_class(classpath));
+
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	assert(7 == dalvik_loader_num_pending());
+
+	/* a class hierarchy query needs every class */
+	const char* buf[16];
+	assert(2 == dalvik_hierarchy_get_subclasses(stringpool_query("BaseClass"), 0, buf, 16));
+	assert(0 == dalvik_loader_num_pending());
+	assert(5 == dalvik_static_field_count);
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
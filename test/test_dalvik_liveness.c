@@ -0,0 +1,103 @@
+#include <adam.h>
+#include <assert.h>
+/* analyze LivenessTest/dead with the given value in the argument register, returns the relocation table */
+static cesk_reloc_table_t* analyze(const dalvik_block_t* graph, uint32_t arg)
+{
+	cesk_frame_t* frame = cesk_frame_new(graph->nregs);
+	assert(NULL != frame);
+	assert(0 == cesk_set_push(frame->regs[CESK_FRAME_GENERAL_REG(1)], arg));
+	cesk_reloc_table_t* rtab;
+	cesk_diff_t* ret = cesk_method_analyze(graph, frame, NULL, &rtab);
+	assert(NULL != ret);
+	cesk_diff_free(ret);
+	cesk_frame_free(frame);
+	return rtab;
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) LivenessTest (super java/lang/Object)"
+		"	(method (attrs public static) branch(int int) int (limit-registers 3)"
+		"		(if-eqz v1 LivenessTest_Lzero)"
+		"		(const v0 1)"
+		"		(return v0)"
+		"		(label LivenessTest_Lzero)"
+		"		(return v2))"
+		"	(method (attrs public static) choose(int) int (limit-registers 3)"
+		"		(const v1 7)"
+		"		(packed-switch v2 0 LivenessTest_L0 LivenessTest_L1 LivenessTest_Ldefault)"
+		"		(label LivenessTest_Ldefault)"
+		"		(return v1)"
+		"		(label LivenessTest_L0)"
+		"		(const v0 0)"
+		"		(return v0)"
+		"		(label LivenessTest_L1)"
+		"		(return v2))"
+		"	(method (attrs public static) dead(int) int (limit-registers 2)"
+		"		(const v0 1)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* intarg[] = {tint, NULL};
+	const dalvik_type_t* twoargs[] = {tint, tint, NULL};
+
+	/* both of the arguments are live at the entry, v0 is written before it's read */
+	const dalvik_block_t* branch = dalvik_block_from_method(stringpool_query("LivenessTest"), stringpool_query("branch"), twoargs, tint);
+	assert(NULL != branch);
+	assert(NULL != branch->live_in);
+	assert(!DALVIK_BLOCK_REG_IS_LIVE(branch, 0));
+	assert(DALVIK_BLOCK_REG_IS_LIVE(branch, 1));
+	assert(DALVIK_BLOCK_REG_IS_LIVE(branch, 2));
+	/* the register out of range is considered live */
+	assert(DALVIK_BLOCK_REG_IS_LIVE(branch, 3));
+	/* after the check, v1 is dead, and v2 is only live on the branch that returns it */
+	int i, nlive = 0;
+	for(i = 0; i < branch->nbranches; i ++)
+	{
+		const dalvik_block_t* target = branch->branches[i].block;
+		if(NULL == target) continue;
+		assert(!DALVIK_BLOCK_REG_IS_LIVE(target, 0));
+		assert(!DALVIK_BLOCK_REG_IS_LIVE(target, 1));
+		nlive += DALVIK_BLOCK_REG_IS_LIVE(target, 2);
+	}
+	assert(1 == nlive);
+
+	/* the default branch of a packed switch is a jump, and the value of v1 reaches it */
+	const dalvik_block_t* choose = dalvik_block_from_method(stringpool_query("LivenessTest"), stringpool_query("choose"), intarg, tint);
+	assert(NULL != choose);
+	assert(NULL != choose->live_in);
+	assert(!DALVIK_BLOCK_REG_IS_LIVE(choose, 0));
+	assert(!DALVIK_BLOCK_REG_IS_LIVE(choose, 1));
+	assert(DALVIK_BLOCK_REG_IS_LIVE(choose, 2));
+	assert(3 == choose->nbranches);
+	const dalvik_block_branch_t* def = choose->branches + choose->nbranches - 1;
+	assert(DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_JUMP(*def));
+	assert(NULL != def->block);
+	assert(DALVIK_BLOCK_REG_IS_LIVE(def->block, 1));
+	assert(!DALVIK_BLOCK_REG_IS_LIVE(def->block, 2));
+	for(i = 0; i < choose->nbranches - 1; i ++)
+	{
+		assert(choose->branches[i].conditional);
+		assert(NULL != choose->branches[i].block);
+		assert(!DALVIK_BLOCK_REG_IS_LIVE(choose->branches[i].block, 1));
+	}
+
+	/* the argument is never read, so the calls with different arguments share the cache entry */
+	const dalvik_block_t* dead = dalvik_block_from_method(stringpool_query("LivenessTest"), stringpool_query("dead"), intarg, tint);
+	assert(NULL != dead);
+	assert(!DALVIK_BLOCK_REG_IS_LIVE(dead, 1));
+	cesk_reloc_table_t* rtab = analyze(dead, CESK_STORE_ADDR_POS);
+	assert(NULL != rtab);
+	assert(rtab == analyze(dead, CESK_STORE_ADDR_NEG));
+	cesk_method_clean_cache();
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include <assert.h>
+#include <string.h>
+#include <adam.h>
+int main()
+{
+	adam_init();
+	assert(0 == dalvik_loader_from_directory("./test/cases/analyzer"));
+	
+	const char* classpath[1024];
+	const char* methodname[1024];
+	const dalvik_type_t* const * signature[1024];
+	const dalvik_type_t* rtype[1024];
+	int n, i;
+
+	/* the result is sorted by class path */
+	n = dalvik_memberdict_find_class_by_prefix("TestClass", classpath, 1024);
+	assert(2 == n);
+	assert(classpath[0] == stringpool_query("TestClass1"));
+	assert(classpath[1] == stringpool_query("TestClass2"));
+
+	/* prefix is case sensitive */
+	n = dalvik_memberdict_find_class_by_prefix("test", classpath, 1024);
+	assert(1 == n);
+	assert(classpath[0] == stringpool_query("testClass"));
+
+	/* the class path is a prefix of the query, this is not a match */
+	assert(0 == dalvik_memberdict_find_class_by_prefix("TestClass1/foo", classpath, 1024));
+
+	/* every class should be found with an empty prefix */
+	assert(8 == dalvik_memberdict_find_class_by_prefix("", classpath, 1024));
+
+	/* the buffer size is respected */
+	assert(3 == dalvik_memberdict_find_class_by_prefix("", classpath, 3));
+
+	/* find the members */
+	n = dalvik_memberdict_find_member_by_prefix("TestClass2", "set", classpath, methodname, signature, rtype, 1024);
+	assert(1 == n);
+	assert(methodname[0] == stringpool_query("setValue"));
+	assert(NULL != signature[0]);
+
+	n = dalvik_memberdict_find_member_by_prefix("TestClass2", "", classpath, methodname, signature, rtype, 1024);
+	for(i = 0; i < n; i ++)
+		assert(classpath[i] == stringpool_query("TestClass2"));
+	/* the class itself, one field and four methods */
+	assert(6 == n);
+
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <adam.h>
+#include <assert.h>
+/* count the disabled branches of the blocks reachable from the entry */
+static int count_disabled(const dalvik_block_t* entry, const dalvik_block_t** list)
+{
+	if(NULL == entry || NULL != list[entry->index]) return 0;
+	list[entry->index] = entry;
+	int i, ret = 0;
+	for(i = 0; i < entry->nbranches; i ++)
+	{
+		if(entry->branches[i].disabled) ret ++;
+		else if(!DALVIK_BLOCK_BRANCH_UNCOND_TYPE_IS_RETURN(entry->branches[i]))
+			ret += count_disabled(entry->branches[i].block, list);
+	}
+	return ret;
+}
+static int disabled_branches(const dalvik_block_t* graph)
+{
+	const dalvik_block_t* list[64] = {};
+	assert(graph->info->nblocks <= 64);
+	return count_disabled(graph, list);
+}
+int main()
+{
+	adam_init();
+	sexpression_t* sexp;
+	assert(NULL != sexp_parse(
+		"(class (attrs public) PrepassBase (super java/lang/Object))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse(
+		"(class (attrs public) PrepassChild (super PrepassBase))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+	assert(NULL != sexp_parse(
+		"(class (attrs public) PrepassTest (super java/lang/Object)"
+		"	(method (attrs public static) known() int (limit-registers 2)"
+		"		(new-instance v0 PrepassChild)"
+		"		(if-nez v0 PrepassTest_Lnonnull)"
+		"		(const v1 -1)"
+		"		(return v1)"
+		"		(label PrepassTest_Lnonnull)"
+		"		(instance-of v1 v0 [object PrepassBase])"
+		"		(if-eqz v1 PrepassTest_Lnotbase)"
+		"		(instance-of v1 v0 [object java/lang/String])"
+		"		(if-nez v1 PrepassTest_Lstring)"
+		"		(const v1 1)"
+		"		(return v1)"
+		"		(label PrepassTest_Lnotbase)"
+		"		(const v1 -2)"
+		"		(return v1)"
+		"		(label PrepassTest_Lstring)"
+		"		(const v1 -3)"
+		"		(return v1))"
+		"	(method (attrs public static) cast(int) int (limit-registers 3)"
+		"		(if-eqz v2 PrepassTest_Lnull)"
+		"		(new-instance v0 PrepassChild)"
+		"		(goto PrepassTest_Lcast)"
+		"		(label PrepassTest_Lnull)"
+		"		(const v0 0)"
+		"		(label PrepassTest_Lcast)"
+		"		(check-cast v0 PrepassBase)"
+		"		(check-cast v0 java/lang/String)"
+		"		(if-eqz v0 PrepassTest_Lcastnull)"
+		"		(const v1 1)"
+		"		(return v1)"
+		"		(label PrepassTest_Lcastnull)"
+		"		(const v1 0)"
+		"		(return v1))"
+		"	(method (attrs public static) unknown(int) int (limit-registers 2)"
+		"		(if-eqz v1 PrepassTest_Lzero)"
+		"		(const v0 1)"
+		"		(return v0)"
+		"		(label PrepassTest_Lzero)"
+		"		(const v0 0)"
+		"		(return v0)))", &sexp));
+	assert(NULL != dalvik_class_from_sexp(sexp));
+	sexp_free(sexp);
+
+	assert(NULL != sexp_parse("int", &sexp));
+	dalvik_type_t* tint = dalvik_type_from_sexp(sexp);
+	sexp_free(sexp);
+	const dalvik_type_t* noarg[] = {NULL};
+	const dalvik_type_t* intarg[] = {tint, NULL};
+
+	/* the null check and both of the instance-of checks are decided */
+	const dalvik_block_t* known = dalvik_block_from_method(stringpool_query("PrepassTest"), stringpool_query("known"), noarg, tint);
+	assert(NULL != known);
+	assert(3 == disabled_branches(known));
+
+	/* the register holds null or a PrepassChild, only null passes the cast to java/lang/String */
+	const dalvik_block_t* cast = dalvik_block_from_method(stringpool_query("PrepassTest"), stringpool_query("cast"), intarg, tint);
+	assert(NULL != cast);
+	assert(1 == disabled_branches(cast));
+
+	/* nothing is known about the argument */
+	const dalvik_block_t* unknown = dalvik_block_from_method(stringpool_query("PrepassTest"), stringpool_query("unknown"), intarg, tint);
+	assert(NULL != unknown);
+	assert(0 == disabled_branches(unknown));
+
+	dalvik_type_free(tint);
+	adam_finalize();
+	return 0;
+}
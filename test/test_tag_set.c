@@ -52,6 +52,16 @@ int main()
 	assert(tag_set_equal(ts6, ts3));
 	assert(tag_set_equal(ts5, ts4));
 
+	/* the merge is commutative, and the contents of equal sets are shared */
+	tag_set_t* ts7 = tag_set_merge(ts3, ts2);
+	assert(NULL != ts7);
+	assert(tag_set_equal(ts7, ts4));
+	assert(tag_set_hashcode(ts7) == tag_set_hashcode(ts4));
+	assert(tag_set_id(ts7) != tag_set_id(ts4));
+	assert(tag_set_contains(ts7, TAG_FILECONTENT));
+	assert(!tag_set_contains(ts2, TAG_FILECONTENT));
+	tag_set_free(ts7);
+
 	tag_set_free(ts4);
 	tag_set_free(ts5);
 	tag_set_free(ts3);
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <adam.h>
+/* create a tag set in the transaction of an instruction */
+static tag_set_t* at(uint32_t inst, tag_set_t* (*make)(const tag_set_t*, const tag_set_t*), const tag_set_t* first, const tag_set_t* second, uint32_t tag)
+{
+	assert(0 == tag_tracker_instruction_transaction_begin(0, inst));
+	tag_set_t* ret;
+	if(NULL != make) 
+		ret = make(first, second);
+	else
+	{
+		uint32_t resol = TAG_RES_EXACT;
+		ret = tag_set_from_array(&tag, &resol, 1);
+	}
+	assert(NULL != ret);
+	assert(0 == tag_tracker_transaction_close());
+	return ret;
+}
+int main()
+{
+	adam_init();
+	/* a(10) -> c(12) -> d(13) -> e(15)
+	 * b(11) -> c(12), b(11) -> d(13), a2(14) -> e(15) */
+	tag_set_t* a = at(10, NULL, NULL, NULL, TAG_FILECONTENT);
+	tag_set_t* b = at(11, NULL, NULL, NULL, TAG_FILENAME);
+	tag_set_t* c = at(12, tag_set_merge, a, b, 0);
+	tag_set_t* d = at(13, tag_set_merge, c, b, 0);
+	tag_set_t* a2 = at(14, NULL, NULL, NULL, TAG_FILECONTENT);
+	tag_set_t* e = at(15, tag_set_merge, d, a2, 0);
+
+	assert(1 == tag_tracker_reachable(TAG_FILECONTENT, tag_set_id(e)));
+	assert(1 == tag_tracker_reachable(TAG_FILENAME, tag_set_id(e)));
+	assert(0 == tag_tracker_reachable(TAG_FILECONTENT, tag_set_id(b)));
+	assert(0 == tag_tracker_reachable(TAG_FILENAME, tag_set_id(a2)));
+
+	/* the paths only go through the tag sets containing the tag */
+	uint32_t* paths[4];
+	void* stack[4];
+	assert(2 == tag_tracker_get_path(TAG_FILECONTENT, tag_set_id(e), paths, 4, stack));
+	uint32_t expected0[] = {15, 13, 12, 10, DALVIK_INSTRUCTION_INVALID};
+	uint32_t expected1[] = {15, 14, DALVIK_INSTRUCTION_INVALID};
+	assert(0 == memcmp(expected0, paths[0], sizeof(expected0)));
+	assert(0 == memcmp(expected1, paths[1], sizeof(expected1)));
+	/* the stack info of the source */
+	assert(10 == tag_tracker_stack_backtrace(stack + 0));
+	assert(14 == tag_tracker_stack_backtrace(stack + 1));
+	free(paths[0]);
+	free(paths[1]);
+	/* at most N paths */
+	assert(1 == tag_tracker_get_path(TAG_FILECONTENT, tag_set_id(e), paths, 1, NULL));
+	free(paths[0]);
+
+	uint32_t buf[8];
+	assert(2 == tag_tracker_shortest_path(TAG_FILECONTENT, tag_set_id(e), buf, 8, NULL));
+	assert(15 == buf[0] && 14 == buf[1] && DALVIK_INSTRUCTION_INVALID == buf[2]);
+	assert(tag_tracker_shortest_path(TAG_FILECONTENT, tag_set_id(e), buf, 2, NULL) < 0);
+	assert(tag_tracker_shortest_path(TAG_FILECONTENT, tag_set_id(b), buf, 8, NULL) < 0);
+
+	/* e is the only sink, because all the other tag sets flow to it */
+	assert(1 == tag_tracker_get_sinks(TAG_FILECONTENT, buf, 8));
+	assert(tag_set_id(e) == buf[0]);
+	assert(1 == tag_tracker_get_sinks(TAG_FILENAME, buf, 8));
+	assert(tag_set_id(e) == buf[0]);
+
+	/* the graph grows after the queries */
+	tag_set_t* f = at(16, tag_set_merge, e, b, 0);
+	assert(1 == tag_tracker_get_sinks(TAG_FILECONTENT, buf, 8));
+	assert(tag_set_id(f) == buf[0]);
+	assert(3 == tag_tracker_shortest_path(TAG_FILECONTENT, tag_set_id(f), buf, 8, NULL));
+
+	/* only the tag sets containing FILENAME are tracked in compact tainted mode */
+	assert(0 == tag_tracker_set_mode(TAG_TRACKER_MODE_COMPACT | TAG_TRACKER_MODE_TAINTED));
+	assert(0 == tag_tracker_watch(TAG_FILENAME));
+	tag_set_t* g = at(17, NULL, NULL, NULL, TAG_FILECONTENT);
+	tag_set_t* h = at(18, NULL, NULL, NULL, TAG_FILENAME);
+	tag_set_t* i = at(19, tag_set_merge, g, h, 0);
+	assert(2 == tag_tracker_shortest_path(TAG_FILENAME, tag_set_id(i), buf, 8, NULL));
+	assert(19 == buf[0] && 18 == buf[1]);
+	assert(0 == tag_tracker_reachable(TAG_FILECONTENT, tag_set_id(g)));
+	assert(0 == tag_tracker_reachable(TAG_FILECONTENT, tag_set_id(i)));
+	assert(tag_tracker_memory_usage() > 0);
+	assert(0 == tag_tracker_set_mode(TAG_TRACKER_MODE_FULL));
+
+	tag_set_free(g);
+	tag_set_free(h);
+	tag_set_free(i);
+	tag_set_free(a);
+	tag_set_free(b);
+	tag_set_free(c);
+	tag_set_free(d);
+	tag_set_free(a2);
+	tag_set_free(e);
+	tag_set_free(f);
+	adam_finalize();
+	return 0;
+}
@@ -29,7 +29,7 @@ GVC_t* gvc = NULL;
 #define PROMPT "(adb) "
 static inline void dfs_block_list(const dalvik_block_t* entry, const dalvik_block_t** bl)
 {
-	if(NULL == entry) return;
+	if(NULL == entry || entry->index >= entry->info->nblocks) return;
 	if(bl[entry->index] != NULL) return;
 	bl[entry->index] = entry;
 	int i;
@@ -40,13 +40,29 @@ static inline void dfs_block_list(const dalvik_block_t* entry, const dalvik_bloc
 			dfs_block_list(entry->branches[i].block, bl);
 		}
 }
+/**
+ * @brief collect the blocks of a graph, the list is indexed by the block index
+ * @param graph the entry block of the graph
+ * @return the block list which should be freed by the caller, NULL on error
+ **/
+static inline const dalvik_block_t** block_list_new(const dalvik_block_t* graph)
+{
+	const dalvik_block_t** bl = (const dalvik_block_t**)calloc(graph->info->nblocks, sizeof(const dalvik_block_t*));
+	if(NULL == bl)
+	{
+		LOG_ERROR("can not allocate memory for the block list");
+		return NULL;
+	}
+	dfs_block_list(graph, bl);
+	return bl;
+}
 void cli_code_to_dot(const dalvik_block_t* block, uint32_t iid, FILE* fout)
 {
 	const dalvik_block_t* graph = dalvik_block_from_method(block->info->class, block->info->method, block->info->signature, block->info->return_type);
-	const dalvik_block_t* block_list[DALVIK_BLOCK_MAX_KEYS] = {};
-	dfs_block_list(graph, block_list);
+	const dalvik_block_t** block_list = block_list_new(graph);
+	if(NULL == block_list) return;
 	int i,j;
-	for(i = 0; i < DALVIK_BLOCK_MAX_KEYS; i ++)
+	for(i = 0; i < graph->info->nblocks; i ++)
 	{
 		if(NULL == block_list[i]) continue;
 		fprintf(fout, "	CB%d[shape=record,", i);
@@ -77,6 +93,7 @@ void cli_code_to_dot(const dalvik_block_t* block, uint32_t iid, FILE* fout)
 
 			}
 	}
+	free(block_list);
 }
 void cli_frame_to_dot(const cesk_frame_t* output, FILE* fout)
 {
@@ -322,6 +339,8 @@ int main(int argc, char** argv)
 {
 	int i;
 	adam_init();
+	/* the block graph display shows the dominator tree and the loop nesting */
+	dalvik_block_loop_info_enabled = 1;
 	cli_command_init();
 #ifdef WITH_GRAPHVIZ
 	gvc = gvContext();
@@ -477,6 +496,16 @@ int do_help(cli_command_t* cmd)
 }
 int do_load(cli_command_t* cmd)
 {
+	if(cmd->index == 30)
+	{
+		/* only index the classes, they are parsed when they are referenced */
+		const char* path = cmd->args[2].string;
+		if(dalvik_loader_index_directory(path) < 0)
+			cli_error("can not index path %s", path);
+		else
+			cli_error("%u classes indexed", dalvik_loader_num_pending());
+		return CLI_COMMAND_DONE;
+	}
 	const char* path = cmd->args[1].string;
 	if(dalvik_loader_from_directory(path) < 0)
 		cli_error("can not load path %s", path);
@@ -486,7 +515,6 @@ int do_list_blocks(cli_command_t* cmd)
 {
 	const char* name = cmd->args[2].function.method;
 	const char* class = cmd->args[2].function.class;
-	const dalvik_block_t* block_list[DALVIK_BLOCK_MAX_KEYS] = {};
 	const dalvik_type_t * const * T = (const dalvik_type_t * const *) cmd->args[2].function.signature;
 	const dalvik_type_t* R = (const dalvik_type_t*) cmd->args[2].function.return_type;
 	const dalvik_block_t* graph = dalvik_block_from_method(class, name, T, R);
@@ -495,12 +523,14 @@ int do_list_blocks(cli_command_t* cmd)
 		cli_error("can not find function %s %s.%s%s", dalvik_type_to_string(R, NULL, 0), class, name, dalvik_type_list_to_string(T, NULL, 0));
 		return CLI_COMMAND_ERROR;
 	}
-	dfs_block_list(graph, block_list);
+	const dalvik_block_t** block_list = block_list_new(graph);
+	if(NULL == block_list) return CLI_COMMAND_ERROR;
 	int i,j;
-	for(i = 0; i < DALVIK_BLOCK_MAX_KEYS; i ++)
+	for(i = 0; i < graph->info->nblocks; i ++)
 	{
 		if(NULL == block_list[i]) continue;
-		printf("Block #%d --> ", i);
+		printf("Block #%d (idom #%u, loop depth %u%s) --> ", i, block_list[i]->idom, block_list[i]->loop_depth, 
+		       block_list[i]->loop_header ? ", loop header" : "");
 		for(j = 0; j < block_list[i]->nbranches; j ++)
 			if(!block_list[i]->branches[j].disabled)
 			{
@@ -511,13 +541,13 @@ int do_list_blocks(cli_command_t* cmd)
 			}
 		puts("");
 	}
+	free(block_list);
 	return CLI_COMMAND_DONE;
 }
 int do_list_code(cli_command_t* cmd)
 {
 	const char* name = cmd->args[2].function.method;
 	const char* class = cmd->args[2].function.class;
-	const dalvik_block_t* block_list[DALVIK_BLOCK_MAX_KEYS] = {};
 	const dalvik_type_t * const * T = (const dalvik_type_t * const *) cmd->args[2].function.signature;
 	const dalvik_type_t* R = (const dalvik_type_t*) cmd->args[2].function.return_type;
 	const dalvik_block_t* graph = dalvik_block_from_method(class, name, T, R);
@@ -526,11 +556,12 @@ int do_list_code(cli_command_t* cmd)
 		cli_error("can not find function %s %s.%s%s", dalvik_type_to_string(R, NULL, 0), class, name, dalvik_type_list_to_string(T, NULL, 0));
 		return CLI_COMMAND_ERROR;
 	}
-	dfs_block_list(graph, block_list);
+	const dalvik_block_t** block_list = block_list_new(graph);
+	if(NULL == block_list) return CLI_COMMAND_ERROR;
 	if(cmd->index == 3)
 	{
 		int i;
-		for(i = 0; i < DALVIK_BLOCK_MAX_KEYS; i ++)
+		for(i = 0; i < graph->info->nblocks; i ++)
 		{
 			if(block_list[i] == NULL) continue;
 			uint32_t j;
@@ -542,7 +573,7 @@ int do_list_code(cli_command_t* cmd)
 	else
 	{
 		uint32_t i = cmd->args[3].numeral;
-		if(block_list[i] != NULL)
+		if(i < graph->info->nblocks && block_list[i] != NULL)
 		{
 			uint32_t j;
 			printf("Block #%d:\n", i);
@@ -550,6 +581,7 @@ int do_list_code(cli_command_t* cmd)
 				printf("\t0x%x\t%s\n", j, dalvik_instruction_to_string(dalvik_instruction_get(j), NULL, 0));
 		}
 	}
+	free(block_list);
 	return CLI_COMMAND_DONE;
 }
 int do_quit(cli_command_t* cmd)
@@ -596,6 +628,67 @@ int do_list_method(cli_command_t* cmd)
 	}
 	return CLI_COMMAND_DONE;
 }
+int do_list_subclasses(cli_command_t* cmd)
+{
+	static const char* classpath[16384];
+	int rc;
+	if((rc = dalvik_hierarchy_get_subclasses(cmd->args[2].class, 1, classpath, sizeof(classpath)/sizeof(classpath[0]))) < 0)
+	{
+		return CLI_COMMAND_ERROR;
+	}
+	int i;
+	for(i = 0; i < rc; i ++)
+		printf("%s\n", classpath[i]);
+	return CLI_COMMAND_DONE;
+}
+int do_list_implementors(cli_command_t* cmd)
+{
+	static const char* classpath[16384];
+	int rc;
+	if((rc = dalvik_hierarchy_get_implementors(cmd->args[2].class, classpath, sizeof(classpath)/sizeof(classpath[0]))) < 0)
+	{
+		return CLI_COMMAND_ERROR;
+	}
+	int i;
+	for(i = 0; i < rc; i ++)
+		printf("%s\n", classpath[i]);
+	return CLI_COMMAND_DONE;
+}
+int do_list_overriders(cli_command_t* cmd)
+{
+	static const char* classpath[16384];
+	const char* name = cmd->args[2].function.method;
+	const char* class = cmd->args[2].function.class;
+	const dalvik_type_t * const * T = (const dalvik_type_t * const *) cmd->args[2].function.signature;
+	const dalvik_type_t* R = (const dalvik_type_t*) cmd->args[2].function.return_type;
+	int rc;
+	if((rc = dalvik_hierarchy_get_overriders(class, name, T, R, classpath, sizeof(classpath)/sizeof(classpath[0]))) < 0)
+	{
+		return CLI_COMMAND_ERROR;
+	}
+	int i;
+	for(i = 0; i < rc; i ++)
+		printf("%s\n", classpath[i]);
+	const char* target = dalvik_hierarchy_resolve_monomorphic(class, name, T, R);
+	if(NULL != target) printf("monomorphic call site, the target is %s.%s\n", target, name);
+	return CLI_COMMAND_DONE;
+}
+int do_precompute(cli_command_t* cmd)
+{
+	int n = dalvik_block_precompute(0);
+	if(n < 0)
+	{
+		cli_error("can not precompute the block graphs");
+		return CLI_COMMAND_ERROR;
+	}
+	printf("%d block graphs are built\n", n);
+	return CLI_COMMAND_DONE;
+}
+int do_stats(cli_command_t* cmd)
+{
+	perf_dump(stdout);
+	return CLI_COMMAND_DONE;
+}
 int do_break(cli_command_t* cmd)
 {
 	uint32_t iid = 0xfffffffful;
@@ -607,7 +700,6 @@ int do_break(cli_command_t* cmd)
 	{
 		const char* name = cmd->args[2].function.method;
 		const char* class = cmd->args[2].function.class;
-		const dalvik_block_t* block_list[DALVIK_BLOCK_MAX_KEYS] = {};
 		const dalvik_type_t * const * T = (const dalvik_type_t * const *) cmd->args[2].function.signature;
 		const dalvik_type_t* R = (const dalvik_type_t*) cmd->args[2].function.return_type;
 		const dalvik_block_t* graph = dalvik_block_from_method(class, name, T, R);
@@ -616,12 +708,14 @@ int do_break(cli_command_t* cmd)
 			cli_error("can not find function %s %s.%s%s", dalvik_type_to_string(R, NULL, 0), class, name, dalvik_type_list_to_string(T, NULL, 0));
 			return CLI_COMMAND_ERROR;
 		}
-		dfs_block_list(graph, block_list);
-		int id = 0;
+		const dalvik_block_t** block_list = block_list_new(graph);
+		if(NULL == block_list) return CLI_COMMAND_ERROR;
+		uint32_t id = 0;
 		if(cmd->index == 10) id = cmd->args[3].numeral;
-		if(id < DALVIK_BLOCK_MAX_KEYS && NULL != block_list[id])  
+		if(id < graph->info->nblocks && NULL != block_list[id])  
 			iid = block_list[id]->begin;
-		else
+		free(block_list);
+		if(0xfffffffful == iid)
 			return CLI_COMMAND_ERROR;
 	}
 	breakpoints[n_breakpoints++] = iid;
@@ -979,5 +1073,41 @@ Commands
 		Method(do_frame_allocate)
 	EndCommand
 
+	Command(25)
+		{"list", "subclasses", CLASSPATH, NULL}
+		Desc("List all subclasses of the class")
+		Method(do_list_subclasses)
+	EndCommand
+
+	Command(26)
+		{"list", "implementors", CLASSPATH, NULL}
+		Desc("List all classes implement the interface")
+		Method(do_list_implementors)
+	EndCommand
+
+	Command(27)
+		{"list", "overriders", FUNCTION, NULL}
+		Desc("List all classes that might provide the virtual method")
+		Method(do_list_overriders)
+	EndCommand
+
+	Command(28)
+		{"stats", NULL}
+		Desc("Show the instrumentation counters (requires cmake -DPERF=yes)")
+		Method(do_stats)
+	EndCommand
+
+	Command(29)
+		{"precompute", NULL}
+		Desc("Build the block graphs of all loaded methods in parallel")
+		Method(do_precompute)
+	EndCommand
+
+	Command(30)
+		{"load", "lazy", FILENAME, NULL}
+		Desc("index dalvik bytecode in a directory, the classes are loaded on demand")
+		Method(do_load)
+	EndCommand
+
 EndCommands
 
@@ -0,0 +1,48 @@
+/**
+ * @file main.c
+ * @brief decode the binary log written with `format binary` into the text format
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <log.h>
+int main(int argc, char** argv)
+{
+	static const char LevelChar[] = "FEWNITD";
+	static char buf[65536 * 3];
+	FILE* fp = stdin;
+	if(argc > 1 && NULL == (fp = fopen(argv[1], "rb")))
+	{
+		fprintf(stderr, "can not open file %s\n", argv[1]);
+		return 1;
+	}
+	log_binary_record_t record;
+	while(fread(&record, sizeof(record), 1, fp) == 1)
+	{
+		if(record.magic != LOG_BINARY_MAGIC || record.level > DEBUG)
+		{
+			fprintf(stderr, "invalid log record\n");
+			return 1;
+		}
+		size_t size = (size_t)record.file_len + record.function_len + record.message_len;
+		if(fread(buf, 1, size, fp) != size)
+		{
+			fprintf(stderr, "truncated log record\n");
+			return 1;
+		}
+		time_t sec = record.timestamp / 1000000000ull;
+		struct tm tm;
+		char timestr[32];
+		strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M:%S", localtime_r(&sec, &tm));
+		printf("%s.%09llu %c[%.*s@%.*s:%u] %.*s\n",
+			   timestr, (unsigned long long)(record.timestamp % 1000000000ull),
+			   LevelChar[record.level],
+			   record.function_len, buf + record.file_len,
+			   record.file_len, buf,
+			   record.line,
+			   record.message_len, buf + record.file_len + record.function_len);
+	}
+	if(fp != stdin) fclose(fp);
+	return 0;
+}
@@ -0,0 +1,3 @@
+set(TYPE binary)
+set(LOCAL_CFLAGS "")
+set(LOCAL_LIBS )
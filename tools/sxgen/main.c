@@ -0,0 +1,213 @@
+/**
+ * @file main.c
+ * @brief generate synthetic dex2sex-style S-Expression class files for scaling tests
+ * @details The generated classes are organized in inheritance chains, each method contains nested
+ *          loops, reads static fields, invokes other methods inside try blocks and the call graph
+ *          is a DAG with a given fan-out. The output is deterministic for a given seed.
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+/** @brief the knobs of the generator */
+static struct {
+	int classes;      /*!< number of classes */
+	int methods;      /*!< methods per class */
+	int depth;        /*!< the length of inheritance chains */
+	int fanout;       /*!< number of callees per method */
+	int loops;        /*!< loop nesting level in each method */
+	int statics;      /*!< static fields per class */
+	int handlers;     /*!< exception handlers per method */
+	unsigned seed;    /*!< the random seed */
+	const char* package;  /*!< the package of the generated classes */
+	const char* output;   /*!< the output directory, "-" for stdout */
+} _knobs = {
+	.classes  = 100,
+	.methods  = 4,
+	.depth    = 3,
+	.fanout   = 2,
+	.loops    = 1,
+	.statics  = 2,
+	.handlers = 1,
+	.seed     = 1,
+	.package  = "synthetic",
+	.output   = "-"
+};
+/** @brief the state of the random number generator */
+static unsigned long long _rand_state;
+/**
+ * @brief a deterministic random number generator (LCG), so that the output does not depend on libc
+ * @return the random number
+ **/
+static inline unsigned _rand()
+{
+	_rand_state = _rand_state * 6364136223846793005ull + 1442695040888963407ull;
+	return (unsigned)(_rand_state >> 33);
+}
+/**
+ * @brief print the usage
+ * @param prog the program name
+ * @return nothing
+ **/
+static void usage(const char* prog)
+{
+	fprintf(stderr, "Usage: %s [options]\n"
+	                "\t-c <n>   number of classes (default %d)\n"
+	                "\t-m <n>   methods per class (default %d)\n"
+	                "\t-d <n>   inheritance depth (default %d)\n"
+	                "\t-f <n>   call graph fan-out (default %d)\n"
+	                "\t-l <n>   loop nesting (default %d)\n"
+	                "\t-s <n>   static fields per class (default %d)\n"
+	                "\t-e <n>   exception handlers per method (default %d)\n"
+	                "\t-r <n>   random seed (default %u)\n"
+	                "\t-p <pkg> package of the classes (default %s)\n"
+	                "\t-o <dir> output directory, one file per class, - for stdout (default %s)\n",
+	        prog, _knobs.classes, _knobs.methods, _knobs.depth, _knobs.fanout, _knobs.loops,
+	        _knobs.statics, _knobs.handlers, _knobs.seed, _knobs.package, _knobs.output);
+}
+/**
+ * @brief write the super class of a class
+ * @param fp the output file
+ * @param cls the class index
+ * @return nothing
+ **/
+static void write_super(FILE* fp, int cls)
+{
+	if(cls % _knobs.depth == 0)
+		fprintf(fp, "\t(super java/lang/Object)\n");
+	else
+		fprintf(fp, "\t(super %s/C%d)\n", _knobs.package, cls - 1);
+}
+/**
+ * @brief write a static method
+ * @param fp the output file
+ * @param cls the class index
+ * @param mid the method index
+ * @return nothing
+ **/
+static void write_method(FILE* fp, int cls, int mid)
+{
+	/* v0: accumulator, v1: constant 1, v2: loop bound, v3: temporary,
+	 * v4 .. v(3+loops): loop counters, v(4+loops): the argument */
+	int nregs = 5 + _knobs.loops;
+	int k, e;
+	fprintf(fp, "\t(method (attrs public static) m%d(int) int\n", mid);
+	fprintf(fp, "\t\t(limit-registers %d)\n", nregs);
+	for(e = 0; e < _knobs.handlers; e ++)
+		fprintf(fp, "\t\t(catch java/lang/Exception from C%d_m%d_T%d to C%d_m%d_U%d using C%d_m%d_H%d)\n",
+		        cls, mid, e, cls, mid, e, cls, mid, e);
+	fprintf(fp, "\t\t(move v0 v%d)\n\t\t(const v1 1)\n\t\t(const v2 10)\n", nregs - 1);
+	if(_knobs.statics > 0)
+		fprintf(fp, "\t\t(sget v3 %s/C%d.S%d int)\n\t\t(add-int v0 v0 v3)\n", _knobs.package, cls, mid % _knobs.statics);
+	/* the loop nest */
+	for(k = 0; k < _knobs.loops; k ++)
+		fprintf(fp, "\t\t(const v%d 0)\n\t\t(label C%d_m%d_B%d)\n\t\t(if-ge v%d v2 C%d_m%d_E%d)\n",
+		        4 + k, cls, mid, k, 4 + k, cls, mid, k);
+	if(_knobs.loops > 0) fprintf(fp, "\t\t(add-int v0 v0 v1)\n");
+	for(k = _knobs.loops - 1; k >= 0; k --)
+		fprintf(fp, "\t\t(add-int v%d v%d v1)\n\t\t(goto C%d_m%d_B%d)\n\t\t(label C%d_m%d_E%d)\n",
+		        4 + k, 4 + k, cls, mid, k, cls, mid, k);
+	/* the calls, the callee always has a greater global index, so the call graph is a DAG */
+	int total = _knobs.classes * _knobs.methods;
+	int self = cls * _knobs.methods + mid;
+	int nregions = (_knobs.handlers > 0) ? _knobs.handlers : 1;
+	int r, f;
+	for(r = 0; r < nregions; r ++)
+	{
+		if(_knobs.handlers > 0) fprintf(fp, "\t\t(label C%d_m%d_T%d)\n\t\t(const v3 %d)\n", cls, mid, r, r);
+		for(f = r; f < _knobs.fanout && self + 1 < total; f += nregions)
+		{
+			int callee = self + 1 + _rand() % (total - self - 1);
+			fprintf(fp, "\t\t(invoke-static {v0} %s/C%d/m%d (int) int)\n\t\t(move-result v3)\n\t\t(add-int v0 v0 v3)\n",
+			        _knobs.package, callee / _knobs.methods, callee % _knobs.methods);
+		}
+		if(_knobs.handlers > 0) fprintf(fp, "\t\t(label C%d_m%d_U%d)\n", cls, mid, r);
+	}
+	fprintf(fp, "\t\t(label C%d_m%d_R)\n\t\t(return v0)\n", cls, mid);
+	/* the exception handlers */
+	for(e = 0; e < _knobs.handlers; e ++)
+		fprintf(fp, "\t\t(label C%d_m%d_H%d)\n\t\t(move-exception v3)\n\t\t(const v0 %d)\n\t\t(goto C%d_m%d_R)\n",
+		        cls, mid, e, -1 - e, cls, mid);
+	fprintf(fp, "\t)\n");
+}
+/**
+ * @brief write a class
+ * @param fp the output file
+ * @param cls the class index
+ * @return nothing
+ **/
+static void write_class(FILE* fp, int cls)
+{
+	int i;
+	fprintf(fp, "(class (attrs public) %s/C%d\n", _knobs.package, cls);
+	write_super(fp, cls);
+	fprintf(fp, "\t(source \"C%d.java\")\n", cls);
+	for(i = 0; i < _knobs.statics; i ++)
+		fprintf(fp, "\t(field (attrs public static) S%d int \"%d\")\n", i, (cls + i) % 100);
+	fprintf(fp, "\t(field (attrs public) value%d int)\n", cls);
+	/* a virtual method that overrides the one in the super class */
+	fprintf(fp, "\t(method (attrs public) get() int\n"
+	            "\t\t(limit-registers 2)\n"
+	            "\t\t(iget v0 v1 %s/C%d.value%d int)\n"
+	            "\t\t(return v0)\n"
+	            "\t)\n", _knobs.package, cls, cls);
+	for(i = 0; i < _knobs.methods; i ++)
+		write_method(fp, cls, i);
+	fprintf(fp, ")\n");
+}
+int main(int argc, char** argv)
+{
+	int opt;
+	while((opt = getopt(argc, argv, "c:m:d:f:l:s:e:r:p:o:h")) != -1)
+	{
+		switch(opt)
+		{
+			case 'c': _knobs.classes  = atoi(optarg); break;
+			case 'm': _knobs.methods  = atoi(optarg); break;
+			case 'd': _knobs.depth    = atoi(optarg); break;
+			case 'f': _knobs.fanout   = atoi(optarg); break;
+			case 'l': _knobs.loops    = atoi(optarg); break;
+			case 's': _knobs.statics  = atoi(optarg); break;
+			case 'e': _knobs.handlers = atoi(optarg); break;
+			case 'r': _knobs.seed     = strtoul(optarg, NULL, 0); break;
+			case 'p': _knobs.package  = optarg; break;
+			case 'o': _knobs.output   = optarg; break;
+			default:
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if(_knobs.classes <= 0 || _knobs.methods < 0 || _knobs.depth <= 0 || _knobs.fanout < 0 ||
+	   _knobs.loops < 0 || _knobs.statics < 0 || _knobs.handlers < 0)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	_rand_state = _knobs.seed;
+	int to_stdout = (strcmp(_knobs.output, "-") == 0);
+	if(!to_stdout && mkdir(_knobs.output, 0755) < 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "can not create directory %s: %s\n", _knobs.output, strerror(errno));
+		return 1;
+	}
+	int i;
+	for(i = 0; i < _knobs.classes; i ++)
+	{
+		FILE* fp = stdout;
+		if(!to_stdout)
+		{
+			char path[4096];
+			snprintf(path, sizeof(path), "%s/C%d.sxddx", _knobs.output, i);
+			if(NULL == (fp = fopen(path, "w")))
+			{
+				fprintf(stderr, "can not open file %s: %s\n", path, strerror(errno));
+				return 1;
+			}
+		}
+		write_class(fp, i);
+		if(!to_stdout) fclose(fp);
+	}
+	return 0;
+}